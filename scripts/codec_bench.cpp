@@ -0,0 +1,448 @@
+#include "net/codec.h"
+#include "net/protocol.h"
+#include "net/protocol_fields.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Byte-at-a-time codec the protocol used before wire_codec.h, kept here as the
+// comparison baseline for a representative set of messages.
+namespace legacy {
+
+bool read_u16(const std::vector<std::uint8_t> &payload, std::size_t &offset,
+              std::uint16_t &out) {
+    if (offset + 2 > payload.size()) {
+        return false;
+    }
+    out = static_cast<std::uint16_t>((payload[offset] << 8) | payload[offset + 1]);
+    offset += 2;
+    return true;
+}
+
+void write_u16(std::uint16_t value, std::vector<std::uint8_t> &out) {
+    out.push_back(static_cast<std::uint8_t>((value >> 8) & 0xFF));
+    out.push_back(static_cast<std::uint8_t>(value & 0xFF));
+}
+
+bool read_u32(const std::vector<std::uint8_t> &payload, std::size_t &offset,
+              std::uint32_t &out) {
+    if (offset + 4 > payload.size()) {
+        return false;
+    }
+    out = (static_cast<std::uint32_t>(payload[offset]) << 24) |
+          (static_cast<std::uint32_t>(payload[offset + 1]) << 16) |
+          (static_cast<std::uint32_t>(payload[offset + 2]) << 8) |
+          static_cast<std::uint32_t>(payload[offset + 3]);
+    offset += 4;
+    return true;
+}
+
+void write_u32(std::uint32_t value, std::vector<std::uint8_t> &out) {
+    out.push_back(static_cast<std::uint8_t>((value >> 24) & 0xFF));
+    out.push_back(static_cast<std::uint8_t>((value >> 16) & 0xFF));
+    out.push_back(static_cast<std::uint8_t>((value >> 8) & 0xFF));
+    out.push_back(static_cast<std::uint8_t>(value & 0xFF));
+}
+
+bool read_u64(const std::vector<std::uint8_t> &payload, std::size_t &offset,
+              std::uint64_t &out) {
+    if (offset + 8 > payload.size()) {
+        return false;
+    }
+    out = 0;
+    for (int i = 0; i < 8; ++i) {
+        out = (out << 8) | payload[offset + static_cast<std::size_t>(i)];
+    }
+    offset += 8;
+    return true;
+}
+
+void write_u64(std::uint64_t value, std::vector<std::uint8_t> &out) {
+    for (int shift = 56; shift >= 0; shift -= 8) {
+        out.push_back(static_cast<std::uint8_t>((value >> shift) & 0xFF));
+    }
+}
+
+bool read_string(const std::vector<std::uint8_t> &payload, std::size_t &offset,
+                 std::string &out) {
+    std::uint16_t size = 0;
+    if (!read_u16(payload, offset, size)) {
+        return false;
+    }
+    if (offset + size > payload.size()) {
+        return false;
+    }
+    out.assign(reinterpret_cast<const char *>(payload.data() + offset), size);
+    offset += size;
+    return true;
+}
+
+void write_string(const std::string &value, std::vector<std::uint8_t> &out) {
+    auto length = static_cast<std::uint16_t>(
+        std::min<std::size_t>(value.size(), std::numeric_limits<std::uint16_t>::max()));
+    write_u16(length, out);
+    out.insert(out.end(), value.begin(), value.begin() + length);
+}
+
+bool read_string_list(const std::vector<std::uint8_t> &payload,
+                      std::size_t &offset,
+                      std::vector<std::string> &out) {
+    std::uint16_t count = 0;
+    if (!read_u16(payload, offset, count)) {
+        return false;
+    }
+    out.clear();
+    out.reserve(count);
+    for (std::uint16_t i = 0; i < count; ++i) {
+        std::string value;
+        if (!read_string(payload, offset, value)) {
+            return false;
+        }
+        out.push_back(std::move(value));
+    }
+    return true;
+}
+
+void write_string_list(const std::vector<std::string> &values,
+                       std::vector<std::uint8_t> &out) {
+    auto length = static_cast<std::uint16_t>(
+        std::min<std::size_t>(values.size(), std::numeric_limits<std::uint16_t>::max()));
+    write_u16(length, out);
+    for (std::uint16_t i = 0; i < length; ++i) {
+        write_string(values[i], out);
+    }
+}
+
+std::vector<std::uint8_t> encodeLoginRequest(const net::LoginRequest &request) {
+    std::vector<std::uint8_t> out;
+    write_string(request.user_id, out);
+    write_string(request.password, out);
+    return out;
+}
+
+bool decodeLoginRequest(const std::vector<std::uint8_t> &payload, net::LoginRequest &out) {
+    std::size_t offset = 0;
+    if (!read_string(payload, offset, out.user_id)) {
+        return false;
+    }
+    if (!read_string(payload, offset, out.password)) {
+        return false;
+    }
+    return offset == payload.size();
+}
+
+std::vector<std::uint8_t> encodePartyEvent(const net::PartyEvent &event) {
+    std::vector<std::uint8_t> out;
+    write_u16(static_cast<std::uint16_t>(event.type), out);
+    write_u64(event.party_id, out);
+    write_string(event.actor_user_id, out);
+    write_string(event.target_user_id, out);
+    write_string_list(event.member_user_ids, out);
+    write_string(event.message, out);
+    return out;
+}
+
+bool decodePartyEvent(const std::vector<std::uint8_t> &payload, net::PartyEvent &out) {
+    std::size_t offset = 0;
+    std::uint16_t type = 0;
+    if (!read_u16(payload, offset, type)) {
+        return false;
+    }
+    out.type = static_cast<net::PartyEventType>(type);
+    if (!read_u64(payload, offset, out.party_id)) {
+        return false;
+    }
+    if (!read_string(payload, offset, out.actor_user_id)) {
+        return false;
+    }
+    if (!read_string(payload, offset, out.target_user_id)) {
+        return false;
+    }
+    if (!read_string_list(payload, offset, out.member_user_ids)) {
+        return false;
+    }
+    if (!read_string(payload, offset, out.message)) {
+        return false;
+    }
+    return offset == payload.size();
+}
+
+std::vector<std::uint8_t> encodeMatchFoundNotify(const net::MatchFoundNotify &notify) {
+    std::vector<std::uint8_t> out;
+    out.push_back(static_cast<std::uint8_t>(notify.success ? 1 : 0));
+    write_string(notify.code, out);
+    write_string(notify.message, out);
+    write_u64(notify.party_id, out);
+    write_u64(notify.instance_id, out);
+    write_string(notify.endpoint, out);
+    write_string(notify.ticket, out);
+    return out;
+}
+
+bool decodeMatchFoundNotify(const std::vector<std::uint8_t> &payload,
+                            net::MatchFoundNotify &out) {
+    if (payload.empty()) {
+        return false;
+    }
+    std::size_t offset = 0;
+    out.success = payload[offset++] != 0;
+    if (!read_string(payload, offset, out.code)) {
+        return false;
+    }
+    if (!read_string(payload, offset, out.message)) {
+        return false;
+    }
+    if (!read_u64(payload, offset, out.party_id)) {
+        return false;
+    }
+    if (!read_u64(payload, offset, out.instance_id)) {
+        return false;
+    }
+    if (!read_string(payload, offset, out.endpoint)) {
+        return false;
+    }
+    if (!read_string(payload, offset, out.ticket)) {
+        return false;
+    }
+    return offset == payload.size();
+}
+
+std::vector<std::uint8_t> encodeDungeonResultNotify(const net::DungeonResultNotify &notify) {
+    std::vector<std::uint8_t> out;
+    write_u16(static_cast<std::uint16_t>(notify.result), out);
+    write_u32(notify.time_sec, out);
+    write_u16(notify.deaths, out);
+    auto length = static_cast<std::uint16_t>(std::min<std::size_t>(
+        notify.rewards.size(), std::numeric_limits<std::uint16_t>::max()));
+    write_u16(length, out);
+    for (std::uint16_t i = 0; i < length; ++i) {
+        write_u32(notify.rewards[i].item_id, out);
+        write_u32(notify.rewards[i].count, out);
+    }
+    return out;
+}
+
+bool decodeDungeonResultNotify(const std::vector<std::uint8_t> &payload,
+                               net::DungeonResultNotify &out) {
+    std::size_t offset = 0;
+    std::uint16_t result = 0;
+    if (!read_u16(payload, offset, result)) {
+        return false;
+    }
+    out.result = static_cast<net::DungeonResultType>(result);
+    if (!read_u32(payload, offset, out.time_sec)) {
+        return false;
+    }
+    if (!read_u16(payload, offset, out.deaths)) {
+        return false;
+    }
+    std::uint16_t count = 0;
+    if (!read_u16(payload, offset, count)) {
+        return false;
+    }
+    out.rewards.clear();
+    out.rewards.reserve(count);
+    for (std::uint16_t i = 0; i < count; ++i) {
+        net::RewardItem item;
+        if (!read_u32(payload, offset, item.item_id)) {
+            return false;
+        }
+        if (!read_u32(payload, offset, item.count)) {
+            return false;
+        }
+        out.rewards.push_back(item);
+    }
+    return offset == payload.size();
+}
+
+std::vector<std::uint8_t> encodeChatEvent(const net::ChatEvent &event) {
+    std::vector<std::uint8_t> out;
+    write_u16(static_cast<std::uint16_t>(event.channel), out);
+    write_u64(event.party_id, out);
+    write_string(event.sender_user_id, out);
+    write_string(event.message, out);
+    return out;
+}
+
+bool decodeChatEvent(const std::vector<std::uint8_t> &payload, net::ChatEvent &out) {
+    std::size_t offset = 0;
+    std::uint16_t channel = 0;
+    if (!read_u16(payload, offset, channel)) {
+        return false;
+    }
+    out.channel = static_cast<net::ChatChannel>(channel);
+    if (!read_u64(payload, offset, out.party_id)) {
+        return false;
+    }
+    if (!read_string(payload, offset, out.sender_user_id)) {
+        return false;
+    }
+    if (!read_string(payload, offset, out.message)) {
+        return false;
+    }
+    return offset == payload.size();
+}
+
+}  // namespace legacy
+
+struct Options {
+    std::size_t iterations{200000};
+};
+
+Options parseArgs(int argc, char **argv) {
+    Options options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg(argv[i]);
+        if (arg == "--iterations") {
+            options.iterations = static_cast<std::size_t>(std::strtoull(argv[i + 1], nullptr, 10));
+        }
+    }
+    return options;
+}
+
+template <typename Fn>
+double nanosPer(std::size_t iterations, Fn fn) {
+    auto begin = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i) {
+        fn();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - begin;
+    return std::chrono::duration<double, std::nano>(elapsed).count() /
+           static_cast<double>(iterations == 0 ? 1 : iterations);
+}
+
+std::size_t sink = 0;
+
+template <typename Message, typename LegacyEncode, typename LegacyDecode,
+          typename Encode, typename Decode>
+bool benchMessage(const char *name,
+                  const Message &message,
+                  std::size_t iterations,
+                  LegacyEncode legacy_encode,
+                  LegacyDecode legacy_decode,
+                  Encode encode,
+                  Decode decode) {
+    auto reference = legacy_encode(message);
+    if (encode(message) != reference) {
+        std::cout << "- " << name << ": encoding mismatch\n";
+        return false;
+    }
+    double legacy_enc = nanosPer(iterations, [&] { sink += legacy_encode(message).size(); });
+    double wire_enc = nanosPer(iterations, [&] { sink += encode(message).size(); });
+    double legacy_dec = nanosPer(iterations, [&] {
+        Message out{};
+        sink += legacy_decode(reference, out) ? 1 : 0;
+    });
+    double wire_dec = nanosPer(iterations, [&] {
+        Message out{};
+        sink += decode(reference, out) ? 1 : 0;
+    });
+    std::cout << "| " << name << " | " << reference.size() << " | " << legacy_enc << " | "
+              << wire_enc << " | " << legacy_dec << " | " << wire_dec << " |\n";
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    Options options = parseArgs(argc, argv);
+
+    net::LoginRequest login{"player_0001", "letmein"};
+
+    net::PartyEvent party_event;
+    party_event.type = net::PartyEventType::InviteAccepted;
+    party_event.party_id = 42;
+    party_event.actor_user_id = "player_0001";
+    party_event.target_user_id = "player_0002";
+    party_event.member_user_ids = {"player_0001", "player_0002", "player_0003", "player_0004"};
+    party_event.message = "Invite accepted";
+
+    net::MatchFoundNotify match;
+    match.success = true;
+    match.code = "OK";
+    match.message = "Match found";
+    match.party_id = 42;
+    match.instance_id = 7;
+    match.endpoint = "dungeon.local:7777";
+    match.ticket = "0123456789abcdef0123456789abcdef";
+
+    net::DungeonResultNotify result;
+    result.result = net::DungeonResultType::Clear;
+    result.time_sec = 900;
+    result.deaths = 1;
+    for (std::uint32_t i = 0; i < 8; ++i) {
+        result.rewards.push_back({1000 + i, i + 1});
+    }
+
+    net::ChatEvent chat{net::ChatChannel::Party, 42, "player_0001", "gg, on to the next run"};
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "# Protocol codec benchmark\n";
+    std::cout << "- Iterations: " << options.iterations << "\n\n";
+    std::cout << "| Message | Bytes | Legacy encode ns | Wire encode ns | Legacy decode ns | "
+                 "Wire decode ns |\n";
+    std::cout << "|---|---|---|---|---|---|\n";
+
+    bool ok = true;
+    ok &= benchMessage("LoginRequest", login, options.iterations, legacy::encodeLoginRequest,
+                       legacy::decodeLoginRequest, net::encodeLoginRequest,
+                       net::decodeLoginRequest);
+    ok &= benchMessage("PartyEvent", party_event, options.iterations, legacy::encodePartyEvent,
+                       legacy::decodePartyEvent, net::encodePartyEvent, net::decodePartyEvent);
+    ok &= benchMessage("MatchFoundNotify", match, options.iterations,
+                       legacy::encodeMatchFoundNotify, legacy::decodeMatchFoundNotify,
+                       net::encodeMatchFoundNotify, net::decodeMatchFoundNotify);
+    ok &= benchMessage("DungeonResultNotify", result, options.iterations,
+                       legacy::encodeDungeonResultNotify, legacy::decodeDungeonResultNotify,
+                       net::encodeDungeonResultNotify, net::decodeDungeonResultNotify);
+    ok &= benchMessage("ChatEvent", chat, options.iterations, legacy::encodeChatEvent,
+                       legacy::decodeChatEvent, net::encodeChatEvent, net::decodeChatEvent);
+
+    // Non-owning request views used on the server decode path.
+    auto login_payload = net::encodeLoginRequest(login);
+    double owned_login = nanosPer(options.iterations, [&] {
+        net::LoginRequest out;
+        sink += net::decodeLoginRequest(login_payload, out) ? 1 : 0;
+    });
+    double view_login = nanosPer(options.iterations, [&] {
+        net::LoginRequestView out;
+        sink += net::decodeLoginRequestView(login_payload, out) ? 1 : 0;
+    });
+    net::ChatSendRequest chat_request{net::ChatChannel::Global, 0,
+                                      "a chat line long enough to defeat the small string buffer"};
+    auto chat_payload = net::encodeChatSendRequest(chat_request);
+    double owned_chat = nanosPer(options.iterations, [&] {
+        net::ChatSendRequest out;
+        sink += net::decodeChatSendRequest(chat_payload, out) ? 1 : 0;
+    });
+    double view_chat = nanosPer(options.iterations, [&] {
+        net::ChatSendRequestView out;
+        sink += net::decodeChatSendRequestView(chat_payload, out) ? 1 : 0;
+    });
+    // Response frames: payload vector + Codec::encode copy vs. in-place builder.
+    double copied_frame = nanosPer(options.iterations, [&] {
+        sink += net::Codec::encode(static_cast<std::uint16_t>(net::PacketType::MatchFoundNotify),
+                                   2, net::encodeMatchFoundNotify(match))
+                    .size();
+    });
+    double built_frame = nanosPer(options.iterations, [&] {
+        sink += net::wire::encodeFrame(net::PacketType::MatchFoundNotify, 2, match).size();
+    });
+
+    std::cout << "\n- LoginRequest decode owned/view: " << owned_login << " / " << view_login
+              << " ns\n";
+    std::cout << "- ChatSendRequest decode owned/view: " << owned_chat << " / " << view_chat
+              << " ns\n";
+    std::cout << "- MatchFoundNotify frame encode+copy/in place: " << copied_frame << " / "
+              << built_frame << " ns\n";
+
+    return ok && sink != 0 ? 0 : 1;
+}
@@ -0,0 +1,162 @@
+#include "combat/dispatcher.h"
+#include "combat/entity_store.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Options {
+    std::size_t events{10000};
+    std::size_t entities{1000};
+    std::size_t ticks{100};
+};
+
+Options parseArgs(int argc, char **argv) {
+    Options options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg(argv[i]);
+        auto value = static_cast<std::size_t>(std::strtoull(argv[i + 1], nullptr, 10));
+        if (arg == "--events") {
+            options.events = std::max<std::size_t>(1, value);
+        } else if (arg == "--entities") {
+            options.entities = std::max<std::size_t>(2, value);
+        } else if (arg == "--ticks") {
+            options.ticks = std::max<std::size_t>(1, value);
+        }
+    }
+    return options;
+}
+
+// Half players, half monsters, with enough hp that nobody dies during the run.
+std::vector<combat::EntityId> populate(combat::EntityStore &store, std::size_t count) {
+    std::vector<combat::EntityId> ids;
+    for (std::size_t i = 0; i < count; ++i) {
+        auto faction = i % 2 == 0 ? combat::Faction::Player : combat::Faction::Monster;
+        ids.push_back(store.spawn({1'000'000'000, 0.0f, 0.0f, faction,
+                                   static_cast<std::int32_t>(i % 7) * 25}));
+    }
+    return ids;
+}
+
+// Every event pairs a player with a monster (either direction).
+std::vector<combat::SkillEvent> makeEvents(const std::vector<combat::EntityId> &ids,
+                                           std::size_t count) {
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<std::size_t> pick(0, ids.size() / 2 - 1);
+    std::uniform_int_distribution<std::int32_t> damage(10, 100);
+    std::vector<combat::SkillEvent> events;
+    events.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        auto player = ids[pick(rng) * 2];
+        auto monster = ids[pick(rng) * 2 + 1];
+        bool forward = i % 3 != 0;
+        events.push_back({forward ? player : monster, forward ? monster : player, 1,
+                          damage(rng)});
+    }
+    return events;
+}
+
+template <typename Fn>
+double nsPerEvent(const Options &options, Fn tick) {
+    auto begin = std::chrono::steady_clock::now();
+    for (std::size_t t = 0; t < options.ticks; ++t) {
+        tick(static_cast<std::uint32_t>(t));
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() -
+                                                            begin)
+                       .count();
+    return elapsed / static_cast<double>(options.ticks * options.events);
+}
+
+void printRow(const char *path, double ns, const Options &options) {
+    std::cout << "| " << path << " | " << ns << " | " << 1000.0 / ns << " | "
+              << ns * static_cast<double>(options.events) / 1000.0 << " |\n";
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    Options options = parseArgs(argc, argv);
+    auto detected = combat::activeDamageKernel();
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "# Combat batch resolution benchmark\n";
+    std::cout << "- Detected damage kernel: " << combat::damageKernelName(detected) << "\n";
+    std::cout << "- Events per tick: " << options.events << "\n";
+    std::cout << "- Entities: " << options.entities << "\n";
+    std::cout << "- Ticks: " << options.ticks << "\n\n";
+    std::cout << "| Path | ns/event | Mevents/s | us/tick |\n";
+    std::cout << "|---|---|---|---|\n";
+
+    std::int64_t checksum = 0;
+    {
+        // Per-event path as a server would wire it: validator, skill handler
+        // and damage handler all reach into the store through std::function.
+        combat::EntityStore store;
+        auto ids = populate(store, options.entities);
+        auto events = makeEvents(ids, options.events);
+        combat::Dispatcher dispatcher;
+        dispatcher.setSkillValidator([&store](const combat::SkillEvent &event) {
+            auto attacker = store.indexOf(event.attacker_id);
+            auto target = store.indexOf(event.target_id);
+            return attacker && target && store.hp()[*attacker] > 0 &&
+                   store.hp()[*target] > 0 &&
+                   store.faction()[*attacker] != store.faction()[*target];
+        });
+        dispatcher.setSkillHandler([&store](const combat::SkillEvent &event)
+                                       -> std::optional<combat::DamageEvent> {
+            auto target = store.indexOf(event.target_id);
+            auto amount = static_cast<float>(event.base_damage) * store.mitigation()[*target];
+            return combat::DamageEvent{event.attacker_id, event.target_id, event.skill_id,
+                                       static_cast<std::int32_t>(std::max(amount, 0.0f))};
+        });
+        dispatcher.setDamageHandler([&store](const combat::DamageEvent &event) {
+            auto &hp = store.hp()[*store.indexOf(event.target_id)];
+            hp = std::max(hp - event.amount, 0);
+        });
+        auto ns = nsPerEvent(options, [&](std::uint32_t) {
+            for (const auto &event : events) {
+                dispatcher.processSkillEvent(event);
+            }
+        });
+        printRow("processSkillEvent (per event)", ns, options);
+        checksum += store.hp()[0];
+    }
+    {
+        combat::EntityStore store;
+        auto ids = populate(store, options.entities);
+        auto events = makeEvents(ids, options.events);
+        combat::Dispatcher dispatcher;
+        auto ns = nsPerEvent(options, [&](std::uint32_t tick) {
+            dispatcher.applySkillBatch(store, events, tick);
+        });
+        printRow("applySkillBatch (in-order)", ns, options);
+        checksum += store.hp()[0];
+    }
+    for (auto kernel : {combat::DamageKernel::Portable, combat::DamageKernel::Avx2}) {
+        if (!combat::setDamageKernel(kernel)) {
+            continue;
+        }
+        combat::EntityStore store;
+        auto ids = populate(store, options.entities);
+        auto events = makeEvents(ids, options.events);
+        combat::Dispatcher dispatcher;
+        auto ns = nsPerEvent(options, [&](std::uint32_t tick) {
+            dispatcher.resolveSkillBatch(store, events, tick);
+        });
+        std::string path = std::string("resolveSkillBatch (") + combat::damageKernelName(kernel) + ")";
+        printRow(path.c_str(), ns, options);
+        checksum += store.hp()[0];
+    }
+    combat::setDamageKernel(detected);
+    return checksum != 0 ? 0 : 1;
+}
@@ -0,0 +1,109 @@
+#include "reward/compiled_drop_table.h"
+#include "reward/drop_table.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Options {
+    std::size_t rolls{1000000};
+    std::size_t entries{12};
+    std::size_t group_size{8};
+};
+
+Options parseArgs(int argc, char **argv) {
+    Options options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg(argv[i]);
+        auto value = static_cast<std::size_t>(std::strtoull(argv[i + 1], nullptr, 10));
+        if (arg == "--rolls") {
+            options.rolls = std::max<std::size_t>(1, value);
+        } else if (arg == "--entries") {
+            options.entries = value;
+        } else if (arg == "--group-size") {
+            options.group_size = value;
+        }
+    }
+    return options;
+}
+
+// Table 1 is the built-in three-entry table; table 2 adds independent entries
+// and one exclusive group (a "pick one rare" slot).
+reward::DropTable makeTables(const Options &options) {
+    reward::DropTable table;
+    for (std::size_t i = 0; i < options.entries; ++i) {
+        table.addEntry(2, reward::DropEntry{static_cast<std::uint32_t>(5000 + i), 1,
+                                            static_cast<std::uint32_t>(1 + i % 4),
+                                            0.05f + 0.07f * static_cast<float>(i % 10)});
+    }
+    for (std::size_t i = 0; i < options.group_size; ++i) {
+        table.addEntry(2, reward::DropEntry{static_cast<std::uint32_t>(9000 + i), 1, 1,
+                                            0.1f / static_cast<float>(i + 1), 1});
+    }
+    return table;
+}
+
+template <typename Fn>
+double nsPerRoll(std::size_t rolls, Fn roll) {
+    auto begin = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < rolls; ++i) {
+        roll();
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() -
+                                                            begin)
+                       .count();
+    return elapsed / static_cast<double>(rolls);
+}
+
+void printRow(const char *path, std::uint32_t table_id, double ns, std::size_t items,
+              std::size_t rolls) {
+    std::cout << "| " << path << " | " << table_id << " | " << ns << " | " << 1000.0 / ns
+              << " | " << static_cast<double>(items) / static_cast<double>(rolls) << " |\n";
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    Options options = parseArgs(argc, argv);
+    auto table = makeTables(options);
+    auto compiled = reward::CompiledDropTable::compile(table);
+    auto view = compiled.view();
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "# Drop table benchmark\n";
+    std::cout << "- Rolls per row: " << options.rolls << "\n";
+    std::cout << "- Table 2: " << options.entries << " independent entries, one group of "
+              << options.group_size << "\n\n";
+    std::cout << "| Path | Table | ns/roll | Mrolls/s | Items/roll |\n";
+    std::cout << "|---|---|---|---|---|\n";
+
+    std::size_t checksum = 0;
+    for (std::uint32_t table_id : {1u, 2u}) {
+        std::mt19937 rng(table_id);
+        std::size_t items = 0;
+        auto ns = nsPerRoll(options.rolls, [&] {
+            items += table.roll(table_id, rng).size();
+        });
+        printRow("DropTable::roll (mt19937)", table_id, ns, items, options.rolls);
+        checksum += items;
+
+        auto drop_rng = reward::DropRng::forInstance(12345, table_id);
+        std::vector<reward::RewardItem> out;
+        items = 0;
+        ns = nsPerRoll(options.rolls, [&] {
+            out.clear();
+            items += view.roll(table_id, drop_rng, out);
+        });
+        printRow("DropTableView::roll (DropRng)", table_id, ns, items, options.rolls);
+        checksum += items;
+    }
+    return checksum != 0 ? 0 : 1;
+}
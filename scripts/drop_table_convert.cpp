@@ -0,0 +1,98 @@
+#include "reward/compiled_drop_table.h"
+#include "reward/drop_table.h"
+#include "reward/drop_table_file.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+// Compiles a CSV drop table source into the binary file the server maps:
+//   dungeonhub_drop_table_convert drop_tables.csv drop_tables.dhdt
+// With --check, validates a binary file and prints its contents as CSV
+// (group members keep their group; probabilities are the compiled ones).
+namespace {
+
+int usage() {
+    std::cerr << "usage: dungeonhub_drop_table_convert <input.csv> <output.dhdt>\n"
+                 "       dungeonhub_drop_table_convert --check <file.dhdt>\n";
+    return 2;
+}
+
+int check(const std::string &path) {
+    auto file = reward::DropTableFile::open(path);
+    if (!file) {
+        std::cerr << "invalid drop table file: " << path << "\n";
+        return 1;
+    }
+    const auto &view = file->view();
+    std::cout << "table_id,item_id,min_quantity,max_quantity,probability,group\n";
+    for (const auto &table : view.tables()) {
+        for (std::uint32_t i = 0; i < table.independent_count; ++i) {
+            const auto &entry = view.entries()[table.first_entry + i];
+            std::cout << table.table_id << "," << entry.item_id << "," << entry.min_quantity
+                      << "," << entry.min_quantity + entry.quantity_span - 1 << ","
+                      << static_cast<double>(entry.threshold) / 2147483648.0 << ",0\n";
+        }
+        for (std::uint32_t g = 0; g < table.group_count; ++g) {
+            const auto &group = view.groups()[table.first_group + g];
+            // Members are the entries the group's slots can pick.
+            std::uint32_t first = 0xFFFFFFFFu;
+            std::uint32_t last = 0;
+            for (std::uint32_t s = 0; s < group.slot_count; ++s) {
+                const auto &slot = view.slots()[group.first_slot + s];
+                for (auto outcome : {slot.primary, slot.alias}) {
+                    if (outcome != reward::AliasSlot::kNoDrop) {
+                        first = std::min(first, outcome);
+                        last = std::max(last, outcome);
+                    }
+                }
+            }
+            for (auto index = first; first != 0xFFFFFFFFu && index <= last; ++index) {
+                const auto &entry = view.entries()[index];
+                std::cout << table.table_id << "," << entry.item_id << ","
+                          << entry.min_quantity << ","
+                          << entry.min_quantity + entry.quantity_span - 1 << ","
+                          << static_cast<double>(entry.threshold) / 2147483648.0 << ","
+                          << g + 1 << "\n";
+            }
+        }
+    }
+    std::cerr << "- Tables: " << view.tables().size() << "\n";
+    std::cerr << "- Entries: " << view.entries().size() << "\n";
+    std::cerr << "- Bytes: " << file->sizeBytes() << "\n";
+    return 0;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        return usage();
+    }
+    std::string first(argv[1]);
+    if (first == "--check") {
+        return check(argv[2]);
+    }
+
+    std::ifstream input(first);
+    if (!input) {
+        std::cerr << "cannot read " << first << "\n";
+        return 1;
+    }
+    std::size_t error_line = 0;
+    auto tables = reward::parseDropTableCsv(input, &error_line);
+    if (!tables) {
+        std::cerr << first << ":" << error_line << ": malformed drop table line\n";
+        return 1;
+    }
+    auto compiled = reward::CompiledDropTable::compile(*tables);
+    if (!reward::writeDropTableFile(argv[2], compiled.view())) {
+        std::cerr << "cannot write " << argv[2] << "\n";
+        return 1;
+    }
+    std::cout << "- Tables: " << compiled.view().tables().size() << "\n";
+    std::cout << "- Entries: " << compiled.view().entries().size() << "\n";
+    std::cout << "- Alias slots: " << compiled.view().slots().size() << "\n";
+    return 0;
+}
@@ -0,0 +1,154 @@
+#include "dungeon/instance_manager.h"
+#include "party/party.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+// Instance bookkeeping before records were reclaimed: the manager kept every
+// record and the server kept four side tables keyed by instance id, none of
+// which were pruned after a successful run.
+namespace legacy {
+
+struct InstanceRecord {
+    std::uint64_t id{0};
+    party::PartyId party_id{0};
+    dungeon::InstanceState state{dungeon::InstanceState::Waiting};
+};
+
+struct Tables {
+    std::uint64_t next_id{1};
+    std::unordered_map<std::uint64_t, InstanceRecord> instances;
+    std::unordered_map<party::PartyId, std::uint64_t> party_instances;
+    std::unordered_map<std::uint64_t, std::string> tickets;
+    std::unordered_map<std::uint64_t, std::uint32_t> seeds;
+    std::unordered_map<std::uint64_t, std::uint64_t> reward_grants;
+};
+
+void run(Tables &tables, party::PartyId party_id, std::uint64_t grant_id) {
+    InstanceRecord record{tables.next_id++, party_id, dungeon::InstanceState::Waiting};
+    tables.instances.emplace(record.id, record);
+    tables.party_instances[party_id] = record.id;
+    tables.tickets[record.id] = "0123456789abcdef0123456789abcdef";
+    tables.seeds[record.id] = static_cast<std::uint32_t>(grant_id);
+    tables.reward_grants[record.id] = grant_id;
+    tables.instances[record.id].state = dungeon::InstanceState::Terminate;
+}
+
+}  // namespace legacy
+
+struct Options {
+    std::size_t runs{1000000};
+    std::size_t legacy_runs{200000};
+    std::size_t checkpoints{10};
+};
+
+Options parseArgs(int argc, char **argv) {
+    Options options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg(argv[i]);
+        auto value = static_cast<std::size_t>(std::strtoull(argv[i + 1], nullptr, 10));
+        if (arg == "--runs") {
+            options.runs = value;
+        } else if (arg == "--legacy-runs") {
+            options.legacy_runs = value;
+        } else if (arg == "--checkpoints") {
+            options.checkpoints = value;
+        }
+    }
+    return options;
+}
+
+// Resident set size from /proc; 0 where it is unavailable.
+std::size_t residentKiB() {
+    std::FILE *file = std::fopen("/proc/self/statm", "r");
+    if (!file) {
+        return 0;
+    }
+    unsigned long pages = 0;
+    unsigned long resident = 0;
+    int fields = std::fscanf(file, "%lu %lu", &pages, &resident);
+    std::fclose(file);
+    if (fields != 2) {
+        return 0;
+    }
+    return resident * static_cast<std::size_t>(sysconf(_SC_PAGESIZE)) / 1024;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    using namespace std::chrono;
+    Options options = parseArgs(argc, argv);
+    std::size_t step = std::max<std::size_t>(1, options.runs / options.checkpoints);
+
+    party::PartyService party_service;
+    auto party_id = party_service.createParty(1, "leader");
+    if (!party_id) {
+        return 1;
+    }
+
+    // One run finishes every simulated millisecond with a 5 s grace period,
+    // so about 5000 terminated records are waiting at any time.
+    dungeon::InstanceManager manager;
+    manager.setReclaimGrace(seconds{5});
+    auto now = steady_clock::now();
+    std::size_t peak_live = 0;
+
+    std::cout << "# Dungeon instance soak benchmark\n";
+    std::cout << "- Runs: " << options.runs << " (1 per simulated ms, 5 s reclaim grace)\n\n";
+    std::cout << "| Runs | Live records | Slot capacity | RSS KiB |\n";
+    std::cout << "|---|---|---|---|\n";
+    auto begin = steady_clock::now();
+    for (std::size_t run = 1; run <= options.runs; ++run) {
+        now += milliseconds{1};
+        auto instance_id = manager.createInstance(*party_id, party_service);
+        auto *record = manager.find(*instance_id);
+        record->ticket.assign("0123456789abcdef0123456789abcdef");
+        record->seed = static_cast<std::uint32_t>(run);
+        for (std::uint64_t member = 0; member < 4; ++member) {
+            record->member_sessions.push_back(run * 4 + member);
+        }
+        record->reward_grant = run;
+        manager.terminateInstance(*instance_id, now);
+        manager.reclaim(now);
+        peak_live = std::max(peak_live, manager.size());
+        if (run % step == 0) {
+            std::cout << "| " << run << " | " << manager.size() << " | "
+                      << manager.capacity() << " | " << residentKiB() << " |\n";
+        }
+    }
+    auto elapsed = steady_clock::now() - begin;
+
+    std::cout << "\n- Peak live records: " << peak_live << "\n";
+    std::cout << std::fixed << std::setprecision(1)
+              << "- Cost per run: "
+              << duration<double, std::nano>(elapsed).count() /
+                     static_cast<double>(options.runs ? options.runs : 1)
+              << " ns\n\n";
+
+    std::cout << "## Legacy tables (never pruned)\n\n";
+    std::cout << "| Runs | Records | RSS KiB |\n";
+    std::cout << "|---|---|---|\n";
+    legacy::Tables tables;
+    std::size_t legacy_step =
+        std::max<std::size_t>(1, options.legacy_runs / options.checkpoints);
+    for (std::size_t run = 1; run <= options.legacy_runs; ++run) {
+        legacy::run(tables, *party_id, run);
+        if (run % legacy_step == 0) {
+            std::cout << "| " << run << " | " << tables.instances.size() << " | "
+                      << residentKiB() << " |\n";
+        }
+    }
+    return manager.capacity() <= peak_live + dungeon::InstanceManager::kSlotsPerSlab ? 0 : 1;
+}
@@ -1,3 +1,5 @@
+#include "admin/logging.h"
+#include "net/buffer_pool.h"
 #include "net/codec.h"
 #include "net/protocol.h"
 #include "net/server.h"
@@ -140,6 +142,20 @@ net::FrameHeader makeHeader(std::uint16_t type, std::uint16_t version,
     return header;
 }
 
+// Decodes a MatchReq response frame into `payload`; true for a successful match.
+bool matchSucceeded(const std::vector<std::uint8_t> &frame,
+                    std::vector<std::uint8_t> &payload) {
+    net::FrameDecoder decoder;
+    decoder.append(frame);
+    net::FrameHeader header{};
+    if (!decoder.nextFrame(header, payload) ||
+        header.type != static_cast<std::uint16_t>(net::PacketType::MatchFoundNotify)) {
+        return false;
+    }
+    net::MatchFoundNotify notify;
+    return net::decodeMatchFoundNotify(payload, notify) && notify.success;
+}
+
 std::string policyName(net::OverflowPolicy policy) {
     switch (policy) {
         case net::OverflowPolicy::DropNewest:
@@ -244,6 +260,11 @@ int main(int argc, char **argv) {
         }
     }
 
+    // Validation below counts log lines, so none may be dropped.
+    admin::LoggerConfig logger_config;
+    logger_config.full_policy = admin::LogFullPolicy::Block;
+    admin::StructuredLogger::configure(logger_config);
+
     net::Server server;
     std::mutex server_mutex;
     std::vector<SessionBundle> bundles;
@@ -314,31 +335,22 @@ int main(int argc, char **argv) {
             response = server.handlePacket(*bundle.session, header, payload,
                                            std::chrono::steady_clock::now());
         }
-        if (!response.has_value()) {
-            match_failures.fetch_add(1, std::memory_order_relaxed);
-            return;
-        }
-        net::FrameDecoder decoder;
-        decoder.append(*response);
-        net::FrameHeader response_header{};
         std::vector<std::uint8_t> response_payload;
-        if (!decoder.nextFrame(response_header, response_payload)) {
-            match_failures.fetch_add(1, std::memory_order_relaxed);
-            return;
+        bool matched = response.has_value() && matchSucceeded(*response, response_payload);
+        // Hand every buffer back so later requests reuse them.
+        net::BufferPool::release(std::move(payload));
+        net::BufferPool::release(std::move(response_payload));
+        if (response.has_value()) {
+            net::BufferPool::release(std::move(*response));
         }
-        if (response_header.type !=
-            static_cast<std::uint16_t>(net::PacketType::MatchFoundNotify)) {
+        if (matched) {
+            match_successes.fetch_add(1, std::memory_order_relaxed);
+        } else {
             match_failures.fetch_add(1, std::memory_order_relaxed);
-            return;
         }
-        net::MatchFoundNotify notify;
-        if (!net::decodeMatchFoundNotify(response_payload, notify) || !notify.success) {
-            match_failures.fetch_add(1, std::memory_order_relaxed);
-            return;
-        }
-        match_successes.fetch_add(1, std::memory_order_relaxed);
     };
 
+    auto pool_before = net::BufferPool::stats();
     std::vector<std::future<void>> futures;
     futures.reserve(options.sessions * options.requests_per_session);
     std::size_t in_flight = 0;
@@ -361,6 +373,7 @@ int main(int argc, char **argv) {
     for (auto &future : futures) {
         future.get();
     }
+    auto pool_after = net::BufferPool::stats();
 
     std::vector<std::uint8_t> overflow_payload(options.overflow_payload_bytes, 0xAB);
     std::map<net::OverflowPolicy, OverflowStats> overflow_stats;
@@ -391,6 +404,7 @@ int main(int argc, char **argv) {
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
         std::chrono::steady_clock::now() - now);
 
+    admin::StructuredLogger::flush();
     if (log_file) {
         log_file.flush();
         log_file.close();
@@ -438,6 +452,21 @@ int main(int argc, char **argv) {
     summary << "- Bytes total: " << metrics.bytes_total << "\n";
     summary << "- Errors total: " << metrics.error_total << "\n\n";
 
+    auto pool_hits = pool_after.hits - pool_before.hits;
+    auto pool_misses = pool_after.misses - pool_before.misses;
+    auto pool_acquires = pool_hits + pool_misses;
+    summary << "## Buffer Pool (match phase)\n";
+    summary << "- Acquires: " << pool_acquires << "\n";
+    summary << "- Hits: " << pool_hits << "\n";
+    summary << "- Misses (allocations): " << pool_misses << "\n";
+    summary << "- Hit rate: " << std::fixed << std::setprecision(1)
+            << (pool_acquires == 0 ? 0.0
+                                   : 100.0 * static_cast<double>(pool_hits) /
+                                         static_cast<double>(pool_acquires))
+            << "%\n";
+    summary << "- Recycled/discarded: " << pool_after.recycled - pool_before.recycled << "/"
+            << pool_after.discarded - pool_before.discarded << "\n\n";
+
     ValidationResults validation = validateLogs(options.log_path);
     summary << "## Validation\n";
     if (!options.log_path.empty()) {
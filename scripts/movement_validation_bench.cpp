@@ -0,0 +1,116 @@
+#include "dungeon/authoritative_validation.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Options {
+    std::size_t samples{10000};
+    std::size_t rounds{200};
+    // Share of samples moving faster than the limit.
+    double cheat_rate{0.05};
+};
+
+Options parseArgs(int argc, char **argv) {
+    Options options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg(argv[i]);
+        if (arg == "--samples") {
+            options.samples = std::max<std::size_t>(
+                1, static_cast<std::size_t>(std::strtoull(argv[i + 1], nullptr, 10)));
+        } else if (arg == "--rounds") {
+            options.rounds = std::max<std::size_t>(
+                1, static_cast<std::size_t>(std::strtoull(argv[i + 1], nullptr, 10)));
+        } else if (arg == "--cheat-rate") {
+            options.cheat_rate = std::clamp(std::strtod(argv[i + 1], nullptr), 0.0, 1.0);
+        }
+    }
+    return options;
+}
+
+template <typename Fn>
+double nsPerSample(const Options &options, Fn round) {
+    auto begin = std::chrono::steady_clock::now();
+    for (std::size_t r = 0; r < options.rounds; ++r) {
+        round();
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() -
+                                                            begin)
+                       .count();
+    return elapsed / static_cast<double>(options.rounds * options.samples);
+}
+
+void printRow(const std::string &path, double ns, std::size_t rejected) {
+    std::cout << "| " << path << " | " << ns << " | " << 1000.0 / ns << " | " << rejected
+              << " |\n";
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    Options options = parseArgs(argc, argv);
+    constexpr float kMaxSpeed = 7.0f;
+
+    // 10-20 Hz updates from players walking near the limit, a few too fast.
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<std::int32_t> interval(50, 100);
+    std::uniform_real_distribution<float> pace(0.2f, 1.0f);
+    std::bernoulli_distribution cheat(options.cheat_rate);
+    std::vector<std::uint64_t> ids(options.samples);
+    std::vector<float> distances(options.samples);
+    std::vector<std::int32_t> elapsed(options.samples);
+    std::vector<dungeon::MovementSample> samples(options.samples);
+    for (std::size_t i = 0; i < options.samples; ++i) {
+        ids[i] = i + 1;
+        elapsed[i] = interval(rng);
+        auto speed = kMaxSpeed * (cheat(rng) ? 2.0f : pace(rng));
+        distances[i] = speed * static_cast<float>(elapsed[i]) / 1000.0f;
+        samples[i] = {ids[i], distances[i], std::chrono::milliseconds{elapsed[i]}};
+    }
+
+    dungeon::MovementValidator validator(kMaxSpeed);
+    auto detected = dungeon::activeMovementKernel();
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "# Movement validation benchmark\n";
+    std::cout << "- Detected movement kernel: " << dungeon::movementKernelName(detected) << "\n";
+    std::cout << "- Samples per round: " << options.samples << "\n";
+    std::cout << "- Rounds: " << options.rounds << "\n";
+    std::cout << "- Cheat rate: " << options.cheat_rate << "\n\n";
+    std::cout << "| Path | ns/sample | Msamples/s | Rejected/round |\n";
+    std::cout << "|---|---|---|---|\n";
+
+    std::size_t rejected = 0;
+    auto ns = nsPerSample(options, [&] {
+        rejected = 0;
+        for (const auto &sample : samples) {
+            std::string reason;
+            if (!validator.validate(sample, reason)) {
+                rejected += 1;
+            }
+        }
+    });
+    printRow("validate (per sample, string reason)", ns, rejected);
+
+    for (auto kernel : {dungeon::MovementKernel::Portable, dungeon::MovementKernel::Avx2}) {
+        if (!dungeon::setMovementKernel(kernel)) {
+            continue;
+        }
+        dungeon::MovementBatchResult result;
+        ns = nsPerSample(options, [&] {
+            validator.validateBatch(ids, distances, elapsed, result);
+        });
+        printRow(std::string("validateBatch (") + dungeon::movementKernelName(kernel) + ")", ns,
+                 result.rejected);
+    }
+    dungeon::setMovementKernel(detected);
+    return 0;
+}
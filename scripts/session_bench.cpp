@@ -0,0 +1,205 @@
+#include "admin/logging.h"
+#include "net/buffer_pool.h"
+#include "net/clock.h"
+#include "net/server.h"
+#include "net/session.h"
+#include "net/session_pool.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Options {
+    std::size_t sessions{100000};
+    std::size_t ticks{1000};
+    std::size_t churn_rounds{2};
+};
+
+Options parseArgs(int argc, char **argv) {
+    Options options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg(argv[i]);
+        auto value = static_cast<std::size_t>(std::strtoull(argv[i + 1], nullptr, 10));
+        if (arg == "--sessions") {
+            options.sessions = value;
+        } else if (arg == "--ticks") {
+            options.ticks = value;
+        } else if (arg == "--churn-rounds") {
+            options.churn_rounds = value;
+        }
+    }
+    return options;
+}
+
+double microsPer(std::chrono::steady_clock::duration elapsed, std::size_t count) {
+    return std::chrono::duration<double, std::micro>(elapsed).count() /
+           static_cast<double>(count == 0 ? 1 : count);
+}
+
+// Keeps `sessions` connected and replaces a pseudo-random one per step, so
+// frees and allocations interleave as they do under real connect churn.
+template <typename MakeFn>
+std::chrono::steady_clock::duration churn(std::size_t sessions,
+                                          std::size_t replacements,
+                                          MakeFn make) {
+    std::vector<std::shared_ptr<net::Session>> population;
+    population.reserve(sessions);
+    for (std::size_t i = 0; i < sessions; ++i) {
+        population.push_back(make(i));
+    }
+    std::uint64_t state = 0x9e3779b97f4a7c15ULL;
+    auto begin = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < replacements; ++i) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        population[(state >> 33) % sessions] = make(sessions + i);
+    }
+    return std::chrono::steady_clock::now() - begin;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    using namespace std::chrono;
+    Options options = parseArgs(argc, argv);
+
+    // Session lifecycle logs would dominate the measurement.
+    std::ostringstream sink;
+    std::streambuf *original_buf = std::cout.rdbuf(sink.rdbuf());
+
+    net::Server server;
+    net::SessionConfig config;
+    auto start = steady_clock::now();
+    std::vector<std::shared_ptr<net::Session>> sessions;
+    sessions.reserve(options.sessions);
+    for (std::size_t i = 0; i < options.sessions; ++i) {
+        sessions.push_back(server.createSession(config, start));
+    }
+
+    // Idle ticks: no session is anywhere near its timeout.
+    auto step = milliseconds{10};
+    auto wheel_begin = steady_clock::now();
+    for (std::size_t i = 1; i <= options.ticks; ++i) {
+        server.tick(start + step * static_cast<int>(i));
+    }
+    auto wheel_elapsed = steady_clock::now() - wheel_begin;
+
+    // Previous Server::tick behaviour: visit every session each tick.
+    auto scan_begin = steady_clock::now();
+    std::size_t still_connected = 0;
+    for (std::size_t i = 1; i <= options.ticks; ++i) {
+        auto now = start + step * static_cast<int>(i);
+        for (const auto &session : sessions) {
+            still_connected += session->tick(now) ? 1 : 0;
+        }
+    }
+    auto scan_elapsed = steady_clock::now() - scan_begin;
+
+    // Broadcast fan-out: one small frame per session, time read per send.
+    std::vector<std::uint8_t> frame(16, 0xAB);
+    std::vector<std::uint8_t> drained;
+    auto direct_begin = steady_clock::now();
+    for (const auto &session : sessions) {
+        session->enqueueSend(frame, steady_clock::now());
+        session->dequeueSend(drained);
+    }
+    auto direct_elapsed = steady_clock::now() - direct_begin;
+
+    net::CoarseClock::update();
+    auto cached_begin = steady_clock::now();
+    for (const auto &session : sessions) {
+        session->enqueueSend(frame);
+        session->dequeueSend(drained);
+    }
+    auto cached_elapsed = steady_clock::now() - cached_begin;
+
+    // Same fan-out with one pooled frame shared by every queue.
+    net::PooledBuffer shared{std::vector<std::uint8_t>(frame)};
+    net::PooledBuffer drained_shared;
+    auto pool_before = net::BufferPool::stats();
+    auto shared_begin = steady_clock::now();
+    for (const auto &session : sessions) {
+        session->enqueueSend(shared);
+        session->dequeueSend(drained_shared);
+    }
+    auto shared_elapsed = steady_clock::now() - shared_begin;
+    auto pool_after = net::BufferPool::stats();
+    net::CoarseClock::reset();
+
+    auto expire_begin = steady_clock::now();
+    server.tick(start + config.timeout + seconds{1});
+    auto expire_elapsed = steady_clock::now() - expire_begin;
+    std::size_t remaining = server.sessionCount();
+    sessions.clear();
+
+    std::size_t replacements = options.sessions * options.churn_rounds;
+    auto shared_churn = churn(options.sessions, replacements, [&](std::size_t id) {
+        return std::make_shared<net::Session>(id, config, start);
+    });
+    auto pool_stats_before = net::SessionPool::stats();
+    auto pooled_churn = churn(options.sessions, replacements, [&](std::size_t id) {
+        return net::makeSession(id, config, start);
+    });
+    auto pool_stats = net::SessionPool::stats();
+
+    // Same churn through the server: registry, timers and lifecycle logs.
+    std::vector<net::Session::SessionId> live_ids;
+    live_ids.reserve(options.sessions);
+    for (std::size_t i = 0; i < options.sessions; ++i) {
+        live_ids.push_back(server.createSession(config, start)->id());
+    }
+    std::uint64_t state = 0x2545f4914f6cdd1dULL;
+    auto server_churn_begin = steady_clock::now();
+    for (std::size_t i = 0; i < replacements; ++i) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        auto &slot = live_ids[(state >> 33) % live_ids.size()];
+        server.removeSession(slot);
+        slot = server.createSession(config, start)->id();
+    }
+    auto server_churn_elapsed = steady_clock::now() - server_churn_begin;
+    for (auto id : live_ids) {
+        server.removeSession(id);
+    }
+
+    admin::StructuredLogger::flush();
+    auto log_stats = admin::StructuredLogger::stats();
+    std::cout.rdbuf(original_buf);
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "# Session tick benchmark\n";
+    std::cout << "- Sessions: " << options.sessions << "\n";
+    std::cout << "- Idle ticks: " << options.ticks << "\n";
+    std::cout << "- Timer wheel tick: " << microsPer(wheel_elapsed, options.ticks)
+              << " us/tick\n";
+    std::cout << "- Full scan tick: " << microsPer(scan_elapsed, options.ticks)
+              << " us/tick (" << still_connected / (options.ticks ? options.ticks : 1)
+              << " sessions visited)\n";
+    std::cout << "- Broadcast send (steady_clock::now): "
+              << microsPer(direct_elapsed, options.sessions) * 1000.0 << " ns/send\n";
+    std::cout << "- Broadcast send (CoarseClock): "
+              << microsPer(cached_elapsed, options.sessions) * 1000.0 << " ns/send\n";
+    std::cout << "- Broadcast send (shared PooledBuffer): "
+              << microsPer(shared_elapsed, options.sessions) * 1000.0 << " ns/send ("
+              << pool_after.misses - pool_before.misses << " pool misses)\n";
+    std::cout << "- Mass timeout tick: "
+              << duration<double, std::milli>(expire_elapsed).count() << " ms ("
+              << remaining << " sessions remaining)\n";
+    std::cout << "- Session churn (make_shared): "
+              << microsPer(shared_churn, replacements) * 1000.0 << " ns/reconnect\n";
+    std::cout << "- Session churn (SessionPool): "
+              << microsPer(pooled_churn, replacements) * 1000.0 << " ns/reconnect ("
+              << pool_stats.reused - pool_stats_before.reused << " slots reused, "
+              << pool_stats.slabs << " slabs of " << net::SessionPool::kSlotsPerSlab
+              << " x " << net::SessionPool::kSlotSize << " B)\n";
+    std::cout << "- Server connect/disconnect churn: "
+              << microsPer(server_churn_elapsed, replacements) * 1000.0
+              << " ns/reconnect\n";
+    std::cout << "- Log lines written/dropped: " << log_stats.written << "/"
+              << log_stats.dropped << "\n";
+    return remaining == 0 ? 0 : 1;
+}
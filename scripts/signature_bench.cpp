@@ -0,0 +1,154 @@
+#include "net/security.h"
+#include "net/sha256.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <span>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+// Double FNV-1a "signature" computeSignature used before HMAC-SHA256, kept
+// here as the throughput baseline.
+namespace legacy {
+
+constexpr std::uint64_t kFnvOffset = 14695981039346656037ULL;
+constexpr std::uint64_t kFnvPrime = 1099511628211ULL;
+
+std::uint64_t fnv1aUpdate(std::uint64_t hash, std::span<const std::uint8_t> data) {
+    for (std::uint8_t byte : data) {
+        hash ^= byte;
+        hash *= kFnvPrime;
+    }
+    return hash;
+}
+
+template <typename T>
+std::array<std::uint8_t, sizeof(T)> toBytes(T value) {
+    std::array<std::uint8_t, sizeof(T)> out{};
+    for (std::size_t i = sizeof(T); i-- > 0;) {
+        out[i] = static_cast<std::uint8_t>(value & 0xFF);
+        value >>= 8;
+    }
+    return out;
+}
+
+std::array<std::uint8_t, 16> computeSignature(std::string_view key,
+                                              std::uint32_t seq,
+                                              std::uint64_t nonce,
+                                              std::span<const std::uint8_t> payload) {
+    auto key_bytes = std::span<const std::uint8_t>(
+        reinterpret_cast<const std::uint8_t *>(key.data()), key.size());
+    auto seq_bytes = toBytes(seq);
+    auto nonce_bytes = toBytes(nonce);
+
+    std::uint64_t hash1 = fnv1aUpdate(kFnvOffset, key_bytes);
+    hash1 = fnv1aUpdate(hash1, seq_bytes);
+    hash1 = fnv1aUpdate(hash1, nonce_bytes);
+    hash1 = fnv1aUpdate(hash1, payload);
+
+    std::uint64_t hash2 = fnv1aUpdate(kFnvOffset ^ 0x9e3779b97f4a7c15ULL, key_bytes);
+    hash2 = fnv1aUpdate(hash2, nonce_bytes);
+    hash2 = fnv1aUpdate(hash2, seq_bytes);
+    hash2 = fnv1aUpdate(hash2, payload);
+
+    std::array<std::uint8_t, 16> out{};
+    auto hash1_bytes = toBytes(hash1);
+    auto hash2_bytes = toBytes(hash2);
+    std::copy(hash1_bytes.begin(), hash1_bytes.end(), out.begin());
+    std::copy(hash2_bytes.begin(), hash2_bytes.end(), out.begin() + 8);
+    return out;
+}
+
+}  // namespace legacy
+
+struct Options {
+    std::size_t bytes_per_case{64u * 1024 * 1024};
+};
+
+Options parseArgs(int argc, char **argv) {
+    Options options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg(argv[i]);
+        if (arg == "--bytes") {
+            options.bytes_per_case =
+                static_cast<std::size_t>(std::strtoull(argv[i + 1], nullptr, 10));
+        }
+    }
+    return options;
+}
+
+std::size_t sink = 0;
+
+// Signs roughly `total_bytes` worth of payloads and returns MiB/s.
+template <typename Fn>
+double mibPerSecond(std::size_t payload_size, std::size_t total_bytes, Fn sign) {
+    std::size_t iterations = std::max<std::size_t>(1, total_bytes / payload_size);
+    auto begin = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i) {
+        sink += sign(static_cast<std::uint32_t>(i))[0];
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin)
+                         .count();
+    double bytes = static_cast<double>(iterations * payload_size);
+    return bytes / (1024.0 * 1024.0) / (seconds > 0 ? seconds : 1e-9);
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    Options options = parseArgs(argc, argv);
+    const std::string key_text = "production-hmac-key";
+    net::SignatureKey key(key_text);
+    auto detected = net::activeSha256Impl();
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "# Packet signature benchmark\n";
+    std::cout << "- Detected SHA-256 implementation: " << net::sha256ImplName(detected) << "\n";
+    std::cout << "- Bytes per case: " << options.bytes_per_case << "\n\n";
+    std::cout << "| Payload bytes | FNV (legacy) MiB/s | HMAC portable MiB/s | "
+                 "HMAC sha-ni MiB/s | HMAC + key schedule per packet MiB/s |\n";
+    std::cout << "|---|---|---|---|---|\n";
+
+    for (std::size_t size : {32u, 128u, 512u, 1400u, 8192u}) {
+        std::vector<std::uint8_t> payload(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            payload[i] = static_cast<std::uint8_t>(i * 31);
+        }
+        auto fnv = mibPerSecond(size, options.bytes_per_case, [&](std::uint32_t seq) {
+            return legacy::computeSignature(key_text, seq, 7, payload);
+        });
+
+        std::string cells[2] = {"n/a", "n/a"};
+        double per_packet_schedule = 0.0;
+        for (auto impl : {net::Sha256Impl::Portable, net::Sha256Impl::ShaNi}) {
+            if (!net::setSha256Impl(impl)) {
+                continue;
+            }
+            auto rate = mibPerSecond(size, options.bytes_per_case, [&](std::uint32_t seq) {
+                return key.sign(seq, 7, payload);
+            });
+            std::ostringstream cell;
+            cell << std::fixed << std::setprecision(1) << rate;
+            cells[impl == net::Sha256Impl::Portable ? 0 : 1] = cell.str();
+            if (impl == detected) {
+                per_packet_schedule =
+                    mibPerSecond(size, options.bytes_per_case, [&](std::uint32_t seq) {
+                        return net::computeSignature(key_text, seq, 7, payload);
+                    });
+            }
+        }
+        net::setSha256Impl(detected);
+
+        std::cout << "| " << size << " | " << fnv << " | " << cells[0] << " | " << cells[1]
+                  << " | " << per_packet_schedule << " |\n";
+    }
+    return sink != 0 ? 0 : 1;
+}
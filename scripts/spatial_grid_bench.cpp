@@ -0,0 +1,150 @@
+#include "combat/entity_store.h"
+#include "combat/spatial_grid.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Options {
+    std::size_t queries{20000};
+    float radius{12.0f};
+    float cell_size{8.0f};
+    // Square units of floor per entity; the floor grows with the count so
+    // local density stays the same.
+    float area_per_entity{25.0f};
+};
+
+Options parseArgs(int argc, char **argv) {
+    Options options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg(argv[i]);
+        if (arg == "--queries") {
+            options.queries = std::max<std::size_t>(
+                1, static_cast<std::size_t>(std::strtoull(argv[i + 1], nullptr, 10)));
+        } else if (arg == "--radius") {
+            options.radius = std::max(0.1f, std::strtof(argv[i + 1], nullptr));
+        } else if (arg == "--cell") {
+            options.cell_size = std::max(0.1f, std::strtof(argv[i + 1], nullptr));
+        } else if (arg == "--area") {
+            options.area_per_entity = std::max(0.1f, std::strtof(argv[i + 1], nullptr));
+        }
+    }
+    return options;
+}
+
+namespace legacy {
+
+// What a range or AoE check costs without an index: every entity in the store.
+std::size_t queryRadius(const combat::EntityStore &store,
+                        float x,
+                        float y,
+                        float radius,
+                        std::vector<combat::EntityId> &out) {
+    auto before = out.size();
+    auto xs = store.positionX();
+    auto ys = store.positionY();
+    auto handles = store.handles();
+    for (std::size_t i = 0; i < handles.size(); ++i) {
+        auto dx = xs[i] - x;
+        auto dy = ys[i] - y;
+        if (dx * dx + dy * dy <= radius * radius) {
+            out.push_back(handles[i]);
+        }
+    }
+    return out.size() - before;
+}
+
+}  // namespace legacy
+
+template <typename Fn>
+double nsPer(std::size_t count, Fn fn) {
+    auto begin = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < count; ++i) {
+        fn(i);
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() -
+                                                            begin)
+                       .count();
+    return elapsed / static_cast<double>(count);
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    Options options = parseArgs(argc, argv);
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "# Spatial grid benchmark\n";
+    std::cout << "- Queries per size: " << options.queries << "\n";
+    std::cout << "- Query radius: " << options.radius << "\n";
+    std::cout << "- Cell size: " << options.cell_size << "\n";
+    std::cout << "- Area per entity: " << options.area_per_entity << "\n\n";
+    std::cout << "| Entities | Hits/query | Grid radius ns | Grid cone ns | Linear scan ns | "
+                 "Move ns |\n";
+    std::cout << "|---|---|---|---|---|---|\n";
+
+    std::size_t checksum = 0;
+    for (std::size_t entities : {1000u, 4000u, 16000u, 64000u}) {
+        auto side = std::sqrt(static_cast<float>(entities) * options.area_per_entity);
+        std::mt19937 rng(11);
+        std::uniform_real_distribution<float> coord(0.0f, side);
+        std::uniform_real_distribution<float> step(-1.5f, 1.5f);
+
+        combat::EntityStore store;
+        combat::SpatialGrid grid(options.cell_size);
+        store.attachSpatialIndex(&grid);
+        for (std::size_t i = 0; i < entities; ++i) {
+            store.spawn({100, coord(rng), coord(rng), combat::Faction::Monster, 0});
+        }
+
+        std::vector<float> qx(options.queries);
+        std::vector<float> qy(options.queries);
+        for (std::size_t i = 0; i < options.queries; ++i) {
+            qx[i] = coord(rng);
+            qy[i] = coord(rng);
+        }
+
+        std::vector<combat::EntityId> hits;
+        std::size_t found = 0;
+        auto radius_ns = nsPer(options.queries, [&](std::size_t i) {
+            hits.clear();
+            found += grid.queryRadius(qx[i], qy[i], options.radius, hits);
+        });
+        auto cone_ns = nsPer(options.queries, [&](std::size_t i) {
+            hits.clear();
+            checksum += grid.queryCone(qx[i], qy[i], 1.0f, 0.0f, 0.6f, options.radius, hits);
+        });
+        // The scan is O(n), so fewer iterations keep the large sizes quick.
+        auto scan_queries = std::max<std::size_t>(1, options.queries * 1000 / entities);
+        auto scan_ns = nsPer(scan_queries, [&](std::size_t i) {
+            hits.clear();
+            checksum += legacy::queryRadius(store, qx[i], qy[i], options.radius, hits);
+        });
+
+        auto handles = std::vector<combat::EntityId>(store.handles().begin(),
+                                                     store.handles().end());
+        auto xs = store.positionX();
+        auto ys = store.positionY();
+        auto moves = std::max<std::size_t>(options.queries, entities);
+        auto move_ns = nsPer(moves, [&](std::size_t i) {
+            auto index = i % handles.size();
+            store.setPosition(handles[index], xs[index] + step(rng), ys[index] + step(rng));
+        });
+
+        std::cout << "| " << entities << " | "
+                  << static_cast<double>(found) / static_cast<double>(options.queries) << " | "
+                  << radius_ns << " | " << cone_ns << " | " << scan_ns << " | " << move_ns
+                  << " |\n";
+        checksum += found + grid.cellCount();
+    }
+    return checksum != 0 ? 0 : 1;
+}
@@ -0,0 +1,144 @@
+#include "dungeon/tick_scheduler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Options {
+    std::vector<std::size_t> instance_counts{500, 1000, 2000, 4000};
+    std::size_t workers{std::max(1u, std::thread::hardware_concurrency())};
+    std::size_t hz{20};
+    std::size_t work_us{5};
+    std::size_t seconds{2};
+    bool pin{false};
+};
+
+std::vector<std::size_t> parseList(const std::string &text) {
+    std::vector<std::size_t> out;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        out.push_back(static_cast<std::size_t>(std::strtoull(item.c_str(), nullptr, 10)));
+    }
+    return out;
+}
+
+Options parseArgs(int argc, char **argv) {
+    Options options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg(argv[i]);
+        auto value = static_cast<std::size_t>(std::strtoull(argv[i + 1], nullptr, 10));
+        if (arg == "--instances") {
+            options.instance_counts = parseList(argv[i + 1]);
+        } else if (arg == "--workers") {
+            options.workers = std::max<std::size_t>(1, value);
+        } else if (arg == "--hz") {
+            options.hz = std::max<std::size_t>(1, value);
+        } else if (arg == "--work-us") {
+            options.work_us = value;
+        } else if (arg == "--seconds") {
+            options.seconds = std::max<std::size_t>(1, value);
+        } else if (arg == "--pin") {
+            options.pin = value != 0;
+        }
+    }
+    return options;
+}
+
+volatile std::uint64_t sink = 0;
+
+// Stand-in for combat/AI work: a dependent LCG chain of `iterations` steps.
+void simulate(std::uint64_t seed, std::size_t iterations) {
+    std::uint64_t state = seed;
+    for (std::size_t i = 0; i < iterations; ++i) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    }
+    sink = sink + (state >> 63);
+}
+
+std::size_t iterationsPerMicrosecond() {
+    constexpr std::size_t kProbe = 4'000'000;
+    auto begin = std::chrono::steady_clock::now();
+    simulate(1, kProbe);
+    auto micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() -
+                                                            begin)
+                      .count();
+    return std::max<std::size_t>(1, static_cast<std::size_t>(kProbe / std::max(micros, 1.0)));
+}
+
+double toMicros(std::chrono::nanoseconds value) {
+    return std::chrono::duration<double, std::micro>(value).count();
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    using namespace std::chrono;
+    Options options = parseArgs(argc, argv);
+    auto iterations = options.work_us * iterationsPerMicrosecond();
+    auto period = duration_cast<nanoseconds>(seconds{1}) / options.hz;
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "# Instance tick scheduler benchmark\n";
+    std::cout << "- Workers: " << options.workers << (options.pin ? " (pinned)" : "") << "\n";
+    std::cout << "- Tick rate: " << options.hz << " Hz (" << toMicros(period) / 1000.0
+              << " ms period)\n";
+    std::cout << "- Simulated work per instance tick: " << options.work_us << " us\n";
+    std::cout << "- Run time per case: " << options.seconds << " s\n\n";
+    std::cout << "| Instances | Worker ticks | Expected | Skipped | Worker overruns | "
+                 "Max worker tick ms | Instance p50 us | Instance p99 us (median) | "
+                 "Instance p99 us (worst) |\n";
+    std::cout << "|---|---|---|---|---|---|---|---|---|\n";
+
+    for (auto count : options.instance_counts) {
+        dungeon::TickSchedulerConfig config;
+        config.period = period;
+        config.worker_count = options.workers;
+        config.pin_workers = options.pin;
+        dungeon::TickScheduler scheduler(config);
+        for (std::size_t id = 1; id <= count; ++id) {
+            scheduler.add(id, [iterations](dungeon::InstanceId instance, std::uint64_t tick,
+                                           nanoseconds) { simulate(instance ^ tick, iterations); });
+        }
+
+        scheduler.start();
+        std::this_thread::sleep_for(seconds{options.seconds});
+        scheduler.stop();
+
+        dungeon::TickWorkerStats totals;
+        for (std::size_t worker = 0; worker < options.workers; ++worker) {
+            auto stats = scheduler.workerStats(worker);
+            totals.ticks += stats.ticks;
+            totals.overruns += stats.overruns;
+            totals.skipped_ticks += stats.skipped_ticks;
+            totals.max_tick = std::max(totals.max_tick, stats.max_tick);
+        }
+        std::vector<nanoseconds> p50s;
+        std::vector<nanoseconds> p99s;
+        for (std::size_t id = 1; id <= count; ++id) {
+            auto stats = scheduler.stats(id);
+            p50s.push_back(stats->p50);
+            p99s.push_back(stats->p99);
+        }
+        std::sort(p50s.begin(), p50s.end());
+        std::sort(p99s.begin(), p99s.end());
+
+        std::cout << "| " << count << " | " << totals.ticks << " | "
+                  << options.seconds * options.hz * options.workers << " | "
+                  << totals.skipped_ticks << " | " << totals.overruns << " | "
+                  << toMicros(totals.max_tick) / 1000.0 << " | "
+                  << toMicros(p50s[p50s.size() / 2]) << " | "
+                  << toMicros(p99s[p99s.size() / 2]) << " | " << toMicros(p99s.back())
+                  << " |\n";
+    }
+    return 0;
+}
@@ -18,8 +18,9 @@ AdminStatus AdminService::getStatus() const {
     status.uptime = std::chrono::duration_cast<std::chrono::seconds>(
         std::chrono::steady_clock::now() - server_.startTime());
 
+    const auto request_trace_id = StructuredLogger::generateTraceId();
     LogFields fields;
-    fields.request_trace_id = StructuredLogger::generateTraceId();
+    fields.request_trace_id = request_trace_id;
     logger_.log("info", "admin_status", "Admin status requested", fields);
 
     return status;
@@ -27,8 +28,9 @@ AdminStatus AdminService::getStatus() const {
 
 bool AdminService::forceTerminateSession(std::uint64_t session_id,
                                          const std::string &reason) {
+    const auto request_trace_id = StructuredLogger::generateTraceId();
     LogFields fields;
-    fields.request_trace_id = StructuredLogger::generateTraceId();
+    fields.request_trace_id = request_trace_id;
     fields.session_id = session_id;
     fields.reason = reason;
 
@@ -42,7 +44,7 @@ bool AdminService::forceTerminateSession(std::uint64_t session_id,
     fields.session_trace_id = session->traceId();
     logger_.log("info", "admin_force_disconnect", "Admin terminating session",
                 fields);
-    return server_.forceDisconnect(session_id, reason, *fields.request_trace_id);
+    return server_.forceDisconnect(session_id, reason, request_trace_id);
 }
 
 }  // namespace admin
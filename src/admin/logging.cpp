@@ -1,141 +1,516 @@
 #include "admin/logging.h"
 
+#include "net/clock.h"
+
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <charconv>
 #include <chrono>
-#include <iomanip>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iterator>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <random>
-#include <sstream>
+#include <string_view>
+#include <thread>
+#include <vector>
 
 namespace admin {
 namespace {
 
-std::string jsonEscape(const std::string &value) {
-    std::ostringstream escaped;
-    for (char ch : value) {
-        switch (ch) {
-            case '"':
-                escaped << "\\\"";
-                break;
-            case '\\':
-                escaped << "\\\\";
-                break;
-            case '\b':
-                escaped << "\\b";
-                break;
-            case '\f':
-                escaped << "\\f";
-                break;
-            case '\n':
-                escaped << "\\n";
-                break;
-            case '\r':
-                escaped << "\\r";
-                break;
-            case '\t':
-                escaped << "\\t";
-                break;
-            default:
-                if (static_cast<unsigned char>(ch) < 0x20) {
-                    escaped << "\\u"
-                            << std::hex << std::setw(4) << std::setfill('0')
-                            << static_cast<int>(static_cast<unsigned char>(ch))
-                            << std::dec;
+// Builds one JSON line in a caller-owned buffer. Numbers go through
+// std::to_chars and strings are copied verbatim unless they contain a
+// character that needs escaping, so a line costs no allocation once the
+// buffer has grown to its working size.
+class JsonLineWriter {
+public:
+    explicit JsonLineWriter(std::string &out) : out_(out) {
+        out_.clear();
+        out_.push_back('{');
+    }
+
+    void appendString(std::string_view key, std::string_view value) {
+        if (value.empty()) {
+            return;
+        }
+        appendKey(key);
+        out_.push_back('"');
+        appendEscaped(value);
+        out_.push_back('"');
+    }
+
+    void appendTraceId(std::string_view key, const TraceIdField &value) {
+        if (!value.isBinary()) {
+            appendString(key, value.text());
+            return;
+        }
+        if (value.id().empty()) {
+            return;
+        }
+        // Hex digits never need escaping.
+        auto digits = value.id().hex();
+        appendKey(key);
+        out_.push_back('"');
+        out_.append(digits.data(), digits.size());
+        out_.push_back('"');
+    }
+
+    template <typename T>
+    void appendNumber(std::string_view key, const std::optional<T> &value) {
+        if (!value.has_value()) {
+            return;
+        }
+        appendKey(key);
+        char digits[24];
+        auto result = std::to_chars(std::begin(digits), std::end(digits), *value);
+        out_.append(digits, result.ptr);
+    }
+
+    std::string_view finish() {
+        out_.push_back('}');
+        return out_;
+    }
+
+private:
+    static bool needsEscape(char ch) {
+        return ch == '"' || ch == '\\' || static_cast<unsigned char>(ch) < 0x20;
+    }
+
+    void appendKey(std::string_view key) {
+        if (!first_) {
+            out_.push_back(',');
+        }
+        first_ = false;
+        out_.push_back('"');
+        out_.append(key);
+        out_.append("\":", 2);
+    }
+
+    void appendEscaped(std::string_view value) {
+        auto clean = std::find_if(value.begin(), value.end(), needsEscape);
+        if (clean == value.end()) {
+            out_.append(value);
+            return;
+        }
+        static constexpr char kHex[] = "0123456789abcdef";
+        out_.append(value.begin(), clean);
+        for (auto it = clean; it != value.end(); ++it) {
+            char ch = *it;
+            switch (ch) {
+                case '"':
+                    out_.append("\\\"", 2);
+                    break;
+                case '\\':
+                    out_.append("\\\\", 2);
+                    break;
+                case '\b':
+                    out_.append("\\b", 2);
+                    break;
+                case '\f':
+                    out_.append("\\f", 2);
+                    break;
+                case '\n':
+                    out_.append("\\n", 2);
+                    break;
+                case '\r':
+                    out_.append("\\r", 2);
+                    break;
+                case '\t':
+                    out_.append("\\t", 2);
+                    break;
+                default:
+                    if (static_cast<unsigned char>(ch) < 0x20) {
+                        auto code = static_cast<unsigned char>(ch);
+                        char escaped[] = {'\\', 'u', '0', '0', kHex[code >> 4], kHex[code & 0x0F]};
+                        out_.append(escaped, sizeof(escaped));
+                    } else {
+                        out_.push_back(ch);
+                    }
+                    break;
+            }
+        }
+    }
+
+    std::string &out_;
+    bool first_{true};
+};
+
+// Single-producer/single-consumer ring owned by one logging thread. Lines up
+// to kInlineBytes are copied into the slot; longer ones spill to a string.
+class LogRing {
+public:
+    static constexpr std::size_t kInlineBytes = 480;
+
+    explicit LogRing(std::size_t capacity) {
+        std::size_t rounded = 1;
+        while (rounded < std::max<std::size_t>(capacity, 2)) {
+            rounded <<= 1;
+        }
+        slots_.resize(rounded);
+        mask_ = rounded - 1;
+    }
+
+    bool tryPush(std::string_view line) {
+        auto head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) > mask_) {
+            return false;
+        }
+        auto &slot = slots_[head & mask_];
+        slot.length = line.size();
+        if (line.size() <= kInlineBytes) {
+            std::memcpy(slot.inline_bytes.data(), line.data(), line.size());
+        } else {
+            slot.spill.assign(line.data(), line.size());
+        }
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Appends every pending line (newline-terminated) to `batch`.
+    std::size_t drainInto(std::string &batch) {
+        auto tail = tail_.load(std::memory_order_relaxed);
+        auto head = head_.load(std::memory_order_acquire);
+        std::size_t count = 0;
+        for (; tail != head; ++tail, ++count) {
+            const auto &slot = slots_[tail & mask_];
+            if (slot.length <= kInlineBytes) {
+                batch.append(slot.inline_bytes.data(), slot.length);
+            } else {
+                batch.append(slot.spill);
+            }
+            batch.push_back('\n');
+        }
+        tail_.store(tail, std::memory_order_release);
+        return count;
+    }
+
+    bool empty() const {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+private:
+    struct Slot {
+        std::size_t length{0};
+        std::array<char, kInlineBytes> inline_bytes{};
+        std::string spill;
+    };
+
+    std::vector<Slot> slots_;
+    std::size_t mask_{0};
+    alignas(64) std::atomic<std::size_t> head_{0};
+    alignas(64) std::atomic<std::size_t> tail_{0};
+};
+
+class AsyncLogWriter {
+public:
+    AsyncLogWriter() : thread_([this] { run(); }) {}
+
+    void push(std::string_view line) {
+        if (stopped_.load(std::memory_order_acquire)) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            writeBatch(std::string(line) + '\n', 1);
+            return;
+        }
+        auto &ring = localRing();
+        if (!ring.tryPush(line)) {
+            if (full_policy_.load(std::memory_order_relaxed) == LogFullPolicy::Drop) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                wake();
+                return;
+            }
+            blocked_.fetch_add(1, std::memory_order_relaxed);
+            do {
+                wake();
+                std::this_thread::yield();
+            } while (!ring.tryPush(line));
+        }
+        // Pairs with the fence in run(): either the writer sees this line or
+        // this thread sees it idle and wakes it.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (writer_idle_.load(std::memory_order_relaxed)) {
+            wake();
+        }
+    }
+
+    void configure(const LoggerConfig &config) {
+        flush();
+        std::lock_guard<std::mutex> lock(mutex_);
+        full_policy_.store(config.full_policy, std::memory_order_relaxed);
+        ring_capacity_ = config.ring_capacity;
+        file_.close();
+        file_.clear();
+        if (!config.path.empty()) {
+            file_.open(config.path, std::ios::out | std::ios::app);
+        }
+    }
+
+    void flush() {
+        if (stopped_.load(std::memory_order_acquire)) {
+            return;
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto target = ++flush_requested_;
+        writer_idle_.store(false, std::memory_order_relaxed);
+        wake_cv_.notify_one();
+        flushed_cv_.wait(lock, [&] { return flush_completed_ >= target; });
+    }
+
+    void shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stop_requested_) {
+                return;
+            }
+            stop_requested_ = true;
+            writer_idle_.store(false, std::memory_order_relaxed);
+        }
+        wake_cv_.notify_one();
+        thread_.join();
+        stopped_.store(true, std::memory_order_release);
+    }
+
+    LoggerStats stats() const {
+        LoggerStats result;
+        result.written = written_.load(std::memory_order_relaxed);
+        result.dropped = dropped_.load(std::memory_order_relaxed);
+        result.blocked = blocked_.load(std::memory_order_relaxed);
+        return result;
+    }
+
+private:
+    LogRing &localRing() {
+        thread_local std::shared_ptr<LogRing> ring;
+        if (!ring) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ring = std::make_shared<LogRing>(ring_capacity_);
+            rings_.push_back(ring);
+        }
+        return *ring;
+    }
+
+    void wake() {
+        if (writer_idle_.exchange(false, std::memory_order_acq_rel)) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            wake_cv_.notify_one();
+        }
+    }
+
+    void run() {
+        std::string batch;
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            auto flush_target = flush_requested_;
+            bool stopping = stop_requested_;
+            batch.clear();
+            std::size_t lines = 0;
+            for (auto it = rings_.begin(); it != rings_.end();) {
+                lines += (*it)->drainInto(batch);
+                // Owning thread has exited and everything it logged is out.
+                if (it->use_count() == 1 && (*it)->empty()) {
+                    it = rings_.erase(it);
                 } else {
-                    escaped << ch;
+                    ++it;
                 }
-                break;
+            }
+            if (lines > 0) {
+                writeBatch(batch, lines);
+            }
+            if (flush_target > flush_completed_) {
+                flush_completed_ = flush_target;
+                flushed_cv_.notify_all();
+            }
+            if (stopping) {
+                return;
+            }
+            if (lines > 0 || flush_requested_ != flush_target) {
+                continue;
+            }
+            writer_idle_.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            bool pending = std::any_of(rings_.begin(), rings_.end(),
+                                       [](const auto &ring) { return !ring->empty(); });
+            if (pending) {
+                writer_idle_.store(false, std::memory_order_relaxed);
+                continue;
+            }
+            wake_cv_.wait_for(lock, std::chrono::milliseconds{50}, [&] {
+                return !writer_idle_.load(std::memory_order_acquire);
+            });
+            writer_idle_.store(false, std::memory_order_relaxed);
         }
     }
-    return escaped.str();
+
+    // Called with mutex_ held; one write and one flush per batch.
+    void writeBatch(const std::string &batch, std::size_t lines) {
+        if (file_.is_open()) {
+            file_.write(batch.data(), static_cast<std::streamsize>(batch.size()));
+            file_.flush();
+        } else {
+            std::cout.write(batch.data(), static_cast<std::streamsize>(batch.size()));
+            std::cout.flush();
+        }
+        written_.fetch_add(lines, std::memory_order_relaxed);
+    }
+
+    std::mutex mutex_;
+    std::condition_variable wake_cv_;
+    std::condition_variable flushed_cv_;
+    std::vector<std::shared_ptr<LogRing>> rings_;
+    std::ofstream file_;
+    std::size_t ring_capacity_{LoggerConfig{}.ring_capacity};
+    std::uint64_t flush_requested_{0};
+    std::uint64_t flush_completed_{0};
+    bool stop_requested_{false};
+    std::atomic<bool> writer_idle_{false};
+    std::atomic<bool> stopped_{false};
+    std::atomic<LogFullPolicy> full_policy_{LogFullPolicy::Drop};
+    std::atomic<std::uint64_t> written_{0};
+    std::atomic<std::uint64_t> dropped_{0};
+    std::atomic<std::uint64_t> blocked_{0};
+    std::thread thread_;
+};
+
+// Intentionally leaked: worker threads may still log during static
+// destruction. Pending lines are written from an atexit hook instead.
+AsyncLogWriter &asyncWriter() {
+    static AsyncLogWriter *writer = [] {
+        auto *instance = new AsyncLogWriter();
+        std::atexit([] { asyncWriter().shutdown(); });
+        return instance;
+    }();
+    return *writer;
+}
+
+std::uint64_t splitMix64(std::uint64_t &state) {
+    std::uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
 }
 
-std::string isoTimestamp() {
-    auto now = std::chrono::system_clock::now();
-    auto time = std::chrono::system_clock::to_time_t(now);
-    std::tm utc_tm{};
-#if defined(_WIN32)
-    gmtime_s(&utc_tm, &time);
-#else
-    gmtime_r(&time, &utc_tm);
-#endif
-    std::ostringstream stamp;
-    stamp << std::put_time(&utc_tm, "%Y-%m-%dT%H:%M:%SZ");
-    return stamp.str();
+std::uint64_t rotl(std::uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
 }
 
-template <typename T>
-void appendNumber(std::ostringstream &out,
-                  const char *key,
-                  const std::optional<T> &value,
-                  bool &first) {
-    if (!value.has_value()) {
-        return;
+// xoshiro256** seeded through splitmix64 from one random_device read plus
+// the thread id and clock, so threads get independent streams.
+class TraceIdGenerator {
+public:
+    TraceIdGenerator() {
+        std::uint64_t seed = std::random_device{}();
+        seed = (seed << 32) ^ std::hash<std::thread::id>{}(std::this_thread::get_id());
+        seed ^= static_cast<std::uint64_t>(
+            std::chrono::steady_clock::now().time_since_epoch().count());
+        for (auto &word : state_) {
+            word = splitMix64(seed);
+        }
     }
-    if (!first) {
-        out << ',';
+
+    TraceId next() {
+        TraceId id{step(), step()};
+        if (id.empty()) {
+            id.low = 1;
+        }
+        return id;
     }
-    first = false;
-    out << '"' << key << "\":" << *value;
-}
 
-void appendString(std::ostringstream &out,
-                  const char *key,
-                  const std::optional<std::string> &value,
-                  bool &first) {
-    if (!value.has_value() || value->empty()) {
-        return;
+private:
+    std::uint64_t step() {
+        std::uint64_t result = rotl(state_[1] * 5, 7) * 9;
+        std::uint64_t t = state_[1] << 17;
+        state_[2] ^= state_[0];
+        state_[3] ^= state_[1];
+        state_[1] ^= state_[2];
+        state_[0] ^= state_[3];
+        state_[2] ^= t;
+        state_[3] = rotl(state_[3], 45);
+        return result;
     }
-    if (!first) {
-        out << ',';
+
+    std::array<std::uint64_t, 4> state_{};
+};
+
+}  // namespace
+
+bool TraceId::empty() const {
+    return high == 0 && low == 0;
+}
+
+std::array<char, 32> TraceId::hex() const {
+    static constexpr char kDigits[] = "0123456789abcdef";
+    std::array<char, 32> out{};
+    for (std::size_t i = 0; i < 16; ++i) {
+        out[i] = kDigits[(high >> (60 - 4 * i)) & 0xF];
+        out[16 + i] = kDigits[(low >> (60 - 4 * i)) & 0xF];
     }
-    first = false;
-    out << '"' << key << "\":\"" << jsonEscape(*value) << '\"';
+    return out;
 }
 
-}  // namespace
+std::string TraceId::toString() const {
+    auto digits = hex();
+    return std::string(digits.data(), digits.size());
+}
+
+bool TraceIdField::empty() const {
+    return text_.empty() && id_.empty();
+}
+
+bool TraceIdField::isBinary() const {
+    return !id_.empty();
+}
+
+std::string_view TraceIdField::text() const {
+    return text_;
+}
+
+const TraceId &TraceIdField::id() const {
+    return id_;
+}
 
-void StructuredLogger::log(const std::string &level,
-                           const std::string &event,
-                           const std::string &message,
+void StructuredLogger::log(std::string_view level,
+                           std::string_view event,
+                           std::string_view message,
                            const LogFields &fields) {
-    std::ostringstream entry;
-    entry << '{';
-    bool first = true;
-    appendString(entry, "timestamp", std::optional<std::string>{isoTimestamp()},
-                 first);
-    appendString(entry, "level", std::optional<std::string>{level}, first);
-    appendString(entry, "event", std::optional<std::string>{event}, first);
-    appendString(entry, "message", std::optional<std::string>{message}, first);
-    appendString(entry, "trace_id", fields.trace_id, first);
-    appendString(entry, "session_trace_id", fields.session_trace_id, first);
-    appendString(entry, "request_trace_id", fields.request_trace_id, first);
-    appendNumber(entry, "session_id", fields.session_id, first);
-    appendNumber(entry, "packet_type", fields.packet_type, first);
-    appendNumber(entry, "protocol_version", fields.protocol_version, first);
-    appendNumber(entry, "bytes", fields.bytes, first);
-    appendString(entry, "user_id", fields.user_id, first);
-    appendString(entry, "reason", fields.reason, first);
-    entry << '}';
-
-    std::lock_guard<std::mutex> lock(mutex_);
-    std::cout << entry.str() << std::endl;
+    thread_local std::string line;
+    JsonLineWriter entry(line);
+    entry.appendString("timestamp", net::CoarseClock::isoTimestamp());
+    entry.appendString("level", level);
+    entry.appendString("event", event);
+    entry.appendString("message", message);
+    entry.appendTraceId("trace_id", fields.trace_id);
+    entry.appendTraceId("session_trace_id", fields.session_trace_id);
+    entry.appendTraceId("request_trace_id", fields.request_trace_id);
+    entry.appendNumber("session_id", fields.session_id);
+    entry.appendNumber("packet_type", fields.packet_type);
+    entry.appendNumber("protocol_version", fields.protocol_version);
+    entry.appendNumber("bytes", fields.bytes);
+    entry.appendString("user_id", fields.user_id);
+    entry.appendString("reason", fields.reason);
+
+    asyncWriter().push(entry.finish());
 }
 
-std::string StructuredLogger::generateTraceId() {
-    std::array<unsigned char, 16> bytes{};
-    std::random_device device;
-    std::mt19937 generator(device());
-    std::uniform_int_distribution<int> dist(0, 255);
-    for (auto &byte : bytes) {
-        byte = static_cast<unsigned char>(dist(generator));
-    }
-    std::ostringstream out;
-    out << std::hex << std::setfill('0');
-    for (unsigned char byte : bytes) {
-        out << std::setw(2) << static_cast<int>(byte);
-    }
-    return out.str();
+TraceId StructuredLogger::generateTraceId() {
+    thread_local TraceIdGenerator generator;
+    return generator.next();
+}
+
+void StructuredLogger::configure(const LoggerConfig &config) {
+    asyncWriter().configure(config);
+}
+
+void StructuredLogger::flush() {
+    asyncWriter().flush();
+}
+
+LoggerStats StructuredLogger::stats() {
+    return asyncWriter().stats();
 }
 
 }  // namespace admin
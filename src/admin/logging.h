@@ -1,37 +1,101 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
 #include <cstdint>
-#include <mutex>
 #include <optional>
 #include <string>
+#include <string_view>
 
 namespace admin {
 
+// 128-bit trace id. It stays binary on the request path; the hex text is
+// only produced when a log line carrying it is written. All-zero is empty.
+struct TraceId {
+    std::uint64_t high{0};
+    std::uint64_t low{0};
+
+    bool empty() const;
+    // 32 lowercase hex digits, most significant first.
+    std::array<char, 32> hex() const;
+    std::string toString() const;
+    bool operator==(const TraceId &other) const = default;
+};
+
+// Trace id slot of LogFields: a borrowed string (ids received from outside)
+// or a binary TraceId.
+class TraceIdField {
+public:
+    TraceIdField() = default;
+    TraceIdField(std::string_view text) : text_(text) {}
+    TraceIdField(const char *text) : text_(text) {}
+    TraceIdField(const std::string &text) : text_(text) {}
+    TraceIdField(const TraceId &id) : id_(id) {}
+
+    bool empty() const;
+    bool isBinary() const;
+    std::string_view text() const;
+    const TraceId &id() const;
+
+private:
+    std::string_view text_;
+    TraceId id_{};
+};
+
+// String fields are borrowed: the viewed strings must outlive the log() call.
+// An empty view means the field is omitted from the line.
 struct LogFields {
-    std::optional<std::string> trace_id;
-    std::optional<std::string> session_trace_id;
-    std::optional<std::string> request_trace_id;
+    TraceIdField trace_id;
+    TraceIdField session_trace_id;
+    TraceIdField request_trace_id;
     std::optional<std::uint64_t> session_id;
     std::optional<std::uint16_t> packet_type;
     std::optional<std::uint16_t> protocol_version;
     std::optional<std::uint64_t> bytes;
-    std::optional<std::string> user_id;
-    std::optional<std::string> reason;
+    std::string_view user_id;
+    std::string_view reason;
+};
+
+enum class LogFullPolicy {
+    Drop,
+    Block
+};
+
+struct LoggerConfig {
+    // Empty path writes to std::cout.
+    std::string path;
+    LogFullPolicy full_policy{LogFullPolicy::Drop};
+    // Lines per thread ring; rounded up to a power of two. Applies to rings
+    // created after configure().
+    std::size_t ring_capacity{1024};
+};
+
+struct LoggerStats {
+    std::uint64_t written{0};
+    std::uint64_t dropped{0};
+    std::uint64_t blocked{0};
 };
 
+// log() formats the line on the calling thread into a reusable per-thread
+// buffer (no heap allocation once warmed up) and hands it to a per-thread
+// lock-free ring; a background writer drains all rings and writes in batches.
 class StructuredLogger {
 public:
     StructuredLogger() = default;
 
-    void log(const std::string &level,
-             const std::string &event,
-             const std::string &message,
+    void log(std::string_view level,
+             std::string_view event,
+             std::string_view message,
              const LogFields &fields = {});
 
-    static std::string generateTraceId();
+    // Thread-local xoshiro256** stream seeded once per thread; no syscall or
+    // allocation per id.
+    static TraceId generateTraceId();
 
-private:
-    std::mutex mutex_;
+    static void configure(const LoggerConfig &config);
+    // Blocks until every line logged before the call has been written.
+    static void flush();
+    static LoggerStats stats();
 };
 
 }  // namespace admin
@@ -0,0 +1,119 @@
+#include "combat/combat_log.h"
+
+#include "common/binary_file.h"
+
+#include <filesystem>
+
+namespace combat {
+
+namespace {
+
+using common::getLittle;
+using common::putLittle;
+
+constexpr common::RecordFileFormat kFormat{{'D', 'H', 'C', 'L'},
+                                           CombatLogWriter::kVersion,
+                                           static_cast<std::uint16_t>(CombatLogWriter::kRecordSize)};
+constexpr std::size_t kFlushBytes = 64 * 1024;
+
+}  // namespace
+
+CombatLogWriter::~CombatLogWriter() {
+    close();
+}
+
+bool CombatLogWriter::open(const std::string &path) {
+    close();
+    std::error_code error;
+    auto existing = std::filesystem::file_size(path, error);
+    bool fresh = error || existing == 0;
+    file_.open(path, std::ios::binary | std::ios::app);
+    if (!file_.is_open()) {
+        return false;
+    }
+    if (fresh) {
+        common::putRecordHeader(buffer_, kFormat);
+    }
+    return flush();
+}
+
+bool CombatLogWriter::isOpen() const {
+    return file_.is_open();
+}
+
+void CombatLogWriter::write(std::span<const DamageRecord> records) {
+    if (!file_.is_open()) {
+        return;
+    }
+    buffer_.reserve(buffer_.size() + records.size() * kRecordSize);
+    for (const auto &record : records) {
+        putLittle(buffer_, record.tick);
+        putLittle(buffer_, record.event.source_id);
+        putLittle(buffer_, record.event.target_id);
+        putLittle(buffer_, record.event.skill_id);
+        putLittle(buffer_, record.event.amount);
+    }
+    written_ += records.size();
+    if (buffer_.size() >= kFlushBytes) {
+        flush();
+    }
+}
+
+bool CombatLogWriter::flush() {
+    if (!file_.is_open()) {
+        return false;
+    }
+    if (!buffer_.empty()) {
+        file_.write(reinterpret_cast<const char *>(buffer_.data()),
+                    static_cast<std::streamsize>(buffer_.size()));
+        buffer_.clear();
+    }
+    file_.flush();
+    return static_cast<bool>(file_);
+}
+
+void CombatLogWriter::close() {
+    if (!file_.is_open()) {
+        return;
+    }
+    flush();
+    file_.close();
+}
+
+std::uint64_t CombatLogWriter::recordsWritten() const {
+    return written_;
+}
+
+DamageHistory::EvictionSink CombatLogWriter::sink() {
+    return [this](std::span<const DamageRecord> evicted) { write(evicted); };
+}
+
+std::optional<std::vector<DamageRecord>> readCombatLog(const std::string &path) {
+    auto contents = common::readFileBytes(path);
+    if (!contents) {
+        return std::nullopt;
+    }
+    const auto &bytes = *contents;
+    constexpr auto kHeaderSize = CombatLogWriter::kHeaderSize;
+    constexpr auto kRecordSize = CombatLogWriter::kRecordSize;
+    if (!common::hasRecordHeader(bytes, kFormat) ||
+        (bytes.size() - kHeaderSize) % kRecordSize != 0) {
+        return std::nullopt;
+    }
+
+    std::vector<DamageRecord> records;
+    records.reserve((bytes.size() - kHeaderSize) / kRecordSize);
+    for (auto at = bytes.data() + kHeaderSize; at < bytes.data() + bytes.size();
+         at += kRecordSize) {
+        DamageRecord record;
+        record.tick = getLittle<std::uint32_t>(at);
+        record.event.source_id = getLittle<std::uint64_t>(at + 4);
+        record.event.target_id = getLittle<std::uint64_t>(at + 12);
+        record.event.skill_id = getLittle<std::uint32_t>(at + 20);
+        record.event.amount = getLittle<std::int32_t>(at + 24);
+        records.push_back(record);
+    }
+    return records;
+}
+
+}  // namespace combat
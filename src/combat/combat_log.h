@@ -0,0 +1,52 @@
+#pragma once
+
+#include "combat/damage_history.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace combat {
+
+// Binary combat log for offline analysis. An 8-byte header ("DHCL", uint16
+// version, uint16 record size) is followed by fixed 28-byte little-endian
+// records: tick u32, source u64, target u64, skill u32, amount i32.
+class CombatLogWriter {
+public:
+    static constexpr std::uint16_t kVersion = 1;
+    static constexpr std::size_t kHeaderSize = 8;
+    static constexpr std::size_t kRecordSize = 28;
+
+    CombatLogWriter() = default;
+    ~CombatLogWriter();
+
+    CombatLogWriter(const CombatLogWriter &) = delete;
+    CombatLogWriter &operator=(const CombatLogWriter &) = delete;
+
+    // Appends to `path`, writing the header when the file is new or empty.
+    bool open(const std::string &path);
+    bool isOpen() const;
+    // Buffered; records reach the file on flush() or once 64 KiB is pending.
+    void write(std::span<const DamageRecord> records);
+    bool flush();
+    void close();
+    std::uint64_t recordsWritten() const;
+
+    // Ready-made DamageHistory eviction sink bound to this writer.
+    DamageHistory::EvictionSink sink();
+
+private:
+    std::ofstream file_;
+    std::vector<std::uint8_t> buffer_;
+    std::uint64_t written_{0};
+};
+
+// Whole-file reader for tools and tests; nullopt on a bad header or a
+// truncated record.
+std::optional<std::vector<DamageRecord>> readCombatLog(const std::string &path);
+
+}  // namespace combat
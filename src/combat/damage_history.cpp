@@ -0,0 +1,264 @@
+#include "combat/damage_history.h"
+
+#include <algorithm>
+
+namespace combat {
+
+void DamageTotalsTable::add(EntityId id, std::int32_t amount) {
+    if ((used_ + 1) * 2 > entries_.size()) {
+        rebuild();
+    }
+    auto mask = entries_.size() - 1;
+    auto index = home(id);
+    while (entries_[index].used && entries_[index].id != id) {
+        index = (index + 1) & mask;
+    }
+    auto &entry = entries_[index];
+    if (!entry.used) {
+        entry.used = true;
+        entry.id = id;
+        used_ += 1;
+    }
+    if (entry.total.hits == 0) {
+        size_ += 1;
+    }
+    entry.total.amount += amount;
+    entry.total.hits += 1;
+}
+
+void DamageTotalsTable::remove(EntityId id, std::int32_t amount) {
+    auto *entry = slotFor(id);
+    if (!entry || entry->total.hits == 0) {
+        return;
+    }
+    entry->total.amount -= amount;
+    entry->total.hits -= 1;
+    if (entry->total.hits == 0) {
+        size_ -= 1;
+    }
+}
+
+DamageTotal DamageTotalsTable::find(EntityId id) const {
+    const auto *entry = const_cast<DamageTotalsTable *>(this)->slotFor(id);
+    return entry ? entry->total : DamageTotal{};
+}
+
+std::size_t DamageTotalsTable::size() const {
+    return size_;
+}
+
+void DamageTotalsTable::clear() {
+    std::fill(entries_.begin(), entries_.end(), Entry{});
+    size_ = 0;
+    used_ = 0;
+}
+
+std::size_t DamageTotalsTable::home(EntityId id) const {
+    auto mixed = id * 0x9e3779b97f4a7c15ULL;
+    mixed ^= mixed >> 32;
+    return static_cast<std::size_t>(mixed) & (entries_.size() - 1);
+}
+
+DamageTotalsTable::Entry *DamageTotalsTable::slotFor(EntityId id) {
+    if (entries_.empty()) {
+        return nullptr;
+    }
+    auto mask = entries_.size() - 1;
+    for (auto index = home(id); entries_[index].used; index = (index + 1) & mask) {
+        if (entries_[index].id == id) {
+            return &entries_[index];
+        }
+    }
+    return nullptr;
+}
+
+// Drops idle entries and doubles only if live ones still fill a quarter of
+// the table.
+void DamageTotalsTable::rebuild() {
+    auto slots = std::max<std::size_t>(16, entries_.size());
+    if ((size_ + 1) * 4 > slots) {
+        slots *= 2;
+    }
+    std::vector<Entry> previous(slots);
+    previous.swap(entries_);
+    used_ = 0;
+    auto mask = entries_.size() - 1;
+    for (const auto &entry : previous) {
+        if (!entry.used || entry.total.hits == 0) {
+            continue;
+        }
+        auto index = home(entry.id);
+        while (entries_[index].used) {
+            index = (index + 1) & mask;
+        }
+        entries_[index] = entry;
+        used_ += 1;
+    }
+}
+
+DamageHistory::DamageHistory(DamageHistoryConfig config) {
+    config_ = config;
+    config_.capacity = std::max<std::size_t>(1, config_.capacity);
+}
+
+void DamageHistory::configure(DamageHistoryConfig config) {
+    config.capacity = std::max<std::size_t>(1, config.capacity);
+    if (size_ > config.capacity) {
+        evict(size_ - config.capacity);
+    }
+    // Re-linearise so the ring can regrow under the new capacity.
+    if (head_ != 0) {
+        std::rotate(records_.begin(),
+                    records_.begin() + static_cast<std::ptrdiff_t>(head_),
+                    records_.end());
+        head_ = 0;
+    }
+    records_.resize(size_);
+    records_.shrink_to_fit();
+    config_ = config;
+    if (size_ > 0) {
+        evictWindow(at(size_ - 1).tick);
+    }
+}
+
+void DamageHistory::setEvictionSink(EvictionSink sink) {
+    sink_ = std::move(sink);
+}
+
+void DamageHistory::push(const DamageEvent &event, std::uint32_t tick) {
+    evictWindow(tick);
+    makeRoom(1);
+    store(event, tick);
+}
+
+void DamageHistory::append(std::span<const DamageEvent> events, std::uint32_t tick) {
+    evictWindow(tick);
+    while (!events.empty()) {
+        auto chunk = std::min(events.size(), config_.capacity);
+        makeRoom(chunk);
+        for (const auto &event : events.first(chunk)) {
+            store(event, tick);
+        }
+        events = events.subspan(chunk);
+    }
+}
+
+void DamageHistory::advance(std::uint32_t tick) {
+    evictWindow(tick);
+}
+
+void DamageHistory::drain() {
+    evict(size_);
+}
+
+std::size_t DamageHistory::size() const {
+    return size_;
+}
+
+bool DamageHistory::empty() const {
+    return size_ == 0;
+}
+
+const DamageHistoryConfig &DamageHistory::config() const {
+    return config_;
+}
+
+const DamageRecord &DamageHistory::at(std::size_t index) const {
+    auto position = head_ + index;
+    return records_[position < records_.size() ? position : position - records_.size()];
+}
+
+std::uint64_t DamageHistory::evictedCount() const {
+    return evicted_;
+}
+
+DamageTotal DamageHistory::dealtBy(EntityId source) const {
+    return dealt_.find(source);
+}
+
+DamageTotal DamageHistory::takenBy(EntityId target) const {
+    return taken_.find(target);
+}
+
+double DamageHistory::dps(EntityId source, std::chrono::nanoseconds tick_period) const {
+    if (size_ == 0) {
+        return 0.0;
+    }
+    auto ticks = static_cast<double>(at(size_ - 1).tick - at(0).tick) + 1.0;
+    auto seconds = ticks * std::chrono::duration<double>(tick_period).count();
+    if (seconds <= 0.0) {
+        return 0.0;
+    }
+    return static_cast<double>(dealtBy(source).amount) / seconds;
+}
+
+void DamageHistory::makeRoom(std::size_t incoming) {
+    if (size_ + incoming <= config_.capacity) {
+        return;
+    }
+    auto overflow = size_ + incoming - config_.capacity;
+    auto chunk = std::max<std::size_t>(1, config_.capacity / 16);
+    evict(std::max(overflow, std::min(size_, chunk)));
+}
+
+void DamageHistory::evictWindow(std::uint32_t tick) {
+    if (config_.window_ticks == 0 || size_ == 0) {
+        return;
+    }
+    std::size_t stale = 0;
+    while (stale < size_ && tick - at(stale).tick >= config_.window_ticks) {
+        stale += 1;
+    }
+    evict(stale);
+}
+
+void DamageHistory::evict(std::size_t count) {
+    count = std::min(count, size_);
+    auto slots = records_.size();
+    while (count > 0) {
+        auto run = std::min(count, slots - head_);
+        std::span<const DamageRecord> evicted(records_.data() + head_, run);
+        for (const auto &record : evicted) {
+            dealt_.remove(record.event.source_id, record.event.amount);
+            taken_.remove(record.event.target_id, record.event.amount);
+        }
+        if (sink_) {
+            sink_(evicted);
+        }
+        head_ += run;
+        if (head_ == slots) {
+            head_ = 0;
+        }
+        size_ -= run;
+        count -= run;
+        evicted_ += run;
+    }
+    if (size_ == 0) {
+        head_ = 0;
+    }
+}
+
+void DamageHistory::store(const DamageEvent &event, std::uint32_t tick) {
+    auto slots = records_.size();
+    if (size_ < slots) {
+        auto position = head_ + size_;
+        records_[position < slots ? position : position - slots] = DamageRecord{tick, event};
+    } else {
+        if (head_ != 0) {
+            std::rotate(records_.begin(),
+                        records_.begin() + static_cast<std::ptrdiff_t>(head_),
+                        records_.end());
+            head_ = 0;
+        }
+        if (records_.size() == records_.capacity()) {
+            records_.reserve(
+                std::min(config_.capacity, std::max<std::size_t>(64, records_.size() * 2)));
+        }
+        records_.push_back(DamageRecord{tick, event});
+    }
+    size_ += 1;
+    dealt_.add(event.source_id, event.amount);
+    taken_.add(event.target_id, event.amount);
+}
+
+}  // namespace combat
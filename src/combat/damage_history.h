@@ -0,0 +1,111 @@
+#pragma once
+
+#include "combat/entity_store.h"
+#include "combat/events.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace combat {
+
+struct DamageRecord {
+    std::uint32_t tick{0};
+    DamageEvent event;
+};
+
+struct DamageTotal {
+    std::int64_t amount{0};
+    std::uint32_t hits{0};
+};
+
+struct DamageHistoryConfig {
+    std::size_t capacity{4096};
+    // Records more than this many ticks behind the newest are evicted as
+    // well; 0 keeps them until the ring wraps.
+    std::uint32_t window_ticks{0};
+};
+
+// Open-addressing EntityId -> DamageTotal map with linear probing. Entries
+// whose hits drop to zero stay in place (sources come and go every tick) and
+// are swept out when the table next fills up, so it is bounded by the
+// entities present in the window rather than every entity ever seen.
+class DamageTotalsTable {
+public:
+    void add(EntityId id, std::int32_t amount);
+    void remove(EntityId id, std::int32_t amount);
+    DamageTotal find(EntityId id) const;
+    // Entities with at least one retained hit.
+    std::size_t size() const;
+    void clear();
+
+private:
+    struct Entry {
+        EntityId id{0};
+        DamageTotal total;
+        bool used{false};
+    };
+
+    std::size_t home(EntityId id) const;
+    Entry *slotFor(EntityId id);
+    void rebuild();
+
+    std::vector<Entry> entries_;
+    std::size_t size_{0};
+    std::size_t used_{0};
+};
+
+// Fixed-capacity ring of the most recent damage, with per-source and
+// per-target totals kept in step on every push and eviction. Evicted records
+// are handed to the eviction sink in contiguous runs (a full ring evicts
+// capacity / 16 at a time) so an exporter can stream them out.
+class DamageHistory {
+public:
+    using EvictionSink = std::function<void(std::span<const DamageRecord> evicted)>;
+
+    explicit DamageHistory(DamageHistoryConfig config = DamageHistoryConfig());
+
+    // Shrinking evicts the oldest records through the sink.
+    void configure(DamageHistoryConfig config);
+    void setEvictionSink(EvictionSink sink);
+
+    void push(const DamageEvent &event, std::uint32_t tick);
+    void append(std::span<const DamageEvent> events, std::uint32_t tick);
+    // Applies the tick window without adding anything (idle instances).
+    void advance(std::uint32_t tick);
+    // Evicts every retained record through the sink.
+    void drain();
+
+    std::size_t size() const;
+    bool empty() const;
+    const DamageHistoryConfig &config() const;
+    // 0 is the oldest retained record.
+    const DamageRecord &at(std::size_t index) const;
+    std::uint64_t evictedCount() const;
+
+    DamageTotal dealtBy(EntityId source) const;
+    DamageTotal takenBy(EntityId target) const;
+    // Damage per second dealt by `source` over the retained ticks.
+    double dps(EntityId source, std::chrono::nanoseconds tick_period) const;
+
+private:
+    void makeRoom(std::size_t incoming);
+    void evictWindow(std::uint32_t tick);
+    void evict(std::size_t count);
+    void store(const DamageEvent &event, std::uint32_t tick);
+
+    DamageHistoryConfig config_;
+    EvictionSink sink_;
+    // Grows up to config_.capacity, then wraps.
+    std::vector<DamageRecord> records_;
+    std::size_t head_{0};
+    std::size_t size_{0};
+    std::uint64_t evicted_{0};
+    DamageTotalsTable dealt_;
+    DamageTotalsTable taken_;
+};
+
+}  // namespace combat
@@ -1,7 +1,130 @@
 #include "combat/dispatcher.h"
 
+#include "common/cpu_dispatch.h"
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+
+#if defined(DUNGEONHUB_HAVE_AVX2)
+#include <immintrin.h>
+#endif
+
 namespace combat {
 
+namespace {
+
+using ScaleFn = void (*)(const float *base, const float *mitigation, std::int32_t *out,
+                         std::size_t count);
+using ApplyFn = std::size_t (*)(std::int32_t *hp, const std::int32_t *damage,
+                                std::size_t count);
+
+constexpr float kMaxHitFloat = static_cast<float>(Dispatcher::kMaxHit);
+
+void scalePortable(const float *base, const float *mitigation, std::int32_t *out,
+                   std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        float amount = std::min(std::max(base[i] * mitigation[i], 0.0f), kMaxHitFloat);
+        out[i] = static_cast<std::int32_t>(amount);
+    }
+}
+
+// hp = max(hp - damage, 0) over the whole store; returns how many went from
+// positive to zero.
+std::size_t applyPortable(std::int32_t *hp, const std::int32_t *damage, std::size_t count) {
+    std::size_t killed = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        auto next = std::max(hp[i] - damage[i], 0);
+        killed += static_cast<std::size_t>(hp[i] > 0 && next == 0);
+        hp[i] = next;
+    }
+    return killed;
+}
+
+#if defined(DUNGEONHUB_HAVE_AVX2)
+
+__attribute__((target("avx2"))) void scaleAvx2(const float *base,
+                                               const float *mitigation,
+                                               std::int32_t *out,
+                                               std::size_t count) {
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 cap = _mm256_set1_ps(kMaxHitFloat);
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 amount = _mm256_mul_ps(_mm256_loadu_ps(base + i), _mm256_loadu_ps(mitigation + i));
+        amount = _mm256_min_ps(_mm256_max_ps(amount, zero), cap);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), _mm256_cvttps_epi32(amount));
+    }
+    scalePortable(base + i, mitigation + i, out + i, count - i);
+}
+
+__attribute__((target("avx2,popcnt"))) std::size_t applyAvx2(std::int32_t *hp,
+                                                             const std::int32_t *damage,
+                                                             std::size_t count) {
+    const __m256i zero = _mm256_setzero_si256();
+    std::size_t killed = 0;
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i before = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(hp + i));
+        __m256i hit = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(damage + i));
+        __m256i after = _mm256_max_epi32(_mm256_sub_epi32(before, hit), zero);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(hp + i), after);
+        __m256i died = _mm256_and_si256(_mm256_cmpgt_epi32(before, zero),
+                                        _mm256_cmpeq_epi32(after, zero));
+        killed += static_cast<std::size_t>(
+            std::popcount(static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(died)))));
+    }
+    return killed + applyPortable(hp + i, damage + i, count - i);
+}
+
+#endif
+
+struct Kernels {
+    ScaleFn scale;
+    ApplyFn apply;
+};
+
+using Dispatch = common::KernelDispatch<DamageKernel, Kernels, 2>;
+
+Dispatch &dispatch() {
+#if defined(DUNGEONHUB_HAVE_AVX2)
+    constexpr Kernels kAvx2{scaleAvx2, applyAvx2};
+#else
+    constexpr Kernels kAvx2{scalePortable, applyPortable};
+#endif
+    static Dispatch instance(
+        {Dispatch::Option{Kernels{scalePortable, applyPortable}, true, "portable"},
+         Dispatch::Option{kAvx2, common::cpuHasAvx2(), "avx2"}});
+    return instance;
+}
+
+}  // namespace
+
+DamageKernel activeDamageKernel() {
+    return dispatch().active();
+}
+
+bool damageKernelSupported(DamageKernel kernel) {
+    return dispatch().supported(kernel);
+}
+
+bool setDamageKernel(DamageKernel kernel) {
+    return dispatch().set(kernel);
+}
+
+const char *damageKernelName(DamageKernel kernel) {
+    return dispatch().name(kernel);
+}
+
+SkillValidator makeRangeValidator(const SpatialGrid &grid,
+                                  std::unordered_map<std::uint32_t, float> skill_ranges) {
+    return [&grid, ranges = std::move(skill_ranges)](const SkillEvent &event) {
+        auto range = ranges.find(event.skill_id);
+        return range == ranges.end() ||
+               grid.withinRange(event.attacker_id, event.target_id, range->second);
+    };
+}
+
 void Dispatcher::setSkillValidator(SkillValidator validator) {
     skill_validator_ = std::move(validator);
 }
@@ -14,6 +137,18 @@ void Dispatcher::setDamageHandler(DamageHandler handler) {
     damage_handler_ = std::move(handler);
 }
 
+void Dispatcher::setDamageBatchHandler(DamageBatchHandler handler) {
+    damage_batch_handler_ = std::move(handler);
+}
+
+bool Dispatcher::setSkillCooldown(std::uint32_t skill_id, CooldownRule rule) {
+    if (rule.slot >= EntityStore::kCooldownSlots) {
+        return false;
+    }
+    cooldowns_[skill_id] = rule;
+    return true;
+}
+
 DamageEvent Dispatcher::processSkillEvent(const SkillEvent &event) {
     // Validation hook: dungeon event processing should confirm skill timing,
     // range, and authority before deriving damage.
@@ -31,16 +166,162 @@ DamageEvent Dispatcher::processSkillEvent(const SkillEvent &event) {
 }
 
 void Dispatcher::processDamageEvent(const DamageEvent &event) {
-    damage_history_.push_back(event);
+    damage_history_.push(event, current_tick_);
     if (damage_handler_) {
         damage_handler_(event);
     }
 }
 
-const std::vector<DamageEvent> &Dispatcher::damageHistory() const {
+BatchResult Dispatcher::applySkillBatch(EntityStore &store,
+                                        std::span<const SkillEvent> events,
+                                        std::uint32_t tick) {
+    current_tick_ = tick;
+    std::size_t rejected = 0;
+    batch_damage_.clear();
+    for (const auto &event : events) {
+        std::uint32_t attacker = 0;
+        std::uint32_t target = 0;
+        if (!acceptSkill(store, event, tick, attacker, target)) {
+            rejected += 1;
+            continue;
+        }
+
+        std::optional<DamageEvent> derived;
+        if (skill_handler_) {
+            derived = skill_handler_(event);
+        }
+        batch_damage_.push_back(derived.value_or(buildDamageFromSkill(event)));
+    }
+
+    auto result = applyDamageBatch(store, batch_damage_);
+    result.rejected += rejected;
+    return result;
+}
+
+BatchResult Dispatcher::applyDamageBatch(EntityStore &store,
+                                         std::span<const DamageEvent> events) {
+    auto hp = store.hp();
+    auto max_hp = store.maxHp();
+    BatchResult result;
+    for (const auto &event : events) {
+        auto target = store.indexOf(event.target_id);
+        if (!target || hp[*target] <= 0) {
+            result.rejected += 1;
+            continue;
+        }
+        auto next = std::clamp<std::int64_t>(
+            static_cast<std::int64_t>(hp[*target]) - event.amount, 0, max_hp[*target]);
+        hp[*target] = static_cast<std::int32_t>(next);
+        result.applied += 1;
+        if (next == 0) {
+            result.killed += 1;
+        }
+        processDamageEvent(event);
+    }
+    return result;
+}
+
+const DamageBatch &Dispatcher::resolveSkillBatch(EntityStore &store,
+                                                 std::span<const SkillEvent> events,
+                                                 std::uint32_t tick) {
+    current_tick_ = tick;
+    auto &batch = damage_batch_;
+    batch.events.clear();
+    batch.targets.clear();
+    batch.totals.clear();
+    batch.hp_after.clear();
+    batch.rejected = 0;
+    batch.killed = 0;
+    batch_targets_.clear();
+    batch_base_.clear();
+    batch_mitigation_.clear();
+
+    // Checks are branchy and stay scalar; they gather the accepted events
+    // into flat buffers for the kernel.
+    auto mitigation = store.mitigation();
+    for (const auto &event : events) {
+        std::uint32_t attacker = 0;
+        std::uint32_t target = 0;
+        if (!acceptSkill(store, event, tick, attacker, target)) {
+            batch.rejected += 1;
+            continue;
+        }
+        batch_targets_.push_back(target);
+        batch_base_.push_back(static_cast<float>(event.base_damage));
+        batch_mitigation_.push_back(mitigation[target]);
+        batch.events.push_back(DamageEvent{event.attacker_id, event.target_id, event.skill_id, 0});
+    }
+
+    auto accepted = batch_targets_.size();
+    batch_amounts_.resize(accepted);
+    dispatch().table().scale(batch_base_.data(), batch_mitigation_.data(),
+                             batch_amounts_.data(), accepted);
+
+    batch_accumulated_.assign(store.size(), 0);
+    for (std::size_t i = 0; i < accepted; ++i) {
+        batch.events[i].amount = batch_amounts_[i];
+        auto &total = batch_accumulated_[batch_targets_[i]];
+        total = static_cast<std::int32_t>(
+            std::min<std::int64_t>(static_cast<std::int64_t>(total) + batch_amounts_[i],
+                                   std::numeric_limits<std::int32_t>::max()));
+    }
+
+    auto hp = store.hp();
+    batch.killed = dispatch().table().apply(hp.data(), batch_accumulated_.data(), hp.size());
+
+    auto handles = store.handles();
+    for (std::size_t index = 0; index < batch_accumulated_.size(); ++index) {
+        if (batch_accumulated_[index] > 0) {
+            batch.targets.push_back(handles[index]);
+            batch.totals.push_back(batch_accumulated_[index]);
+            batch.hp_after.push_back(hp[index]);
+        }
+    }
+
+    damage_history_.append(batch.events, tick);
+    if (damage_batch_handler_) {
+        damage_batch_handler_(batch);
+    }
+    return batch;
+}
+
+DamageHistory &Dispatcher::damageHistory() {
     return damage_history_;
 }
 
+const DamageHistory &Dispatcher::damageHistory() const {
+    return damage_history_;
+}
+
+bool Dispatcher::acceptSkill(EntityStore &store,
+                             const SkillEvent &event,
+                             std::uint32_t tick,
+                             std::uint32_t &attacker,
+                             std::uint32_t &target) {
+    auto hp = store.hp();
+    auto faction = store.faction();
+    auto attacker_index = store.indexOf(event.attacker_id);
+    auto target_index = store.indexOf(event.target_id);
+    if (!attacker_index || !target_index || hp[*attacker_index] <= 0 ||
+        hp[*target_index] <= 0 || faction[*attacker_index] == faction[*target_index]) {
+        return false;
+    }
+    if (skill_validator_ && !skill_validator_(event)) {
+        return false;
+    }
+    auto rule = cooldowns_.empty() ? cooldowns_.end() : cooldowns_.find(event.skill_id);
+    if (rule != cooldowns_.end()) {
+        auto &ready = store.cooldownReady(rule->second.slot)[*attacker_index];
+        if (ready > tick) {
+            return false;
+        }
+        ready = tick + rule->second.ticks;
+    }
+    attacker = *attacker_index;
+    target = *target_index;
+    return true;
+}
+
 DamageEvent Dispatcher::buildDamageFromSkill(const SkillEvent &event) const {
     DamageEvent damage;
     damage.source_id = event.attacker_id;
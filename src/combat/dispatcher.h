@@ -1,51 +1,136 @@
 #pragma once
 
+#include "combat/damage_history.h"
+#include "combat/entity_store.h"
+#include "combat/events.h"
+#include "combat/spatial_grid.h"
+
+#include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <optional>
+#include <span>
+#include <unordered_map>
 #include <vector>
 
 namespace combat {
 
-using EntityId = std::uint64_t;
+enum class DamageKernel {
+    Portable,
+    Avx2
+};
+
+// Batch damage kernel selection (common::KernelDispatch).
+DamageKernel activeDamageKernel();
+bool damageKernelSupported(DamageKernel kernel);
+bool setDamageKernel(DamageKernel kernel);
+const char *damageKernelName(DamageKernel kernel);
+
+using SkillValidator = std::function<bool(const SkillEvent &event)>;
+
+// Server-side range check: rejects a skill whose target is farther from the
+// attacker than the skill's range, or either of which is missing from the
+// grid. Skills without a range always pass. The validator keeps a reference
+// to `grid`, which must outlive it (and any Dispatcher it is installed in).
+SkillValidator makeRangeValidator(const SpatialGrid &grid,
+                                  std::unordered_map<std::uint32_t, float> skill_ranges);
 
-struct SkillEvent {
-    EntityId attacker_id{0};
-    EntityId target_id{0};
-    std::uint32_t skill_id{0};
-    std::int32_t base_damage{0};
+struct CooldownRule {
+    std::size_t slot{0};
+    std::uint32_t ticks{0};
 };
 
-struct DamageEvent {
-    EntityId source_id{0};
-    EntityId target_id{0};
-    std::uint32_t skill_id{0};
-    std::int32_t amount{0};
+struct BatchResult {
+    std::size_t applied{0};
+    std::size_t rejected{0};
+    // Targets whose hp reached zero in this batch.
+    std::size_t killed{0};
 };
 
-using SkillValidator = std::function<bool(const SkillEvent &event)>;
+// Aggregated output of one resolveSkillBatch call; owned by the dispatcher
+// and overwritten by the next call.
+struct DamageBatch {
+    // Accepted events with their final amounts, in input order.
+    std::vector<DamageEvent> events;
+    // One entry per damaged target: summed damage and hp afterwards.
+    std::vector<EntityId> targets;
+    std::vector<std::int32_t> totals;
+    std::vector<std::int32_t> hp_after;
+    std::size_t rejected{0};
+    std::size_t killed{0};
+};
 
 class Dispatcher {
 public:
     using SkillHandler = std::function<std::optional<DamageEvent>(const SkillEvent &event)>;
     using DamageHandler = std::function<void(const DamageEvent &event)>;
+    using DamageBatchHandler = std::function<void(const DamageBatch &batch)>;
+
+    static constexpr std::int32_t kMaxHit = 1'000'000'000;
 
     void setSkillValidator(SkillValidator validator);
     void setSkillHandler(SkillHandler handler);
     void setDamageHandler(DamageHandler handler);
+    void setDamageBatchHandler(DamageBatchHandler handler);
+
+    // Skills without a rule have no cooldown. `slot` must be below
+    // EntityStore::kCooldownSlots.
+    bool setSkillCooldown(std::uint32_t skill_id, CooldownRule rule);
 
     DamageEvent processSkillEvent(const SkillEvent &event);
     void processDamageEvent(const DamageEvent &event);
 
-    const std::vector<DamageEvent> &damageHistory() const;
+    // Tick batch against an instance's entity store. Events whose attacker or
+    // target is unknown or dead, that target the attacker's own faction, or
+    // whose skill is on cooldown are rejected; the rest derive damage like
+    // processSkillEvent. Attackers are checked against hp at the start of the
+    // tick (simultaneous casts all land), then damage is applied in order, so
+    // a target killed earlier in the batch rejects later hits.
+    BatchResult applySkillBatch(EntityStore &store,
+                                std::span<const SkillEvent> events,
+                                std::uint32_t tick);
+    // Subtracts each amount from the target's hp, clamped to [0, max hp].
+    BatchResult applyDamageBatch(EntityStore &store, std::span<const DamageEvent> events);
+
+    // Fast path for a tick's skills. Same acceptance checks as
+    // applySkillBatch (the validator still runs if one is set), but damage is
+    // base_damage scaled by the target's mitigation and clamped to
+    // [0, kMaxHit], computed with the batch kernel; hits are summed per
+    // target and resolved simultaneously. The skill handler and per-event
+    // damage handler are not called; the batch handler gets one DamageBatch.
+    const DamageBatch &resolveSkillBatch(EntityStore &store,
+                                         std::span<const SkillEvent> events,
+                                         std::uint32_t tick);
+
+    // Bounded window of recent damage; configure its size and export sink
+    // through the non-const overload. Records made outside a batch carry the
+    // tick of the last batch.
+    DamageHistory &damageHistory();
+    const DamageHistory &damageHistory() const;
 
 private:
     DamageEvent buildDamageFromSkill(const SkillEvent &event) const;
+    bool acceptSkill(EntityStore &store,
+                     const SkillEvent &event,
+                     std::uint32_t tick,
+                     std::uint32_t &attacker,
+                     std::uint32_t &target);
 
     SkillValidator skill_validator_{};
     SkillHandler skill_handler_;
     DamageHandler damage_handler_;
-    std::vector<DamageEvent> damage_history_;
+    DamageBatchHandler damage_batch_handler_;
+    DamageHistory damage_history_;
+    std::uint32_t current_tick_{0};
+    std::unordered_map<std::uint32_t, CooldownRule> cooldowns_;
+    // Scratch reused across batches.
+    std::vector<DamageEvent> batch_damage_;
+    std::vector<std::uint32_t> batch_targets_;
+    std::vector<float> batch_base_;
+    std::vector<float> batch_mitigation_;
+    std::vector<std::int32_t> batch_amounts_;
+    std::vector<std::int32_t> batch_accumulated_;
+    DamageBatch damage_batch_;
 };
 
 }  // namespace combat
@@ -0,0 +1,197 @@
+#include "combat/entity_store.h"
+
+#include "combat/spatial_grid.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace combat {
+
+namespace {
+
+EntityId makeHandle(std::uint32_t slot, std::uint32_t generation) {
+    return (static_cast<EntityId>(generation) << 32) | (static_cast<EntityId>(slot) + 1);
+}
+
+template <typename T>
+void swapRemove(std::vector<T> &values, std::size_t index) {
+    values[index] = values.back();
+    values.pop_back();
+}
+
+}  // namespace
+
+EntityId EntityStore::spawn(const EntitySpawn &spawn) {
+    std::uint32_t slot_index = 0;
+    if (!free_slots_.empty()) {
+        slot_index = free_slots_.back();
+        free_slots_.pop_back();
+    } else {
+        slot_index = static_cast<std::uint32_t>(slots_.size());
+        slots_.emplace_back();
+    }
+    auto &slot = slots_[slot_index];
+    slot.dense = static_cast<std::uint32_t>(handles_.size());
+    slot.live = true;
+
+    auto handle = makeHandle(slot_index, slot.generation);
+    handles_.push_back(handle);
+    hp_.push_back(spawn.hp);
+    max_hp_.push_back(spawn.hp);
+    pos_x_.push_back(spawn.x);
+    pos_y_.push_back(spawn.y);
+    faction_.push_back(spawn.faction);
+    mitigation_.push_back(100.0f / (100.0f + static_cast<float>(std::max(0, spawn.armor))));
+    for (auto &ready : cooldown_ready_) {
+        ready.push_back(0);
+    }
+    if (grid_) {
+        grid_->upsert(handle, spawn.x, spawn.y);
+    }
+    return handle;
+}
+
+bool EntityStore::despawn(EntityId id) {
+    auto *found = slotFor(id);
+    if (!found) {
+        return false;
+    }
+    auto slot_index = static_cast<std::uint32_t>((id & 0xFFFFFFFFu) - 1);
+    auto &slot = slots_[slot_index];
+    auto dense = slot.dense;
+    auto last = static_cast<std::uint32_t>(handles_.size() - 1);
+    if (dense != last) {
+        auto moved = handles_[last];
+        slots_[static_cast<std::uint32_t>((moved & 0xFFFFFFFFu) - 1)].dense = dense;
+    }
+    swapRemove(handles_, dense);
+    swapRemove(hp_, dense);
+    swapRemove(max_hp_, dense);
+    swapRemove(pos_x_, dense);
+    swapRemove(pos_y_, dense);
+    swapRemove(faction_, dense);
+    swapRemove(mitigation_, dense);
+    for (auto &ready : cooldown_ready_) {
+        swapRemove(ready, dense);
+    }
+
+    slot.live = false;
+    slot.generation += 1;
+    free_slots_.push_back(slot_index);
+    if (grid_) {
+        grid_->remove(id);
+    }
+    return true;
+}
+
+bool EntityStore::contains(EntityId id) const {
+    return slotFor(id) != nullptr;
+}
+
+std::optional<std::uint32_t> EntityStore::indexOf(EntityId id) const {
+    auto *slot = slotFor(id);
+    if (!slot) {
+        return std::nullopt;
+    }
+    return slot->dense;
+}
+
+std::size_t EntityStore::size() const {
+    return handles_.size();
+}
+
+void EntityStore::clear() {
+    while (!handles_.empty()) {
+        despawn(handles_.back());
+    }
+}
+
+bool EntityStore::setPosition(EntityId id, float x, float y) {
+    auto *slot = slotFor(id);
+    if (!slot || !std::isfinite(x) || !std::isfinite(y)) {
+        return false;
+    }
+    pos_x_[slot->dense] = x;
+    pos_y_[slot->dense] = y;
+    if (grid_) {
+        grid_->upsert(id, x, y);
+    }
+    return true;
+}
+
+void EntityStore::attachSpatialIndex(SpatialGrid *grid) {
+    grid_ = grid;
+    if (!grid_) {
+        return;
+    }
+    grid_->clear();
+    for (std::size_t i = 0; i < handles_.size(); ++i) {
+        grid_->upsert(handles_[i], pos_x_[i], pos_y_[i]);
+    }
+}
+
+const SpatialGrid *EntityStore::spatialIndex() const {
+    return grid_;
+}
+
+std::span<const EntityId> EntityStore::handles() const {
+    return handles_;
+}
+
+std::span<std::int32_t> EntityStore::hp() {
+    return hp_;
+}
+
+std::span<const std::int32_t> EntityStore::hp() const {
+    return hp_;
+}
+
+std::span<const std::int32_t> EntityStore::maxHp() const {
+    return max_hp_;
+}
+
+std::span<float> EntityStore::positionX() {
+    return pos_x_;
+}
+
+std::span<const float> EntityStore::positionX() const {
+    return pos_x_;
+}
+
+std::span<float> EntityStore::positionY() {
+    return pos_y_;
+}
+
+std::span<const float> EntityStore::positionY() const {
+    return pos_y_;
+}
+
+std::span<const Faction> EntityStore::faction() const {
+    return faction_;
+}
+
+std::span<const float> EntityStore::mitigation() const {
+    return mitigation_;
+}
+
+std::span<std::uint32_t> EntityStore::cooldownReady(std::size_t slot) {
+    return cooldown_ready_[slot];
+}
+
+std::span<const std::uint32_t> EntityStore::cooldownReady(std::size_t slot) const {
+    return cooldown_ready_[slot];
+}
+
+const EntityStore::Slot *EntityStore::slotFor(EntityId id) const {
+    auto low = id & 0xFFFFFFFFu;
+    if (low == 0 || low > slots_.size()) {
+        return nullptr;
+    }
+    const auto &slot = slots_[low - 1];
+    if (!slot.live || slot.generation != static_cast<std::uint32_t>(id >> 32)) {
+        return nullptr;
+    }
+    return &slot;
+}
+
+}  // namespace combat
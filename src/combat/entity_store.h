@@ -0,0 +1,96 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace combat {
+
+class SpatialGrid;
+
+// Generation-checked handle: slot generation in the high 32 bits, slot
+// index + 1 in the low 32 bits. Handles of despawned entities never resolve.
+using EntityId = std::uint64_t;
+
+enum class Faction : std::uint8_t {
+    Neutral = 0,
+    Player = 1,
+    Monster = 2
+};
+
+struct EntitySpawn {
+    std::int32_t hp{1};
+    float x{0.0f};
+    float y{0.0f};
+    Faction faction{Faction::Neutral};
+    // Incoming skill damage is scaled by 100 / (100 + armor).
+    std::int32_t armor{0};
+};
+
+// Per-instance combat state in structure-of-arrays layout. Component arrays
+// are dense (index 0..size()-1) so a tick's batch touches a few contiguous
+// lines; handles go through a sparse slot table and stay valid while other
+// entities are despawned (despawn moves the last entity into the hole).
+class EntityStore {
+public:
+    static constexpr std::size_t kCooldownSlots = 4;
+
+    EntityId spawn(const EntitySpawn &spawn);
+    bool despawn(EntityId id);
+    bool contains(EntityId id) const;
+    // Dense index for component arrays; invalidated by the next despawn.
+    std::optional<std::uint32_t> indexOf(EntityId id) const;
+    std::size_t size() const;
+    void clear();
+
+    // False for an unknown id or a non-finite position.
+    bool setPosition(EntityId id, float x, float y);
+
+    // Keeps `grid` in step with spawn, despawn and setPosition (writes through
+    // positionX()/positionY() bypass it). Existing entities are indexed on
+    // attach; nullptr detaches. The grid must outlive the attachment.
+    void attachSpatialIndex(SpatialGrid *grid);
+    const SpatialGrid *spatialIndex() const;
+
+    std::span<const EntityId> handles() const;
+    std::span<std::int32_t> hp();
+    std::span<const std::int32_t> hp() const;
+    std::span<const std::int32_t> maxHp() const;
+    std::span<float> positionX();
+    std::span<const float> positionX() const;
+    std::span<float> positionY();
+    std::span<const float> positionY() const;
+    std::span<const Faction> faction() const;
+    // Damage multiplier derived from armor, in (0, 1].
+    std::span<const float> mitigation() const;
+    // Tick at which the slot is ready again, one array per slot.
+    std::span<std::uint32_t> cooldownReady(std::size_t slot);
+    std::span<const std::uint32_t> cooldownReady(std::size_t slot) const;
+
+private:
+    struct Slot {
+        std::uint32_t dense{0};
+        std::uint32_t generation{1};
+        bool live{false};
+    };
+
+    const Slot *slotFor(EntityId id) const;
+
+    std::vector<Slot> slots_;
+    std::vector<std::uint32_t> free_slots_;
+
+    std::vector<EntityId> handles_;
+    std::vector<std::int32_t> hp_;
+    std::vector<std::int32_t> max_hp_;
+    std::vector<float> pos_x_;
+    std::vector<float> pos_y_;
+    std::vector<Faction> faction_;
+    std::vector<float> mitigation_;
+    std::array<std::vector<std::uint32_t>, kCooldownSlots> cooldown_ready_;
+    SpatialGrid *grid_{nullptr};
+};
+
+}  // namespace combat
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "combat/entity_store.h"
+
+#include <cstdint>
+
+namespace combat {
+
+struct SkillEvent {
+    EntityId attacker_id{0};
+    EntityId target_id{0};
+    std::uint32_t skill_id{0};
+    std::int32_t base_damage{0};
+};
+
+struct DamageEvent {
+    EntityId source_id{0};
+    EntityId target_id{0};
+    std::uint32_t skill_id{0};
+    std::int32_t amount{0};
+};
+
+}  // namespace combat
@@ -0,0 +1,208 @@
+#include "combat/spatial_grid.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace combat {
+
+SpatialGrid::SpatialGrid(float cell_size)
+    : cell_size_(cell_size > 0.0f && std::isfinite(1.0f / cell_size) ? cell_size : 8.0f),
+      inv_cell_size_(1.0f / cell_size_) {}
+
+bool SpatialGrid::upsert(EntityId id, float x, float y) {
+    if (!std::isfinite(x) || !std::isfinite(y)) {
+        return false;
+    }
+    auto key = cellKey(cellCoord(x), cellCoord(y));
+    auto found = locations_.find(id);
+    if (found != locations_.end()) {
+        if (found->second.cell == key) {
+            auto &cell = cells_[key];
+            cell.xs[found->second.slot] = x;
+            cell.ys[found->second.slot] = y;
+            return true;
+        }
+        detach(found->second);
+    }
+
+    auto &cell = cells_[key];
+    Location location{key, static_cast<std::uint32_t>(cell.ids.size())};
+    cell.ids.push_back(id);
+    cell.xs.push_back(x);
+    cell.ys.push_back(y);
+    if (found != locations_.end()) {
+        found->second = location;
+    } else {
+        locations_.emplace(id, location);
+    }
+    return true;
+}
+
+bool SpatialGrid::remove(EntityId id) {
+    auto found = locations_.find(id);
+    if (found == locations_.end()) {
+        return false;
+    }
+    detach(found->second);
+    locations_.erase(found);
+    return true;
+}
+
+void SpatialGrid::clear() {
+    cells_.clear();
+    locations_.clear();
+}
+
+bool SpatialGrid::contains(EntityId id) const {
+    return locations_.count(id) > 0;
+}
+
+std::optional<GridPosition> SpatialGrid::position(EntityId id) const {
+    auto found = locations_.find(id);
+    if (found == locations_.end()) {
+        return std::nullopt;
+    }
+    const auto &cell = cells_.at(found->second.cell);
+    return GridPosition{cell.xs[found->second.slot], cell.ys[found->second.slot]};
+}
+
+std::size_t SpatialGrid::size() const {
+    return locations_.size();
+}
+
+std::size_t SpatialGrid::cellCount() const {
+    return cells_.size();
+}
+
+float SpatialGrid::cellSize() const {
+    return cell_size_;
+}
+
+bool SpatialGrid::withinRange(EntityId from, EntityId to, float range) const {
+    auto a = position(from);
+    auto b = position(to);
+    if (!a || !b) {
+        return false;
+    }
+    auto dx = a->x - b->x;
+    auto dy = a->y - b->y;
+    return dx * dx + dy * dy <= range * range;
+}
+
+std::size_t SpatialGrid::queryRadius(float x,
+                                     float y,
+                                     float radius,
+                                     std::vector<EntityId> &out) const {
+    if (!validQuery(x, y, radius)) {
+        return 0;
+    }
+    auto before = out.size();
+    auto radius_sq = radius * radius;
+    forEachCell(x, y, radius, [&](const Cell &cell) {
+        for (std::size_t i = 0; i < cell.ids.size(); ++i) {
+            auto dx = cell.xs[i] - x;
+            auto dy = cell.ys[i] - y;
+            if (dx * dx + dy * dy <= radius_sq) {
+                out.push_back(cell.ids[i]);
+            }
+        }
+    });
+    return out.size() - before;
+}
+
+std::size_t SpatialGrid::queryCone(float x,
+                                   float y,
+                                   float facing_x,
+                                   float facing_y,
+                                   float half_angle,
+                                   float radius,
+                                   std::vector<EntityId> &out) const {
+    auto length = std::sqrt(facing_x * facing_x + facing_y * facing_y);
+    if (!validQuery(x, y, radius) || !(length > 0.0f) || !std::isfinite(length)) {
+        return 0;
+    }
+    facing_x /= length;
+    facing_y /= length;
+    auto cos_half = std::cos(std::clamp(half_angle, 0.0f, 3.14159265f));
+    auto before = out.size();
+    auto radius_sq = radius * radius;
+    forEachCell(x, y, radius, [&](const Cell &cell) {
+        for (std::size_t i = 0; i < cell.ids.size(); ++i) {
+            auto dx = cell.xs[i] - x;
+            auto dy = cell.ys[i] - y;
+            auto distance_sq = dx * dx + dy * dy;
+            if (distance_sq > radius_sq) {
+                continue;
+            }
+            // The apex itself counts as inside.
+            if (distance_sq == 0.0f ||
+                dx * facing_x + dy * facing_y >= cos_half * std::sqrt(distance_sq)) {
+                out.push_back(cell.ids[i]);
+            }
+        }
+    });
+    return out.size() - before;
+}
+
+bool SpatialGrid::validQuery(float x, float y, float radius) {
+    return std::isfinite(x) && std::isfinite(y) && std::isfinite(radius) && radius >= 0.0f;
+}
+
+std::int32_t SpatialGrid::cellCoord(float value) const {
+    // Callers pass finite values, but value * inv_cell_size_ may still be
+    // far outside int32.
+    auto scaled = std::clamp(std::floor(value * inv_cell_size_), -kCellLimit, kCellLimit);
+    return static_cast<std::int32_t>(scaled);
+}
+
+std::uint64_t SpatialGrid::cellKey(std::int32_t cx, std::int32_t cy) {
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(cx)) << 32) |
+           static_cast<std::uint32_t>(cy);
+}
+
+void SpatialGrid::detach(const Location &location) {
+    auto &cell = cells_[location.cell];
+    auto slot = location.slot;
+    auto last = cell.ids.size() - 1;
+    if (slot != last) {
+        cell.ids[slot] = cell.ids[last];
+        cell.xs[slot] = cell.xs[last];
+        cell.ys[slot] = cell.ys[last];
+        locations_[cell.ids[slot]].slot = slot;
+    }
+    cell.ids.pop_back();
+    cell.xs.pop_back();
+    cell.ys.pop_back();
+}
+
+template <typename Visit>
+void SpatialGrid::forEachCell(float x, float y, float radius, Visit &&visit) const {
+    auto min_x = cellCoord(x - radius);
+    auto max_x = cellCoord(x + radius);
+    auto min_y = cellCoord(y - radius);
+    auto max_y = cellCoord(y + radius);
+    // At most (2^31 + 1)^2, so neither the widths nor the product overflow.
+    auto span = (static_cast<std::uint64_t>(std::int64_t{max_x} - min_x) + 1) *
+                (static_cast<std::uint64_t>(std::int64_t{max_y} - min_y) + 1);
+    // A query wider than the populated area walks the cells instead.
+    if (span > cells_.size()) {
+        for (const auto &[key, cell] : cells_) {
+            auto cx = static_cast<std::int32_t>(static_cast<std::uint32_t>(key >> 32));
+            auto cy = static_cast<std::int32_t>(static_cast<std::uint32_t>(key));
+            if (cx >= min_x && cx <= max_x && cy >= min_y && cy <= max_y) {
+                visit(cell);
+            }
+        }
+        return;
+    }
+    for (auto cx = min_x; cx <= max_x; ++cx) {
+        for (auto cy = min_y; cy <= max_y; ++cy) {
+            auto found = cells_.find(cellKey(cx, cy));
+            if (found != cells_.end()) {
+                visit(found->second);
+            }
+        }
+    }
+}
+
+}  // namespace combat
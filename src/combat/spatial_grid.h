@@ -0,0 +1,83 @@
+#pragma once
+
+#include "combat/entity_store.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace combat {
+
+struct GridPosition {
+    float x{0.0f};
+    float y{0.0f};
+};
+
+// Uniform grid over the dungeon floor, hashed by cell coordinate so the map
+// needs no bounds. Each cell keeps its members' ids and positions in parallel
+// arrays; moving an entity is O(1) (a swap-remove when it changes cell), and
+// a radius query only visits the cells overlapping the circle, so its cost
+// depends on local density rather than the entity count. Cells are kept once
+// created; their number is bounded by the area the instance has used.
+// Coordinates beyond +-2^30 cells share the edge cell; NaN and infinite
+// positions are never indexed and match no query.
+class SpatialGrid {
+public:
+    explicit SpatialGrid(float cell_size = 8.0f);
+
+    // Inserts or moves. False (and nothing changes) for a non-finite position.
+    bool upsert(EntityId id, float x, float y);
+    bool remove(EntityId id);
+    void clear();
+    bool contains(EntityId id) const;
+    std::optional<GridPosition> position(EntityId id) const;
+    std::size_t size() const;
+    std::size_t cellCount() const;
+    float cellSize() const;
+
+    // False when either entity is not indexed.
+    bool withinRange(EntityId from, EntityId to, float range) const;
+    // Appends entities within `radius` of (x, y) to `out`; returns how many.
+    std::size_t queryRadius(float x, float y, float radius, std::vector<EntityId> &out) const;
+    // Like queryRadius, limited to `half_angle` radians either side of the
+    // facing vector (which need not be normalised).
+    std::size_t queryCone(float x,
+                          float y,
+                          float facing_x,
+                          float facing_y,
+                          float half_angle,
+                          float radius,
+                          std::vector<EntityId> &out) const;
+
+private:
+    struct Cell {
+        std::vector<EntityId> ids;
+        std::vector<float> xs;
+        std::vector<float> ys;
+    };
+
+    struct Location {
+        std::uint64_t cell{0};
+        std::uint32_t slot{0};
+    };
+
+    static constexpr float kCellLimit = 1073741824.0f;  // 2^30
+
+    static bool validQuery(float x, float y, float radius);
+    std::int32_t cellCoord(float value) const;
+    static std::uint64_t cellKey(std::int32_t cx, std::int32_t cy);
+    void detach(const Location &location);
+
+    // Visits every cell overlapping the square around (x, y).
+    template <typename Visit>
+    void forEachCell(float x, float y, float radius, Visit &&visit) const;
+
+    float cell_size_;
+    float inv_cell_size_;
+    std::unordered_map<std::uint64_t, Cell> cells_;
+    std::unordered_map<EntityId, Location> locations_;
+};
+
+}  // namespace combat
@@ -0,0 +1,104 @@
+#include "common/binary_file.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+#if !defined(_WIN32)
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace common {
+
+namespace {
+
+// Writes and syncs the whole file; any short write, flush or close error
+// fails it, so a partial temp file is never renamed into place.
+bool writeDurably(const std::string &path, std::span<const std::uint8_t> bytes) {
+#if defined(_WIN32)
+    std::ofstream output(path, std::ios::binary | std::ios::trunc);
+    output.write(reinterpret_cast<const char *>(bytes.data()),
+                 static_cast<std::streamsize>(bytes.size()));
+    output.close();
+    return static_cast<bool>(output);
+#else
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    std::size_t written = 0;
+    while (written < bytes.size()) {
+        auto result = ::write(fd, bytes.data() + written, bytes.size() - written);
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result <= 0) {
+            ::close(fd);
+            return false;
+        }
+        written += static_cast<std::size_t>(result);
+    }
+    bool synced = ::fsync(fd) == 0;
+    return ::close(fd) == 0 && synced;
+#endif
+}
+
+// Makes the rename itself durable; best effort.
+void syncParentDirectory(const std::string &path) {
+#if !defined(_WIN32)
+    auto parent = std::filesystem::path(path).parent_path();
+    int fd = ::open(parent.empty() ? "." : parent.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd >= 0) {
+        ::fsync(fd);
+        ::close(fd);
+    }
+#else
+    (void)path;
+#endif
+}
+
+}  // namespace
+
+void putRecordHeader(std::vector<std::uint8_t> &out, const RecordFileFormat &format) {
+    out.insert(out.end(), format.magic.begin(), format.magic.end());
+    putLittle(out, format.version);
+    putLittle(out, format.record_size);
+}
+
+bool hasRecordHeader(std::span<const std::uint8_t> bytes, const RecordFileFormat &format) {
+    return bytes.size() >= RecordFileFormat::kHeaderSize &&
+           std::equal(format.magic.begin(), format.magic.end(), bytes.begin()) &&
+           getLittle<std::uint16_t>(bytes.data() + 4) == format.version &&
+           getLittle<std::uint16_t>(bytes.data() + 6) == format.record_size;
+}
+
+std::optional<std::vector<std::uint8_t>> readFileBytes(const std::string &path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return std::nullopt;
+    }
+    return std::vector<std::uint8_t>((std::istreambuf_iterator<char>(file)),
+                                     std::istreambuf_iterator<char>());
+}
+
+bool replaceFile(const std::string &path, std::span<const std::uint8_t> bytes) {
+    auto temp = path + ".tmp";
+    if (!writeDurably(temp, bytes)) {
+        std::error_code ignored;
+        std::filesystem::remove(temp, ignored);
+        return false;
+    }
+    std::error_code error;
+    std::filesystem::rename(temp, path, error);
+    if (error) {
+        std::filesystem::remove(temp, error);
+        return false;
+    }
+    syncParentDirectory(path);
+    return true;
+}
+
+}  // namespace common
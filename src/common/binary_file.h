@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace common {
+
+// Fixed-width integers in little-endian order, whatever the host order.
+template <typename T>
+void putLittle(std::vector<std::uint8_t> &out, T value) {
+    auto bits = static_cast<std::make_unsigned_t<T>>(value);
+    for (std::size_t i = 0; i < sizeof(T); ++i) {
+        out.push_back(static_cast<std::uint8_t>(bits >> (8 * i)));
+    }
+}
+
+template <typename T>
+T getLittle(const std::uint8_t *in) {
+    std::make_unsigned_t<T> bits = 0;
+    for (std::size_t i = sizeof(T); i-- > 0;) {
+        bits = static_cast<std::make_unsigned_t<T>>((bits << 8) | in[i]);
+    }
+    return static_cast<T>(bits);
+}
+
+// Files of fixed-size records start with an 8-byte header: a 4-byte magic,
+// then uint16 version and uint16 record size.
+struct RecordFileFormat {
+    static constexpr std::size_t kHeaderSize = 8;
+
+    std::array<char, 4> magic;
+    std::uint16_t version;
+    std::uint16_t record_size;
+};
+
+void putRecordHeader(std::vector<std::uint8_t> &out, const RecordFileFormat &format);
+bool hasRecordHeader(std::span<const std::uint8_t> bytes, const RecordFileFormat &format);
+
+// Whole file contents; nullopt if it cannot be opened.
+std::optional<std::vector<std::uint8_t>> readFileBytes(const std::string &path);
+
+// Writes `bytes` to a sibling temp file, syncs it and renames it over
+// `path`, so readers (and a restart after a crash) see either the old or
+// the new contents, never a partial file. The temp file is removed on error.
+bool replaceFile(const std::string &path, std::span<const std::uint8_t> bytes);
+
+}  // namespace common
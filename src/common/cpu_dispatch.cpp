@@ -0,0 +1,48 @@
+#include "common/cpu_dispatch.h"
+
+#if defined(DUNGEONHUB_HAVE_SHA_NI)
+#include <cpuid.h>
+#endif
+
+namespace common {
+
+namespace {
+
+bool detectAvx2() {
+#if defined(DUNGEONHUB_HAVE_AVX2)
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+#else
+    return false;
+#endif
+}
+
+bool detectShaNi() {
+#if defined(DUNGEONHUB_HAVE_SHA_NI)
+    unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return false;
+    }
+    bool ssse3 = (ecx & bit_SSSE3) != 0;
+    bool sse41 = (ecx & bit_SSE4_1) != 0;
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        return false;
+    }
+    return ssse3 && sse41 && (ebx & (1u << 29)) != 0;
+#else
+    return false;
+#endif
+}
+
+}  // namespace
+
+bool cpuHasAvx2() {
+    static const bool supported = detectAvx2();
+    return supported;
+}
+
+bool cpuHasShaNi() {
+    static const bool supported = detectShaNi();
+    return supported;
+}
+
+}  // namespace common
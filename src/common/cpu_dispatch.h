@@ -0,0 +1,75 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define DUNGEONHUB_HAVE_AVX2 1
+#define DUNGEONHUB_HAVE_SHA_NI 1
+#endif
+
+namespace common {
+
+// Probed once per process; false on other architectures.
+bool cpuHasAvx2();
+bool cpuHasShaNi();
+
+// Runtime choice between implementations of one kernel. `Kernel` is an enum
+// numbered 0..N-1 with the portable fallback first; `Table` holds the
+// function pointers of one implementation. The last supported kernel is
+// active from the start. Tests and benchmarks may pin another with set(),
+// which fails if the CPU lacks it; switching is safe while other threads
+// call through table().
+template <typename Kernel, typename Table, std::size_t N>
+class KernelDispatch {
+public:
+    struct Option {
+        Table table;
+        bool supported;
+        const char *name;
+    };
+
+    explicit KernelDispatch(std::array<Option, N> options) : options_(options) {
+        options_[0].supported = true;
+        std::size_t best = 0;
+        for (std::size_t i = 0; i < N; ++i) {
+            best = options_[i].supported ? i : best;
+        }
+        active_.store(static_cast<Kernel>(best), std::memory_order_relaxed);
+    }
+
+    const Table &table() const {
+        return options_[index(active_.load(std::memory_order_relaxed))].table;
+    }
+
+    Kernel active() const {
+        return active_.load(std::memory_order_relaxed);
+    }
+
+    bool supported(Kernel kernel) const {
+        return index(kernel) < N && options_[index(kernel)].supported;
+    }
+
+    bool set(Kernel kernel) {
+        if (!supported(kernel)) {
+            return false;
+        }
+        active_.store(kernel, std::memory_order_relaxed);
+        return true;
+    }
+
+    const char *name(Kernel kernel) const {
+        return index(kernel) < N ? options_[index(kernel)].name : "unknown";
+    }
+
+private:
+    static std::size_t index(Kernel kernel) {
+        return static_cast<std::size_t>(kernel);
+    }
+
+    std::array<Option, N> options_;
+    std::atomic<Kernel> active_;
+};
+
+}  // namespace common
@@ -1,8 +1,11 @@
 #pragma once
 
 #include <chrono>
+#include <cstddef>
 #include <cstdint>
+#include <span>
 #include <string>
+#include <vector>
 
 namespace dungeon {
 
@@ -12,11 +15,54 @@ struct MovementSample {
     std::chrono::milliseconds elapsed{0};
 };
 
+enum class MovementRejection : std::uint8_t {
+    None = 0,
+    InvalidElapsed = 1,
+    SpeedExceeded = 2
+};
+
+// Static text for logs; never allocates.
+const char *movementRejectionReason(MovementRejection rejection);
+
+enum class MovementKernel {
+    Portable,
+    Avx2
+};
+
+// Speed kernel selection (common::KernelDispatch).
+MovementKernel activeMovementKernel();
+bool movementKernelSupported(MovementKernel kernel);
+bool setMovementKernel(MovementKernel kernel);
+const char *movementKernelName(MovementKernel kernel);
+
+// Output of MovementValidator::validateBatch; reuse one across ticks so its
+// buffers stop growing.
+struct MovementBatchResult {
+    // Bit i of word i / 64 is set when sample i was rejected.
+    std::vector<std::uint64_t> rejected_mask;
+    // One code per sample, None for accepted ones.
+    std::vector<MovementRejection> reasons;
+    std::size_t rejected{0};
+
+    bool isRejected(std::size_t index) const;
+};
+
 class MovementValidator {
 public:
     explicit MovementValidator(float max_speed);
 
     bool validate(const MovementSample &sample, std::string &reason) const;
+    MovementRejection check(const MovementSample &sample) const;
+
+    // Validates a tick's movement updates in one pass with the movement
+    // kernel; sample i is (character_ids[i], distances[i], elapsed_ms[i]).
+    // Same verdicts as check(). Returns false without touching `result` if the
+    // spans differ in length. Character ids are only carried for the caller's
+    // logging; look them up by the rejected indices.
+    bool validateBatch(std::span<const std::uint64_t> character_ids,
+                       std::span<const float> distances,
+                       std::span<const std::int32_t> elapsed_ms,
+                       MovementBatchResult &result) const;
 
 private:
     float max_speed_;
@@ -1,9 +1,27 @@
 #include "dungeon/instance_manager.h"
 
 #include <algorithm>
+#include <cstdint>
+#include <utility>
 
 namespace dungeon {
 
+namespace {
+
+std::uint32_t slotIndex(InstanceId instance_id) {
+    return static_cast<std::uint32_t>(instance_id & 0xFFFFFFFFu) - 1;
+}
+
+std::uint32_t slotGeneration(InstanceId instance_id) {
+    return static_cast<std::uint32_t>(instance_id >> 32);
+}
+
+InstanceId makeInstanceId(std::uint32_t index, std::uint32_t generation) {
+    return (static_cast<InstanceId>(generation) << 32) | (static_cast<InstanceId>(index) + 1);
+}
+
+}  // namespace
+
 InstanceManager::InstanceManager() = default;
 
 std::optional<InstanceId> InstanceManager::createInstance(
@@ -13,60 +31,149 @@ std::optional<InstanceId> InstanceManager::createInstance(
         return std::nullopt;
     }
 
-    InstanceRecord record;
-    record.id = next_instance_id_++;
+    std::uint32_t index = 0;
+    if (!free_slots_.empty()) {
+        index = free_slots_.back();
+        free_slots_.pop_back();
+    } else {
+        if (slot_count_ == slabs_.size() * kSlotsPerSlab) {
+            slabs_.push_back(std::make_unique<Slot[]>(kSlotsPerSlab));
+        }
+        index = static_cast<std::uint32_t>(slot_count_++);
+    }
+
+    // Reused slots keep their string and vector capacity.
+    Slot &slot = slabs_[index / kSlotsPerSlab][index % kSlotsPerSlab];
+    slot.live = true;
+    InstanceRecord &record = slot.record;
+    record.id = makeInstanceId(index, slot.generation);
     record.party_id = party_id;
     record.state = InstanceState::Waiting;
-    instances_.emplace(record.id, record);
+    record.seed = 0;
+    record.ticket.clear();
+    record.reward_grant.reset();
+    record.member_sessions.clear();
+    ++live_count_;
     return record.id;
 }
 
 bool InstanceManager::terminateInstance(InstanceId instance_id) {
-    auto it = instances_.find(instance_id);
-    if (it == instances_.end()) {
+    return terminateInstance(instance_id, std::chrono::steady_clock::now());
+}
+
+bool InstanceManager::terminateInstance(InstanceId instance_id,
+                                        std::chrono::steady_clock::time_point now) {
+    Slot *slot = slotFor(instance_id);
+    if (!slot) {
         return false;
     }
-    it->second.state = InstanceState::Terminate;
+    if (slot->record.state != InstanceState::Terminate) {
+        slot->record.state = InstanceState::Terminate;
+        pending_reclaim_.push_back({instance_id, now + reclaim_grace_});
+        std::push_heap(pending_reclaim_.begin(), pending_reclaim_.end());
+    }
     return true;
 }
 
 bool InstanceManager::requestTransition(InstanceId instance_id,
                                         InstanceState next_state,
                                         const party::PartyService &party_service) {
-    auto it = instances_.find(instance_id);
-    if (it == instances_.end()) {
+    InstanceRecord *record = find(instance_id);
+    if (!record) {
         return false;
     }
 
-    if (it->second.state == next_state) {
+    if (record->state == next_state) {
         return false;
     }
 
-    if (!transitionAllowed(it->second.state, next_state)) {
+    if (!transitionAllowed(record->state, next_state)) {
         return false;
     }
 
     if (next_state == InstanceState::Ready || next_state == InstanceState::Playing) {
-        if (!isPartyReady(it->second.party_id, party_service)) {
+        if (!isPartyReady(record->party_id, party_service)) {
             return false;
         }
     }
 
-    it->second.state = next_state;
+    if (next_state == InstanceState::Terminate) {
+        return terminateInstance(instance_id);
+    }
+    record->state = next_state;
     return true;
 }
 
 std::optional<InstanceRecord> InstanceManager::getInstance(
     InstanceId instance_id) const {
-    auto it = instances_.find(instance_id);
-    if (it == instances_.end()) {
+    const InstanceRecord *record = find(instance_id);
+    if (!record) {
         return std::nullopt;
     }
-    return it->second;
+    return *record;
+}
+
+InstanceRecord *InstanceManager::find(InstanceId instance_id) {
+    Slot *slot = slotFor(instance_id);
+    return slot ? &slot->record : nullptr;
+}
+
+const InstanceRecord *InstanceManager::find(InstanceId instance_id) const {
+    const Slot *slot = slotFor(instance_id);
+    return slot ? &slot->record : nullptr;
+}
+
+void InstanceManager::setReclaimGrace(std::chrono::milliseconds grace) {
+    reclaim_grace_ = grace;
+}
+
+std::size_t InstanceManager::reclaim(
+    std::chrono::steady_clock::time_point now,
+    const std::function<void(const InstanceRecord &)> &on_reclaim) {
+    std::size_t reclaimed = 0;
+    while (!pending_reclaim_.empty() && pending_reclaim_.front().due <= now) {
+        InstanceId instance_id = pending_reclaim_.front().id;
+        std::pop_heap(pending_reclaim_.begin(), pending_reclaim_.end());
+        pending_reclaim_.pop_back();
+        Slot *slot = slotFor(instance_id);
+        if (!slot) {
+            continue;
+        }
+        if (on_reclaim) {
+            on_reclaim(slot->record);
+        }
+        slot->live = false;
+        // Skip generation 0 on wrap so a handle is never all-zero in the top half.
+        slot->generation = slot->generation == UINT32_MAX ? 1 : slot->generation + 1;
+        free_slots_.push_back(slotIndex(instance_id));
+        --live_count_;
+        ++reclaimed;
+    }
+    return reclaimed;
 }
 
 std::size_t InstanceManager::size() const {
-    return instances_.size();
+    return live_count_;
+}
+
+std::size_t InstanceManager::capacity() const {
+    return slabs_.size() * kSlotsPerSlab;
+}
+
+InstanceManager::Slot *InstanceManager::slotFor(InstanceId instance_id) {
+    return const_cast<Slot *>(std::as_const(*this).slotFor(instance_id));
+}
+
+const InstanceManager::Slot *InstanceManager::slotFor(InstanceId instance_id) const {
+    std::uint32_t index = slotIndex(instance_id);
+    if (index >= slot_count_) {
+        return nullptr;
+    }
+    const Slot &slot = slabs_[index / kSlotsPerSlab][index % kSlotsPerSlab];
+    if (!slot.live || slot.generation != slotGeneration(instance_id)) {
+        return nullptr;
+    }
+    return &slot;
 }
 
 bool InstanceManager::isPartyReady(party::PartyId party_id,
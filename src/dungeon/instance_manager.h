@@ -1,14 +1,20 @@
 #pragma once
 
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
+#include <functional>
+#include <memory>
 #include <optional>
-#include <unordered_map>
+#include <string>
+#include <vector>
 
 #include "party/party.h"
 
 namespace dungeon {
 
+// Generation-checked handle: slot generation in the high 32 bits, slot
+// index + 1 in the low 32 bits. Ids of reclaimed instances never resolve.
 using InstanceId = std::uint64_t;
 
 enum class InstanceState : std::uint8_t {
@@ -20,33 +26,82 @@ enum class InstanceState : std::uint8_t {
     Terminate = 5
 };
 
+// Everything the server keeps per dungeon run.
 struct InstanceRecord {
     InstanceId id{0};
     party::PartyId party_id{0};
     InstanceState state{InstanceState::Waiting};
+    std::uint32_t seed{0};
+    std::string ticket;
+    std::optional<std::uint64_t> reward_grant;
+    std::vector<std::uint64_t> member_sessions;
 };
 
+// Records live in fixed slabs of slots that are reused after reclamation, so
+// memory is bounded by the peak number of concurrent runs. A terminated
+// instance stays readable for a grace period (late enter/result packets still
+// resolve) and is reclaimed by reclaim().
 class InstanceManager {
 public:
+    static constexpr std::size_t kSlotsPerSlab = 256;
+
     InstanceManager();
 
     std::optional<InstanceId> createInstance(party::PartyId party_id,
                                              const party::PartyService &party_service);
     bool terminateInstance(InstanceId instance_id);
+    bool terminateInstance(InstanceId instance_id, std::chrono::steady_clock::time_point now);
     bool requestTransition(InstanceId instance_id,
                            InstanceState next_state,
                            const party::PartyService &party_service);
 
     std::optional<InstanceRecord> getInstance(InstanceId instance_id) const;
+    // Null for unknown or reclaimed ids. Valid until the instance is reclaimed.
+    InstanceRecord *find(InstanceId instance_id);
+    const InstanceRecord *find(InstanceId instance_id) const;
+
+    void setReclaimGrace(std::chrono::milliseconds grace);
+    // Frees instances terminated at least one grace period before `now`,
+    // passing each to `on_reclaim` first. Returns how many were freed.
+    std::size_t reclaim(std::chrono::steady_clock::time_point now,
+                        const std::function<void(const InstanceRecord &)> &on_reclaim = {});
+
+    // Instances not yet reclaimed, terminated ones included.
     std::size_t size() const;
+    // Slots allocated across all slabs.
+    std::size_t capacity() const;
 
 private:
+    struct Slot {
+        InstanceRecord record;
+        std::uint32_t generation{1};
+        bool live{false};
+    };
+
+    struct PendingReclaim {
+        InstanceId id;
+        std::chrono::steady_clock::time_point due;
+
+        // Inverted so the std heap algorithms keep the earliest due on top.
+        bool operator<(const PendingReclaim &other) const {
+            return due > other.due;
+        }
+    };
+
+    Slot *slotFor(InstanceId instance_id);
+    const Slot *slotFor(InstanceId instance_id) const;
     bool isPartyReady(party::PartyId party_id,
                       const party::PartyService &party_service) const;
     bool transitionAllowed(InstanceState from, InstanceState to) const;
 
-    InstanceId next_instance_id_{1};
-    std::unordered_map<InstanceId, InstanceRecord> instances_;
+    std::vector<std::unique_ptr<Slot[]>> slabs_;
+    std::vector<std::uint32_t> free_slots_;
+    std::size_t slot_count_{0};
+    std::size_t live_count_{0};
+    // Min-heap on due time: terminate order is not due order once the grace
+    // changes or callers pass different clocks.
+    std::vector<PendingReclaim> pending_reclaim_;
+    std::chrono::milliseconds reclaim_grace_{std::chrono::seconds{30}};
 };
 
 }  // namespace dungeon
@@ -0,0 +1,404 @@
+#include "dungeon/tick_scheduler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <thread>
+#include <utility>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace dungeon {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+bool pinCurrentThread(std::size_t cpu) {
+#if defined(__linux__)
+    auto cpus = std::max(1u, std::thread::hardware_concurrency());
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(static_cast<int>(cpu % cpus), &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+}  // namespace
+
+void TickHistogram::record(std::chrono::nanoseconds duration) {
+    auto nanoseconds = static_cast<std::uint64_t>(std::max<std::int64_t>(0, duration.count()));
+    counts_[bucketFor(nanoseconds)] += 1;
+    count_ += 1;
+}
+
+std::chrono::nanoseconds TickHistogram::percentile(double fraction) const {
+    if (count_ == 0) {
+        return std::chrono::nanoseconds{0};
+    }
+    auto rank = static_cast<std::uint64_t>(std::ceil(fraction * static_cast<double>(count_)));
+    rank = std::clamp<std::uint64_t>(rank, 1, count_);
+    std::uint64_t seen = 0;
+    for (std::size_t bucket = 0; bucket < kBuckets; ++bucket) {
+        seen += counts_[bucket];
+        if (seen >= rank) {
+            return std::chrono::nanoseconds{static_cast<std::int64_t>(upperBound(bucket))};
+        }
+    }
+    return std::chrono::nanoseconds{static_cast<std::int64_t>(upperBound(kBuckets - 1))};
+}
+
+std::uint64_t TickHistogram::count() const {
+    return count_;
+}
+
+std::size_t TickHistogram::bucketFor(std::uint64_t nanoseconds) {
+    constexpr std::uint64_t kSubBuckets = std::uint64_t{1} << kSubBits;
+    if (nanoseconds < kSubBuckets) {
+        return static_cast<std::size_t>(nanoseconds);
+    }
+    nanoseconds = std::min(nanoseconds, (std::uint64_t{1} << kMaxBits) - 1);
+    auto exponent = static_cast<std::uint32_t>(std::bit_width(nanoseconds)) - 1;
+    auto sub = (nanoseconds >> (exponent - kSubBits)) & (kSubBuckets - 1);
+    return (static_cast<std::size_t>(exponent - kSubBits + 1) << kSubBits) |
+           static_cast<std::size_t>(sub);
+}
+
+std::uint64_t TickHistogram::upperBound(std::size_t bucket) {
+    constexpr std::size_t kSubBuckets = std::size_t{1} << kSubBits;
+    if (bucket < kSubBuckets) {
+        return bucket;
+    }
+    auto exponent = static_cast<std::uint32_t>(bucket >> kSubBits) + kSubBits - 1;
+    auto shift = exponent - kSubBits;
+    auto lower = (kSubBuckets | (bucket & (kSubBuckets - 1))) << shift;
+    return lower + (std::uint64_t{1} << shift) - 1;
+}
+
+struct TickScheduler::Worker {
+    struct Entry {
+        InstanceId id{0};
+        TickFn tick;
+        std::uint64_t next_tick{0};
+    };
+
+    struct EntryStats {
+        TickHistogram histogram;
+        std::uint64_t overruns{0};
+        std::chrono::nanoseconds max{0};
+    };
+
+    // Queued add (tick set) or remove (tick empty), applied in order.
+    struct PendingOp {
+        enum class Kind { Add, Remove };
+
+        Kind kind{Kind::Add};
+        InstanceId id{0};
+        TickFn tick;
+        RemovedFn on_removed;
+    };
+
+    std::size_t index{0};
+
+    // Held for the whole tick; guards everything below it.
+    mutable std::mutex mutex;
+    std::vector<Entry> entries;
+    // Parallel to `entries`, kept apart so the tick loop stays compact.
+    std::vector<EntryStats> stats;
+    TickWorkerStats totals;
+
+    std::mutex pending_mutex;
+    std::vector<PendingOp> pending;
+    std::atomic<bool> has_pending{false};
+
+    std::thread thread;
+};
+
+TickScheduler::TickScheduler(TickSchedulerConfig config) : config_(config) {
+    config_.worker_count = std::max<std::size_t>(1, config_.worker_count);
+    if (config_.period.count() <= 0) {
+        config_.period = std::chrono::milliseconds{50};
+    }
+    workers_.reserve(config_.worker_count);
+    for (std::size_t i = 0; i < config_.worker_count; ++i) {
+        workers_.push_back(std::make_unique<Worker>());
+        workers_.back()->index = i;
+    }
+    loads_.assign(config_.worker_count, 0);
+}
+
+TickScheduler::~TickScheduler() {
+    stop();
+}
+
+bool TickScheduler::add(InstanceId instance_id, TickFn tick) {
+    if (!tick) {
+        return false;
+    }
+    std::size_t worker = 0;
+    {
+        std::lock_guard<std::mutex> lock(assign_mutex_);
+        if (assignments_.count(instance_id) > 0 || removing_.count(instance_id) > 0) {
+            return false;
+        }
+        worker = static_cast<std::size_t>(
+            std::min_element(loads_.begin(), loads_.end()) - loads_.begin());
+        assignments_.emplace(instance_id, worker);
+        loads_[worker] += 1;
+    }
+    auto &target = *workers_[worker];
+    std::lock_guard<std::mutex> lock(target.pending_mutex);
+    target.pending.push_back(Worker::PendingOp{
+        Worker::PendingOp::Kind::Add, instance_id, std::move(tick), RemovedFn()});
+    target.has_pending.store(true, std::memory_order_release);
+    return true;
+}
+
+bool TickScheduler::remove(InstanceId instance_id, RemovedFn on_removed) {
+    std::size_t worker = 0;
+    {
+        std::lock_guard<std::mutex> lock(assign_mutex_);
+        auto it = assignments_.find(instance_id);
+        if (it == assignments_.end()) {
+            return false;
+        }
+        worker = it->second;
+        assignments_.erase(it);
+        removing_.insert(instance_id);
+        loads_[worker] -= 1;
+    }
+    auto &target = *workers_[worker];
+    std::lock_guard<std::mutex> lock(target.pending_mutex);
+    target.pending.push_back(Worker::PendingOp{
+        Worker::PendingOp::Kind::Remove, instance_id, TickFn{}, std::move(on_removed)});
+    target.has_pending.store(true, std::memory_order_release);
+    return true;
+}
+
+std::optional<std::size_t> TickScheduler::workerOf(InstanceId instance_id) const {
+    std::lock_guard<std::mutex> lock(assign_mutex_);
+    auto it = assignments_.find(instance_id);
+    if (it == assignments_.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+std::size_t TickScheduler::size() const {
+    std::lock_guard<std::mutex> lock(assign_mutex_);
+    return assignments_.size();
+}
+
+void TickScheduler::setOverrunHandler(OverrunHandler handler) {
+    overrun_handler_ = std::move(handler);
+}
+
+void TickScheduler::start() {
+    if (running_) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(stop_mutex_);
+        stopping_ = false;
+    }
+    running_ = true;
+    for (auto &worker : workers_) {
+        worker->thread = std::thread(&TickScheduler::workerLoop, this, std::ref(*worker));
+    }
+}
+
+void TickScheduler::stop() {
+    if (!running_) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(stop_mutex_);
+        stopping_ = true;
+    }
+    stop_cv_.notify_all();
+    for (auto &worker : workers_) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+        // Removals queued since the last tick still complete.
+        applyPending(*worker);
+    }
+    running_ = false;
+}
+
+void TickScheduler::runOnce() {
+    if (running_) {
+        return;
+    }
+    for (auto &worker : workers_) {
+        runTick(*worker);
+    }
+}
+
+std::optional<TickStats> TickScheduler::stats(InstanceId instance_id) const {
+    auto worker = workerOf(instance_id);
+    if (!worker) {
+        return std::nullopt;
+    }
+    const auto &owner = *workers_[*worker];
+    std::lock_guard<std::mutex> lock(owner.mutex);
+    TickStats out;
+    for (std::size_t i = 0; i < owner.entries.size(); ++i) {
+        if (owner.entries[i].id != instance_id) {
+            continue;
+        }
+        const auto &entry = owner.stats[i];
+        out.ticks = entry.histogram.count();
+        out.overruns = entry.overruns;
+        out.p50 = entry.histogram.percentile(0.50);
+        out.p95 = entry.histogram.percentile(0.95);
+        out.p99 = entry.histogram.percentile(0.99);
+        out.max = entry.max;
+        break;
+    }
+    // Still queued: known, but not ticked yet.
+    return out;
+}
+
+TickWorkerStats TickScheduler::workerStats(std::size_t worker) const {
+    if (worker >= workers_.size()) {
+        return TickWorkerStats{};
+    }
+    const auto &owner = *workers_[worker];
+    std::lock_guard<std::mutex> lock(owner.mutex);
+    auto out = owner.totals;
+    out.instances = owner.entries.size();
+    return out;
+}
+
+const TickSchedulerConfig &TickScheduler::config() const {
+    return config_;
+}
+
+void TickScheduler::workerLoop(Worker &worker) {
+    if (config_.pin_workers) {
+        bool pinned = pinCurrentThread(config_.first_cpu + worker.index);
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.totals.pinned = pinned;
+    }
+
+    const auto max_behind = config_.period * std::max<std::uint32_t>(1, config_.max_catch_up_ticks);
+    auto next = Clock::now();
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(stop_mutex_);
+            if (stop_cv_.wait_until(lock, next, [this] { return stopping_; })) {
+                return;
+            }
+        }
+        runTick(worker);
+        next += config_.period;
+
+        auto behind = Clock::now() - next;
+        if (behind > max_behind) {
+            auto missed = static_cast<std::uint64_t>(behind / config_.period);
+            next += config_.period * missed;
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            worker.totals.skipped_ticks += missed;
+        }
+    }
+}
+
+void TickScheduler::runTick(Worker &worker) {
+    if (worker.has_pending.load(std::memory_order_acquire)) {
+        applyPending(worker);
+    }
+
+    std::vector<std::pair<InstanceId, std::chrono::nanoseconds>> overruns;
+    std::unique_lock<std::mutex> lock(worker.mutex);
+    const auto started = Clock::now();
+    auto previous = started;
+    for (std::size_t i = 0; i < worker.entries.size(); ++i) {
+        auto &entry = worker.entries[i];
+        entry.tick(entry.id, entry.next_tick++, config_.period);
+        auto finished = Clock::now();
+        auto took = std::chrono::duration_cast<std::chrono::nanoseconds>(finished - previous);
+        previous = finished;
+
+        auto &stats = worker.stats[i];
+        stats.histogram.record(took);
+        stats.max = std::max(stats.max, took);
+        if (took > config_.instance_budget) {
+            stats.overruns += 1;
+            if (overrun_handler_) {
+                overruns.emplace_back(entry.id, took);
+            }
+        }
+    }
+
+    auto took = std::chrono::duration_cast<std::chrono::nanoseconds>(previous - started);
+    worker.totals.ticks += 1;
+    worker.totals.max_tick = std::max(worker.totals.max_tick, took);
+    if (took > config_.period) {
+        worker.totals.overruns += 1;
+    }
+    lock.unlock();
+
+    for (const auto &[instance_id, instance_took] : overruns) {
+        overrun_handler_(instance_id, instance_took);
+    }
+}
+
+void TickScheduler::applyPending(Worker &worker) {
+    std::vector<Worker::PendingOp> pending;
+    {
+        std::lock_guard<std::mutex> lock(worker.pending_mutex);
+        pending.swap(worker.pending);
+        worker.has_pending.store(false, std::memory_order_relaxed);
+    }
+
+    bool removed = false;
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        for (auto &op : pending) {
+            if (op.kind == Worker::PendingOp::Kind::Add) {
+                worker.entries.push_back(Worker::Entry{op.id, std::move(op.tick), 0});
+                worker.stats.emplace_back();
+                continue;
+            }
+            removed = true;
+            for (std::size_t i = 0; i < worker.entries.size(); ++i) {
+                if (worker.entries[i].id != op.id) {
+                    continue;
+                }
+                // Order within a worker is not significant; swap with the last.
+                worker.entries[i] = std::move(worker.entries.back());
+                worker.entries.pop_back();
+                worker.stats[i] = worker.stats.back();
+                worker.stats.pop_back();
+                break;
+            }
+        }
+    }
+    if (!removed) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(assign_mutex_);
+        for (const auto &op : pending) {
+            if (op.kind == Worker::PendingOp::Kind::Remove) {
+                removing_.erase(op.id);
+            }
+        }
+    }
+    for (auto &op : pending) {
+        if (op.kind == Worker::PendingOp::Kind::Remove && op.on_removed) {
+            op.on_removed(op.id);
+        }
+    }
+}
+
+}  // namespace dungeon
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "dungeon/instance_manager.h"
+
+namespace dungeon {
+
+// Log-linear histogram of durations: 8 buckets per power of two nanoseconds,
+// so percentiles are bucket upper bounds within 12.5% of the true value.
+class TickHistogram {
+public:
+    void record(std::chrono::nanoseconds duration);
+    // `fraction` in (0, 1]; zero when nothing was recorded.
+    std::chrono::nanoseconds percentile(double fraction) const;
+    std::uint64_t count() const;
+
+private:
+    static constexpr std::uint32_t kSubBits = 3;
+    static constexpr std::uint32_t kMaxBits = 36;
+    static constexpr std::size_t kBuckets = (kMaxBits - kSubBits + 1) << kSubBits;
+
+    static std::size_t bucketFor(std::uint64_t nanoseconds);
+    static std::uint64_t upperBound(std::size_t bucket);
+
+    std::array<std::uint32_t, kBuckets> counts_{};
+    std::uint64_t count_{0};
+};
+
+struct TickSchedulerConfig {
+    // Fixed timestep; 20 Hz by default.
+    std::chrono::nanoseconds period{std::chrono::milliseconds{50}};
+    std::size_t worker_count{1};
+    // A single instance tick longer than this counts as an overrun.
+    std::chrono::nanoseconds instance_budget{std::chrono::milliseconds{5}};
+    // A worker more than this many periods behind drops the missed ticks
+    // instead of running them back to back.
+    std::uint32_t max_catch_up_ticks{2};
+    // Pins worker i to CPU (first_cpu + i) modulo the CPU count (Linux only).
+    bool pin_workers{false};
+    std::size_t first_cpu{0};
+};
+
+struct TickStats {
+    std::uint64_t ticks{0};
+    std::uint64_t overruns{0};
+    std::chrono::nanoseconds p50{0};
+    std::chrono::nanoseconds p95{0};
+    std::chrono::nanoseconds p99{0};
+    std::chrono::nanoseconds max{0};
+};
+
+struct TickWorkerStats {
+    std::size_t instances{0};
+    std::uint64_t ticks{0};
+    // Worker ticks (all instances together) that took longer than a period.
+    std::uint64_t overruns{0};
+    // Ticks dropped after falling more than max_catch_up_ticks behind.
+    std::uint64_t skipped_ticks{0};
+    std::chrono::nanoseconds max_tick{0};
+    bool pinned{false};
+};
+
+// Runs every registered instance at a fixed rate on a small set of worker
+// threads. An instance is bound to the least loaded worker when added and
+// always ticks there, so its simulation state is only touched by one thread.
+// Adds and removes are queued and take effect at the worker's next tick.
+// A removed id cannot be added again until its removal has been applied.
+class TickScheduler {
+public:
+    // `tick` counts from zero for each instance; `dt` is always the period.
+    using TickFn =
+        std::function<void(InstanceId instance_id, std::uint64_t tick, std::chrono::nanoseconds dt)>;
+    using OverrunHandler =
+        std::function<void(InstanceId instance_id, std::chrono::nanoseconds took)>;
+    using RemovedFn = std::function<void(InstanceId instance_id)>;
+
+    explicit TickScheduler(TickSchedulerConfig config = TickSchedulerConfig());
+    ~TickScheduler();
+
+    TickScheduler(const TickScheduler &) = delete;
+    TickScheduler &operator=(const TickScheduler &) = delete;
+
+    bool add(InstanceId instance_id, TickFn tick);
+    // The instance keeps ticking until its worker applies the removal.
+    // `on_removed` then runs on that thread (or in runOnce/stop), after the
+    // last tick and after its TickFn is destroyed, so state the TickFn
+    // captured may be freed from there.
+    bool remove(InstanceId instance_id, RemovedFn on_removed = RemovedFn());
+    std::optional<std::size_t> workerOf(InstanceId instance_id) const;
+    std::size_t size() const;
+
+    // Called on the worker thread once the worker's tick is over, with its
+    // lock released, so the handler may call stats(). Set it before start().
+    void setOverrunHandler(OverrunHandler handler);
+
+    void start();
+    void stop();
+    // Runs one tick of every worker on the calling thread. For tests and
+    // single-threaded hosts; does nothing while started.
+    void runOnce();
+
+    // Tick callbacks must not call these; the worker holds its stats lock
+    // for the whole tick.
+    std::optional<TickStats> stats(InstanceId instance_id) const;
+    TickWorkerStats workerStats(std::size_t worker) const;
+    const TickSchedulerConfig &config() const;
+
+private:
+    struct Worker;
+
+    void workerLoop(Worker &worker);
+    void runTick(Worker &worker);
+    void applyPending(Worker &worker);
+
+    TickSchedulerConfig config_;
+    OverrunHandler overrun_handler_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+
+    mutable std::mutex assign_mutex_;
+    std::unordered_map<InstanceId, std::size_t> assignments_;
+    // Removed, but a worker may still tick them.
+    std::unordered_set<InstanceId> removing_;
+    std::vector<std::size_t> loads_;
+
+    std::mutex stop_mutex_;
+    std::condition_variable stop_cv_;
+    bool stopping_{false};
+    bool running_{false};
+};
+
+}  // namespace dungeon
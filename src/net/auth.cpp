@@ -15,7 +15,7 @@ std::string TokenService::issueToken(const std::string &user_id,
     return token;
 }
 
-bool TokenService::validateToken(const std::string &token,
+bool TokenService::validateToken(std::string_view token,
                                  std::chrono::steady_clock::time_point now,
                                  std::string &user_id) {
     auto it = tokens_.find(token);
@@ -1,9 +1,13 @@
 #pragma once
 
+#include "net/string_hash.h"
+
 #include <chrono>
 #include <cstdint>
+#include <functional>
 #include <random>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 
 namespace net {
@@ -14,7 +18,7 @@ public:
 
     std::string issueToken(const std::string &user_id,
                            std::chrono::steady_clock::time_point now);
-    bool validateToken(const std::string &token,
+    bool validateToken(std::string_view token,
                        std::chrono::steady_clock::time_point now,
                        std::string &user_id);
 
@@ -28,7 +32,7 @@ private:
 
     std::mt19937 rng_;
     std::uniform_int_distribution<std::uint8_t> dist_;
-    std::unordered_map<std::string, TokenRecord> tokens_;
+    std::unordered_map<std::string, TokenRecord, StringHash, std::equal_to<>> tokens_;
     std::chrono::seconds ttl_;
 };
 
@@ -0,0 +1,282 @@
+#include "net/buffer_pool.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <mutex>
+#include <utility>
+
+namespace net {
+
+namespace {
+
+using Buffer = std::vector<std::uint8_t>;
+
+// Roughly 256 KiB per class per thread and 2 MiB per class in the depot, but
+// never fewer than a handful of buffers for the large classes.
+constexpr std::size_t kThreadCacheBytes = 256 * 1024;
+constexpr std::size_t kDepotBytes = 2 * 1024 * 1024;
+constexpr std::size_t kMinCachedBuffers = 4;
+constexpr std::size_t kRefillBatch = 16;
+constexpr std::size_t kMaxBlockCache = 256;
+
+std::size_t classBytes(std::size_t index) {
+    return BufferPool::kMinClassBytes << index;
+}
+
+std::size_t threadLimit(std::size_t index) {
+    return std::max(kMinCachedBuffers, kThreadCacheBytes / classBytes(index));
+}
+
+std::size_t depotLimit(std::size_t index) {
+    return std::max(kMinCachedBuffers, kDepotBytes / classBytes(index));
+}
+
+// Smallest class that holds `capacity` bytes.
+std::size_t classFor(std::size_t capacity) {
+    if (capacity <= BufferPool::kMinClassBytes) {
+        return 0;
+    }
+    return static_cast<std::size_t>(std::bit_width(capacity - 1)) -
+           static_cast<std::size_t>(std::bit_width(BufferPool::kMinClassBytes - 1));
+}
+
+struct Stats {
+    std::atomic<std::uint64_t> hits{0};
+    std::atomic<std::uint64_t> misses{0};
+    std::atomic<std::uint64_t> recycled{0};
+    std::atomic<std::uint64_t> discarded{0};
+};
+
+Stats &counters() {
+    static Stats instance;
+    return instance;
+}
+
+struct Depot {
+    std::mutex mutex;
+    std::array<std::vector<Buffer>, BufferPool::kClassCount> free;
+};
+
+// Leaked so threads that exit during static destruction can still flush.
+Depot &depot() {
+    static Depot *instance = new Depot();
+    return *instance;
+}
+
+thread_local bool thread_cache_destroyed = false;
+
+struct ThreadCache {
+    std::array<std::vector<Buffer>, BufferPool::kClassCount> free;
+    // Spare PooledBuffer control blocks; the type is private to the handle,
+    // which also supplies the deleter.
+    std::vector<void *> blocks;
+    void (*destroy_block)(void *){nullptr};
+
+    ~ThreadCache();
+};
+
+ThreadCache *threadCache() {
+    if (thread_cache_destroyed) {
+        return nullptr;
+    }
+    thread_local ThreadCache cache;
+    return &cache;
+}
+
+// Moves up to `count` buffers of one class from `from` to `to`.
+void transfer(std::vector<Buffer> &from, std::vector<Buffer> &to, std::size_t count) {
+    count = std::min(count, from.size());
+    for (std::size_t i = 0; i < count; ++i) {
+        to.push_back(std::move(from.back()));
+        from.pop_back();
+    }
+}
+
+ThreadCache::~ThreadCache() {
+    thread_cache_destroyed = true;
+    {
+        auto &shared = depot();
+        std::lock_guard<std::mutex> lock(shared.mutex);
+        for (std::size_t index = 0; index < free.size(); ++index) {
+            auto room = depotLimit(index) - std::min(depotLimit(index),
+                                                     shared.free[index].size());
+            transfer(free[index], shared.free[index], room);
+        }
+    }
+    for (void *block : blocks) {
+        destroy_block(block);
+    }
+}
+
+}  // namespace
+
+struct PooledBuffer::Block {
+    std::atomic<std::uint32_t> refs{1};
+    Buffer bytes;
+};
+
+Buffer BufferPool::acquire(std::size_t capacity) {
+    Buffer buffer;
+    if (capacity > kMaxClassBytes) {
+        counters().misses.fetch_add(1, std::memory_order_relaxed);
+        buffer.reserve(capacity);
+        return buffer;
+    }
+
+    auto index = classFor(capacity);
+    if (auto *cache = threadCache()) {
+        auto &local = cache->free[index];
+        if (local.empty()) {
+            auto &shared = depot();
+            std::lock_guard<std::mutex> lock(shared.mutex);
+            transfer(shared.free[index], local, std::min(kRefillBatch, threadLimit(index)));
+        }
+        if (!local.empty()) {
+            buffer = std::move(local.back());
+            local.pop_back();
+            counters().hits.fetch_add(1, std::memory_order_relaxed);
+            return buffer;
+        }
+    }
+
+    counters().misses.fetch_add(1, std::memory_order_relaxed);
+    buffer.reserve(classBytes(index));
+    return buffer;
+}
+
+void BufferPool::release(Buffer &&buffer) {
+    auto capacity = buffer.capacity();
+    if (capacity == 0) {
+        return;
+    }
+    if (capacity < kMinClassBytes || capacity >= kMaxClassBytes * 2) {
+        counters().discarded.fetch_add(1, std::memory_order_relaxed);
+        Buffer().swap(buffer);
+        return;
+    }
+
+    // Largest class the capacity fully covers, so acquire() can trust it.
+    auto index = static_cast<std::size_t>(std::bit_width(capacity)) -
+                 static_cast<std::size_t>(std::bit_width(kMinClassBytes));
+    buffer.clear();
+    Buffer owned = std::move(buffer);
+    buffer = Buffer();
+
+    auto *cache = threadCache();
+    if (cache && cache->free[index].size() < threadLimit(index)) {
+        cache->free[index].push_back(std::move(owned));
+        counters().recycled.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    auto &shared = depot();
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    if (cache) {
+        // Spill half the local cache so the next release stays local.
+        auto &local = cache->free[index];
+        auto room = depotLimit(index) - std::min(depotLimit(index),
+                                                 shared.free[index].size());
+        transfer(local, shared.free[index], std::min(room, local.size() / 2));
+    }
+    if (shared.free[index].size() < depotLimit(index)) {
+        shared.free[index].push_back(std::move(owned));
+        counters().recycled.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    counters().discarded.fetch_add(1, std::memory_order_relaxed);
+}
+
+BufferPoolStats BufferPool::stats() {
+    auto &totals = counters();
+    BufferPoolStats out;
+    out.hits = totals.hits.load(std::memory_order_relaxed);
+    out.misses = totals.misses.load(std::memory_order_relaxed);
+    out.recycled = totals.recycled.load(std::memory_order_relaxed);
+    out.discarded = totals.discarded.load(std::memory_order_relaxed);
+    return out;
+}
+
+PooledBuffer::PooledBuffer(Buffer &&bytes) {
+    auto *cache = threadCache();
+    if (cache && !cache->blocks.empty()) {
+        block_ = static_cast<Block *>(cache->blocks.back());
+        cache->blocks.pop_back();
+        block_->refs.store(1, std::memory_order_relaxed);
+    } else {
+        block_ = new Block();
+    }
+    block_->bytes = std::move(bytes);
+}
+
+PooledBuffer::PooledBuffer(const PooledBuffer &other) : block_(other.block_) {
+    if (block_) {
+        block_->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+PooledBuffer::PooledBuffer(PooledBuffer &&other) noexcept
+    : block_(std::exchange(other.block_, nullptr)) {}
+
+PooledBuffer &PooledBuffer::operator=(PooledBuffer other) noexcept {
+    std::swap(block_, other.block_);
+    return *this;
+}
+
+PooledBuffer::~PooledBuffer() {
+    reset();
+}
+
+std::span<const std::uint8_t> PooledBuffer::bytes() const {
+    if (!block_) {
+        return {};
+    }
+    return block_->bytes;
+}
+
+std::size_t PooledBuffer::size() const {
+    return block_ ? block_->bytes.size() : 0;
+}
+
+bool PooledBuffer::empty() const {
+    return size() == 0;
+}
+
+std::size_t PooledBuffer::useCount() const {
+    return block_ ? block_->refs.load(std::memory_order_relaxed) : 0;
+}
+
+Buffer PooledBuffer::take() {
+    if (!block_) {
+        return {};
+    }
+    Buffer out;
+    if (block_->refs.load(std::memory_order_acquire) == 1) {
+        out = std::move(block_->bytes);
+    } else {
+        out = BufferPool::acquire(block_->bytes.size());
+        out.assign(block_->bytes.begin(), block_->bytes.end());
+    }
+    reset();
+    return out;
+}
+
+void PooledBuffer::reset() {
+    if (!block_) {
+        return;
+    }
+    if (block_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        BufferPool::release(std::move(block_->bytes));
+        auto *cache = threadCache();
+        if (cache && cache->blocks.size() < kMaxBlockCache) {
+            cache->destroy_block = [](void *block) { delete static_cast<Block *>(block); };
+            cache->blocks.push_back(block_);
+        } else {
+            delete block_;
+        }
+    }
+    block_ = nullptr;
+}
+
+}  // namespace net
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace net {
+
+struct BufferPoolStats {
+    std::uint64_t hits{0};       // acquire() served from a cache
+    std::uint64_t misses{0};     // acquire() had to allocate
+    std::uint64_t recycled{0};   // release() kept the buffer for reuse
+    std::uint64_t discarded{0};  // release() freed it (odd size or caches full)
+};
+
+// Recycles byte buffers in power-of-two size classes from 64 B to 64 KiB.
+// Each thread keeps a small cache per class and trades batches with a shared
+// depot, so a buffer released on another thread is still reused. Requests
+// above the largest class are plain allocations and are freed on release.
+class BufferPool {
+public:
+    static constexpr std::size_t kMinClassBytes = 64;
+    static constexpr std::size_t kMaxClassBytes = 64 * 1024;
+    static constexpr std::size_t kClassCount = 11;
+
+    // Returns an empty vector with capacity for at least `capacity` bytes.
+    static std::vector<std::uint8_t> acquire(std::size_t capacity);
+    // Takes the storage back; `buffer` is left empty with no capacity.
+    static void release(std::vector<std::uint8_t> &&buffer);
+
+    static BufferPoolStats stats();
+};
+
+// Ref-counted handle to a pooled buffer. Copies share the bytes, so one frame
+// can sit in several send queues; the storage goes back to BufferPool when
+// the last handle is dropped.
+class PooledBuffer {
+public:
+    PooledBuffer() = default;
+    explicit PooledBuffer(std::vector<std::uint8_t> &&bytes);
+    PooledBuffer(const PooledBuffer &other);
+    PooledBuffer(PooledBuffer &&other) noexcept;
+    PooledBuffer &operator=(PooledBuffer other) noexcept;
+    ~PooledBuffer();
+
+    std::span<const std::uint8_t> bytes() const;
+    std::size_t size() const;
+    bool empty() const;
+    std::size_t useCount() const;
+
+    // Moves the bytes out when this is the only handle and copies them into
+    // a pooled buffer otherwise. The handle is empty afterwards.
+    std::vector<std::uint8_t> take();
+
+private:
+    struct Block;
+
+    void reset();
+
+    Block *block_{nullptr};
+};
+
+}  // namespace net
@@ -0,0 +1,83 @@
+#include "net/clock.h"
+
+#include <ctime>
+
+namespace net {
+namespace {
+
+struct CachedTime {
+    bool active{false};
+    std::chrono::steady_clock::time_point steady{};
+    std::chrono::system_clock::time_point system{};
+};
+
+thread_local CachedTime cached_time;
+
+std::chrono::system_clock::time_point wallTimeOf(std::chrono::steady_clock::time_point steady_now) {
+    // Both real clocks read back to back give the current offset between them.
+    auto offset = std::chrono::system_clock::now().time_since_epoch() -
+                  std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                      std::chrono::steady_clock::now().time_since_epoch());
+    return std::chrono::system_clock::time_point{
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(
+            steady_now.time_since_epoch()) +
+        offset};
+}
+
+}  // namespace
+
+CoarseClock::Scope::Scope(std::chrono::steady_clock::time_point steady_now)
+    : was_active_(cached_time.active), steady_(cached_time.steady), system_(cached_time.system) {
+    CoarseClock::update(steady_now);
+}
+
+CoarseClock::Scope::~Scope() {
+    cached_time = CachedTime{was_active_, steady_, system_};
+}
+
+void CoarseClock::update() {
+    update(std::chrono::steady_clock::now());
+}
+
+void CoarseClock::update(std::chrono::steady_clock::time_point steady_now) {
+    cached_time = CachedTime{true, steady_now, wallTimeOf(steady_now)};
+}
+
+void CoarseClock::reset() {
+    cached_time.active = false;
+}
+
+std::chrono::steady_clock::time_point CoarseClock::now() {
+    if (!cached_time.active) {
+        return std::chrono::steady_clock::now();
+    }
+    return cached_time.steady;
+}
+
+std::chrono::system_clock::time_point CoarseClock::systemNow() {
+    if (!cached_time.active) {
+        return std::chrono::system_clock::now();
+    }
+    return cached_time.system;
+}
+
+const std::string &CoarseClock::isoTimestamp() {
+    thread_local std::time_t cached_second = -1;
+    thread_local std::string cached;
+    auto time = std::chrono::system_clock::to_time_t(systemNow());
+    if (time != cached_second) {
+        std::tm utc_tm{};
+#if defined(_WIN32)
+        gmtime_s(&utc_tm, &time);
+#else
+        gmtime_r(&time, &utc_tm);
+#endif
+        char buffer[32];
+        auto length = std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", &utc_tm);
+        cached.assign(buffer, length);
+        cached_second = time;
+    }
+    return cached;
+}
+
+}  // namespace net
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+
+namespace net {
+
+// Per-thread coarse clock. An event loop holds a Scope while it drains, so
+// hot paths on that thread read the drain's time instead of querying the OS
+// clock; each loop thread has its own cache, so loops never move each
+// other's time. Outside a scope or update() (other threads, an idle loop,
+// unit tests) reads fall through to the real clocks, so a cached value is
+// never older than the drain or update that set it.
+class CoarseClock {
+public:
+    // Caches `steady_now` for the calling thread until the scope ends, then
+    // restores whatever the thread had before.
+    class Scope {
+    public:
+        explicit Scope(std::chrono::steady_clock::time_point steady_now);
+        ~Scope();
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        bool was_active_;
+        std::chrono::steady_clock::time_point steady_;
+        std::chrono::system_clock::time_point system_;
+    };
+
+    // Pins the calling thread's cache until reset(); for tools and tests.
+    static void update();
+    static void update(std::chrono::steady_clock::time_point steady_now);
+    static void reset();
+
+    static std::chrono::steady_clock::time_point now();
+    // The wall-clock time of now(): an injected steady time maps to the
+    // matching wall time rather than the current one.
+    static std::chrono::system_clock::time_point systemNow();
+
+    // UTC "YYYY-MM-DDTHH:MM:SSZ" for systemNow(). Formatted at most once per
+    // second per thread; the reference stays valid until the next call on the
+    // same thread.
+    static const std::string &isoTimestamp();
+};
+
+}  // namespace net
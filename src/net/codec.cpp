@@ -1,6 +1,9 @@
 #include "net/codec.h"
 
+#include "net/buffer_pool.h"
+
 #include <algorithm>
+#include <utility>
 
 namespace net {
 
@@ -34,7 +37,8 @@ void write_u16(std::uint16_t value, std::uint8_t *out) {
 std::vector<std::uint8_t> Codec::encode(std::uint16_t type,
                                         std::uint16_t version,
                                         std::span<const std::uint8_t> payload) {
-    std::vector<std::uint8_t> buffer(kHeaderSize + payload.size());
+    auto buffer = BufferPool::acquire(kHeaderSize + payload.size());
+    buffer.resize(kHeaderSize + payload.size());
     write_u32(static_cast<std::uint32_t>(payload.size()), buffer.data());
     write_u16(type, buffer.data() + 4);
     write_u16(version, buffer.data() + 6);
@@ -42,27 +46,101 @@ std::vector<std::uint8_t> Codec::encode(std::uint16_t type,
     return buffer;
 }
 
+FrameBuilder::FrameBuilder(std::uint16_t type,
+                           std::uint16_t version,
+                           std::size_t payload_capacity)
+    : buffer_(BufferPool::acquire(Codec::kHeaderSize + payload_capacity)) {
+    buffer_.resize(Codec::kHeaderSize);
+    write_u16(type, buffer_.data() + 4);
+    write_u16(version, buffer_.data() + 6);
+}
+
+std::uint8_t *FrameBuilder::extend(std::size_t count) {
+    auto offset = buffer_.size();
+    buffer_.resize(offset + count);
+    return buffer_.data() + offset;
+}
+
+void FrameBuilder::append(std::span<const std::uint8_t> bytes) {
+    buffer_.insert(buffer_.end(), bytes.begin(), bytes.end());
+}
+
+std::size_t FrameBuilder::payloadSize() const {
+    return buffer_.size() - Codec::kHeaderSize;
+}
+
+std::vector<std::uint8_t> FrameBuilder::finish() && {
+    write_u32(static_cast<std::uint32_t>(payloadSize()), buffer_.data());
+    return std::move(buffer_);
+}
+
+FrameDecoder::FrameDecoder(FrameDecoder &&other) noexcept
+    : buffer_(std::move(other.buffer_)), read_offset_(std::exchange(other.read_offset_, 0)) {}
+
+FrameDecoder &FrameDecoder::operator=(FrameDecoder &&other) noexcept {
+    if (this != &other) {
+        BufferPool::release(std::move(buffer_));
+        buffer_ = std::move(other.buffer_);
+        read_offset_ = std::exchange(other.read_offset_, 0);
+    }
+    return *this;
+}
+
+FrameDecoder::~FrameDecoder() {
+    BufferPool::release(std::move(buffer_));
+}
+
 void FrameDecoder::append(std::span<const std::uint8_t> data) {
+    // Consumed bytes are dropped lazily: all at once when the buffer drains,
+    // otherwise only once they make up half of it.
+    if (read_offset_ == buffer_.size()) {
+        buffer_.clear();
+        read_offset_ = 0;
+    } else if (read_offset_ * 2 >= buffer_.size()) {
+        buffer_.erase(buffer_.begin(),
+                      buffer_.begin() + static_cast<std::ptrdiff_t>(read_offset_));
+        read_offset_ = 0;
+    }
+    auto needed = buffer_.size() + data.size();
+    if (needed > buffer_.capacity()) {
+        auto grown = BufferPool::acquire(std::max(needed, buffer_.capacity() * 2));
+        grown.assign(buffer_.begin(), buffer_.end());
+        BufferPool::release(std::move(buffer_));
+        buffer_ = std::move(grown);
+    }
     buffer_.insert(buffer_.end(), data.begin(), data.end());
 }
 
-bool FrameDecoder::nextFrame(FrameHeader &header, std::vector<std::uint8_t> &payload) {
-    if (buffer_.size() < Codec::kHeaderSize) {
+bool FrameDecoder::nextFrameView(FrameHeader &header, std::span<const std::uint8_t> &payload) {
+    std::size_t available = buffer_.size() - read_offset_;
+    if (available < Codec::kHeaderSize) {
         return false;
     }
 
-    header.length = read_u32(buffer_.data());
-    header.type = read_u16(buffer_.data() + 4);
-    header.version = read_u16(buffer_.data() + 6);
+    const std::uint8_t *frame = buffer_.data() + read_offset_;
+    header.length = read_u32(frame);
+    header.type = read_u16(frame + 4);
+    header.version = read_u16(frame + 6);
 
-    if (buffer_.size() < Codec::kHeaderSize + header.length) {
+    if (available < Codec::kHeaderSize + header.length) {
         return false;
     }
 
-    payload.assign(buffer_.begin() + Codec::kHeaderSize,
-                   buffer_.begin() + Codec::kHeaderSize + header.length);
-    buffer_.erase(buffer_.begin(),
-                  buffer_.begin() + Codec::kHeaderSize + header.length);
+    payload = std::span<const std::uint8_t>(frame + Codec::kHeaderSize, header.length);
+    read_offset_ += Codec::kHeaderSize + header.length;
+    return true;
+}
+
+bool FrameDecoder::nextFrame(FrameHeader &header, std::vector<std::uint8_t> &payload) {
+    std::span<const std::uint8_t> view;
+    if (!nextFrameView(header, view)) {
+        return false;
+    }
+    if (payload.capacity() < view.size()) {
+        BufferPool::release(std::move(payload));
+        payload = BufferPool::acquire(view.size());
+    }
+    payload.assign(view.begin(), view.end());
     return true;
 }
 
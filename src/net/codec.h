@@ -22,13 +22,46 @@ public:
                                             std::span<const std::uint8_t> payload);
 };
 
+// Builds one frame in a single buffer: the header is reserved up front,
+// encoders append the payload directly behind it and finish() backpatches the
+// length. Replaces encoding into a temporary payload and copying it through
+// Codec::encode.
+class FrameBuilder {
+public:
+    FrameBuilder(std::uint16_t type, std::uint16_t version, std::size_t payload_capacity = 0);
+
+    // Grows the payload by `count` bytes and returns where they start. The
+    // pointer is invalidated by the next extend()/append().
+    std::uint8_t *extend(std::size_t count);
+    void append(std::span<const std::uint8_t> bytes);
+    std::size_t payloadSize() const;
+
+    std::vector<std::uint8_t> finish() &&;
+
+private:
+    std::vector<std::uint8_t> buffer_;
+};
+
+// Reassembles frames from a byte stream. The buffer and payloads come from
+// BufferPool; consumed bytes are tracked with an offset instead of erasing
+// from the front after every frame.
 class FrameDecoder {
 public:
+    FrameDecoder() = default;
+    FrameDecoder(FrameDecoder &&other) noexcept;
+    FrameDecoder &operator=(FrameDecoder &&other) noexcept;
+    ~FrameDecoder();
+
     void append(std::span<const std::uint8_t> data);
+    // `payload` is reused when it has room, otherwise swapped for a pooled buffer.
     bool nextFrame(FrameHeader &header, std::vector<std::uint8_t> &payload);
+    // Zero-copy variant: `payload` views the internal buffer and stays valid
+    // until the next append().
+    bool nextFrameView(FrameHeader &header, std::span<const std::uint8_t> &payload);
 
 private:
     std::vector<std::uint8_t> buffer_;
+    std::size_t read_offset_{0};
 };
 
 }  // namespace net
@@ -1,5 +1,10 @@
 #include "net/io_layer.h"
 
+#include "net/buffer_pool.h"
+#include "net/clock.h"
+
+#include <algorithm>
+
 namespace net {
 
 IoPlatform defaultIoPlatform() {
@@ -13,6 +18,10 @@ IoPlatform defaultIoPlatform() {
 PacketPipeline::PacketPipeline(DispatchFn dispatch)
     : dispatch_(std::move(dispatch)) {}
 
+void PacketPipeline::setScreen(ScreenFn screen) {
+    screen_ = std::move(screen);
+}
+
 void PacketPipeline::registerConnection(std::uint64_t connection_id) {
     decoders_.emplace(connection_id, FrameDecoder{});
 }
@@ -29,14 +38,35 @@ void PacketPipeline::onRead(std::uint64_t connection_id,
         return;
     }
     it->second.append(payload);
-    FrameHeader header{};
+    frames_.clear();
+    InboundFrame frame;
+    while (it->second.nextFrameView(frame.header, frame.payload)) {
+        frames_.push_back(frame);
+    }
+
     std::vector<std::uint8_t> frame_payload;
-    while (it->second.nextFrame(header, frame_payload)) {
-        if (dispatch_) {
-            dispatch_(connection_id, header, frame_payload, now);
+    std::span<InboundFrame> pending(frames_);
+    while (!pending.empty()) {
+        std::size_t screened = pending.size();
+        if (screen_) {
+            screened = std::clamp<std::size_t>(screen_(connection_id, pending), 1, pending.size());
+        }
+        for (const auto &decoded : pending.first(screened)) {
+            if (decoded.rejection != FrameRejection::None || !dispatch_) {
+                continue;
+            }
+            if (frame_payload.capacity() < decoded.payload.size()) {
+                BufferPool::release(std::move(frame_payload));
+                frame_payload = BufferPool::acquire(decoded.payload.size());
+            }
+            frame_payload.assign(decoded.payload.begin(), decoded.payload.end());
+            dispatch_(connection_id, decoded.header, frame_payload, now);
+            frame_payload.clear();
         }
-        frame_payload.clear();
+        pending = pending.subspan(screened);
     }
+    frames_.clear();
+    BufferPool::release(std::move(frame_payload));
 }
 
 void IoEventLoop::setAcceptHandler(AcceptHandler handler) {
@@ -60,7 +90,10 @@ void IoEventLoop::enqueueEvent(IoEvent event) {
 }
 
 void IoEventLoop::drain(std::chrono::steady_clock::time_point now) {
-    for (const auto &event : pending_) {
+    // Handlers on this thread read `now` from the coarse clock until the
+    // drain ends; afterwards they fall back to the real clock.
+    CoarseClock::Scope clock_scope(now);
+    for (auto &event : pending_) {
         switch (event.type) {
             case IoEvent::Type::Accept:
                 if (on_accept_) {
@@ -71,6 +104,7 @@ void IoEventLoop::drain(std::chrono::steady_clock::time_point now) {
                 if (on_read_) {
                     on_read_(event.connection_id, event.payload, now);
                 }
+                BufferPool::release(std::move(event.payload));
                 break;
             case IoEvent::Type::Write:
                 if (on_write_) {
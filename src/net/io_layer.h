@@ -1,11 +1,13 @@
 #pragma once
 
 #include "net/codec.h"
+#include "net/security.h"
 
 #include <chrono>
 #include <cstdint>
 #include <functional>
 #include <optional>
+#include <span>
 #include <unordered_map>
 #include <vector>
 
@@ -45,9 +47,16 @@ public:
                                           const FrameHeader &,
                                           const std::vector<std::uint8_t> &,
                                           std::chrono::steady_clock::time_point)>;
+    // Sees the frames decoded from one read before they are dispatched and
+    // marks the ones to drop. Returns how many leading frames it screened;
+    // the rest are passed again once those are dispatched (see
+    // Server::screenFrames).
+    using ScreenFn = std::function<std::size_t(std::uint64_t, std::span<InboundFrame>)>;
 
     explicit PacketPipeline(DispatchFn dispatch);
 
+    void setScreen(ScreenFn screen);
+
     void registerConnection(std::uint64_t connection_id);
     void removeConnection(std::uint64_t connection_id);
     void onRead(std::uint64_t connection_id,
@@ -56,7 +65,10 @@ public:
 
 private:
     DispatchFn dispatch_;
+    ScreenFn screen_;
     std::unordered_map<std::uint64_t, FrameDecoder> decoders_;
+    // Views into the decoder buffer for the read being processed.
+    std::vector<InboundFrame> frames_;
 };
 
 class IoEventLoop {
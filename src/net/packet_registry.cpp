@@ -0,0 +1,77 @@
+#include "net/packet_registry.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace net {
+
+void LatencyHistogram::record(std::chrono::nanoseconds latency) {
+    auto micros = static_cast<std::uint64_t>(
+        std::max<std::int64_t>(0, latency.count()) / 1000);
+    auto bound = std::lower_bound(kBucketBoundsUs.begin(), kBucketBoundsUs.end(), micros);
+    buckets_[static_cast<std::size_t>(bound - kBucketBoundsUs.begin())] += 1;
+    count_ += 1;
+    max_us_ = std::max(max_us_, micros);
+}
+
+std::uint64_t LatencyHistogram::count() const {
+    return count_;
+}
+
+std::uint64_t LatencyHistogram::bucketCount(std::size_t index) const {
+    return index < buckets_.size() ? buckets_[index] : 0;
+}
+
+std::chrono::microseconds LatencyHistogram::quantile(double q) const {
+    if (count_ == 0) {
+        return std::chrono::microseconds{0};
+    }
+    q = std::clamp(q, 0.0, 1.0);
+    auto rank = static_cast<std::uint64_t>(std::ceil(q * static_cast<double>(count_)));
+    rank = std::max<std::uint64_t>(rank, 1);
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < kBucketBoundsUs.size(); ++i) {
+        seen += buckets_[i];
+        if (seen >= rank) {
+            return std::chrono::microseconds{
+                static_cast<std::int64_t>(kBucketBoundsUs[i])};
+        }
+    }
+    return std::chrono::microseconds{static_cast<std::int64_t>(max_us_)};
+}
+
+void PacketHandlerRegistry::add(PacketType request_type, Handler handler) {
+    entries_[static_cast<std::uint16_t>(request_type)] = Entry{std::move(handler), {}};
+}
+
+bool PacketHandlerRegistry::contains(PacketType type) const {
+    return entries_.find(static_cast<std::uint16_t>(type)) != entries_.end();
+}
+
+std::optional<std::vector<std::uint8_t>> PacketHandlerRegistry::dispatch(
+    PacketContext &context,
+    std::span<const std::uint8_t> payload) {
+    auto it = entries_.find(context.header.type);
+    if (it == entries_.end()) {
+        return std::nullopt;
+    }
+    auto started = std::chrono::steady_clock::now();
+    auto frame = it->second.handler(context, payload);
+    auto &metrics = it->second.metrics;
+    metrics.count += 1;
+    if (context.failed) {
+        metrics.errors += 1;
+    }
+    metrics.latency.record(std::chrono::steady_clock::now() - started);
+    return frame;
+}
+
+std::optional<PacketTypeMetrics> PacketHandlerRegistry::metrics(PacketType type) const {
+    auto it = entries_.find(static_cast<std::uint16_t>(type));
+    if (it == entries_.end()) {
+        return std::nullopt;
+    }
+    return it->second.metrics;
+}
+
+}  // namespace net
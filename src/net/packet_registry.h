@@ -0,0 +1,103 @@
+#pragma once
+
+#include "admin/logging.h"
+#include "net/codec.h"
+#include "net/protocol.h"
+#include "net/protocol_fields.h"
+#include "net/session.h"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace net {
+
+// Per-packet state handed to every registered handler. `fields` starts as the
+// packet_received log fields; handlers enrich it (user_id, reason) before
+// logging their outcome and set `failed` when the request was rejected. The
+// fields only borrow strings, so they must be logged before the viewed request
+// or response goes out of scope.
+struct PacketContext {
+    Session &session;
+    const FrameHeader &header;
+    std::chrono::steady_clock::time_point now;
+    admin::LogFields fields;
+    bool failed{false};
+};
+
+class LatencyHistogram {
+public:
+    // Upper bucket bounds in microseconds; the last bucket is open-ended.
+    static constexpr std::array<std::uint64_t, 12> kBucketBoundsUs{
+        1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 5000, 10000};
+
+    void record(std::chrono::nanoseconds latency);
+    std::uint64_t count() const;
+    std::uint64_t bucketCount(std::size_t index) const;
+    // Upper bound of the bucket containing the given quantile (0.0 - 1.0).
+    std::chrono::microseconds quantile(double q) const;
+
+private:
+    std::array<std::uint64_t, kBucketBoundsUs.size() + 1> buckets_{};
+    std::uint64_t count_{0};
+    std::uint64_t max_us_{0};
+};
+
+struct PacketTypeMetrics {
+    std::uint64_t count{0};
+    std::uint64_t errors{0};
+    LatencyHistogram latency;
+};
+
+class PacketHandlerRegistry {
+public:
+    // Payloads are views into the received frame (past any security header).
+    using Handler = std::function<std::vector<std::uint8_t>(
+        PacketContext &, std::span<const std::uint8_t>)>;
+
+    // Binds a request type to a typed handler. Decode is resolved at compile
+    // time and the response is encoded straight into its frame;
+    // `on_malformed` builds the response when Decode fails.
+    template <typename Request, typename Response, auto Decode,
+              typename MalformedFn, typename HandlerFn>
+    void bind(PacketType request_type,
+              PacketType response_type,
+              MalformedFn on_malformed,
+              HandlerFn handler) {
+        add(request_type,
+            [response_type, on_malformed = std::move(on_malformed),
+             handler = std::move(handler)](PacketContext &context,
+                                           std::span<const std::uint8_t> payload) {
+                Request request{};
+                Response response = Decode(payload, request)
+                                        ? handler(context, request)
+                                        : on_malformed(context);
+                return wire::encodeFrame(response_type, context.header.version, response);
+            });
+    }
+
+    void add(PacketType request_type, Handler handler);
+    bool contains(PacketType type) const;
+    std::optional<std::vector<std::uint8_t>> dispatch(
+        PacketContext &context,
+        std::span<const std::uint8_t> payload);
+
+    std::optional<PacketTypeMetrics> metrics(PacketType type) const;
+
+private:
+    struct Entry {
+        Handler handler;
+        PacketTypeMetrics metrics;
+    };
+
+    std::unordered_map<std::uint16_t, Entry> entries_;
+};
+
+}  // namespace net
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <cstdint>
+#include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace net {
@@ -283,134 +285,207 @@ struct ChatEvent {
     std::string message;
 };
 
+// Non-owning request views for the server's decode path. String fields point
+// into the payload passed to decodeXView and are valid only while that buffer
+// is alive and unmodified; handlers copy what they keep.
+struct LoginRequestView {
+    std::string_view user_id;
+    std::string_view password;
+};
+
+struct SessionReconnectRequestView {
+    std::string_view token;
+    std::uint32_t last_seq{0};
+};
+
+struct GuildCreateRequestView {
+    std::string_view guild_name;
+};
+
+struct PartyCreateRequestView {
+    std::string_view leader_user_id;
+};
+
+struct PartyInviteRequestView {
+    std::uint64_t party_id{0};
+    std::string_view inviter_user_id;
+    std::string_view invitee_user_id;
+};
+
+struct PartyAcceptRequestView {
+    std::uint64_t party_id{0};
+    std::string_view invitee_user_id;
+};
+
+struct PartyDisbandRequestView {
+    std::uint64_t party_id{0};
+    std::string_view requester_user_id;
+};
+
+struct MatchRequestView {
+    std::uint64_t party_id{0};
+    std::uint32_t dungeon_id{0};
+    std::string_view difficulty;
+};
+
+struct DungeonEnterRequestView {
+    std::uint64_t instance_id{0};
+    std::string_view ticket;
+    std::uint64_t char_id{0};
+};
+
+struct ChatSendRequestView {
+    ChatChannel channel{ChatChannel::Global};
+    std::uint64_t party_id{0};
+    std::string_view message;
+};
+
 std::vector<std::uint8_t> encodeLoginRequest(const LoginRequest &request);
-bool decodeLoginRequest(const std::vector<std::uint8_t> &payload, LoginRequest &out);
+bool decodeLoginRequest(std::span<const std::uint8_t> payload, LoginRequest &out);
+bool decodeLoginRequestView(std::span<const std::uint8_t> payload, LoginRequestView &out);
 
 std::vector<std::uint8_t> encodeLoginResponse(const LoginResponse &response);
-bool decodeLoginResponse(const std::vector<std::uint8_t> &payload, LoginResponse &out);
+bool decodeLoginResponse(std::span<const std::uint8_t> payload, LoginResponse &out);
 
 std::vector<std::uint8_t> encodeVersionReject(const VersionReject &reject);
-bool decodeVersionReject(const std::vector<std::uint8_t> &payload, VersionReject &out);
+bool decodeVersionReject(std::span<const std::uint8_t> payload, VersionReject &out);
 
 std::vector<std::uint8_t> encodeLogoutRequest(const LogoutRequest &request);
-bool decodeLogoutRequest(const std::vector<std::uint8_t> &payload, LogoutRequest &out);
+bool decodeLogoutRequest(std::span<const std::uint8_t> payload, LogoutRequest &out);
 
 std::vector<std::uint8_t> encodeLogoutResponse(const LogoutResponse &response);
-bool decodeLogoutResponse(const std::vector<std::uint8_t> &payload, LogoutResponse &out);
+bool decodeLogoutResponse(std::span<const std::uint8_t> payload, LogoutResponse &out);
 
 std::vector<std::uint8_t> encodeSessionReconnectRequest(
     const SessionReconnectRequest &request);
-bool decodeSessionReconnectRequest(const std::vector<std::uint8_t> &payload,
+bool decodeSessionReconnectRequest(std::span<const std::uint8_t> payload,
                                    SessionReconnectRequest &out);
+bool decodeSessionReconnectRequestView(std::span<const std::uint8_t> payload,
+                                       SessionReconnectRequestView &out);
 
 std::vector<std::uint8_t> encodeSessionReconnectResponse(
     const SessionReconnectResponse &response);
-bool decodeSessionReconnectResponse(const std::vector<std::uint8_t> &payload,
+bool decodeSessionReconnectResponse(std::span<const std::uint8_t> payload,
                                     SessionReconnectResponse &out);
 
 std::vector<std::uint8_t> encodeGuildCreateRequest(const GuildCreateRequest &request);
-bool decodeGuildCreateRequest(const std::vector<std::uint8_t> &payload,
+bool decodeGuildCreateRequest(std::span<const std::uint8_t> payload,
                               GuildCreateRequest &out);
+bool decodeGuildCreateRequestView(std::span<const std::uint8_t> payload,
+                                  GuildCreateRequestView &out);
 
 std::vector<std::uint8_t> encodeGuildCreateResponse(const GuildCreateResponse &response);
-bool decodeGuildCreateResponse(const std::vector<std::uint8_t> &payload,
+bool decodeGuildCreateResponse(std::span<const std::uint8_t> payload,
                                GuildCreateResponse &out);
 
 std::vector<std::uint8_t> encodeGuildJoinRequest(const GuildJoinRequest &request);
-bool decodeGuildJoinRequest(const std::vector<std::uint8_t> &payload,
+bool decodeGuildJoinRequest(std::span<const std::uint8_t> payload,
                             GuildJoinRequest &out);
 
 std::vector<std::uint8_t> encodeGuildJoinResponse(const GuildJoinResponse &response);
-bool decodeGuildJoinResponse(const std::vector<std::uint8_t> &payload,
+bool decodeGuildJoinResponse(std::span<const std::uint8_t> payload,
                              GuildJoinResponse &out);
 
 std::vector<std::uint8_t> encodeGuildLeaveRequest(const GuildLeaveRequest &request);
-bool decodeGuildLeaveRequest(const std::vector<std::uint8_t> &payload,
+bool decodeGuildLeaveRequest(std::span<const std::uint8_t> payload,
                              GuildLeaveRequest &out);
 
 std::vector<std::uint8_t> encodeGuildLeaveResponse(const GuildLeaveResponse &response);
-bool decodeGuildLeaveResponse(const std::vector<std::uint8_t> &payload,
+bool decodeGuildLeaveResponse(std::span<const std::uint8_t> payload,
                               GuildLeaveResponse &out);
 
 std::vector<std::uint8_t> encodeGuildEvent(const GuildEvent &event);
-bool decodeGuildEvent(const std::vector<std::uint8_t> &payload, GuildEvent &out);
+bool decodeGuildEvent(std::span<const std::uint8_t> payload, GuildEvent &out);
 
 std::vector<std::uint8_t> encodePartyCreateRequest(const PartyCreateRequest &request);
-bool decodePartyCreateRequest(const std::vector<std::uint8_t> &payload,
+bool decodePartyCreateRequest(std::span<const std::uint8_t> payload,
                               PartyCreateRequest &out);
+bool decodePartyCreateRequestView(std::span<const std::uint8_t> payload,
+                                  PartyCreateRequestView &out);
 
 std::vector<std::uint8_t> encodePartyCreateResponse(const PartyCreateResponse &response);
-bool decodePartyCreateResponse(const std::vector<std::uint8_t> &payload,
+bool decodePartyCreateResponse(std::span<const std::uint8_t> payload,
                                PartyCreateResponse &out);
 
 std::vector<std::uint8_t> encodePartyInviteRequest(const PartyInviteRequest &request);
-bool decodePartyInviteRequest(const std::vector<std::uint8_t> &payload,
+bool decodePartyInviteRequest(std::span<const std::uint8_t> payload,
                               PartyInviteRequest &out);
+bool decodePartyInviteRequestView(std::span<const std::uint8_t> payload,
+                                  PartyInviteRequestView &out);
 
 std::vector<std::uint8_t> encodePartyInviteResponse(const PartyInviteResponse &response);
-bool decodePartyInviteResponse(const std::vector<std::uint8_t> &payload,
+bool decodePartyInviteResponse(std::span<const std::uint8_t> payload,
                                PartyInviteResponse &out);
 
 std::vector<std::uint8_t> encodePartyAcceptRequest(const PartyAcceptRequest &request);
-bool decodePartyAcceptRequest(const std::vector<std::uint8_t> &payload,
+bool decodePartyAcceptRequest(std::span<const std::uint8_t> payload,
                               PartyAcceptRequest &out);
+bool decodePartyAcceptRequestView(std::span<const std::uint8_t> payload,
+                                  PartyAcceptRequestView &out);
 
 std::vector<std::uint8_t> encodePartyAcceptResponse(const PartyAcceptResponse &response);
-bool decodePartyAcceptResponse(const std::vector<std::uint8_t> &payload,
+bool decodePartyAcceptResponse(std::span<const std::uint8_t> payload,
                                PartyAcceptResponse &out);
 
 std::vector<std::uint8_t> encodePartyDisbandRequest(const PartyDisbandRequest &request);
-bool decodePartyDisbandRequest(const std::vector<std::uint8_t> &payload,
+bool decodePartyDisbandRequest(std::span<const std::uint8_t> payload,
                                PartyDisbandRequest &out);
+bool decodePartyDisbandRequestView(std::span<const std::uint8_t> payload,
+                                   PartyDisbandRequestView &out);
 
 std::vector<std::uint8_t> encodePartyDisbandResponse(const PartyDisbandResponse &response);
-bool decodePartyDisbandResponse(const std::vector<std::uint8_t> &payload,
+bool decodePartyDisbandResponse(std::span<const std::uint8_t> payload,
                                 PartyDisbandResponse &out);
 
 std::vector<std::uint8_t> encodePartyEvent(const PartyEvent &event);
-bool decodePartyEvent(const std::vector<std::uint8_t> &payload, PartyEvent &out);
+bool decodePartyEvent(std::span<const std::uint8_t> payload, PartyEvent &out);
 
 std::vector<std::uint8_t> encodeMatchRequest(const MatchRequest &request);
-bool decodeMatchRequest(const std::vector<std::uint8_t> &payload, MatchRequest &out);
+bool decodeMatchRequest(std::span<const std::uint8_t> payload, MatchRequest &out);
+bool decodeMatchRequestView(std::span<const std::uint8_t> payload, MatchRequestView &out);
 
 std::vector<std::uint8_t> encodeMatchFoundNotify(const MatchFoundNotify &notify);
-bool decodeMatchFoundNotify(const std::vector<std::uint8_t> &payload,
+bool decodeMatchFoundNotify(std::span<const std::uint8_t> payload,
                             MatchFoundNotify &out);
 
 std::vector<std::uint8_t> encodeDungeonEnterRequest(const DungeonEnterRequest &request);
-bool decodeDungeonEnterRequest(const std::vector<std::uint8_t> &payload,
+bool decodeDungeonEnterRequest(std::span<const std::uint8_t> payload,
                                DungeonEnterRequest &out);
+bool decodeDungeonEnterRequestView(std::span<const std::uint8_t> payload,
+                                   DungeonEnterRequestView &out);
 
 std::vector<std::uint8_t> encodeDungeonEnterResponse(const DungeonEnterResponse &response);
-bool decodeDungeonEnterResponse(const std::vector<std::uint8_t> &payload,
+bool decodeDungeonEnterResponse(std::span<const std::uint8_t> payload,
                                 DungeonEnterResponse &out);
 
 std::vector<std::uint8_t> encodeDungeonResultNotify(const DungeonResultNotify &notify);
-bool decodeDungeonResultNotify(const std::vector<std::uint8_t> &payload,
+bool decodeDungeonResultNotify(std::span<const std::uint8_t> payload,
                                DungeonResultNotify &out);
 
 std::vector<std::uint8_t> encodeDungeonResultResponse(const DungeonResultResponse &response);
-bool decodeDungeonResultResponse(const std::vector<std::uint8_t> &payload,
+bool decodeDungeonResultResponse(std::span<const std::uint8_t> payload,
                                  DungeonResultResponse &out);
 
 std::vector<std::uint8_t> encodeChatSendRequest(const ChatSendRequest &request);
-bool decodeChatSendRequest(const std::vector<std::uint8_t> &payload,
+bool decodeChatSendRequest(std::span<const std::uint8_t> payload,
                            ChatSendRequest &out);
+bool decodeChatSendRequestView(std::span<const std::uint8_t> payload,
+                               ChatSendRequestView &out);
 
 std::vector<std::uint8_t> encodeChatSendResponse(const ChatSendResponse &response);
-bool decodeChatSendResponse(const std::vector<std::uint8_t> &payload,
+bool decodeChatSendResponse(std::span<const std::uint8_t> payload,
                             ChatSendResponse &out);
 
 std::vector<std::uint8_t> encodeChatEvent(const ChatEvent &event);
-bool decodeChatEvent(const std::vector<std::uint8_t> &payload, ChatEvent &out);
+bool decodeChatEvent(std::span<const std::uint8_t> payload, ChatEvent &out);
 
 std::vector<std::uint8_t> encodeInventoryUpdateNotify(const InventoryUpdateNotify &notify);
-bool decodeInventoryUpdateNotify(const std::vector<std::uint8_t> &payload,
+bool decodeInventoryUpdateNotify(std::span<const std::uint8_t> payload,
                                  InventoryUpdateNotify &out);
 
 std::vector<std::uint8_t> encodeInventoryUpdateResponse(
     const InventoryUpdateResponse &response);
-bool decodeInventoryUpdateResponse(const std::vector<std::uint8_t> &payload,
+bool decodeInventoryUpdateResponse(std::span<const std::uint8_t> payload,
                                    InventoryUpdateResponse &out);
 
 }  // namespace net
@@ -0,0 +1,341 @@
+#pragma once
+
+#include "net/protocol.h"
+#include "net/wire_codec.h"
+
+#include <cstdint>
+#include <tuple>
+#include <vector>
+
+namespace net::wire {
+
+// Wire layout of every protocol message, in field order. Adding a field here
+// is all that is needed for encode/decode to pick it up.
+
+template <>
+struct Fields<LoginRequest> {
+    static constexpr auto members = std::tuple{&LoginRequest::user_id, &LoginRequest::password};
+};
+
+template <>
+struct Fields<LoginResponse> {
+    static constexpr auto members = std::tuple{
+        &LoginResponse::accepted, &LoginResponse::token, &LoginResponse::message
+    };
+};
+
+template <>
+struct Fields<VersionReject> {
+    static constexpr auto members = std::tuple{
+        &VersionReject::min_version, &VersionReject::max_version,
+        &VersionReject::client_version, &VersionReject::message
+    };
+};
+
+template <>
+struct Fields<LogoutRequest> {
+    static constexpr auto members = std::tuple<>{};
+};
+
+template <>
+struct Fields<LogoutResponse> {
+    static constexpr auto members = std::tuple{
+        &LogoutResponse::success, &LogoutResponse::message
+    };
+};
+
+template <>
+struct Fields<SessionReconnectRequest> {
+    static constexpr auto members = std::tuple{
+        &SessionReconnectRequest::token, &SessionReconnectRequest::last_seq
+    };
+};
+
+template <>
+struct Fields<SessionReconnectResponse> {
+    static constexpr auto members = std::tuple{
+        &SessionReconnectResponse::success, &SessionReconnectResponse::message,
+        &SessionReconnectResponse::session_id, &SessionReconnectResponse::resume_from_seq
+    };
+};
+
+template <>
+struct Fields<GuildCreateRequest> {
+    static constexpr auto members = std::tuple{&GuildCreateRequest::guild_name};
+};
+
+template <>
+struct Fields<GuildCreateResponse> {
+    static constexpr auto members = std::tuple{
+        &GuildCreateResponse::success, &GuildCreateResponse::guild_id,
+        &GuildCreateResponse::message
+    };
+};
+
+template <>
+struct Fields<GuildJoinRequest> {
+    static constexpr auto members = std::tuple{&GuildJoinRequest::guild_id};
+};
+
+template <>
+struct Fields<GuildJoinResponse> {
+    static constexpr auto members = std::tuple{
+        &GuildJoinResponse::success, &GuildJoinResponse::message
+    };
+};
+
+template <>
+struct Fields<GuildLeaveRequest> {
+    static constexpr auto members = std::tuple{&GuildLeaveRequest::guild_id};
+};
+
+template <>
+struct Fields<GuildLeaveResponse> {
+    static constexpr auto members = std::tuple{
+        &GuildLeaveResponse::success, &GuildLeaveResponse::message
+    };
+};
+
+template <>
+struct Fields<GuildEvent> {
+    static constexpr auto members = std::tuple{
+        &GuildEvent::type, &GuildEvent::guild_id, &GuildEvent::actor_user_id,
+        &GuildEvent::member_user_ids, &GuildEvent::message
+    };
+};
+
+template <>
+struct Fields<PartyCreateRequest> {
+    static constexpr auto members = std::tuple{&PartyCreateRequest::leader_user_id};
+};
+
+template <>
+struct Fields<PartyCreateResponse> {
+    static constexpr auto members = std::tuple{
+        &PartyCreateResponse::success, &PartyCreateResponse::party_id,
+        &PartyCreateResponse::message
+    };
+};
+
+template <>
+struct Fields<PartyInviteRequest> {
+    static constexpr auto members = std::tuple{
+        &PartyInviteRequest::party_id, &PartyInviteRequest::inviter_user_id,
+        &PartyInviteRequest::invitee_user_id
+    };
+};
+
+template <>
+struct Fields<PartyInviteResponse> {
+    static constexpr auto members = std::tuple{
+        &PartyInviteResponse::success, &PartyInviteResponse::message
+    };
+};
+
+template <>
+struct Fields<PartyAcceptRequest> {
+    static constexpr auto members = std::tuple{
+        &PartyAcceptRequest::party_id, &PartyAcceptRequest::invitee_user_id
+    };
+};
+
+template <>
+struct Fields<PartyAcceptResponse> {
+    static constexpr auto members = std::tuple{
+        &PartyAcceptResponse::success, &PartyAcceptResponse::message
+    };
+};
+
+template <>
+struct Fields<PartyDisbandRequest> {
+    static constexpr auto members = std::tuple{
+        &PartyDisbandRequest::party_id, &PartyDisbandRequest::requester_user_id
+    };
+};
+
+template <>
+struct Fields<PartyDisbandResponse> {
+    static constexpr auto members = std::tuple{
+        &PartyDisbandResponse::success, &PartyDisbandResponse::message
+    };
+};
+
+template <>
+struct Fields<PartyEvent> {
+    static constexpr auto members = std::tuple{
+        &PartyEvent::type, &PartyEvent::party_id, &PartyEvent::actor_user_id,
+        &PartyEvent::target_user_id, &PartyEvent::member_user_ids, &PartyEvent::message
+    };
+};
+
+template <>
+struct Fields<MatchRequest> {
+    static constexpr auto members = std::tuple{
+        &MatchRequest::party_id, &MatchRequest::dungeon_id, &MatchRequest::difficulty
+    };
+};
+
+template <>
+struct Fields<MatchFoundNotify> {
+    static constexpr auto members = std::tuple{
+        &MatchFoundNotify::success, &MatchFoundNotify::code, &MatchFoundNotify::message,
+        &MatchFoundNotify::party_id, &MatchFoundNotify::instance_id,
+        &MatchFoundNotify::endpoint, &MatchFoundNotify::ticket
+    };
+};
+
+template <>
+struct Fields<DungeonEnterRequest> {
+    static constexpr auto members = std::tuple{
+        &DungeonEnterRequest::instance_id, &DungeonEnterRequest::ticket,
+        &DungeonEnterRequest::char_id
+    };
+};
+
+template <>
+struct Fields<DungeonEnterResponse> {
+    static constexpr auto members = std::tuple{
+        &DungeonEnterResponse::success, &DungeonEnterResponse::code,
+        &DungeonEnterResponse::message, &DungeonEnterResponse::state,
+        &DungeonEnterResponse::seed
+    };
+};
+
+template <>
+struct Fields<RewardItem> {
+    static constexpr auto members = std::tuple{&RewardItem::item_id, &RewardItem::count};
+};
+
+template <>
+struct Fields<DungeonResultNotify> {
+    static constexpr auto members = std::tuple{
+        &DungeonResultNotify::result, &DungeonResultNotify::time_sec,
+        &DungeonResultNotify::deaths, &DungeonResultNotify::rewards
+    };
+};
+
+template <>
+struct Fields<DungeonResultResponse> {
+    static constexpr auto members = std::tuple{
+        &DungeonResultResponse::success, &DungeonResultResponse::code,
+        &DungeonResultResponse::message, &DungeonResultResponse::summary
+    };
+};
+
+template <>
+struct Fields<InventoryUpdateNotify> {
+    static constexpr auto members = std::tuple{
+        &InventoryUpdateNotify::char_id, &InventoryUpdateNotify::items
+    };
+};
+
+template <>
+struct Fields<InventoryUpdateResponse> {
+    static constexpr auto members = std::tuple{
+        &InventoryUpdateResponse::success, &InventoryUpdateResponse::code,
+        &InventoryUpdateResponse::message, &InventoryUpdateResponse::inventory_version
+    };
+};
+
+template <>
+struct Fields<ChatSendRequest> {
+    static constexpr auto members = std::tuple{
+        &ChatSendRequest::channel, &ChatSendRequest::party_id, &ChatSendRequest::message
+    };
+};
+
+template <>
+struct Fields<ChatSendResponse> {
+    static constexpr auto members = std::tuple{
+        &ChatSendResponse::success, &ChatSendResponse::message
+    };
+};
+
+template <>
+struct Fields<ChatEvent> {
+    static constexpr auto members = std::tuple{
+        &ChatEvent::channel, &ChatEvent::party_id, &ChatEvent::sender_user_id,
+        &ChatEvent::message
+    };
+};
+
+// Request views share the layout of the owning request types.
+
+template <>
+struct Fields<LoginRequestView> {
+    static constexpr auto members = std::tuple{
+        &LoginRequestView::user_id, &LoginRequestView::password
+    };
+};
+
+template <>
+struct Fields<SessionReconnectRequestView> {
+    static constexpr auto members = std::tuple{
+        &SessionReconnectRequestView::token, &SessionReconnectRequestView::last_seq
+    };
+};
+
+template <>
+struct Fields<GuildCreateRequestView> {
+    static constexpr auto members = std::tuple{&GuildCreateRequestView::guild_name};
+};
+
+template <>
+struct Fields<PartyCreateRequestView> {
+    static constexpr auto members = std::tuple{&PartyCreateRequestView::leader_user_id};
+};
+
+template <>
+struct Fields<PartyInviteRequestView> {
+    static constexpr auto members = std::tuple{
+        &PartyInviteRequestView::party_id, &PartyInviteRequestView::inviter_user_id,
+        &PartyInviteRequestView::invitee_user_id
+    };
+};
+
+template <>
+struct Fields<PartyAcceptRequestView> {
+    static constexpr auto members = std::tuple{
+        &PartyAcceptRequestView::party_id, &PartyAcceptRequestView::invitee_user_id
+    };
+};
+
+template <>
+struct Fields<PartyDisbandRequestView> {
+    static constexpr auto members = std::tuple{
+        &PartyDisbandRequestView::party_id, &PartyDisbandRequestView::requester_user_id
+    };
+};
+
+template <>
+struct Fields<MatchRequestView> {
+    static constexpr auto members = std::tuple{
+        &MatchRequestView::party_id, &MatchRequestView::dungeon_id,
+        &MatchRequestView::difficulty
+    };
+};
+
+template <>
+struct Fields<DungeonEnterRequestView> {
+    static constexpr auto members = std::tuple{
+        &DungeonEnterRequestView::instance_id, &DungeonEnterRequestView::ticket,
+        &DungeonEnterRequestView::char_id
+    };
+};
+
+template <>
+struct Fields<ChatSendRequestView> {
+    static constexpr auto members = std::tuple{
+        &ChatSendRequestView::channel, &ChatSendRequestView::party_id,
+        &ChatSendRequestView::message
+    };
+};
+
+template <typename Message>
+std::vector<std::uint8_t> encodeFrame(PacketType type,
+                                      std::uint16_t version,
+                                      const Message &message) {
+    return encodeFrame(static_cast<std::uint16_t>(type), version, message);
+}
+
+}  // namespace net::wire
@@ -0,0 +1,73 @@
+#include "net/replay_window.h"
+
+#include <algorithm>
+
+namespace net {
+
+ReplayWindow::ReplayWindow(std::size_t bits)
+    : size_(static_cast<std::uint32_t>(
+          std::clamp<std::size_t>((bits + 63) / 64 * 64, kMinBits, kMaxBits))) {}
+
+bool ReplayWindow::check(std::uint64_t seq) const {
+    if (seq == 0) {
+        return false;
+    }
+    if (seq > highest_) {
+        return true;
+    }
+    if (highest_ - seq >= size_) {
+        return false;
+    }
+    return !seen(seq);
+}
+
+bool ReplayWindow::accept(std::uint64_t seq) {
+    if (!check(seq)) {
+        return false;
+    }
+    if (seq > highest_) {
+        // Slots between the old and new highest now belong to unseen sequences.
+        auto advance = seq - highest_;
+        if (advance >= size_) {
+            bits_.fill(0);
+        } else {
+            for (auto next = highest_ + 1; next < seq; ++next) {
+                clear(next);
+            }
+        }
+        highest_ = seq;
+    }
+    mark(seq);
+    return true;
+}
+
+void ReplayWindow::reset(std::uint64_t highest) {
+    highest_ = highest;
+    // Everything inside the window is at or below `highest`, hence seen.
+    std::fill(bits_.begin(), bits_.begin() + size_ / 64, ~std::uint64_t{0});
+}
+
+std::uint64_t ReplayWindow::highest() const {
+    return highest_;
+}
+
+std::size_t ReplayWindow::size() const {
+    return size_;
+}
+
+bool ReplayWindow::seen(std::uint64_t seq) const {
+    auto slot = seq % size_;
+    return (bits_[slot / 64] >> (slot % 64)) & 1;
+}
+
+void ReplayWindow::mark(std::uint64_t seq) {
+    auto slot = seq % size_;
+    bits_[slot / 64] |= std::uint64_t{1} << (slot % 64);
+}
+
+void ReplayWindow::clear(std::uint64_t seq) {
+    auto slot = seq % size_;
+    bits_[slot / 64] &= ~(std::uint64_t{1} << (slot % 64));
+}
+
+}  // namespace net
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace net {
+
+// IPsec-style anti-replay window over packet sequence numbers. Tracks the
+// highest sequence accepted plus a bitmap of the `size()` sequences behind it,
+// so packets may arrive out of order by up to the window size but each
+// sequence is accepted at most once. Sequences that fall behind the window are
+// rejected. Checks are O(1) and never allocate.
+class ReplayWindow {
+public:
+    static constexpr std::size_t kMinBits = 64;
+    static constexpr std::size_t kMaxBits = 1024;
+
+    // `bits` is rounded up to a multiple of 64 and clamped to [64, 1024].
+    explicit ReplayWindow(std::size_t bits = kMinBits);
+
+    // Records `seq` and returns true if it is new; sequence 0 is never valid.
+    bool accept(std::uint64_t seq);
+    // Same test as accept() without recording anything.
+    bool check(std::uint64_t seq) const;
+
+    // Restarts the window with every sequence up to `highest` treated as seen
+    // (used when a reconnect resumes an earlier session).
+    void reset(std::uint64_t highest);
+
+    std::uint64_t highest() const;
+    std::size_t size() const;
+
+private:
+    bool seen(std::uint64_t seq) const;
+    void mark(std::uint64_t seq);
+    void clear(std::uint64_t seq);
+
+    // Ring bitmap indexed by seq % size(); only the first size()/64 words are used.
+    std::array<std::uint64_t, kMaxBits / 64> bits_{};
+    std::uint64_t highest_{0};
+    std::uint32_t size_;
+};
+
+}  // namespace net
@@ -1,35 +1,21 @@
 #include "net/security.h"
 
+#include "net/buffer_pool.h"
+#include "net/sha256.h"
+
+#include <algorithm>
 #include <array>
 
 namespace net {
 namespace {
 
-constexpr std::uint64_t kFnvOffset = 14695981039346656037ULL;
-constexpr std::uint64_t kFnvPrime = 1099511628211ULL;
-
-std::uint64_t fnv1aUpdate(std::uint64_t hash, std::span<const std::uint8_t> data) {
-    for (std::uint8_t byte : data) {
-        hash ^= byte;
-        hash *= kFnvPrime;
+std::array<std::uint8_t, 12> sequenceBytes(std::uint32_t seq, std::uint64_t nonce) {
+    std::array<std::uint8_t, 12> out{};
+    for (std::size_t i = 0; i < 4; ++i) {
+        out[i] = static_cast<std::uint8_t>(seq >> (8 * (3 - i)));
     }
-    return hash;
-}
-
-std::array<std::uint8_t, 8> toBytes(std::uint64_t value) {
-    std::array<std::uint8_t, 8> out{};
-    for (int i = 7; i >= 0; --i) {
-        out[static_cast<std::size_t>(i)] = static_cast<std::uint8_t>(value & 0xFF);
-        value >>= 8;
-    }
-    return out;
-}
-
-std::array<std::uint8_t, 4> toBytes(std::uint32_t value) {
-    std::array<std::uint8_t, 4> out{};
-    for (int i = 3; i >= 0; --i) {
-        out[static_cast<std::size_t>(i)] = static_cast<std::uint8_t>(value & 0xFF);
-        value >>= 8;
+    for (std::size_t i = 0; i < 8; ++i) {
+        out[4 + i] = static_cast<std::uint8_t>(nonce >> (8 * (7 - i)));
     }
     return out;
 }
@@ -47,77 +33,114 @@ void writeU64(std::uint64_t value, std::vector<std::uint8_t> &out) {
     }
 }
 
-bool readU32(const std::vector<std::uint8_t> &payload,
-             std::size_t &offset,
-             std::uint32_t &out) {
-    if (offset + 4 > payload.size()) {
-        return false;
+// Callers check the length once; reads are unchecked.
+std::uint64_t readBigEndian(const std::uint8_t *data, std::size_t count) {
+    std::uint64_t out = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        out = (out << 8) | data[i];
     }
-    out = (static_cast<std::uint32_t>(payload[offset]) << 24) |
-          (static_cast<std::uint32_t>(payload[offset + 1]) << 16) |
-          (static_cast<std::uint32_t>(payload[offset + 2]) << 8) |
-          static_cast<std::uint32_t>(payload[offset + 3]);
-    offset += 4;
-    return true;
+    return out;
 }
 
-bool readU64(const std::vector<std::uint8_t> &payload,
-             std::size_t &offset,
-             std::uint64_t &out) {
-    if (offset + 8 > payload.size()) {
-        return false;
+}  // namespace
+
+SignatureKey::SignatureKey(std::string_view key)
+    : SignatureKey(std::span<const std::uint8_t>(
+          reinterpret_cast<const std::uint8_t *>(key.data()), key.size())) {}
+
+SignatureKey::SignatureKey(std::span<const std::uint8_t> key_bytes) {
+    // Keys longer than a block are hashed first, as HMAC specifies.
+    std::array<std::uint8_t, Sha256::kBlockSize> block{};
+    if (key_bytes.size() > block.size()) {
+        auto digest = Sha256::hash(key_bytes);
+        std::copy(digest.begin(), digest.end(), block.begin());
+    } else {
+        std::copy(key_bytes.begin(), key_bytes.end(), block.begin());
+    }
+
+    std::array<std::uint8_t, Sha256::kBlockSize> pad{};
+    for (std::size_t i = 0; i < pad.size(); ++i) {
+        pad[i] = block[i] ^ 0x36;
     }
-    out = 0;
-    for (int i = 0; i < 8; ++i) {
-        out = (out << 8) | payload[offset + static_cast<std::size_t>(i)];
+    Sha256 inner;
+    inner.update(pad);
+    inner_state_ = inner.state();
+    for (std::size_t i = 0; i < pad.size(); ++i) {
+        pad[i] = block[i] ^ 0x5c;
     }
-    offset += 8;
-    return true;
+    Sha256 outer;
+    outer.update(pad);
+    outer_state_ = outer.state();
 }
 
-}  // namespace
+std::array<std::uint8_t, 16> SignatureKey::sign(std::uint32_t seq,
+                                                std::uint64_t nonce,
+                                                std::span<const std::uint8_t> payload) const {
+    auto prefix = sequenceBytes(seq, nonce);
+    Sha256 inner(inner_state_, Sha256::kBlockSize);
+    inner.update(prefix);
+    inner.update(payload);
+    auto inner_digest = inner.finish();
+
+    Sha256 outer(outer_state_, Sha256::kBlockSize);
+    outer.update(inner_digest);
+    auto digest = outer.finish();
+
+    std::array<std::uint8_t, 16> out{};
+    std::copy(digest.begin(), digest.begin() + out.size(), out.begin());
+    return out;
+}
+
+std::array<std::uint8_t, 32> SignatureKey::mac(std::span<const std::uint8_t> message) const {
+    Sha256 inner(inner_state_, Sha256::kBlockSize);
+    inner.update(message);
+    auto inner_digest = inner.finish();
+
+    Sha256 outer(outer_state_, Sha256::kBlockSize);
+    outer.update(inner_digest);
+    return outer.finish();
+}
+
+SignatureKey deriveSessionKey(const SignatureKey &server_key, std::string_view token) {
+    static constexpr std::string_view kLabel = "dungeonhub session v1\x01";
+    auto prk = server_key.mac(std::span<const std::uint8_t>(
+        reinterpret_cast<const std::uint8_t *>(token.data()), token.size()));
+    auto okm = SignatureKey(prk).mac(std::span<const std::uint8_t>(
+        reinterpret_cast<const std::uint8_t *>(kLabel.data()), kLabel.size()));
+    return SignatureKey(okm);
+}
 
 std::array<std::uint8_t, 16> computeSignature(std::string_view key,
                                               std::uint32_t seq,
                                               std::uint64_t nonce,
                                               std::span<const std::uint8_t> payload) {
-    auto key_bytes = std::span<const std::uint8_t>(
-        reinterpret_cast<const std::uint8_t *>(key.data()), key.size());
-    auto seq_bytes = toBytes(seq);
-    auto nonce_bytes = toBytes(nonce);
-
-    std::uint64_t hash1 = fnv1aUpdate(kFnvOffset, key_bytes);
-    hash1 = fnv1aUpdate(hash1, seq_bytes);
-    hash1 = fnv1aUpdate(hash1, nonce_bytes);
-    hash1 = fnv1aUpdate(hash1, payload);
-
-    std::uint64_t hash2 = fnv1aUpdate(kFnvOffset ^ 0x9e3779b97f4a7c15ULL, key_bytes);
-    hash2 = fnv1aUpdate(hash2, nonce_bytes);
-    hash2 = fnv1aUpdate(hash2, seq_bytes);
-    hash2 = fnv1aUpdate(hash2, payload);
+    return SignatureKey(key).sign(seq, nonce, payload);
+}
 
-    std::array<std::uint8_t, 16> out{};
-    auto hash1_bytes = toBytes(hash1);
-    auto hash2_bytes = toBytes(hash2);
-    std::copy(hash1_bytes.begin(), hash1_bytes.end(), out.begin());
-    std::copy(hash2_bytes.begin(), hash2_bytes.end(), out.begin() + 8);
-    return out;
+bool verifySignature(const SignatureKey &key,
+                     const SecurityHeader &header,
+                     std::span<const std::uint8_t> payload) {
+    auto expected = key.sign(header.seq, header.nonce, payload);
+    // Constant time: no early exit on the first differing byte.
+    std::uint8_t diff = 0;
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        diff |= static_cast<std::uint8_t>(expected[i] ^ header.signature[i]);
+    }
+    return diff == 0;
 }
 
 bool verifySignature(std::string_view key,
                      const SecurityHeader &header,
                      std::span<const std::uint8_t> payload) {
-    auto expected = computeSignature(key, header.seq, header.nonce, payload);
-    return expected == header.signature;
+    return verifySignature(SignatureKey(key), header, payload);
 }
 
 std::vector<std::uint8_t> wrapSecurePayload(std::uint32_t seq,
                                             std::uint64_t nonce,
-                                            std::string_view key,
+                                            const SignatureKey &key,
                                             std::span<const std::uint8_t> payload) {
-    std::vector<std::uint8_t> out;
-    out.reserve(kSecurityHeaderSize + payload.size());
-    auto signature = computeSignature(key, seq, nonce, payload);
+    auto out = BufferPool::acquire(kSecurityHeaderSize + payload.size());
+    auto signature = key.sign(seq, nonce, payload);
     writeU32(seq, out);
     writeU64(nonce, out);
     out.insert(out.end(), signature.begin(), signature.end());
@@ -125,25 +148,48 @@ std::vector<std::uint8_t> wrapSecurePayload(std::uint32_t seq,
     return out;
 }
 
-bool unwrapSecurePayload(const std::vector<std::uint8_t> &payload,
+std::vector<std::uint8_t> wrapSecurePayload(std::uint32_t seq,
+                                            std::uint64_t nonce,
+                                            std::string_view key,
+                                            std::span<const std::uint8_t> payload) {
+    return wrapSecurePayload(seq, nonce, SignatureKey(key), payload);
+}
+
+bool unwrapSecurePayload(std::span<const std::uint8_t> payload,
                          SecurityHeader &header,
-                         std::vector<std::uint8_t> &inner_payload) {
-    std::size_t offset = 0;
-    if (!readU32(payload, offset, header.seq)) {
-        return false;
-    }
-    if (!readU64(payload, offset, header.nonce)) {
+                         std::span<const std::uint8_t> &inner_payload) {
+    if (payload.size() < kSecurityHeaderSize) {
         return false;
     }
-    if (offset + header.signature.size() > payload.size()) {
+    const std::uint8_t *data = payload.data();
+    header.seq = static_cast<std::uint32_t>(readBigEndian(data, 4));
+    header.nonce = readBigEndian(data + 4, 8);
+    std::copy(data + 12, data + kSecurityHeaderSize, header.signature.begin());
+    inner_payload = payload.subspan(kSecurityHeaderSize);
+    return true;
+}
+
+bool unwrapSecurePayload(InboundFrame &frame) {
+    if (!unwrapSecurePayload(frame.payload, frame.security, frame.body)) {
+        frame.rejection = FrameRejection::MalformedHeader;
         return false;
     }
-    std::copy(payload.begin() + offset,
-              payload.begin() + offset + header.signature.size(),
-              header.signature.begin());
-    offset += header.signature.size();
-    inner_payload.assign(payload.begin() + offset, payload.end());
     return true;
 }
 
+std::size_t verifyBatch(const SignatureKey &key, std::span<InboundFrame> frames) {
+    std::size_t verified = 0;
+    for (auto &frame : frames) {
+        if (frame.rejection != FrameRejection::None) {
+            continue;
+        }
+        if (verifySignature(key, frame.security, frame.body)) {
+            ++verified;
+        } else {
+            frame.rejection = FrameRejection::InvalidSignature;
+        }
+    }
+    return verified;
+}
+
 }  // namespace net
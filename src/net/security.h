@@ -1,5 +1,7 @@
 #pragma once
 
+#include "net/codec.h"
+
 #include <array>
 #include <cstddef>
 #include <cstdint>
@@ -19,21 +21,81 @@ struct SecurityHeader {
 constexpr std::size_t kSecurityHeaderSize =
     sizeof(std::uint32_t) + sizeof(std::uint64_t) + 16;
 
+// HMAC-SHA256 over seq || nonce || payload (big-endian), truncated to 16
+// bytes. The key schedule (SHA-256 state after the inner and outer pads) is
+// computed once here, so signing a packet hashes only the message.
+class SignatureKey {
+public:
+    explicit SignatureKey(std::string_view key);
+    explicit SignatureKey(std::span<const std::uint8_t> key);
+
+    std::array<std::uint8_t, 16> sign(std::uint32_t seq,
+                                      std::uint64_t nonce,
+                                      std::span<const std::uint8_t> payload) const;
+    // Full, untruncated HMAC of `message`.
+    std::array<std::uint8_t, 32> mac(std::span<const std::uint8_t> message) const;
+
+private:
+    std::array<std::uint32_t, 8> inner_state_{};
+    std::array<std::uint32_t, 8> outer_state_{};
+};
+
+// Per-session key bound to a login token, HKDF-style: the server key
+// extracts a PRK from the token, which is expanded with a fixed label.
+// Clients holding the same server key derive it from the token in LoginRes.
+SignatureKey deriveSessionKey(const SignatureKey &server_key, std::string_view token);
+
+// The string_view overloads derive the key schedule on every call; hot paths
+// keep a SignatureKey instead.
 std::array<std::uint8_t, 16> computeSignature(std::string_view key,
                                               std::uint32_t seq,
                                               std::uint64_t nonce,
                                               std::span<const std::uint8_t> payload);
+bool verifySignature(const SignatureKey &key,
+                     const SecurityHeader &header,
+                     std::span<const std::uint8_t> payload);
 bool verifySignature(std::string_view key,
                      const SecurityHeader &header,
                      std::span<const std::uint8_t> payload);
 
+std::vector<std::uint8_t> wrapSecurePayload(std::uint32_t seq,
+                                            std::uint64_t nonce,
+                                            const SignatureKey &key,
+                                            std::span<const std::uint8_t> payload);
 std::vector<std::uint8_t> wrapSecurePayload(std::uint32_t seq,
                                             std::uint64_t nonce,
                                             std::string_view key,
                                             std::span<const std::uint8_t> payload);
 
-bool unwrapSecurePayload(const std::vector<std::uint8_t> &payload,
+// Parses the header in place: `inner_payload` points into `payload`, so the
+// body is verified and dispatched without being copied.
+bool unwrapSecurePayload(std::span<const std::uint8_t> payload,
                          SecurityHeader &header,
-                         std::vector<std::uint8_t> &inner_payload);
+                         std::span<const std::uint8_t> &inner_payload);
+
+enum class FrameRejection {
+    None,
+    MalformedHeader,
+    InvalidSignature,
+    Replay,
+};
+
+// One frame decoded from a read. Screening fills in `security` and `body`,
+// the view behind the security header, and sets `rejection` for frames that
+// must not be dispatched.
+struct InboundFrame {
+    FrameHeader header{};
+    std::span<const std::uint8_t> payload;
+    SecurityHeader security{};
+    std::span<const std::uint8_t> body;
+    FrameRejection rejection{FrameRejection::None};
+};
+
+// Unwraps `frame.payload`; marks the frame MalformedHeader on failure.
+bool unwrapSecurePayload(InboundFrame &frame);
+
+// Verifies every unwrapped, not yet rejected frame against one key schedule
+// and marks failures InvalidSignature. Returns the number that passed.
+std::size_t verifyBatch(const SignatureKey &key, std::span<InboundFrame> frames);
 
 }  // namespace net
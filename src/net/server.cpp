@@ -11,6 +11,8 @@
 #include "inventory/cached_inventory_storage.h"
 #include "inventory/in_memory_inventory_storage.h"
 #include "inventory/mysql_inventory_storage.h"
+#include "net/protocol_fields.h"
+#include "net/session_pool.h"
 
 namespace net {
 
@@ -18,7 +20,10 @@ Server::Server(std::shared_ptr<inventory::InventoryStorage> inventory_storage,
                SecurityPolicy security_policy)
     : inventory_storage_(std::move(inventory_storage)),
       started_at_(std::chrono::steady_clock::now()),
-      security_policy_(std::move(security_policy)) {
+      security_policy_(std::move(security_policy)),
+      signature_key_(security_policy_.hmac_key),
+      session_timers_(started_at_),
+      instance_timers_(started_at_) {
     if (!inventory_storage_) {
         inventory_storage_ = std::make_shared<inventory::CachedInventoryStorage>(
             std::make_unique<inventory::MySqlInventoryStorage>(),
@@ -37,11 +42,9 @@ Server::Server(std::shared_ptr<inventory::InventoryStorage> inventory_storage,
         payload.actor_user_id = event.actor_user_id;
         payload.member_user_ids = event.member_user_ids;
         payload.message = event.message;
-        auto encoded = encodeGuildEvent(payload);
-        auto frame = Codec::encode(static_cast<std::uint16_t>(PacketType::GuildEvent),
-                                   session->protocolVersion(),
-                                   encoded);
-        session->enqueueSend(std::move(frame), std::chrono::steady_clock::now());
+        sendTo(*session, wire::encodeFrame(PacketType::GuildEvent,
+                                           session->protocolVersion(),
+                                           payload));
     });
 
     chat_service_.setEventSink([this](SessionId session_id,
@@ -57,12 +60,11 @@ Server::Server(std::shared_ptr<inventory::InventoryStorage> inventory_storage,
         payload.party_id = message.party_id;
         payload.sender_user_id = message.sender_user_id;
         payload.message = message.text;
-        auto encoded = encodeChatEvent(payload);
-        auto frame = Codec::encode(static_cast<std::uint16_t>(PacketType::ChatEvent),
-                                   session->protocolVersion(),
-                                   encoded);
-        session->enqueueSend(std::move(frame), std::chrono::steady_clock::now());
+        sendTo(*session, wire::encodeFrame(PacketType::ChatEvent,
+                                           session->protocolVersion(),
+                                           payload));
     });
+    registerHandlers();
 }
 
 bool Server::SessionRegistry::registerSession(SessionId id, SessionRecord record) {
@@ -95,7 +97,7 @@ const Server::SessionRecord *Server::SessionRegistry::find(SessionId id) const {
     return &it->second;
 }
 
-bool Server::SessionRegistry::hasUser(const std::string &user_id,
+bool Server::SessionRegistry::hasUser(std::string_view user_id,
                                       SessionId &session_id) const {
     auto it = active_users_.find(user_id);
     if (it == active_users_.end()) {
@@ -108,8 +110,9 @@ bool Server::SessionRegistry::hasUser(const std::string &user_id,
 std::shared_ptr<Session> Server::createSession(
     const SessionConfig &config,
     std::chrono::steady_clock::time_point now) {
-    auto session = std::make_shared<Session>(next_id_++, config, now);
+    auto session = makeSession(next_id_++, config, now);
     sessions_.emplace(session->id(), session);
+    session_timers_.schedule(session->timeoutDeadline(), session->id());
     admin::LogFields fields;
     fields.session_id = session->id();
     fields.session_trace_id = session->traceId();
@@ -143,15 +146,36 @@ std::shared_ptr<Session> Server::findSession(SessionId id) const {
 }
 
 void Server::tick(std::chrono::steady_clock::time_point now) {
-    std::vector<SessionId> to_remove;
-    for (const auto &entry : sessions_) {
-        if (!entry.second->tick(now)) {
-            to_remove.push_back(entry.first);
+    expired_timers_.clear();
+    session_timers_.advance(now, expired_timers_);
+    for (SessionId id : expired_timers_) {
+        auto session = findSession(id);
+        if (!session) {
+            continue;
+        }
+        // Timers are armed for the deadline seen at scheduling time; activity
+        // since then only moves the deadline, so re-arm instead of expiring.
+        if (!session->tick(now)) {
+            pending_disconnects_.push_back(id);
+        } else {
+            session_timers_.schedule(session->timeoutDeadline(), id);
         }
     }
-    for (SessionId id : to_remove) {
+    for (SessionId id : pending_disconnects_) {
         removeSession(id);
     }
+    pending_disconnects_.clear();
+
+    expired_timers_.clear();
+    instance_timers_.advance(now, expired_timers_);
+    for (dungeon::InstanceId instance_id : expired_timers_) {
+        expireInstance(instance_id, now);
+    }
+    instance_manager_.reclaim(now, [this](const dungeon::InstanceRecord &record) {
+        releaseInstance(record);
+    });
+
+    party_service_.expireInvites(now);
 }
 
 std::size_t Server::sessionCount() const {
@@ -169,8 +193,129 @@ std::chrono::steady_clock::time_point Server::startTime() const {
 std::optional<std::vector<std::uint8_t>> Server::handlePacket(
     Session &session,
     const FrameHeader &header,
-    const std::vector<std::uint8_t> &payload,
+    std::span<const std::uint8_t> payload,
+    std::chrono::steady_clock::time_point now) {
+    InboundFrame frame;
+    frame.header = header;
+    frame.payload = payload;
+    return processPacket(session, std::move(frame), false, now);
+}
+
+std::optional<std::vector<std::uint8_t>> Server::handleScreenedPacket(
+    Session &session,
+    const FrameHeader &header,
+    std::span<const std::uint8_t> payload,
+    std::chrono::steady_clock::time_point now) {
+    InboundFrame frame;
+    frame.header = header;
+    frame.payload = payload;
+    return processPacket(session, std::move(frame), true, now);
+}
+
+std::size_t Server::screenFrames(Session &session, std::span<InboundFrame> frames) {
+    if (!securityEnabled()) {
+        for (auto &frame : frames) {
+            frame.body = frame.payload;
+        }
+        return frames.size();
+    }
+    auto key_change = std::find_if(frames.begin(), frames.end(), [](const InboundFrame &frame) {
+        auto type = static_cast<PacketType>(frame.header.type);
+        return type == PacketType::LoginReq || type == PacketType::SessionReconnectReq ||
+               type == PacketType::LogoutReq;
+    });
+    if (key_change != frames.end()) {
+        frames = frames.first(static_cast<std::size_t>(key_change - frames.begin()) + 1);
+    }
+    screen(session, frames);
+    for (const auto &frame : frames) {
+        if (frame.rejection == FrameRejection::None) {
+            continue;
+        }
+        metrics_.packets_total += 1;
+        metrics_.bytes_total += frame.payload.size();
+        admin::LogFields fields;
+        fields.session_id = session.id();
+        fields.session_trace_id = session.traceId();
+        fields.packet_type = frame.header.type;
+        fields.protocol_version = frame.header.version;
+        fields.bytes = frame.payload.size();
+        logRejectedFrame(frame, std::move(fields));
+    }
+    return frames.size();
+}
+
+bool Server::securityEnabled() const {
+    return security_policy_.require_hmac || security_policy_.enable_replay_protection;
+}
+
+const SignatureKey &Server::verificationKey(const Session &session,
+                                            const FrameHeader &header) const {
+    auto type = static_cast<PacketType>(header.type);
+    const SignatureKey *session_key = session.signingKey();
+    if (!session_key || type == PacketType::LoginReq ||
+        type == PacketType::SessionReconnectReq) {
+        return signature_key_;
+    }
+    return *session_key;
+}
+
+void Server::screen(Session &session, std::span<InboundFrame> frames) {
+    for (auto &frame : frames) {
+        frame.rejection = FrameRejection::None;
+        unwrapSecurePayload(frame);
+    }
+    if (security_policy_.require_hmac) {
+        std::size_t begin = 0;
+        while (begin < frames.size()) {
+            const SignatureKey &key = verificationKey(session, frames[begin].header);
+            std::size_t end = begin + 1;
+            while (end < frames.size() &&
+                   &verificationKey(session, frames[end].header) == &key) {
+                ++end;
+            }
+            verifyBatch(key, frames.subspan(begin, end - begin));
+            begin = end;
+        }
+    }
+    // Only authentic frames may advance the window, in arrival order.
+    if (security_policy_.enable_replay_protection) {
+        for (auto &frame : frames) {
+            if (frame.rejection == FrameRejection::None &&
+                !session.acceptSeq(frame.security.seq)) {
+                frame.rejection = FrameRejection::Replay;
+            }
+        }
+    }
+}
+
+void Server::logRejectedFrame(const InboundFrame &frame, admin::LogFields fields) {
+    metrics_.error_total += 1;
+    const char *message = "Malformed security header";
+    switch (frame.rejection) {
+        case FrameRejection::None:
+        case FrameRejection::MalformedHeader:
+            fields.reason = "Malformed security header";
+            break;
+        case FrameRejection::InvalidSignature:
+            fields.reason = "Invalid signature";
+            message = "Signature verification failed";
+            break;
+        case FrameRejection::Replay:
+            fields.reason = "Replay sequence detected";
+            message = "Replay sequence detected";
+            break;
+    }
+    logger_.log("warn", "security_violation", message, fields);
+}
+
+std::optional<std::vector<std::uint8_t>> Server::processPacket(
+    Session &session,
+    InboundFrame frame,
+    bool screened,
     std::chrono::steady_clock::time_point now) {
+    const FrameHeader &header = frame.header;
+    std::span<const std::uint8_t> payload = frame.payload;
     const auto request_trace_id = admin::StructuredLogger::generateTraceId();
     metrics_.packets_total += 1;
     metrics_.bytes_total += payload.size();
@@ -205,1216 +350,866 @@ std::optional<std::vector<std::uint8_t>> Server::handlePacket(
                 << " (supported " << kMinProtocolVersion << "-"
                 << kMaxProtocolVersion << ")";
         reject.message = message.str();
-        auto encoded = encodeVersionReject(reject);
         metrics_.error_total += 1;
         admin::LogFields fields = received_fields;
         fields.reason = reject.message;
         logger_.log("warn", "packet_rejected", "Unsupported protocol version",
                     fields);
-        return Codec::encode(static_cast<std::uint16_t>(PacketType::VersionReject),
-                             header.version,
-                             encoded);
-    }
-
-    std::vector<std::uint8_t> decoded_payload = payload;
-    if (security_policy_.require_hmac || security_policy_.enable_replay_protection) {
-        SecurityHeader security_header{};
-        std::vector<std::uint8_t> inner_payload;
-        if (!unwrapSecurePayload(payload, security_header, inner_payload)) {
-            metrics_.error_total += 1;
-            admin::LogFields fields = received_fields;
-            fields.reason = "Malformed security header";
-            logger_.log("warn", "security_violation",
-                        "Malformed security header", fields);
-            return std::nullopt;
-        }
-        if (security_policy_.require_hmac &&
-            !verifySignature(security_policy_.hmac_key, security_header, inner_payload)) {
-            metrics_.error_total += 1;
-            admin::LogFields fields = received_fields;
-            fields.reason = "Invalid signature";
-            logger_.log("warn", "security_violation",
-                        "Signature verification failed", fields);
+        return wire::encodeFrame(PacketType::VersionReject, header.version, reject);
+    }
+
+    // Secured packets dispatch a view of the body behind the security header;
+    // neither path copies the payload.
+    if (!securityEnabled()) {
+        frame.body = frame.payload;
+    } else if (screened && frame.payload.size() >= kSecurityHeaderSize) {
+        frame.body = frame.payload.subspan(kSecurityHeaderSize);
+    } else {
+        // Unscreened, or too short to have passed screening: check it here.
+        screen(session, std::span<InboundFrame>(&frame, 1));
+        if (frame.rejection != FrameRejection::None) {
+            logRejectedFrame(frame, received_fields);
             return std::nullopt;
         }
-        if (security_policy_.enable_replay_protection) {
-            if (security_header.seq <= session.lastSeq()) {
-                metrics_.error_total += 1;
-                admin::LogFields fields = received_fields;
-                fields.reason = "Replay sequence detected";
-                logger_.log("warn", "security_violation",
-                            "Replay sequence detected", fields);
-                return std::nullopt;
-            }
-            if (!session.recordNonce(security_header.nonce)) {
-                metrics_.error_total += 1;
-                admin::LogFields fields = received_fields;
-                fields.reason = "Replay nonce detected";
-                logger_.log("warn", "security_violation",
-                            "Replay nonce detected", fields);
-                return std::nullopt;
-            }
-            session.setLastSeq(security_header.seq);
-        }
-        decoded_payload = std::move(inner_payload);
-    }
-
-    // Validation hook: after each decode* call below, verify HMAC/signature and
-    // replay protection fields (nonce/seq) before executing game logic.
-    switch (static_cast<PacketType>(header.type)) {
-        case PacketType::LoginReq: {
-            LoginRequest request;
-            if (!decodeLoginRequest(decoded_payload, request)) {
-                LoginResponse response;
-                response.accepted = false;
-                response.message = "Malformed login payload";
-                auto encoded = encodeLoginResponse(response);
-                metrics_.error_total += 1;
-                admin::LogFields fields = received_fields;
-                fields.reason = response.message;
-                logger_.log("warn", "login_failed", response.message, fields);
-                return Codec::encode(static_cast<std::uint16_t>(PacketType::LoginRes),
-                                     header.version,
-                                     encoded);
-            }
+    }
 
-            if (request.password != "letmein") {
-                LoginResponse response;
-                response.accepted = false;
-                response.message = "Invalid credentials";
-                auto encoded = encodeLoginResponse(response);
-                metrics_.error_total += 1;
-                admin::LogFields fields = received_fields;
-                fields.user_id = request.user_id;
-                fields.reason = response.message;
-                logger_.log("warn", "login_failed", response.message, fields);
-                return Codec::encode(static_cast<std::uint16_t>(PacketType::LoginRes),
-                                     header.version,
-                                     encoded);
-            }
+    if (!handlers_.contains(static_cast<PacketType>(header.type))) {
+        metrics_.error_total += 1;
+        admin::LogFields fields = received_fields;
+        fields.reason = "Unknown packet type";
+        logger_.log("warn", "packet_unhandled", "Unknown packet type", fields);
+        return std::nullopt;
+    }
 
-            SessionId existing_id = 0;
-            if (registry_.hasUser(request.user_id, existing_id) &&
-                existing_id != session.id()) {
-                LoginResponse response;
-                response.accepted = false;
-                response.message = "User already logged in";
-                auto encoded = encodeLoginResponse(response);
-                metrics_.error_total += 1;
-                admin::LogFields fields = received_fields;
-                fields.user_id = request.user_id;
-                fields.reason = response.message;
-                logger_.log("warn", "login_failed", response.message, fields);
-                return Codec::encode(static_cast<std::uint16_t>(PacketType::LoginRes),
-                                     header.version,
-                                     encoded);
-            }
+    PacketContext context{session, header, now, received_fields};
+    return handlers_.dispatch(context, frame.body);
+}
 
-            auto token = token_service_.issueToken(request.user_id, now);
-            Session::UserContext context{request.user_id, token};
-            session.attachUserContext(context);
-            if (!registry_.registerSession(session.id(), {request.user_id, token})) {
-                LoginResponse response;
-                response.accepted = false;
-                response.message = "User already logged in";
-                auto encoded = encodeLoginResponse(response);
-                metrics_.error_total += 1;
-                admin::LogFields fields = received_fields;
-                fields.user_id = request.user_id;
-                fields.reason = response.message;
-                logger_.log("warn", "login_failed", response.message, fields);
-                return Codec::encode(static_cast<std::uint16_t>(PacketType::LoginRes),
-                                     header.version,
-                                     encoded);
-            }
+std::optional<PacketTypeMetrics> Server::packetMetrics(PacketType type) const {
+    return handlers_.metrics(type);
+}
 
+void Server::registerHandlers() {
+    handlers_.bind<LoginRequestView, LoginResponse, decodeLoginRequestView>(
+        PacketType::LoginReq, PacketType::LoginRes,
+        [this](PacketContext &context) {
             LoginResponse response;
-            response.accepted = true;
-            response.token = token;
-            response.message = "Login accepted";
-            auto encoded = encodeLoginResponse(response);
-            admin::LogFields fields = received_fields;
-            fields.user_id = request.user_id;
-            logger_.log("info", "login_success", response.message, fields);
-            return Codec::encode(static_cast<std::uint16_t>(PacketType::LoginRes),
-                                 header.version,
-                                 encoded);
-        }
-        case PacketType::LogoutReq: {
-            LogoutRequest request;
-            if (!decodeLogoutRequest(decoded_payload, request)) {
-                LogoutResponse response;
-                response.success = false;
-                response.message = "Malformed logout payload";
-                auto encoded = encodeLogoutResponse(response);
-                metrics_.error_total += 1;
-                admin::LogFields fields = received_fields;
-                fields.reason = response.message;
-                logger_.log("warn", "logout_failed", response.message, fields);
-                return Codec::encode(static_cast<std::uint16_t>(PacketType::LogoutRes),
-                                     header.version,
-                                     encoded);
-            }
-
-            session.clearUserContext();
-            registry_.removeSession(session.id());
-
+            response.message = "Malformed login payload";
+            rejectPacket(context, "login_failed", response.message);
+            return response;
+        },
+        [this](PacketContext &context, const LoginRequestView &request) {
+            return handleLogin(context, request);
+        });
+
+    handlers_.bind<LogoutRequest, LogoutResponse, decodeLogoutRequest>(
+        PacketType::LogoutReq, PacketType::LogoutRes,
+        [this](PacketContext &context) {
             LogoutResponse response;
-            response.success = true;
-            response.message = "Logout successful";
-            auto encoded = encodeLogoutResponse(response);
-            logger_.log("info", "logout_success", response.message, received_fields);
-            return Codec::encode(static_cast<std::uint16_t>(PacketType::LogoutRes),
-                                 header.version,
-                                 encoded);
-        }
-        case PacketType::SessionReconnectReq: {
-            SessionReconnectRequest request;
-            if (!decodeSessionReconnectRequest(decoded_payload, request)) {
-                SessionReconnectResponse response;
-                response.success = false;
-                response.message = "Malformed reconnect payload";
-                auto encoded = encodeSessionReconnectResponse(response);
-                metrics_.error_total += 1;
-                admin::LogFields fields = received_fields;
-                fields.reason = response.message;
-                logger_.log("warn", "session_reconnect_failed", response.message, fields);
-                return Codec::encode(
-                    static_cast<std::uint16_t>(PacketType::SessionReconnectRes),
-                    header.version,
-                    encoded);
-            }
+            response.message = "Malformed logout payload";
+            rejectPacket(context, "logout_failed", response.message);
+            return response;
+        },
+        [this](PacketContext &context, const LogoutRequest &request) {
+            return handleLogout(context, request);
+        });
+
+    handlers_.bind<SessionReconnectRequestView, SessionReconnectResponse,
+                   decodeSessionReconnectRequestView>(
+        PacketType::SessionReconnectReq, PacketType::SessionReconnectRes,
+        [this](PacketContext &context) {
+            SessionReconnectResponse response;
+            response.message = "Malformed reconnect payload";
+            rejectPacket(context, "session_reconnect_failed", response.message);
+            return response;
+        },
+        [this](PacketContext &context, const SessionReconnectRequestView &request) {
+            return handleSessionReconnect(context, request);
+        });
+
+    handlers_.bind<MatchRequestView, MatchFoundNotify, decodeMatchRequestView>(
+        PacketType::MatchReq, PacketType::MatchFoundNotify,
+        [this](PacketContext &context) {
+            MatchFoundNotify response;
+            response.code = "MALFORMED";
+            response.message = "Malformed match request";
+            rejectPacket(context, "match_request_failed", response.message);
+            return response;
+        },
+        [this](PacketContext &context, const MatchRequestView &request) {
+            return handleMatch(context, request);
+        });
+
+    handlers_.bind<DungeonEnterRequestView, DungeonEnterResponse,
+                   decodeDungeonEnterRequestView>(
+        PacketType::DungeonEnterReq, PacketType::DungeonEnterRes,
+        [this](PacketContext &context) {
+            DungeonEnterResponse response;
+            response.code = "MALFORMED";
+            response.message = "Malformed dungeon enter payload";
+            rejectPacket(context, "dungeon_enter_failed", response.message);
+            return response;
+        },
+        [this](PacketContext &context, const DungeonEnterRequestView &request) {
+            return handleDungeonEnter(context, request);
+        });
+
+    handlers_.bind<DungeonResultNotify, DungeonResultResponse, decodeDungeonResultNotify>(
+        PacketType::DungeonResultNotify, PacketType::DungeonResultRes,
+        [this](PacketContext &context) {
+            DungeonResultResponse response;
+            response.code = "MALFORMED";
+            response.message = "Malformed dungeon result payload";
+            response.summary = "result rejected";
+            rejectPacket(context, "dungeon_result_failed", response.message);
+            return response;
+        },
+        [this](PacketContext &context, const DungeonResultNotify &request) {
+            return handleDungeonResult(context, request);
+        });
+
+    handlers_.bind<InventoryUpdateNotify, InventoryUpdateResponse,
+                   decodeInventoryUpdateNotify>(
+        PacketType::InventoryUpdateNotify, PacketType::InventoryUpdateRes,
+        [this](PacketContext &context) {
+            InventoryUpdateResponse response;
+            response.code = "MALFORMED";
+            response.message = "Malformed inventory update payload";
+            rejectPacket(context, "inventory_update_failed", response.message);
+            return response;
+        },
+        [this](PacketContext &context, const InventoryUpdateNotify &request) {
+            return handleInventoryUpdate(context, request);
+        });
+
+    handlers_.bind<GuildCreateRequestView, GuildCreateResponse,
+                   decodeGuildCreateRequestView>(
+        PacketType::GuildCreateReq, PacketType::GuildCreateRes,
+        [this](PacketContext &context) {
+            GuildCreateResponse response;
+            response.message = "Malformed guild create payload";
+            rejectPacket(context, "guild_create_failed", response.message);
+            return response;
+        },
+        [this](PacketContext &context, const GuildCreateRequestView &request) {
+            return handleGuildCreate(context, request);
+        });
+
+    handlers_.bind<GuildJoinRequest, GuildJoinResponse, decodeGuildJoinRequest>(
+        PacketType::GuildJoinReq, PacketType::GuildJoinRes,
+        [this](PacketContext &context) {
+            GuildJoinResponse response;
+            response.message = "Malformed guild join payload";
+            rejectPacket(context, "guild_join_failed", response.message);
+            return response;
+        },
+        [this](PacketContext &context, const GuildJoinRequest &request) {
+            return handleGuildJoin(context, request);
+        });
+
+    handlers_.bind<GuildLeaveRequest, GuildLeaveResponse, decodeGuildLeaveRequest>(
+        PacketType::GuildLeaveReq, PacketType::GuildLeaveRes,
+        [this](PacketContext &context) {
+            GuildLeaveResponse response;
+            response.message = "Malformed guild leave payload";
+            rejectPacket(context, "guild_leave_failed", response.message);
+            return response;
+        },
+        [this](PacketContext &context, const GuildLeaveRequest &request) {
+            return handleGuildLeave(context, request);
+        });
+
+    handlers_.bind<ChatSendRequestView, ChatSendResponse, decodeChatSendRequestView>(
+        PacketType::ChatSendReq, PacketType::ChatSendRes,
+        [this](PacketContext &context) {
+            ChatSendResponse response;
+            response.message = "Malformed chat payload";
+            rejectPacket(context, "chat_send_failed", response.message);
+            return response;
+        },
+        [this](PacketContext &context, const ChatSendRequestView &request) {
+            return handleChatSend(context, request);
+        });
+}
 
-            std::string user_id;
-            if (!token_service_.validateToken(request.token, now, user_id)) {
-                SessionReconnectResponse response;
-                response.success = false;
-                response.message = "Invalid or expired token";
-                auto encoded = encodeSessionReconnectResponse(response);
-                metrics_.error_total += 1;
-                admin::LogFields fields = received_fields;
-                fields.reason = response.message;
-                logger_.log("warn", "session_reconnect_failed", response.message, fields);
-                return Codec::encode(
-                    static_cast<std::uint16_t>(PacketType::SessionReconnectRes),
-                    header.version,
-                    encoded);
-            }
+void Server::rejectPacket(PacketContext &context,
+                          const char *event,
+                          const std::string &reason) {
+    metrics_.error_total += 1;
+    context.failed = true;
+    context.fields.reason = reason;
+    logger_.log("warn", event, reason, context.fields);
+}
 
-            SessionId existing_id = 0;
-            std::uint64_t previous_last_seq = 0;
-            if (registry_.hasUser(user_id, existing_id) && existing_id != session.id()) {
-                auto existing_session = findSession(existing_id);
-                if (existing_session) {
-                    previous_last_seq = existing_session->lastSeq();
-                    party_service_.replaceMemberSession(existing_id, session.id());
-                    guild_service_.replaceMemberSession(existing_id, session.id());
-                    auto instance_it = session_instances_.find(existing_id);
-                    if (instance_it != session_instances_.end()) {
-                        session_instances_[session.id()] = instance_it->second;
-                        session_instances_.erase(instance_it);
-                    }
-                    auto character_it = session_characters_.find(existing_id);
-                    if (character_it != session_characters_.end()) {
-                        session_characters_[session.id()] = character_it->second;
-                        session_characters_.erase(character_it);
-                    }
-                    existing_session->clearUserContext();
-                    sessions_.erase(existing_id);
-                }
-                registry_.removeSession(existing_id);
-            }
+const Session::UserContext *Server::authenticatedUser(const PacketContext &context) const {
+    const auto &user = context.session.userContext();
+    return user.has_value() ? &user.value() : nullptr;
+}
 
-            Session::UserContext context{user_id, request.token};
-            session.attachUserContext(context);
-            if (!registry_.registerSession(session.id(), {user_id, request.token})) {
-                SessionReconnectResponse response;
-                response.success = false;
-                response.message = "User already logged in";
-                auto encoded = encodeSessionReconnectResponse(response);
-                metrics_.error_total += 1;
-                admin::LogFields fields = received_fields;
-                fields.user_id = user_id;
-                fields.reason = response.message;
-                logger_.log("warn", "session_reconnect_failed", response.message, fields);
-                return Codec::encode(
-                    static_cast<std::uint16_t>(PacketType::SessionReconnectRes),
-                    header.version,
-                    encoded);
-            }
+LoginResponse Server::handleLogin(PacketContext &context, const LoginRequestView &request) {
+    Session &session = context.session;
+    LoginResponse response;
+    if (request.password != "letmein") {
+        response.message = "Invalid credentials";
+        context.fields.user_id = request.user_id;
+        rejectPacket(context, "login_failed", response.message);
+        return response;
+    }
 
-            std::uint64_t restored_last_seq =
-                std::max<std::uint64_t>(request.last_seq, previous_last_seq);
-            session.setLastSeq(restored_last_seq);
+    SessionId existing_id = 0;
+    if (registry_.hasUser(request.user_id, existing_id) && existing_id != session.id()) {
+        response.message = "User already logged in";
+        context.fields.user_id = request.user_id;
+        rejectPacket(context, "login_failed", response.message);
+        return response;
+    }
 
-            SessionReconnectResponse response;
-            response.success = true;
-            response.message = "Reconnect accepted";
-            response.session_id = session.id();
-            response.resume_from_seq = static_cast<std::uint32_t>(restored_last_seq + 1);
-            auto encoded = encodeSessionReconnectResponse(response);
-            admin::LogFields fields = received_fields;
-            fields.user_id = user_id;
-            fields.reason = response.message;
-            logger_.log("info", "session_reconnected", response.message, fields);
-            return Codec::encode(
-                static_cast<std::uint16_t>(PacketType::SessionReconnectRes),
-                header.version,
-                encoded);
-        }
-        case PacketType::MatchReq: {
-            MatchRequest request;
-            if (!decodeMatchRequest(decoded_payload, request)) {
-                MatchFoundNotify response;
-                response.success = false;
-                response.code = "MALFORMED";
-                response.message = "Malformed match request";
-                auto encoded = encodeMatchFoundNotify(response);
-                metrics_.error_total += 1;
-                admin::LogFields fields = received_fields;
-                fields.reason = response.message;
-                logger_.log("warn", "match_request_failed", response.message, fields);
-                return Codec::encode(static_cast<std::uint16_t>(PacketType::MatchFoundNotify),
-                                     header.version,
-                                     encoded);
-            }
+    std::string user_id(request.user_id);
+    auto token = token_service_.issueToken(user_id, context.now);
+    Session::UserContext user_context{user_id, token};
+    session.attachUserContext(user_context);
+    session.setSigningKey(deriveSessionKey(signature_key_, token));
+    if (!registry_.registerSession(session.id(), {std::move(user_id), token})) {
+        response.message = "User already logged in";
+        context.fields.user_id = request.user_id;
+        rejectPacket(context, "login_failed", response.message);
+        return response;
+    }
 
-            const auto *user = session.userContext().has_value()
-                                   ? &session.userContext().value()
-                                   : nullptr;
-            if (!user) {
-                MatchFoundNotify response;
-                response.success = false;
-                response.code = "UNAUTHENTICATED";
-                response.message = "Authentication required";
-                auto encoded = encodeMatchFoundNotify(response);
-                metrics_.error_total += 1;
-                admin::LogFields fields = received_fields;
-                fields.reason = response.message;
-                logger_.log("warn", "match_request_failed", response.message, fields);
-                return Codec::encode(static_cast<std::uint16_t>(PacketType::MatchFoundNotify),
-                                     header.version,
-                                     encoded);
-            }
+    response.accepted = true;
+    response.token = token;
+    response.message = "Login accepted";
+    context.fields.user_id = request.user_id;
+    logger_.log("info", "login_success", response.message, context.fields);
+    return response;
+}
 
-            std::uint64_t party_id = request.party_id;
-            if (party_id == 0) {
-                auto party_for_member = party_service_.partyForMember(session.id());
-                if (!party_for_member) {
-                    MatchFoundNotify response;
-                    response.success = false;
-                    response.code = "NO_PARTY";
-                    response.message = "Not in a party";
-                    auto encoded = encodeMatchFoundNotify(response);
-                    metrics_.error_total += 1;
-                    admin::LogFields fields = received_fields;
-                    fields.user_id = user->user_id;
-                    fields.reason = response.message;
-                    logger_.log("warn", "match_request_failed", response.message, fields);
-                    return Codec::encode(
-                        static_cast<std::uint16_t>(PacketType::MatchFoundNotify),
-                        header.version,
-                        encoded);
-                }
-                party_id = *party_for_member;
-            }
+LogoutResponse Server::handleLogout(PacketContext &context, const LogoutRequest &) {
+    context.session.clearUserContext();
+    registry_.removeSession(context.session.id());
 
-            auto party_info = party_service_.getPartyInfo(party_id);
-            if (!party_info) {
-                MatchFoundNotify response;
-                response.success = false;
-                response.code = "PARTY_NOT_FOUND";
-                response.message = "Party not found";
-                auto encoded = encodeMatchFoundNotify(response);
-                metrics_.error_total += 1;
-                admin::LogFields fields = received_fields;
-                fields.user_id = user->user_id;
-                fields.reason = response.message;
-                logger_.log("warn", "match_request_failed", response.message, fields);
-                return Codec::encode(static_cast<std::uint16_t>(PacketType::MatchFoundNotify),
-                                     header.version,
-                                     encoded);
-            }
+    LogoutResponse response;
+    response.success = true;
+    response.message = "Logout successful";
+    logger_.log("info", "logout_success", response.message, context.fields);
+    return response;
+}
 
-            bool is_member = false;
-            for (const auto &member : party_info->members) {
-                if (member.session_id == session.id()) {
-                    is_member = true;
-                    break;
+SessionReconnectResponse Server::handleSessionReconnect(
+    PacketContext &context,
+    const SessionReconnectRequestView &request) {
+    Session &session = context.session;
+    SessionReconnectResponse response;
+    std::string user_id;
+    if (!token_service_.validateToken(request.token, context.now, user_id)) {
+        response.message = "Invalid or expired token";
+        rejectPacket(context, "session_reconnect_failed", response.message);
+        return response;
+    }
+
+    SessionId existing_id = 0;
+    std::uint64_t previous_last_seq = 0;
+    if (registry_.hasUser(user_id, existing_id) && existing_id != session.id()) {
+        auto existing_session = findSession(existing_id);
+        if (existing_session) {
+            previous_last_seq = existing_session->lastSeq();
+            party_service_.replaceMemberSession(existing_id, session.id());
+            guild_service_.replaceMemberSession(existing_id, session.id());
+            auto instance_it = session_instances_.find(existing_id);
+            if (instance_it != session_instances_.end()) {
+                if (auto *record = instance_manager_.find(instance_it->second)) {
+                    std::replace(record->member_sessions.begin(),
+                                 record->member_sessions.end(), existing_id, session.id());
                 }
+                session_instances_[session.id()] = instance_it->second;
+                session_instances_.erase(instance_it);
             }
-            if (!is_member) {
-                MatchFoundNotify response;
-                response.success = false;
-                response.code = "NOT_PARTY_MEMBER";
-                response.message = "Not authorized for match";
-                auto encoded = encodeMatchFoundNotify(response);
-                metrics_.error_total += 1;
-                admin::LogFields fields = received_fields;
-                fields.user_id = user->user_id;
-                fields.reason = response.message;
-                logger_.log("warn", "match_request_failed", response.message, fields);
-                return Codec::encode(static_cast<std::uint16_t>(PacketType::MatchFoundNotify),
-                                     header.version,
-                                     encoded);
+            auto character_it = session_characters_.find(existing_id);
+            if (character_it != session_characters_.end()) {
+                session_characters_[session.id()] = character_it->second;
+                session_characters_.erase(character_it);
             }
+            existing_session->clearUserContext();
+            sessions_.erase(existing_id);
+        }
+        registry_.removeSession(existing_id);
+    }
 
-            match::MatchCandidate candidate;
-            candidate.party_id = party_id;
-            candidate.mmr = 0;
-            candidate.party_size = party_info->members.size();
-            candidate.enqueue_time = now;
-            if (!match_queue_.enqueue(candidate)) {
-                MatchFoundNotify response;
-                response.success = false;
-                response.code = "QUEUE_REJECTED";
-                response.message = "Unable to enqueue for match";
-                auto encoded = encodeMatchFoundNotify(response);
-                metrics_.error_total += 1;
-                admin::LogFields fields = received_fields;
-                fields.user_id = user->user_id;
-                fields.reason = response.message;
-                logger_.log("warn", "match_request_failed", response.message, fields);
-                return Codec::encode(static_cast<std::uint16_t>(PacketType::MatchFoundNotify),
-                                     header.version,
-                                     encoded);
-            }
+    Session::UserContext user_context{user_id, std::string(request.token)};
+    session.attachUserContext(user_context);
+    session.setSigningKey(deriveSessionKey(signature_key_, request.token));
+    if (!registry_.registerSession(session.id(), user_context)) {
+        response.message = "User already logged in";
+        context.fields.user_id = user_id;
+        rejectPacket(context, "session_reconnect_failed", response.message);
+        return response;
+    }
 
-            std::optional<std::pair<match::MatchCandidate, match::MatchCandidate>> found =
-                match_queue_.findMatch(now);
-            std::vector<match::MatchCandidate> matches;
-            if (found) {
-                matches.push_back(found->first);
-                matches.push_back(found->second);
-            } else {
-                match_queue_.cancel(party_id);
-                matches.push_back(candidate);
-            }
+    std::uint64_t restored_last_seq =
+        std::max<std::uint64_t>(request.last_seq, previous_last_seq);
+    session.setLastSeq(restored_last_seq);
+
+    response.success = true;
+    response.message = "Reconnect accepted";
+    response.session_id = session.id();
+    response.resume_from_seq = static_cast<std::uint32_t>(restored_last_seq + 1);
+    context.fields.user_id = user_id;
+    context.fields.reason = response.message;
+    logger_.log("info", "session_reconnected", response.message, context.fields);
+    return response;
+}
 
-            std::optional<MatchFoundNotify> response_to_requester;
-            for (const auto &match_candidate : matches) {
-                auto instance_id = instance_manager_.createInstance(match_candidate.party_id,
-                                                                    party_service_);
-                if (!instance_id) {
-                    MatchFoundNotify response;
-                    response.success = false;
-                    response.code = "INSTANCE_FAILED";
-                    response.message = "Unable to create dungeon instance";
-                    metrics_.error_total += 1;
-                    admin::LogFields fields = received_fields;
-                    fields.user_id = user->user_id;
-                    fields.reason = response.message;
-                    logger_.log("warn", "match_request_failed", response.message, fields);
-                    return Codec::encode(
-                        static_cast<std::uint16_t>(PacketType::MatchFoundNotify),
-                        header.version,
-                        encodeMatchFoundNotify(response));
-                }
+MatchFoundNotify Server::handleMatch(PacketContext &context, const MatchRequestView &request) {
+    Session &session = context.session;
+    MatchFoundNotify response;
+    const auto *user = authenticatedUser(context);
+    if (!user) {
+        response.code = "UNAUTHENTICATED";
+        response.message = "Authentication required";
+        rejectPacket(context, "match_request_failed", response.message);
+        return response;
+    }
+    context.fields.user_id = user->user_id;
+
+    std::uint64_t party_id = request.party_id;
+    if (party_id == 0) {
+        auto party_for_member = party_service_.partyForMember(session.id());
+        if (!party_for_member) {
+            response.code = "NO_PARTY";
+            response.message = "Not in a party";
+            rejectPacket(context, "match_request_failed", response.message);
+            return response;
+        }
+        party_id = *party_for_member;
+    }
 
-                std::string ticket = admin::StructuredLogger::generateTraceId();
-                std::string endpoint = "dungeon.local:7777";
-                party_instances_[match_candidate.party_id] = *instance_id;
-                instance_tickets_[*instance_id] = ticket;
-                std::uniform_int_distribution<std::uint32_t> dist(
-                    1, std::numeric_limits<std::uint32_t>::max());
-                instance_seeds_[*instance_id] = dist(rng_);
-
-                MatchFoundNotify notify;
-                notify.success = true;
-                notify.code = "OK";
-                notify.message = "Match found";
-                notify.party_id = match_candidate.party_id;
-                notify.instance_id = *instance_id;
-                notify.endpoint = endpoint;
-                notify.ticket = ticket;
-
-                auto encoded = encodeMatchFoundNotify(notify);
-                auto frame = Codec::encode(
-                    static_cast<std::uint16_t>(PacketType::MatchFoundNotify),
-                    header.version,
-                    encoded);
-
-                auto notify_party_info = party_service_.getPartyInfo(match_candidate.party_id);
-                if (notify_party_info) {
-                    for (const auto &member : notify_party_info->members) {
-                        auto member_session = findSession(member.session_id);
-                        if (member_session) {
-                            session_instances_[member.session_id] = *instance_id;
-                            if (!(match_candidate.party_id == party_id &&
-                                  member.session_id == session.id())) {
-                                member_session->enqueueSend(
-                                    frame, std::chrono::steady_clock::now());
-                            }
-                        }
-                    }
-                }
+    auto party_info = party_service_.getPartyInfo(party_id);
+    if (!party_info) {
+        response.code = "PARTY_NOT_FOUND";
+        response.message = "Party not found";
+        rejectPacket(context, "match_request_failed", response.message);
+        return response;
+    }
 
-                if (match_candidate.party_id == party_id) {
-                    response_to_requester = notify;
-                }
-            }
+    bool is_member = false;
+    for (const auto &member : party_info->members) {
+        if (member.session_id == session.id()) {
+            is_member = true;
+            break;
+        }
+    }
+    if (!is_member) {
+        response.code = "NOT_PARTY_MEMBER";
+        response.message = "Not authorized for match";
+        rejectPacket(context, "match_request_failed", response.message);
+        return response;
+    }
 
-            if (!response_to_requester) {
-                MatchFoundNotify response;
-                response.success = false;
-                response.code = "MATCH_NOT_FOUND";
-                response.message = "Match not found";
-                metrics_.error_total += 1;
-                admin::LogFields fields = received_fields;
-                fields.user_id = user->user_id;
-                fields.reason = response.message;
-                logger_.log("warn", "match_request_failed", response.message, fields);
-                return Codec::encode(static_cast<std::uint16_t>(PacketType::MatchFoundNotify),
-                                     header.version,
-                                     encodeMatchFoundNotify(response));
-            }
+    match::MatchCandidate candidate;
+    candidate.party_id = party_id;
+    candidate.mmr = 0;
+    candidate.party_size = party_info->members.size();
+    candidate.enqueue_time = context.now;
+    if (!match_queue_.enqueue(candidate)) {
+        response.code = "QUEUE_REJECTED";
+        response.message = "Unable to enqueue for match";
+        rejectPacket(context, "match_request_failed", response.message);
+        return response;
+    }
+
+    std::optional<std::pair<match::MatchCandidate, match::MatchCandidate>> found =
+        match_queue_.findMatch(context.now);
+    std::vector<match::MatchCandidate> matches;
+    if (found) {
+        matches.push_back(found->first);
+        matches.push_back(found->second);
+    } else {
+        match_queue_.cancel(party_id);
+        matches.push_back(candidate);
+    }
 
-            admin::LogFields fields = received_fields;
-            fields.user_id = user->user_id;
-            fields.reason = response_to_requester->message;
-            logger_.log("info", "match_found", response_to_requester->message, fields);
-            return Codec::encode(static_cast<std::uint16_t>(PacketType::MatchFoundNotify),
-                                 header.version,
-                                 encodeMatchFoundNotify(*response_to_requester));
+    std::optional<MatchFoundNotify> response_to_requester;
+    for (const auto &match_candidate : matches) {
+        auto instance_id = instance_manager_.createInstance(match_candidate.party_id,
+                                                            party_service_);
+        if (!instance_id) {
+            response.code = "INSTANCE_FAILED";
+            response.message = "Unable to create dungeon instance";
+            rejectPacket(context, "match_request_failed", response.message);
+            return response;
         }
-        case PacketType::DungeonEnterReq: {
-            DungeonEnterRequest request;
-            if (!decodeDungeonEnterRequest(decoded_payload, request)) {
-                DungeonEnterResponse response;
-                response.success = false;
-                response.code = "MALFORMED";
-                response.message = "Malformed dungeon enter payload";
-                auto encoded = encodeDungeonEnterResponse(response);
-                metrics_.error_total += 1;
-                admin::LogFields fields = received_fields;
-                fields.reason = response.message;
-                logger_.log("warn", "dungeon_enter_failed", response.message, fields);
-                return Codec::encode(static_cast<std::uint16_t>(PacketType::DungeonEnterRes),
-                                     header.version,
-                                     encoded);
-            }
 
-            const auto *user = session.userContext().has_value()
-                                   ? &session.userContext().value()
-                                   : nullptr;
-            if (!user) {
-                DungeonEnterResponse response;
-                response.success = false;
-                response.code = "UNAUTHENTICATED";
-                response.message = "Authentication required";
-                auto encoded = encodeDungeonEnterResponse(response);
-                metrics_.error_total += 1;
-                admin::LogFields fields = received_fields;
-                fields.reason = response.message;
-                logger_.log("warn", "dungeon_enter_failed", response.message, fields);
-                return Codec::encode(static_cast<std::uint16_t>(PacketType::DungeonEnterRes),
-                                     header.version,
-                                     encoded);
+        dungeon::InstanceRecord *record = instance_manager_.find(*instance_id);
+        auto ticket = admin::StructuredLogger::generateTraceId().hex();
+        record->ticket.assign(ticket.data(), ticket.size());
+        std::string endpoint = "dungeon.local:7777";
+        std::uniform_int_distribution<std::uint32_t> dist(
+            1, std::numeric_limits<std::uint32_t>::max());
+        record->seed = dist(rng_);
+        instance_timers_.schedule(context.now + instance_ready_timeout_, *instance_id);
+
+        MatchFoundNotify notify;
+        notify.success = true;
+        notify.code = "OK";
+        notify.message = "Match found";
+        notify.party_id = match_candidate.party_id;
+        notify.instance_id = *instance_id;
+        notify.endpoint = endpoint;
+        notify.ticket = record->ticket;
+
+        // Encoded once; every member's send queue shares the same buffer.
+        PooledBuffer frame(wire::encodeFrame(PacketType::MatchFoundNotify,
+                                             context.header.version,
+                                             notify));
+
+        auto notify_party_info = party_service_.getPartyInfo(match_candidate.party_id);
+        if (notify_party_info) {
+            for (const auto &member : notify_party_info->members) {
+                auto member_session = findSession(member.session_id);
+                if (member_session) {
+                    session_instances_[member.session_id] = *instance_id;
+                    record->member_sessions.push_back(member.session_id);
+                    if (!(match_candidate.party_id == party_id &&
+                          member.session_id == session.id())) {
+                        sendTo(*member_session, frame);
+                    }
+                }
             }
+        }
 
-            auto instance = instance_manager_.getInstance(request.instance_id);
-            if (!instance) {
-                DungeonEnterResponse response;
-                response.success = false;
-                response.code = "INSTANCE_NOT_FOUND";
-                response.message = "Dungeon instance not found";
-                auto encoded = encodeDungeonEnterResponse(response);
-                metrics_.error_total += 1;
-                admin::LogFields fields = received_fields;
-                fields.user_id = user->user_id;
-                fields.reason = response.message;
-                logger_.log("warn", "dungeon_enter_failed", response.message, fields);
-                return Codec::encode(static_cast<std::uint16_t>(PacketType::DungeonEnterRes),
-                                     header.version,
-                                     encoded);
-            }
+        if (match_candidate.party_id == party_id) {
+            response_to_requester = notify;
+        }
+    }
 
-            auto ticket_it = instance_tickets_.find(request.instance_id);
-            if (ticket_it == instance_tickets_.end() || ticket_it->second != request.ticket) {
-                DungeonEnterResponse response;
-                response.success = false;
-                response.code = "INVALID_TICKET";
-                response.message = "Invalid enter ticket";
-                auto encoded = encodeDungeonEnterResponse(response);
-                metrics_.error_total += 1;
-                admin::LogFields fields = received_fields;
-                fields.user_id = user->user_id;
-                fields.reason = response.message;
-                logger_.log("warn", "dungeon_enter_failed", response.message, fields);
-                return Codec::encode(static_cast<std::uint16_t>(PacketType::DungeonEnterRes),
-                                     header.version,
-                                     encoded);
-            }
+    if (!response_to_requester) {
+        response.code = "MATCH_NOT_FOUND";
+        response.message = "Match not found";
+        rejectPacket(context, "match_request_failed", response.message);
+        return response;
+    }
 
-            auto party_info = party_service_.getPartyInfo(instance->party_id);
-            if (!party_info) {
-                DungeonEnterResponse response;
-                response.success = false;
-                response.code = "PARTY_NOT_FOUND";
-                response.message = "Party not found for instance";
-                auto encoded = encodeDungeonEnterResponse(response);
-                metrics_.error_total += 1;
-                admin::LogFields fields = received_fields;
-                fields.user_id = user->user_id;
-                fields.reason = response.message;
-                logger_.log("warn", "dungeon_enter_failed", response.message, fields);
-                return Codec::encode(static_cast<std::uint16_t>(PacketType::DungeonEnterRes),
-                                     header.version,
-                                     encoded);
-            }
+    context.fields.reason = response_to_requester->message;
+    logger_.log("info", "match_found", response_to_requester->message, context.fields);
+    return *response_to_requester;
+}
 
-            bool is_member = false;
-            for (const auto &member : party_info->members) {
-                if (member.session_id == session.id()) {
-                    is_member = true;
-                    break;
-                }
-            }
-            if (!is_member) {
-                DungeonEnterResponse response;
-                response.success = false;
-                response.code = "NOT_PARTY_MEMBER";
-                response.message = "Not authorized for instance";
-                auto encoded = encodeDungeonEnterResponse(response);
-                metrics_.error_total += 1;
-                admin::LogFields fields = received_fields;
-                fields.user_id = user->user_id;
-                fields.reason = response.message;
-                logger_.log("warn", "dungeon_enter_failed", response.message, fields);
-                return Codec::encode(static_cast<std::uint16_t>(PacketType::DungeonEnterRes),
-                                     header.version,
-                                     encoded);
-            }
+DungeonEnterResponse Server::handleDungeonEnter(PacketContext &context,
+                                                const DungeonEnterRequestView &request) {
+    Session &session = context.session;
+    DungeonEnterResponse response;
+    const auto *user = authenticatedUser(context);
+    if (!user) {
+        response.code = "UNAUTHENTICATED";
+        response.message = "Authentication required";
+        rejectPacket(context, "dungeon_enter_failed", response.message);
+        return response;
+    }
+    context.fields.user_id = user->user_id;
+
+    dungeon::InstanceRecord *instance = instance_manager_.find(request.instance_id);
+    if (!instance) {
+        response.code = "INSTANCE_NOT_FOUND";
+        response.message = "Dungeon instance not found";
+        rejectPacket(context, "dungeon_enter_failed", response.message);
+        return response;
+    }
 
-            if (!instance_manager_.requestTransition(request.instance_id,
-                                                     dungeon::InstanceState::Ready,
-                                                     party_service_)) {
-                DungeonEnterResponse response;
-                response.success = false;
-                response.code = "INVALID_STATE";
-                response.message = "Dungeon not ready to enter";
-                auto encoded = encodeDungeonEnterResponse(response);
-                metrics_.error_total += 1;
-                admin::LogFields fields = received_fields;
-                fields.user_id = user->user_id;
-                fields.reason = response.message;
-                logger_.log("warn", "dungeon_enter_failed", response.message, fields);
-                return Codec::encode(static_cast<std::uint16_t>(PacketType::DungeonEnterRes),
-                                     header.version,
-                                     encoded);
-            }
+    // Tickets die with the instance even while its record is still in grace.
+    if (instance->state == dungeon::InstanceState::Terminate ||
+        instance->ticket != request.ticket) {
+        response.code = "INVALID_TICKET";
+        response.message = "Invalid enter ticket";
+        rejectPacket(context, "dungeon_enter_failed", response.message);
+        return response;
+    }
 
-            session_characters_[session.id()] = request.char_id;
-            session_instances_[session.id()] = request.instance_id;
+    auto party_info = party_service_.getPartyInfo(instance->party_id);
+    if (!party_info) {
+        response.code = "PARTY_NOT_FOUND";
+        response.message = "Party not found for instance";
+        rejectPacket(context, "dungeon_enter_failed", response.message);
+        return response;
+    }
 
-            DungeonEnterResponse response;
-            response.success = true;
-            response.code = "OK";
-            response.message = "Dungeon entry accepted";
-            response.state = DungeonState::Ready;
-            response.seed = instance_seeds_[request.instance_id];
-            auto encoded = encodeDungeonEnterResponse(response);
-            admin::LogFields fields = received_fields;
-            fields.user_id = user->user_id;
-            fields.reason = response.message;
-            logger_.log("info", "dungeon_entered", response.message, fields);
-            return Codec::encode(static_cast<std::uint16_t>(PacketType::DungeonEnterRes),
-                                 header.version,
-                                 encoded);
+    bool is_member = false;
+    for (const auto &member : party_info->members) {
+        if (member.session_id == session.id()) {
+            is_member = true;
+            break;
         }
-        case PacketType::DungeonResultNotify: {
-            DungeonResultNotify request;
-            if (!decodeDungeonResultNotify(decoded_payload, request)) {
-                DungeonResultResponse response;
-                response.success = false;
-                response.code = "MALFORMED";
-                response.message = "Malformed dungeon result payload";
-                response.summary = "result rejected";
-                auto encoded = encodeDungeonResultResponse(response);
-                metrics_.error_total += 1;
-                admin::LogFields fields = received_fields;
-                fields.reason = response.message;
-                logger_.log("warn", "dungeon_result_failed", response.message, fields);
-                return Codec::encode(static_cast<std::uint16_t>(PacketType::DungeonResultRes),
-                                     header.version,
-                                     encoded);
-            }
+    }
+    if (!is_member) {
+        response.code = "NOT_PARTY_MEMBER";
+        response.message = "Not authorized for instance";
+        rejectPacket(context, "dungeon_enter_failed", response.message);
+        return response;
+    }
 
-            const auto *user = session.userContext().has_value()
-                                   ? &session.userContext().value()
-                                   : nullptr;
-            if (!user) {
-                DungeonResultResponse response;
-                response.success = false;
-                response.code = "UNAUTHENTICATED";
-                response.message = "Authentication required";
-                response.summary = "result rejected";
-                auto encoded = encodeDungeonResultResponse(response);
-                metrics_.error_total += 1;
-                admin::LogFields fields = received_fields;
-                fields.reason = response.message;
-                logger_.log("warn", "dungeon_result_failed", response.message, fields);
-                return Codec::encode(static_cast<std::uint16_t>(PacketType::DungeonResultRes),
-                                     header.version,
-                                     encoded);
-            }
+    if (!instance_manager_.requestTransition(request.instance_id,
+                                             dungeon::InstanceState::Ready,
+                                             party_service_)) {
+        response.code = "INVALID_STATE";
+        response.message = "Dungeon not ready to enter";
+        rejectPacket(context, "dungeon_enter_failed", response.message);
+        return response;
+    }
 
-            auto instance_it = session_instances_.find(session.id());
-            if (instance_it == session_instances_.end()) {
-                DungeonResultResponse response;
-                response.success = false;
-                response.code = "NO_INSTANCE";
-                response.message = "No active dungeon instance";
-                response.summary = "result rejected";
-                auto encoded = encodeDungeonResultResponse(response);
-                metrics_.error_total += 1;
-                admin::LogFields fields = received_fields;
-                fields.user_id = user->user_id;
-                fields.reason = response.message;
-                logger_.log("warn", "dungeon_result_failed", response.message, fields);
-                return Codec::encode(static_cast<std::uint16_t>(PacketType::DungeonResultRes),
-                                     header.version,
-                                     encoded);
-            }
+    session_characters_[session.id()] = request.char_id;
+    session_instances_[session.id()] = request.instance_id;
+    auto &members = instance->member_sessions;
+    if (std::find(members.begin(), members.end(), session.id()) == members.end()) {
+        members.push_back(session.id());
+    }
 
-            auto instance = instance_manager_.getInstance(instance_it->second);
-            if (!instance) {
-                DungeonResultResponse response;
-                response.success = false;
-                response.code = "INSTANCE_NOT_FOUND";
-                response.message = "Dungeon instance missing";
-                response.summary = "result rejected";
-                auto encoded = encodeDungeonResultResponse(response);
-                metrics_.error_total += 1;
-                admin::LogFields fields = received_fields;
-                fields.user_id = user->user_id;
-                fields.reason = response.message;
-                logger_.log("warn", "dungeon_result_failed", response.message, fields);
-                return Codec::encode(static_cast<std::uint16_t>(PacketType::DungeonResultRes),
-                                     header.version,
-                                     encoded);
-            }
+    response.success = true;
+    response.code = "OK";
+    response.message = "Dungeon entry accepted";
+    response.state = DungeonState::Ready;
+    response.seed = instance->seed;
+    context.fields.reason = response.message;
+    logger_.log("info", "dungeon_entered", response.message, context.fields);
+    return response;
+}
 
-            auto grant_it = instance_reward_grants_.find(instance_it->second);
-            if (grant_it != instance_reward_grants_.end()) {
-                DungeonResultResponse response;
-                response.success = false;
-                response.code = "REWARD_DUPLICATE";
-                response.message = "Reward grant already processed";
-                response.summary = "result rejected";
-                auto encoded = encodeDungeonResultResponse(response);
-                metrics_.error_total += 1;
-                admin::LogFields fields = received_fields;
-                fields.user_id = user->user_id;
-                fields.reason = response.message;
-                logger_.log("warn", "dungeon_result_failed", response.message, fields);
-                return Codec::encode(static_cast<std::uint16_t>(PacketType::DungeonResultRes),
-                                     header.version,
-                                     encoded);
-            }
+DungeonResultResponse Server::handleDungeonResult(PacketContext &context,
+                                                  const DungeonResultNotify &request) {
+    Session &session = context.session;
+    DungeonResultResponse response;
+    response.summary = "result rejected";
+    const auto *user = authenticatedUser(context);
+    if (!user) {
+        response.code = "UNAUTHENTICATED";
+        response.message = "Authentication required";
+        rejectPacket(context, "dungeon_result_failed", response.message);
+        return response;
+    }
+    context.fields.user_id = user->user_id;
+
+    auto instance_it = session_instances_.find(session.id());
+    if (instance_it == session_instances_.end()) {
+        response.code = "NO_INSTANCE";
+        response.message = "No active dungeon instance";
+        rejectPacket(context, "dungeon_result_failed", response.message);
+        return response;
+    }
 
-            dungeon::InstanceState next_state =
-                request.result == DungeonResultType::Clear ? dungeon::InstanceState::Clear
-                                                           : dungeon::InstanceState::Fail;
-            if (!instance_manager_.requestTransition(instance_it->second,
-                                                     next_state,
-                                                     party_service_)) {
-                DungeonResultResponse response;
-                response.success = false;
-                response.code = "INVALID_STATE";
-                response.message = "Dungeon state transition rejected";
-                response.summary = "result rejected";
-                auto encoded = encodeDungeonResultResponse(response);
-                metrics_.error_total += 1;
-                admin::LogFields fields = received_fields;
-                fields.user_id = user->user_id;
-                fields.reason = response.message;
-                logger_.log("warn", "dungeon_result_failed", response.message, fields);
-                return Codec::encode(static_cast<std::uint16_t>(PacketType::DungeonResultRes),
-                                     header.version,
-                                     encoded);
-            }
+    // A run's grant id is its instance id; ids carry a generation, so a
+    // reused slot never inherits the previous run's grant.
+    reward::GrantId grant_id = instance_it->second;
+    auto grant_status = reward_grants_.status(grant_id);
+    dungeon::InstanceRecord *instance = instance_manager_.find(instance_it->second);
+    if (!instance && grant_status != reward::GrantStatus::Completed) {
+        response.code = "INSTANCE_NOT_FOUND";
+        response.message = "Dungeon instance missing";
+        rejectPacket(context, "dungeon_result_failed", response.message);
+        return response;
+    }
 
-            auto char_it = session_characters_.find(session.id());
-            if (char_it == session_characters_.end()) {
-                DungeonResultResponse response;
-                response.success = false;
-                response.code = "CHAR_NOT_SET";
-                response.message = "Character not registered for session";
-                response.summary = "result rejected";
-                auto encoded = encodeDungeonResultResponse(response);
-                metrics_.error_total += 1;
-                admin::LogFields fields = received_fields;
-                fields.user_id = user->user_id;
-                fields.reason = response.message;
-                logger_.log("warn", "dungeon_result_failed", response.message, fields);
-                return Codec::encode(static_cast<std::uint16_t>(PacketType::DungeonResultRes),
-                                     header.version,
-                                     encoded);
-            }
+    // The store still knows the grant after the record is reclaimed.
+    if (grant_status == reward::GrantStatus::Completed || instance->reward_grant) {
+        response.code = "REWARD_DUPLICATE";
+        response.message = "Reward grant already processed";
+        rejectPacket(context, "dungeon_result_failed", response.message);
+        return response;
+    }
 
-            std::vector<reward::RewardItem> reward_items;
-            reward_items.reserve(request.rewards.size());
-            for (const auto &item : request.rewards) {
-                reward_items.push_back(reward::RewardItem{item.item_id, item.count});
-            }
+    dungeon::InstanceState next_state =
+        request.result == DungeonResultType::Clear ? dungeon::InstanceState::Clear
+                                                   : dungeon::InstanceState::Fail;
+    if (!instance_manager_.requestTransition(instance_it->second,
+                                             next_state,
+                                             party_service_)) {
+        response.code = "INVALID_STATE";
+        response.message = "Dungeon state transition rejected";
+        rejectPacket(context, "dungeon_result_failed", response.message);
+        return response;
+    }
 
-            reward::Inventory reward_inventory;
-            auto grant_id = next_reward_grant_id_++;
-            auto grant_result = reward_service_.grantRewardsDetailed(
-                reward_inventory, grant_id, reward_items);
-            if (grant_result != reward::RewardService::GrantResult::Completed) {
-                DungeonResultResponse response;
-                response.success = false;
-                response.code = grant_result == reward::RewardService::GrantResult::Duplicate
-                                    ? "REWARD_DUPLICATE"
-                                    : "REWARD_FAILED";
-                response.message = grant_result == reward::RewardService::GrantResult::Duplicate
-                                       ? "Reward grant already processed"
-                                       : "Reward grant failed";
-                response.summary = "result rejected";
-                auto encoded = encodeDungeonResultResponse(response);
-                metrics_.error_total += 1;
-                admin::LogFields fields = received_fields;
-                fields.user_id = user->user_id;
-                fields.reason = response.message;
-                logger_.log("warn", "dungeon_result_failed", response.message, fields);
-                return Codec::encode(static_cast<std::uint16_t>(PacketType::DungeonResultRes),
-                                     header.version,
-                                     encoded);
-            }
+    auto char_it = session_characters_.find(session.id());
+    if (char_it == session_characters_.end()) {
+        response.code = "CHAR_NOT_SET";
+        response.message = "Character not registered for session";
+        rejectPacket(context, "dungeon_result_failed", response.message);
+        return response;
+    }
 
-            bool inventory_ok = true;
-            auto inventory_tx = inventory_storage_->beginTransaction();
-            for (const auto &item : request.rewards) {
-                if (!inventory_storage_->addItem(char_it->second,
-                                                 item.item_id,
-                                                 item.count,
-                                                 "dungeon_reward")) {
-                    inventory_ok = false;
-                    break;
-                }
-            }
-            if (!inventory_ok) {
-                inventory_storage_->rollbackTransaction(inventory_tx);
-                DungeonResultResponse response;
-                response.success = false;
-                response.code = "INVENTORY_FAILED";
-                response.message = "Failed to update inventory";
-                response.summary = "result rejected";
-                auto encoded = encodeDungeonResultResponse(response);
-                metrics_.error_total += 1;
-                admin::LogFields fields = received_fields;
-                fields.user_id = user->user_id;
-                fields.reason = response.message;
-                logger_.log("warn", "dungeon_result_failed", response.message, fields);
-                return Codec::encode(static_cast<std::uint16_t>(PacketType::DungeonResultRes),
-                                     header.version,
-                                     encoded);
-            }
-            inventory_storage_->commitTransaction(inventory_tx);
+    std::vector<reward::RewardItem> reward_items;
+    reward_items.reserve(request.rewards.size());
+    for (const auto &item : request.rewards) {
+        reward_items.push_back(reward::RewardItem{item.item_id, item.count});
+    }
 
-            DungeonResultResponse response;
-            response.success = true;
-            response.code = "OK";
-            response.message = "Dungeon result recorded";
-            response.summary = "result recorded";
-            instance_reward_grants_[instance_it->second] = grant_id;
-            auto encoded = encodeDungeonResultResponse(response);
-            admin::LogFields fields = received_fields;
-            fields.user_id = user->user_id;
-            fields.reason = response.message;
-            logger_.log("info", "dungeon_result_recorded", response.message, fields);
-            return Codec::encode(static_cast<std::uint16_t>(PacketType::DungeonResultRes),
-                                 header.version,
-                                 encoded);
-        }
-        case PacketType::InventoryUpdateNotify: {
-            InventoryUpdateNotify request;
-            if (!decodeInventoryUpdateNotify(decoded_payload, request)) {
-                InventoryUpdateResponse response;
-                response.success = false;
-                response.code = "MALFORMED";
-                response.message = "Malformed inventory update payload";
-                auto encoded = encodeInventoryUpdateResponse(response);
-                metrics_.error_total += 1;
-                admin::LogFields fields = received_fields;
-                fields.reason = response.message;
-                logger_.log("warn", "inventory_update_failed", response.message, fields);
-                return Codec::encode(
-                    static_cast<std::uint16_t>(PacketType::InventoryUpdateRes),
-                    header.version,
-                    encoded);
-            }
+    reward::Inventory reward_inventory;
+    reward_inventory.attachGrantStore(
+        &reward_grants_,
+        wall_started_at_ + std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                               context.now - started_at_));
+    auto grant_result = reward_service_.grantRewardsDetailed(
+        reward_inventory, grant_id, reward_items);
+    if (grant_result != reward::RewardService::GrantResult::Completed) {
+        bool duplicate = grant_result == reward::RewardService::GrantResult::Duplicate;
+        response.code = duplicate ? "REWARD_DUPLICATE" : "REWARD_FAILED";
+        response.message =
+            duplicate ? "Reward grant already processed" : "Reward grant failed";
+        rejectPacket(context, "dungeon_result_failed", response.message);
+        return response;
+    }
 
-            const auto *user = session.userContext().has_value()
-                                   ? &session.userContext().value()
-                                   : nullptr;
-            if (!user) {
-                InventoryUpdateResponse response;
-                response.success = false;
-                response.code = "UNAUTHENTICATED";
-                response.message = "Authentication required";
-                auto encoded = encodeInventoryUpdateResponse(response);
-                metrics_.error_total += 1;
-                admin::LogFields fields = received_fields;
-                fields.reason = response.message;
-                logger_.log("warn", "inventory_update_failed", response.message, fields);
-                return Codec::encode(
-                    static_cast<std::uint16_t>(PacketType::InventoryUpdateRes),
-                    header.version,
-                    encoded);
-            }
+    bool inventory_ok = true;
+    auto inventory_tx = inventory_storage_->beginTransaction();
+    for (const auto &item : request.rewards) {
+        if (!inventory_storage_->addItem(char_it->second,
+                                         item.item_id,
+                                         item.count,
+                                         "dungeon_reward")) {
+            inventory_ok = false;
+            break;
+        }
+    }
+    if (!inventory_ok) {
+        inventory_storage_->rollbackTransaction(inventory_tx);
+        response.code = "INVENTORY_FAILED";
+        response.message = "Failed to update inventory";
+        rejectPacket(context, "dungeon_result_failed", response.message);
+        return response;
+    }
+    inventory_storage_->commitTransaction(inventory_tx);
+
+    response.success = true;
+    response.code = "OK";
+    response.message = "Dungeon result recorded";
+    response.summary = "result recorded";
+    instance->reward_grant = grant_id;
+    // The run is over; the record lingers for the grace period so duplicate
+    // results are still recognised, then the slot is reused.
+    instance_manager_.terminateInstance(instance_it->second, context.now);
+    context.fields.reason = response.message;
+    logger_.log("info", "dungeon_result_recorded", response.message, context.fields);
+    return response;
+}
 
-            bool inventory_ok = true;
-            auto inventory_tx = inventory_storage_->beginTransaction();
-            for (const auto &item : request.items) {
-                if (!inventory_storage_->addItem(request.char_id,
-                                                 item.item_id,
-                                                 item.count,
-                                                 "inventory_update")) {
-                    inventory_ok = false;
-                    break;
-                }
-            }
-            if (!inventory_ok) {
-                inventory_storage_->rollbackTransaction(inventory_tx);
-            } else {
-                inventory_storage_->commitTransaction(inventory_tx);
-            }
+InventoryUpdateResponse Server::handleInventoryUpdate(
+    PacketContext &context,
+    const InventoryUpdateNotify &request) {
+    InventoryUpdateResponse response;
+    const auto *user = authenticatedUser(context);
+    if (!user) {
+        response.code = "UNAUTHENTICATED";
+        response.message = "Authentication required";
+        rejectPacket(context, "inventory_update_failed", response.message);
+        return response;
+    }
 
-            InventoryUpdateResponse response;
-            response.success = inventory_ok;
-            response.code = inventory_ok ? "OK" : "INVENTORY_FAILED";
-            response.message =
-                inventory_ok ? "Inventory updated" : "Failed to update inventory";
-            response.inventory_version =
-                inventory_storage_->changeLog(request.char_id).size();
-            auto encoded = encodeInventoryUpdateResponse(response);
-            admin::LogFields fields = received_fields;
-            fields.user_id = user->user_id;
-            fields.reason = response.message;
-            logger_.log(response.success ? "info" : "warn",
-                        response.success ? "inventory_updated"
-                                         : "inventory_update_failed",
-                        response.message,
-                        fields);
-            return Codec::encode(
-                static_cast<std::uint16_t>(PacketType::InventoryUpdateRes),
-                header.version,
-                encoded);
+    bool inventory_ok = true;
+    auto inventory_tx = inventory_storage_->beginTransaction();
+    for (const auto &item : request.items) {
+        if (!inventory_storage_->addItem(request.char_id,
+                                         item.item_id,
+                                         item.count,
+                                         "inventory_update")) {
+            inventory_ok = false;
+            break;
         }
-        case PacketType::GuildCreateReq: {
-            GuildCreateRequest request;
-            if (!decodeGuildCreateRequest(decoded_payload, request)) {
-                GuildCreateResponse response;
-                response.success = false;
-                response.message = "Malformed guild create payload";
-                auto encoded = encodeGuildCreateResponse(response);
-                metrics_.error_total += 1;
-                admin::LogFields fields = received_fields;
-                fields.reason = response.message;
-                logger_.log("warn", "guild_create_failed", response.message, fields);
-                return Codec::encode(static_cast<std::uint16_t>(PacketType::GuildCreateRes),
-                                     header.version,
-                                     encoded);
-            }
+    }
+    if (!inventory_ok) {
+        inventory_storage_->rollbackTransaction(inventory_tx);
+    } else {
+        inventory_storage_->commitTransaction(inventory_tx);
+    }
 
-            const auto *user = session.userContext().has_value()
-                                   ? &session.userContext().value()
-                                   : nullptr;
-            if (!user) {
-                GuildCreateResponse response;
-                response.success = false;
-                response.message = "Authentication required";
-                auto encoded = encodeGuildCreateResponse(response);
-                metrics_.error_total += 1;
-                admin::LogFields fields = received_fields;
-                fields.reason = response.message;
-                logger_.log("warn", "guild_create_failed", response.message, fields);
-                return Codec::encode(static_cast<std::uint16_t>(PacketType::GuildCreateRes),
-                                     header.version,
-                                     encoded);
-            }
+    response.success = inventory_ok;
+    response.code = inventory_ok ? "OK" : "INVENTORY_FAILED";
+    response.message = inventory_ok ? "Inventory updated" : "Failed to update inventory";
+    response.inventory_version = inventory_storage_->changeLog(request.char_id).size();
+    context.failed = !response.success;
+    context.fields.user_id = user->user_id;
+    context.fields.reason = response.message;
+    logger_.log(response.success ? "info" : "warn",
+                response.success ? "inventory_updated" : "inventory_update_failed",
+                response.message,
+                context.fields);
+    return response;
+}
 
-            auto guild_id = guild_service_.createGuild(session.id(),
-                                                       user->user_id,
-                                                       request.guild_name);
-            GuildCreateResponse response;
-            if (!guild_id) {
-                response.success = false;
-                response.message = "Unable to create guild";
-                metrics_.error_total += 1;
-            } else {
-                response.success = true;
-                response.guild_id = *guild_id;
-                response.message = "Guild created";
-            }
-            auto encoded = encodeGuildCreateResponse(response);
-            admin::LogFields fields = received_fields;
-            fields.user_id = user->user_id;
-            fields.reason = response.message;
-            logger_.log(response.success ? "info" : "warn",
-                        response.success ? "guild_created" : "guild_create_failed",
-                        response.message, fields);
-            return Codec::encode(static_cast<std::uint16_t>(PacketType::GuildCreateRes),
-                                 header.version,
-                                 encoded);
-        }
-        case PacketType::GuildJoinReq: {
-            GuildJoinRequest request;
-            if (!decodeGuildJoinRequest(decoded_payload, request)) {
-                GuildJoinResponse response;
-                response.success = false;
-                response.message = "Malformed guild join payload";
-                auto encoded = encodeGuildJoinResponse(response);
-                metrics_.error_total += 1;
-                admin::LogFields fields = received_fields;
-                fields.reason = response.message;
-                logger_.log("warn", "guild_join_failed", response.message, fields);
-                return Codec::encode(static_cast<std::uint16_t>(PacketType::GuildJoinRes),
-                                     header.version,
-                                     encoded);
-            }
+GuildCreateResponse Server::handleGuildCreate(PacketContext &context,
+                                              const GuildCreateRequestView &request) {
+    GuildCreateResponse response;
+    const auto *user = authenticatedUser(context);
+    if (!user) {
+        response.message = "Authentication required";
+        rejectPacket(context, "guild_create_failed", response.message);
+        return response;
+    }
 
-            const auto *user = session.userContext().has_value()
-                                   ? &session.userContext().value()
-                                   : nullptr;
-            if (!user) {
-                GuildJoinResponse response;
-                response.success = false;
-                response.message = "Authentication required";
-                auto encoded = encodeGuildJoinResponse(response);
-                metrics_.error_total += 1;
-                admin::LogFields fields = received_fields;
-                fields.reason = response.message;
-                logger_.log("warn", "guild_join_failed", response.message, fields);
-                return Codec::encode(static_cast<std::uint16_t>(PacketType::GuildJoinRes),
-                                     header.version,
-                                     encoded);
-            }
+    auto guild_id = guild_service_.createGuild(context.session.id(),
+                                               user->user_id,
+                                               std::string(request.guild_name));
+    if (!guild_id) {
+        response.success = false;
+        response.message = "Unable to create guild";
+        metrics_.error_total += 1;
+    } else {
+        response.success = true;
+        response.guild_id = *guild_id;
+        response.message = "Guild created";
+    }
+    context.failed = !response.success;
+    context.fields.user_id = user->user_id;
+    context.fields.reason = response.message;
+    logger_.log(response.success ? "info" : "warn",
+                response.success ? "guild_created" : "guild_create_failed",
+                response.message, context.fields);
+    return response;
+}
 
-            GuildJoinResponse response;
-            response.success = guild_service_.joinGuild(request.guild_id,
-                                                        session.id(),
-                                                        user->user_id);
-            response.message = response.success ? "Joined guild" : "Unable to join guild";
-            auto encoded = encodeGuildJoinResponse(response);
-            admin::LogFields fields = received_fields;
-            fields.user_id = user->user_id;
-            fields.reason = response.message;
-            logger_.log(response.success ? "info" : "warn",
-                        response.success ? "guild_joined" : "guild_join_failed",
-                        response.message, fields);
-            return Codec::encode(static_cast<std::uint16_t>(PacketType::GuildJoinRes),
-                                 header.version,
-                                 encoded);
+GuildJoinResponse Server::handleGuildJoin(PacketContext &context,
+                                          const GuildJoinRequest &request) {
+    GuildJoinResponse response;
+    const auto *user = authenticatedUser(context);
+    if (!user) {
+        response.message = "Authentication required";
+        rejectPacket(context, "guild_join_failed", response.message);
+        return response;
+    }
+
+    response.success = guild_service_.joinGuild(request.guild_id,
+                                                context.session.id(),
+                                                user->user_id);
+    response.message = response.success ? "Joined guild" : "Unable to join guild";
+    context.failed = !response.success;
+    context.fields.user_id = user->user_id;
+    context.fields.reason = response.message;
+    logger_.log(response.success ? "info" : "warn",
+                response.success ? "guild_joined" : "guild_join_failed",
+                response.message, context.fields);
+    return response;
+}
+
+GuildLeaveResponse Server::handleGuildLeave(PacketContext &context,
+                                            const GuildLeaveRequest &request) {
+    GuildLeaveResponse response;
+    const auto *user = authenticatedUser(context);
+    if (!user) {
+        response.message = "Authentication required";
+        rejectPacket(context, "guild_leave_failed", response.message);
+        return response;
+    }
+    context.fields.user_id = user->user_id;
+
+    auto guild_id = request.guild_id;
+    if (guild_id == 0) {
+        auto current = guild_service_.guildForMember(context.session.id());
+        if (!current) {
+            response.message = "Not in a guild";
+            rejectPacket(context, "guild_leave_failed", response.message);
+            return response;
         }
-        case PacketType::GuildLeaveReq: {
-            GuildLeaveRequest request;
-            if (!decodeGuildLeaveRequest(decoded_payload, request)) {
-                GuildLeaveResponse response;
-                response.success = false;
-                response.message = "Malformed guild leave payload";
-                auto encoded = encodeGuildLeaveResponse(response);
-                metrics_.error_total += 1;
-                admin::LogFields fields = received_fields;
-                fields.reason = response.message;
-                logger_.log("warn", "guild_leave_failed", response.message, fields);
-                return Codec::encode(static_cast<std::uint16_t>(PacketType::GuildLeaveRes),
-                                     header.version,
-                                     encoded);
-            }
+        guild_id = *current;
+    }
 
-            const auto *user = session.userContext().has_value()
-                                   ? &session.userContext().value()
-                                   : nullptr;
-            if (!user) {
-                GuildLeaveResponse response;
-                response.success = false;
-                response.message = "Authentication required";
-                auto encoded = encodeGuildLeaveResponse(response);
-                metrics_.error_total += 1;
-                admin::LogFields fields = received_fields;
-                fields.reason = response.message;
-                logger_.log("warn", "guild_leave_failed", response.message, fields);
-                return Codec::encode(static_cast<std::uint16_t>(PacketType::GuildLeaveRes),
-                                     header.version,
-                                     encoded);
-            }
+    response.success = guild_service_.leaveGuild(guild_id, context.session.id());
+    response.message = response.success ? "Left guild" : "Unable to leave guild";
+    context.failed = !response.success;
+    context.fields.reason = response.message;
+    logger_.log(response.success ? "info" : "warn",
+                response.success ? "guild_left" : "guild_leave_failed",
+                response.message, context.fields);
+    return response;
+}
 
-            auto guild_id = request.guild_id;
-            if (guild_id == 0) {
-                auto current = guild_service_.guildForMember(session.id());
-                if (!current) {
-                    GuildLeaveResponse response;
-                    response.success = false;
-                    response.message = "Not in a guild";
-                    auto encoded = encodeGuildLeaveResponse(response);
-                    metrics_.error_total += 1;
-                    admin::LogFields fields = received_fields;
-                    fields.user_id = user->user_id;
-                    fields.reason = response.message;
-                    logger_.log("warn", "guild_leave_failed", response.message, fields);
-                    return Codec::encode(static_cast<std::uint16_t>(PacketType::GuildLeaveRes),
-                                         header.version,
-                                         encoded);
-                }
-                guild_id = *current;
-            }
+ChatSendResponse Server::handleChatSend(PacketContext &context,
+                                        const ChatSendRequestView &request) {
+    Session &session = context.session;
+    ChatSendResponse response;
+    const auto *user = authenticatedUser(context);
+    if (!user) {
+        response.message = "Authentication required";
+        rejectPacket(context, "chat_send_failed", response.message);
+        return response;
+    }
+    context.fields.user_id = user->user_id;
 
-            GuildLeaveResponse response;
-            response.success = guild_service_.leaveGuild(guild_id, session.id());
-            response.message = response.success ? "Left guild" : "Unable to leave guild";
-            auto encoded = encodeGuildLeaveResponse(response);
-            admin::LogFields fields = received_fields;
-            fields.user_id = user->user_id;
-            fields.reason = response.message;
-            logger_.log(response.success ? "info" : "warn",
-                        response.success ? "guild_left" : "guild_leave_failed",
-                        response.message, fields);
-            return Codec::encode(static_cast<std::uint16_t>(PacketType::GuildLeaveRes),
-                                 header.version,
-                                 encoded);
-        }
-        case PacketType::ChatSendReq: {
-            ChatSendRequest request;
-            if (!decodeChatSendRequest(decoded_payload, request)) {
-                ChatSendResponse response;
-                response.success = false;
-                response.message = "Malformed chat payload";
-                auto encoded = encodeChatSendResponse(response);
-                metrics_.error_total += 1;
-                admin::LogFields fields = received_fields;
-                fields.reason = response.message;
-                logger_.log("warn", "chat_send_failed", response.message, fields);
-                return Codec::encode(static_cast<std::uint16_t>(PacketType::ChatSendRes),
-                                     header.version,
-                                     encoded);
-            }
+    if (request.message.empty()) {
+        response.message = "Chat message cannot be empty";
+        rejectPacket(context, "chat_send_failed", response.message);
+        return response;
+    }
 
-            const auto *user = session.userContext().has_value()
-                                   ? &session.userContext().value()
-                                   : nullptr;
-            if (!user) {
-                ChatSendResponse response;
+    std::vector<SessionId> recipients;
+    if (request.channel == ChatChannel::Global) {
+        recipients.reserve(sessions_.size());
+        for (const auto &entry : sessions_) {
+            if (entry.second->userContext().has_value()) {
+                recipients.push_back(entry.first);
+            }
+        }
+        response.success = chat_service_.sendGlobal(session.id(),
+                                                    user->user_id,
+                                                    std::string(request.message),
+                                                    recipients);
+        response.message = response.success ? "Global chat delivered"
+                                            : "Failed to deliver global chat";
+    } else if (request.channel == ChatChannel::Party) {
+        std::uint64_t party_id = request.party_id;
+        bool can_send = true;
+        if (party_id == 0) {
+            auto current_party = party_service_.partyForMember(session.id());
+            if (!current_party) {
                 response.success = false;
-                response.message = "Authentication required";
-                auto encoded = encodeChatSendResponse(response);
+                response.message = "Not in a party";
+                can_send = false;
                 metrics_.error_total += 1;
-                admin::LogFields fields = received_fields;
-                fields.reason = response.message;
-                logger_.log("warn", "chat_send_failed", response.message, fields);
-                return Codec::encode(static_cast<std::uint16_t>(PacketType::ChatSendRes),
-                                     header.version,
-                                     encoded);
+            } else {
+                party_id = *current_party;
             }
-
-            if (request.message.empty()) {
-                ChatSendResponse response;
+        }
+        if (can_send) {
+            auto party_info = party_service_.getPartyInfo(party_id);
+            if (!party_info) {
                 response.success = false;
-                response.message = "Chat message cannot be empty";
-                auto encoded = encodeChatSendResponse(response);
+                response.message = "Party not found";
                 metrics_.error_total += 1;
-                admin::LogFields fields = received_fields;
-                fields.user_id = user->user_id;
-                fields.reason = response.message;
-                logger_.log("warn", "chat_send_failed", response.message, fields);
-                return Codec::encode(static_cast<std::uint16_t>(PacketType::ChatSendRes),
-                                     header.version,
-                                     encoded);
-            }
-
-            ChatSendResponse response;
-            std::vector<SessionId> recipients;
-            if (request.channel == ChatChannel::Global) {
-                recipients.reserve(sessions_.size());
-                for (const auto &entry : sessions_) {
-                    if (entry.second->userContext().has_value()) {
-                        recipients.push_back(entry.first);
-                    }
-                }
-                response.success = chat_service_.sendGlobal(session.id(),
-                                                            user->user_id,
-                                                            request.message,
-                                                            recipients);
-                response.message = response.success ? "Global chat delivered"
-                                                    : "Failed to deliver global chat";
-            } else if (request.channel == ChatChannel::Party) {
-                std::uint64_t party_id = request.party_id;
-                bool can_send = true;
-                if (party_id == 0) {
-                    auto current_party = party_service_.partyForMember(session.id());
-                    if (!current_party) {
-                        response.success = false;
-                        response.message = "Not in a party";
-                        can_send = false;
-                        metrics_.error_total += 1;
-                    } else {
-                        party_id = *current_party;
+            } else {
+                bool is_member = false;
+                recipients.reserve(party_info->members.size());
+                for (const auto &member : party_info->members) {
+                    if (member.session_id == session.id()) {
+                        is_member = true;
                     }
+                    recipients.push_back(member.session_id);
                 }
-                if (can_send) {
-                    auto party_info = party_service_.getPartyInfo(party_id);
-                    if (!party_info) {
-                        response.success = false;
-                        response.message = "Party not found";
+                if (!is_member) {
+                    response.success = false;
+                    response.message = "Not authorized for party chat";
+                    metrics_.error_total += 1;
+                } else {
+                    response.success = chat_service_.sendParty(session.id(),
+                                                              user->user_id,
+                                                              party_id,
+                                                              std::string(request.message),
+                                                              recipients);
+                    response.message = response.success
+                                           ? "Party chat delivered"
+                                           : "Failed to deliver party chat";
+                    if (!response.success) {
                         metrics_.error_total += 1;
-                    } else {
-                        bool is_member = false;
-                        recipients.reserve(party_info->members.size());
-                        for (const auto &member : party_info->members) {
-                            if (member.session_id == session.id()) {
-                                is_member = true;
-                            }
-                            recipients.push_back(member.session_id);
-                        }
-                        if (!is_member) {
-                            response.success = false;
-                            response.message = "Not authorized for party chat";
-                            metrics_.error_total += 1;
-                        } else {
-                            response.success = chat_service_.sendParty(session.id(),
-                                                                      user->user_id,
-                                                                      party_id,
-                                                                      request.message,
-                                                                      recipients);
-                            response.message = response.success
-                                                   ? "Party chat delivered"
-                                                   : "Failed to deliver party chat";
-                            if (!response.success) {
-                                metrics_.error_total += 1;
-                            }
-                        }
                     }
                 }
-            } else {
-                response.success = false;
-                response.message = "Unknown chat channel";
-                metrics_.error_total += 1;
             }
-
-            auto encoded = encodeChatSendResponse(response);
-            admin::LogFields fields = received_fields;
-            fields.user_id = user->user_id;
-            fields.reason = response.message;
-            logger_.log(response.success ? "info" : "warn",
-                        response.success ? "chat_sent" : "chat_send_failed",
-                        response.message, fields);
-            return Codec::encode(static_cast<std::uint16_t>(PacketType::ChatSendRes),
-                                 header.version,
-                                 encoded);
         }
-        default:
-            metrics_.error_total += 1;
-            admin::LogFields fields = received_fields;
-            fields.reason = "Unknown packet type";
-            logger_.log("warn", "packet_unhandled", "Unknown packet type",
-                        fields);
-            break;
+    } else {
+        response.success = false;
+        response.message = "Unknown chat channel";
+        metrics_.error_total += 1;
     }
 
-    return std::nullopt;
+    context.failed = !response.success;
+    context.fields.reason = response.message;
+    logger_.log(response.success ? "info" : "warn",
+                response.success ? "chat_sent" : "chat_send_failed",
+                response.message, context.fields);
+    return response;
 }
 
 const Session::UserContext *Server::sessionUser(SessionId id) const {
@@ -1429,9 +1224,55 @@ dungeon::InstanceManager &Server::instanceManager() {
     return instance_manager_;
 }
 
+const reward::GrantIdempotencyStore &Server::rewardGrants() const {
+    return reward_grants_;
+}
+
+void Server::setInstanceReadyTimeout(std::chrono::milliseconds timeout) {
+    instance_ready_timeout_ = timeout;
+}
+
+void Server::setInstanceReclaimGrace(std::chrono::milliseconds grace) {
+    instance_manager_.setReclaimGrace(grace);
+}
+
+void Server::sendTo(Session &session, std::vector<std::uint8_t> frame) {
+    sendTo(session, PooledBuffer(std::move(frame)));
+}
+
+void Server::sendTo(Session &session, PooledBuffer frame) {
+    // Overflow with OverflowPolicy::Disconnect drops the session on the next
+    // tick rather than waiting for its timeout timer.
+    if (!session.enqueueSend(std::move(frame)) &&
+        !session.connected()) {
+        pending_disconnects_.push_back(session.id());
+    }
+}
+
+void Server::expireInstance(dungeon::InstanceId instance_id,
+                            std::chrono::steady_clock::time_point now) {
+    const dungeon::InstanceRecord *instance = instance_manager_.find(instance_id);
+    if (!instance || instance->state != dungeon::InstanceState::Waiting) {
+        return;
+    }
+    instance_manager_.terminateInstance(instance_id, now);
+    admin::LogFields fields;
+    fields.reason = "Party did not enter before ready timeout";
+    logger_.log("warn", "instance_ready_timeout", "Dungeon instance expired", fields);
+}
+
+void Server::releaseInstance(const dungeon::InstanceRecord &record) {
+    for (auto session_id : record.member_sessions) {
+        auto it = session_instances_.find(session_id);
+        if (it != session_instances_.end() && it->second == record.id) {
+            session_instances_.erase(it);
+        }
+    }
+}
+
 bool Server::forceDisconnect(SessionId id,
                              const std::string &reason,
-                             const std::string &request_trace_id) {
+                             admin::TraceId request_trace_id) {
     auto session = findSession(id);
     if (!session) {
         admin::LogFields fields;
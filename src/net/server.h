@@ -7,18 +7,25 @@
 #include "match/match_queue.h"
 #include "net/auth.h"
 #include "net/codec.h"
+#include "net/packet_registry.h"
 #include "net/protocol.h"
 #include "net/security.h"
 #include "net/session.h"
+#include "net/string_hash.h"
+#include "net/timer_wheel.h"
 #include "party/party.h"
 #include "dungeon/instance_manager.h"
+#include "reward/grant_store.h"
 #include "reward/reward_service.h"
 
 #include <chrono>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <random>
+#include <span>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 
 namespace net {
@@ -49,6 +56,8 @@ public:
     void removeSession(SessionId id);
     std::shared_ptr<Session> findSession(SessionId id) const;
 
+    // Fires due session timeouts, instance ready timeouts and party invite
+    // expiry; cost scales with the number of expired timers, not sessions.
     void tick(std::chrono::steady_clock::time_point now);
     std::size_t sessionCount() const;
     Metrics metrics() const;
@@ -57,15 +66,36 @@ public:
     std::optional<std::vector<std::uint8_t>> handlePacket(
         Session &session,
         const FrameHeader &header,
-        const std::vector<std::uint8_t> &payload,
+        std::span<const std::uint8_t> payload,
         std::chrono::steady_clock::time_point now);
+    // Runs the security checks for the frames from one read before any of
+    // them is queued: signatures are verified in runs sharing a key, then seqs
+    // go through the replay window in arrival order. Rejected frames are
+    // logged and counted here. Login, reconnect and logout change the key
+    // (and reconnect the replay window) for what follows, so screening stops
+    // after the first of them; returns how many leading frames were screened,
+    // and the caller passes the rest again once those are dispatched.
+    std::size_t screenFrames(Session &session, std::span<InboundFrame> frames);
+    // Dispatches a payload that already passed screenFrames, skipping the
+    // signature and replay checks. A payload shorter than the security
+    // header cannot have passed and gets the full checks instead.
+    std::optional<std::vector<std::uint8_t>> handleScreenedPacket(
+        Session &session,
+        const FrameHeader &header,
+        std::span<const std::uint8_t> payload,
+        std::chrono::steady_clock::time_point now);
+    std::optional<PacketTypeMetrics> packetMetrics(PacketType type) const;
 
     const Session::UserContext *sessionUser(SessionId id) const;
     party::PartyService &partyService();
     dungeon::InstanceManager &instanceManager();
+    const reward::GrantIdempotencyStore &rewardGrants() const;
+    void setInstanceReadyTimeout(std::chrono::milliseconds timeout);
+    // How long a terminated instance stays resolvable before it is reclaimed.
+    void setInstanceReclaimGrace(std::chrono::milliseconds grace);
     bool forceDisconnect(SessionId id,
                          const std::string &reason,
-                         const std::string &request_trace_id);
+                         admin::TraceId request_trace_id);
 
 private:
     using SessionRecord = Session::UserContext;
@@ -75,13 +105,55 @@ private:
         bool registerSession(SessionId id, SessionRecord record);
         void removeSession(SessionId id);
         const SessionRecord *find(SessionId id) const;
-        bool hasUser(const std::string &user_id, SessionId &session_id) const;
+        bool hasUser(std::string_view user_id, SessionId &session_id) const;
 
     private:
         std::unordered_map<SessionId, SessionRecord> records_;
-        std::unordered_map<std::string, SessionId> active_users_;
+        std::unordered_map<std::string, SessionId, StringHash, std::equal_to<>> active_users_;
     };
 
+    void registerHandlers();
+    bool securityEnabled() const;
+    // Login and reconnect requests are signed with the server key; everything
+    // else uses the session key once login has derived one.
+    const SignatureKey &verificationKey(const Session &session,
+                                        const FrameHeader &header) const;
+    void screen(Session &session, std::span<InboundFrame> frames);
+    void logRejectedFrame(const InboundFrame &frame, admin::LogFields fields);
+    std::optional<std::vector<std::uint8_t>> processPacket(
+        Session &session,
+        InboundFrame frame,
+        bool screened,
+        std::chrono::steady_clock::time_point now);
+    void sendTo(Session &session, std::vector<std::uint8_t> frame);
+    void sendTo(Session &session, PooledBuffer frame);
+    void expireInstance(dungeon::InstanceId instance_id,
+                        std::chrono::steady_clock::time_point now);
+    void releaseInstance(const dungeon::InstanceRecord &record);
+    void rejectPacket(PacketContext &context, const char *event, const std::string &reason);
+    const Session::UserContext *authenticatedUser(const PacketContext &context) const;
+
+    LoginResponse handleLogin(PacketContext &context, const LoginRequestView &request);
+    LogoutResponse handleLogout(PacketContext &context, const LogoutRequest &request);
+    SessionReconnectResponse handleSessionReconnect(
+        PacketContext &context,
+        const SessionReconnectRequestView &request);
+    MatchFoundNotify handleMatch(PacketContext &context, const MatchRequestView &request);
+    DungeonEnterResponse handleDungeonEnter(PacketContext &context,
+                                            const DungeonEnterRequestView &request);
+    DungeonResultResponse handleDungeonResult(PacketContext &context,
+                                              const DungeonResultNotify &request);
+    InventoryUpdateResponse handleInventoryUpdate(PacketContext &context,
+                                                  const InventoryUpdateNotify &request);
+    GuildCreateResponse handleGuildCreate(PacketContext &context,
+                                          const GuildCreateRequestView &request);
+    GuildJoinResponse handleGuildJoin(PacketContext &context,
+                                      const GuildJoinRequest &request);
+    GuildLeaveResponse handleGuildLeave(PacketContext &context,
+                                        const GuildLeaveRequest &request);
+    ChatSendResponse handleChatSend(PacketContext &context,
+                                    const ChatSendRequestView &request);
+
     SessionId next_id_{1};
     std::unordered_map<SessionId, std::shared_ptr<Session>> sessions_;
     SessionRegistry registry_;
@@ -93,18 +165,27 @@ private:
     dungeon::InstanceManager instance_manager_;
     std::shared_ptr<inventory::InventoryStorage> inventory_storage_;
     reward::RewardService reward_service_;
-    std::unordered_map<party::PartyId, dungeon::InstanceId> party_instances_;
-    std::unordered_map<dungeon::InstanceId, std::string> instance_tickets_;
-    std::unordered_map<dungeon::InstanceId, std::uint32_t> instance_seeds_;
-    std::unordered_map<dungeon::InstanceId, reward::GrantId> instance_reward_grants_;
+    // Dedup state for reward grants over the last day, keyed by instance id,
+    // so it outlives the instance record. The per-result Inventory records
+    // its grant here instead of in its own map.
+    reward::GrantIdempotencyStore reward_grants_;
     std::unordered_map<SessionId, dungeon::InstanceId> session_instances_;
     std::unordered_map<SessionId, std::uint64_t> session_characters_;
     std::mt19937 rng_{std::random_device{}()};
-    std::uint64_t next_reward_grant_id_{1};
     Metrics metrics_{};
     std::chrono::steady_clock::time_point started_at_;
+    // Pairs with started_at_ to turn packet times into wall-clock times.
+    std::chrono::system_clock::time_point wall_started_at_{std::chrono::system_clock::now()};
     admin::StructuredLogger logger_{};
     SecurityPolicy security_policy_{};
+    // Key schedule derived once from security_policy_.hmac_key.
+    SignatureKey signature_key_;
+    PacketHandlerRegistry handlers_;
+    TimerWheel session_timers_;
+    TimerWheel instance_timers_;
+    std::vector<TimerWheel::Key> expired_timers_;
+    std::vector<SessionId> pending_disconnects_;
+    std::chrono::milliseconds instance_ready_timeout_{std::chrono::seconds{60}};
 };
 
 }  // namespace net
@@ -1,8 +1,10 @@
 #include "net/session.h"
 
 #include "admin/logging.h"
+#include "net/clock.h"
 
 #include <algorithm>
+#include <utility>
 
 namespace net {
 namespace {
@@ -15,7 +17,8 @@ admin::StructuredLogger &sessionLogger() {
 }  // namespace
 
 bool TokenBucket::consume(double amount, std::chrono::steady_clock::time_point now) {
-    auto elapsed = std::chrono::duration<double>(now - last_refill).count();
+    // The cached loop clock may lag an explicit `now` passed by another caller.
+    auto elapsed = std::max(0.0, std::chrono::duration<double>(now - last_refill).count());
     tokens = std::min(capacity, tokens + elapsed * refill_rate);
     last_refill = now;
     if (tokens >= amount) {
@@ -25,18 +28,57 @@ bool TokenBucket::consume(double amount, std::chrono::steady_clock::time_point n
     return false;
 }
 
+bool SendQueue::empty() const {
+    return count_ == 0;
+}
+
+std::size_t SendQueue::size() const {
+    return count_;
+}
+
+PooledBuffer &SendQueue::front() {
+    return slots_[head_];
+}
+
+void SendQueue::push_back(PooledBuffer frame) {
+    if (count_ == slots_.size()) {
+        grow();
+    }
+    slots_[(head_ + count_) & (slots_.size() - 1)] = std::move(frame);
+    ++count_;
+}
+
+void SendQueue::pop_front() {
+    slots_[head_] = PooledBuffer();
+    head_ = (head_ + 1) & (slots_.size() - 1);
+    --count_;
+}
+
+void SendQueue::grow() {
+    // Power-of-two capacity so the ring index is a mask.
+    std::vector<PooledBuffer> grown(slots_.empty() ? 4 : slots_.size() * 2);
+    for (std::size_t i = 0; i < count_; ++i) {
+        grown[i] = std::move(slots_[(head_ + i) & (slots_.size() - 1)]);
+    }
+    slots_ = std::move(grown);
+    head_ = 0;
+}
+
 Session::Session(SessionId id, const SessionConfig &config,
                  std::chrono::steady_clock::time_point now)
-    : id_(id),
-      config_(config),
+    : last_receive_(now),
+      last_activity_(now),
+      last_heartbeat_(now),
+      timeout_(config.timeout),
+      send_queue_limit_bytes_(config.send_queue_limit_bytes),
       bucket_{config.rate_limit_capacity,
               config.rate_limit_capacity,
               config.rate_limit_refill_per_sec,
               now},
-      last_activity_(now),
-      last_receive_(now),
-      last_heartbeat_(now),
-      trace_id_(admin::StructuredLogger::generateTraceId()) {}
+      id_(id),
+      config_(config),
+      trace_id_(admin::StructuredLogger::generateTraceId()),
+      replay_window_(config.replay_window_bits) {}
 
 Session::SessionId Session::id() const {
     return id_;
@@ -51,8 +93,20 @@ void Session::onReceive(std::chrono::steady_clock::time_point now) {
     last_activity_ = now;
 }
 
+bool Session::enqueueSend(std::vector<std::uint8_t> payload) {
+    return enqueueSend(PooledBuffer(std::move(payload)), CoarseClock::now());
+}
+
 bool Session::enqueueSend(std::vector<std::uint8_t> payload,
                           std::chrono::steady_clock::time_point now) {
+    return enqueueSend(PooledBuffer(std::move(payload)), now);
+}
+
+bool Session::enqueueSend(PooledBuffer payload) {
+    return enqueueSend(std::move(payload), CoarseClock::now());
+}
+
+bool Session::enqueueSend(PooledBuffer payload, std::chrono::steady_clock::time_point now) {
     if (!connected_) {
         return false;
     }
@@ -68,13 +122,13 @@ bool Session::enqueueSend(std::vector<std::uint8_t> payload,
     }
 
     std::size_t next_size = send_queue_bytes_ + payload.size();
-    if (next_size > config_.send_queue_limit_bytes) {
+    if (next_size > send_queue_limit_bytes_) {
         if (config_.overflow_policy == OverflowPolicy::Disconnect) {
             disconnect("send queue overflow");
             return false;
         }
         if (config_.overflow_policy == OverflowPolicy::DropOldest) {
-            while (!send_queue_.empty() && next_size > config_.send_queue_limit_bytes) {
+            while (!send_queue_.empty() && next_size > send_queue_limit_bytes_) {
                 next_size -= send_queue_.front().size();
                 send_queue_bytes_ -= send_queue_.front().size();
                 send_queue_.pop_front();
@@ -109,13 +163,17 @@ bool Session::tick(std::chrono::steady_clock::time_point now) {
         return false;
     }
 
-    if ((now - last_receive_) >= config_.timeout) {
+    if ((now - last_receive_) >= timeout_) {
         disconnect("timeout");
     }
 
     return connected_;
 }
 
+std::chrono::steady_clock::time_point Session::timeoutDeadline() const {
+    return last_receive_ + timeout_;
+}
+
 std::size_t Session::queuedBytes() const {
     return send_queue_bytes_;
 }
@@ -126,13 +184,22 @@ void Session::attachUserContext(UserContext context) {
 
 void Session::clearUserContext() {
     user_context_.reset();
+    signing_key_.reset();
 }
 
 const std::optional<Session::UserContext> &Session::userContext() const {
     return user_context_;
 }
 
-const std::string &Session::traceId() const {
+void Session::setSigningKey(SignatureKey key) {
+    signing_key_ = std::move(key);
+}
+
+const SignatureKey *Session::signingKey() const {
+    return signing_key_ ? &*signing_key_ : nullptr;
+}
+
+admin::TraceId Session::traceId() const {
     return trace_id_;
 }
 
@@ -145,25 +212,15 @@ std::uint16_t Session::protocolVersion() const {
 }
 
 void Session::setLastSeq(std::uint64_t last_seq) {
-    last_seq_ = last_seq;
+    replay_window_.reset(last_seq);
 }
 
 std::uint64_t Session::lastSeq() const {
-    return last_seq_;
+    return replay_window_.highest();
 }
 
-bool Session::recordNonce(std::uint64_t nonce) {
-    if (nonce_cache_.find(nonce) != nonce_cache_.end()) {
-        return false;
-    }
-    nonce_cache_.insert(nonce);
-    nonce_order_.push_back(nonce);
-    while (nonce_order_.size() > config_.nonce_cache_limit) {
-        auto oldest = nonce_order_.front();
-        nonce_order_.pop_front();
-        nonce_cache_.erase(oldest);
-    }
-    return true;
+bool Session::acceptSeq(std::uint64_t seq) {
+    return replay_window_.accept(seq);
 }
 
 bool Session::tlsEstablished() const {
@@ -180,6 +237,17 @@ std::chrono::milliseconds Session::tlsHandshakeTime() const {
 }
 
 bool Session::dequeueSend(std::vector<std::uint8_t> &payload) {
+    if (send_queue_.empty()) {
+        return false;
+    }
+    BufferPool::release(std::move(payload));
+    send_queue_bytes_ -= send_queue_.front().size();
+    payload = send_queue_.front().take();
+    send_queue_.pop_front();
+    return true;
+}
+
+bool Session::dequeueSend(PooledBuffer &payload) {
     if (send_queue_.empty()) {
         return false;
     }
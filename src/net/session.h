@@ -1,10 +1,13 @@
 #pragma once
 
+#include "admin/logging.h"
+#include "net/buffer_pool.h"
+#include "net/replay_window.h"
+#include "net/security.h"
+
 #include <chrono>
 #include <cstdint>
-#include <deque>
 #include <optional>
-#include <unordered_set>
 #include <string>
 #include <vector>
 
@@ -23,7 +26,8 @@ struct SessionConfig {
     OverflowPolicy overflow_policy{OverflowPolicy::DropNewest};
     double rate_limit_capacity{65536.0};
     double rate_limit_refill_per_sec{32768.0};
-    std::size_t nonce_cache_limit{64};
+    // Secured packets may arrive this many sequence numbers out of order.
+    std::size_t replay_window_bits{64};
 };
 
 struct TokenBucket {
@@ -35,7 +39,28 @@ struct TokenBucket {
     bool consume(double amount, std::chrono::steady_clock::time_point now);
 };
 
-class Session {
+// FIFO of queued frames on a ring that is allocated on the first push and
+// kept afterwards. std::deque would allocate its map and first chunk as soon
+// as an idle session is constructed.
+class SendQueue {
+public:
+    bool empty() const;
+    std::size_t size() const;
+    PooledBuffer &front();
+    void push_back(PooledBuffer frame);
+    void pop_front();
+
+private:
+    void grow();
+
+    std::vector<PooledBuffer> slots_;
+    std::size_t head_{0};
+    std::size_t count_{0};
+};
+
+// Fields are grouped by access: the first cache lines hold what tick,
+// onReceive and enqueueSend touch; identity and security state follow.
+class alignas(64) Session {
 public:
     using SessionId = std::uint64_t;
 
@@ -53,47 +78,66 @@ public:
     void onReceive(std::chrono::steady_clock::time_point now);
     bool enqueueSend(std::vector<std::uint8_t> payload,
                      std::chrono::steady_clock::time_point now);
+    // Uses the loop's cached clock; for fan-out paths that have no `now`.
+    bool enqueueSend(std::vector<std::uint8_t> payload);
+    // Shared frames: the queue holds a reference instead of a copy.
+    bool enqueueSend(PooledBuffer payload, std::chrono::steady_clock::time_point now);
+    bool enqueueSend(PooledBuffer payload);
 
     bool shouldSendHeartbeat(std::chrono::steady_clock::time_point now) const;
     void markHeartbeatSent(std::chrono::steady_clock::time_point now);
 
     bool tick(std::chrono::steady_clock::time_point now);
+    std::chrono::steady_clock::time_point timeoutDeadline() const;
     std::size_t queuedBytes() const;
 
     void attachUserContext(UserContext context);
+    // Also drops the session signing key.
     void clearUserContext();
     const std::optional<UserContext> &userContext() const;
-    const std::string &traceId() const;
+    void setSigningKey(SignatureKey key);
+    // Key derived from the login token, or null before login.
+    const SignatureKey *signingKey() const;
+    admin::TraceId traceId() const;
     void setProtocolVersion(std::uint16_t version);
     std::uint16_t protocolVersion() const;
+    // Restarts replay tracking as if every seq up to `last_seq` was received.
     void setLastSeq(std::uint64_t last_seq);
+    // Highest seq accepted so far.
     std::uint64_t lastSeq() const;
-    bool recordNonce(std::uint64_t nonce);
+    // False for a replayed seq or one older than the replay window.
+    bool acceptSeq(std::uint64_t seq);
     bool tlsEstablished() const;
     void markTlsEstablished(std::chrono::milliseconds handshake_time);
     std::chrono::milliseconds tlsHandshakeTime() const;
+    // The previous contents of `payload` are returned to BufferPool.
     bool dequeueSend(std::vector<std::uint8_t> &payload);
+    bool dequeueSend(PooledBuffer &payload);
 
 private:
     void disconnect(const char *reason);
 
-    SessionId id_;
-    SessionConfig config_;
-    TokenBucket bucket_;
+    // Hot.
     bool connected_{true};
-    std::chrono::steady_clock::time_point last_activity_;
     std::chrono::steady_clock::time_point last_receive_;
+    std::chrono::steady_clock::time_point last_activity_;
     std::chrono::steady_clock::time_point last_heartbeat_;
-    std::deque<std::vector<std::uint8_t>> send_queue_;
+    std::chrono::milliseconds timeout_;
     std::size_t send_queue_bytes_{0};
-    std::optional<UserContext> user_context_;
-    std::string trace_id_;
+    std::size_t send_queue_limit_bytes_;
+    TokenBucket bucket_;
+    SendQueue send_queue_;
+
+    // Cold.
+    SessionId id_;
+    SessionConfig config_;
     std::uint16_t protocol_version_{0};
-    std::uint64_t last_seq_{0};
-    std::unordered_set<std::uint64_t> nonce_cache_;
-    std::deque<std::uint64_t> nonce_order_;
     bool tls_established_{false};
     std::chrono::milliseconds tls_handshake_time_{0};
+    admin::TraceId trace_id_;
+    std::optional<UserContext> user_context_;
+    std::optional<SignatureKey> signing_key_;
+    ReplayWindow replay_window_;
 };
 
 }  // namespace net
@@ -0,0 +1,79 @@
+#include "net/session_pool.h"
+
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace net {
+namespace {
+
+struct FreeSlot {
+    FreeSlot *next;
+};
+
+struct Arena {
+    std::mutex mutex;
+    std::vector<std::byte *> slabs;
+    // Intrusive free list threaded through the released slots.
+    FreeSlot *free_list{nullptr};
+    // Unused tail of the newest slab.
+    std::byte *fresh{nullptr};
+    std::byte *fresh_end{nullptr};
+    SessionPoolStats stats;
+};
+
+// Leaked: sessions may still be released during static destruction.
+Arena &arena() {
+    static Arena *instance = new Arena();
+    return *instance;
+}
+
+}  // namespace
+
+void *SessionPool::allocate() {
+    auto &shared = arena();
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    shared.stats.allocations += 1;
+    shared.stats.live += 1;
+    if (shared.free_list) {
+        FreeSlot *slot = shared.free_list;
+        shared.free_list = slot->next;
+        shared.stats.reused += 1;
+        return slot;
+    }
+
+    if (shared.fresh == shared.fresh_end) {
+        auto *slab = static_cast<std::byte *>(
+            ::operator new(kSlotSize * kSlotsPerSlab, std::align_val_t{kSlotAlign}));
+        shared.slabs.push_back(slab);
+        shared.stats.slabs += 1;
+        shared.fresh = slab;
+        shared.fresh_end = slab + kSlotSize * kSlotsPerSlab;
+    }
+    void *slot = shared.fresh;
+    shared.fresh += kSlotSize;
+    return slot;
+}
+
+void SessionPool::deallocate(void *slot) {
+    auto &shared = arena();
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    auto *free_slot = static_cast<FreeSlot *>(slot);
+    free_slot->next = shared.free_list;
+    shared.free_list = free_slot;
+    shared.stats.live -= 1;
+}
+
+SessionPoolStats SessionPool::stats() {
+    auto &shared = arena();
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    return shared.stats;
+}
+
+std::shared_ptr<Session> makeSession(Session::SessionId id,
+                                     const SessionConfig &config,
+                                     std::chrono::steady_clock::time_point now) {
+    return std::allocate_shared<Session>(SessionAllocator<Session>{}, id, config, now);
+}
+
+}  // namespace net
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "net/session.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace net {
+
+struct SessionPoolStats {
+    std::uint64_t slabs{0};
+    std::uint64_t live{0};
+    std::uint64_t allocations{0};
+    // Allocations served from a previously freed slot.
+    std::uint64_t reused{0};
+};
+
+// Slab allocator for sessions. allocate_shared places the control block and
+// the Session in one fixed-size slot, so a connect costs no heap allocation
+// once the slabs are warm. Freed slots are reused most-recent first, which
+// keeps live sessions packed into few slabs. Slabs are never returned.
+class SessionPool {
+public:
+    static constexpr std::size_t kSlotAlign = alignof(Session);
+    // Room for the Session plus a shared_ptr control block header.
+    static constexpr std::size_t kSlotSize =
+        (sizeof(Session) + 2 * kSlotAlign - 1) / kSlotAlign * kSlotAlign;
+    static constexpr std::size_t kSlotsPerSlab = 256;
+
+    static void *allocate();
+    static void deallocate(void *slot);
+    static SessionPoolStats stats();
+};
+
+template <typename T>
+class SessionAllocator {
+public:
+    using value_type = T;
+
+    SessionAllocator() = default;
+    template <typename U>
+    SessionAllocator(const SessionAllocator<U> &) {}
+
+    T *allocate(std::size_t count) {
+        if (!fitsSlot(count)) {
+            return std::allocator<T>().allocate(count);
+        }
+        return static_cast<T *>(SessionPool::allocate());
+    }
+
+    void deallocate(T *pointer, std::size_t count) {
+        if (!fitsSlot(count)) {
+            std::allocator<T>().deallocate(pointer, count);
+            return;
+        }
+        SessionPool::deallocate(pointer);
+    }
+
+    template <typename U>
+    bool operator==(const SessionAllocator<U> &) const {
+        return true;
+    }
+
+private:
+    static bool fitsSlot(std::size_t count) {
+        return count == 1 && sizeof(T) <= SessionPool::kSlotSize &&
+               alignof(T) <= SessionPool::kSlotAlign;
+    }
+};
+
+std::shared_ptr<Session> makeSession(Session::SessionId id,
+                                     const SessionConfig &config,
+                                     std::chrono::steady_clock::time_point now);
+
+}  // namespace net
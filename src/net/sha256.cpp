@@ -0,0 +1,242 @@
+#include "net/sha256.h"
+
+#include "common/cpu_dispatch.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(DUNGEONHUB_HAVE_SHA_NI)
+#include <immintrin.h>
+#endif
+
+namespace net {
+namespace {
+
+using CompressFn = void (*)(std::uint32_t *state, const std::uint8_t *data,
+                           std::size_t blocks);
+
+constexpr std::array<std::uint32_t, 64> kRoundConstants{
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4,
+    0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe,
+    0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f,
+    0x4a7484aa, 0x5cb0a9dc, 0x76f988da, 0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+    0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc,
+    0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070, 0x19a4c116,
+    0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7,
+    0xc67178f2};
+
+constexpr Sha256::State kInitialState{0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                                      0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+
+std::uint32_t rotr(std::uint32_t value, int bits) {
+    return (value >> bits) | (value << (32 - bits));
+}
+
+void compressPortable(std::uint32_t *state, const std::uint8_t *data, std::size_t blocks) {
+    for (; blocks > 0; --blocks, data += Sha256::kBlockSize) {
+        std::array<std::uint32_t, 64> w{};
+        for (std::size_t i = 0; i < 16; ++i) {
+            w[i] = (static_cast<std::uint32_t>(data[i * 4]) << 24) |
+                   (static_cast<std::uint32_t>(data[i * 4 + 1]) << 16) |
+                   (static_cast<std::uint32_t>(data[i * 4 + 2]) << 8) |
+                   static_cast<std::uint32_t>(data[i * 4 + 3]);
+        }
+        for (std::size_t i = 16; i < 64; ++i) {
+            auto s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            auto s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        auto a = state[0], b = state[1], c = state[2], d = state[3];
+        auto e = state[4], f = state[5], g = state[6], h = state[7];
+        for (std::size_t i = 0; i < 64; ++i) {
+            auto s1 = rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25);
+            auto choose = (e & f) ^ (~e & g);
+            auto t1 = h + s1 + choose + kRoundConstants[i] + w[i];
+            auto s0 = rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22);
+            auto majority = (a & b) ^ (a & c) ^ (b & c);
+            auto t2 = s0 + majority;
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+    }
+}
+
+#if defined(DUNGEONHUB_HAVE_SHA_NI)
+
+// Four rounds per step: sha256rnds2 runs two, so the scheduled words are
+// shuffled down for the second half. The message schedule keeps only the
+// last four word groups in registers; the loop must be fully unrolled for
+// w[] to stay in registers.
+__attribute__((target("sha,sse4.1"))) void compressShaNi(std::uint32_t *state,
+                                                         const std::uint8_t *data,
+                                                         std::size_t blocks) {
+    const __m128i byte_swap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    __m128i tmp = _mm_loadu_si128(reinterpret_cast<const __m128i *>(state));
+    __m128i state1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(state + 4));
+    tmp = _mm_shuffle_epi32(tmp, 0xB1);                // CDAB
+    state1 = _mm_shuffle_epi32(state1, 0x1B);          // EFGH
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);  // ABEF
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0);       // CDGH
+
+    for (; blocks > 0; --blocks, data += Sha256::kBlockSize) {
+        const __m128i abef_save = state0;
+        const __m128i cdgh_save = state1;
+        __m128i w[4];
+#pragma GCC unroll 16
+        for (int i = 0; i < 16; ++i) {
+            __m128i &current = w[i & 3];
+            if (i < 4) {
+                current = _mm_shuffle_epi8(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i * 16)),
+                    byte_swap);
+            } else {
+                const __m128i &previous = w[(i + 3) & 3];
+                __m128i next = _mm_sha256msg1_epu32(current, w[(i + 1) & 3]);
+                next = _mm_add_epi32(next, _mm_alignr_epi8(previous, w[(i + 2) & 3], 4));
+                current = _mm_sha256msg2_epu32(next, previous);
+            }
+            __m128i message = _mm_add_epi32(
+                current,
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(&kRoundConstants[i * 4])));
+            state1 = _mm_sha256rnds2_epu32(state1, state0, message);
+            message = _mm_shuffle_epi32(message, 0x0E);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, message);
+        }
+        state0 = _mm_add_epi32(state0, abef_save);
+        state1 = _mm_add_epi32(state1, cdgh_save);
+    }
+
+    tmp = _mm_shuffle_epi32(state0, 0x1B);        // FEBA
+    state1 = _mm_shuffle_epi32(state1, 0xB1);     // DCHG
+    state0 = _mm_blend_epi16(tmp, state1, 0xF0);  // DCBA
+    state1 = _mm_alignr_epi8(state1, tmp, 8);     // ABEF
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(state), state0);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(state + 4), state1);
+}
+
+#endif
+
+using Dispatch = common::KernelDispatch<Sha256Impl, CompressFn, 2>;
+
+Dispatch &dispatch() {
+#if defined(DUNGEONHUB_HAVE_SHA_NI)
+    constexpr CompressFn kShaNi = compressShaNi;
+#else
+    constexpr CompressFn kShaNi = compressPortable;
+#endif
+    static Dispatch instance({Dispatch::Option{compressPortable, true, "portable"},
+                              Dispatch::Option{kShaNi, common::cpuHasShaNi(), "sha-ni"}});
+    return instance;
+}
+
+void compress(std::uint32_t *state, const std::uint8_t *data, std::size_t blocks) {
+    dispatch().table()(state, data, blocks);
+}
+
+}  // namespace
+
+Sha256Impl activeSha256Impl() {
+    return dispatch().active();
+}
+
+bool sha256ImplSupported(Sha256Impl impl) {
+    return dispatch().supported(impl);
+}
+
+bool setSha256Impl(Sha256Impl impl) {
+    return dispatch().set(impl);
+}
+
+const char *sha256ImplName(Sha256Impl impl) {
+    return dispatch().name(impl);
+}
+
+Sha256::Sha256() : state_(kInitialState) {}
+
+Sha256::Sha256(const State &state, std::uint64_t bytes_hashed)
+    : state_(state), total_bytes_(bytes_hashed) {}
+
+void Sha256::update(std::span<const std::uint8_t> data) {
+    total_bytes_ += data.size();
+    const std::uint8_t *in = data.data();
+    std::size_t remaining = data.size();
+
+    if (block_used_ > 0) {
+        auto count = std::min(remaining, kBlockSize - block_used_);
+        std::memcpy(block_.data() + block_used_, in, count);
+        block_used_ += count;
+        in += count;
+        remaining -= count;
+        if (block_used_ < kBlockSize) {
+            return;
+        }
+        compress(state_.data(), block_.data(), 1);
+        block_used_ = 0;
+    }
+
+    // Whole blocks go straight from the input in one call.
+    if (auto blocks = remaining / kBlockSize; blocks > 0) {
+        compress(state_.data(), in, blocks);
+        in += blocks * kBlockSize;
+        remaining -= blocks * kBlockSize;
+    }
+    if (remaining > 0) {
+        std::memcpy(block_.data(), in, remaining);
+        block_used_ = remaining;
+    }
+}
+
+Sha256::Digest Sha256::finish() {
+    std::uint64_t bit_length = total_bytes_ * 8;
+    block_[block_used_++] = 0x80;
+    if (block_used_ > kBlockSize - 8) {
+        std::fill(block_.begin() + static_cast<std::ptrdiff_t>(block_used_), block_.end(), 0);
+        compress(state_.data(), block_.data(), 1);
+        block_used_ = 0;
+    }
+    std::fill(block_.begin() + static_cast<std::ptrdiff_t>(block_used_), block_.end() - 8, 0);
+    for (std::size_t i = 0; i < 8; ++i) {
+        block_[kBlockSize - 1 - i] = static_cast<std::uint8_t>(bit_length >> (8 * i));
+    }
+    compress(state_.data(), block_.data(), 1);
+    block_used_ = 0;
+
+    Digest digest{};
+    for (std::size_t i = 0; i < state_.size(); ++i) {
+        digest[i * 4] = static_cast<std::uint8_t>(state_[i] >> 24);
+        digest[i * 4 + 1] = static_cast<std::uint8_t>(state_[i] >> 16);
+        digest[i * 4 + 2] = static_cast<std::uint8_t>(state_[i] >> 8);
+        digest[i * 4 + 3] = static_cast<std::uint8_t>(state_[i]);
+    }
+    return digest;
+}
+
+const Sha256::State &Sha256::state() const {
+    return state_;
+}
+
+Sha256::Digest Sha256::hash(std::span<const std::uint8_t> data) {
+    Sha256 hasher;
+    hasher.update(data);
+    return hasher.finish();
+}
+
+}  // namespace net
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace net {
+
+enum class Sha256Impl {
+    Portable,
+    ShaNi  // x86 SHA extensions
+};
+
+// Block function selection (common::KernelDispatch).
+Sha256Impl activeSha256Impl();
+bool sha256ImplSupported(Sha256Impl impl);
+bool setSha256Impl(Sha256Impl impl);
+const char *sha256ImplName(Sha256Impl impl);
+
+class Sha256 {
+public:
+    static constexpr std::size_t kBlockSize = 64;
+    static constexpr std::size_t kDigestSize = 32;
+    using State = std::array<std::uint32_t, 8>;
+    using Digest = std::array<std::uint8_t, kDigestSize>;
+
+    Sha256();
+    // Resumes from a state captured after `bytes_hashed` bytes, which must be
+    // a whole number of blocks (used for precomputed HMAC pads).
+    Sha256(const State &state, std::uint64_t bytes_hashed);
+
+    void update(std::span<const std::uint8_t> data);
+    Digest finish();
+    // Chaining state; only meaningful on a block boundary.
+    const State &state() const;
+
+    static Digest hash(std::span<const std::uint8_t> data);
+
+private:
+    State state_;
+    std::array<std::uint8_t, kBlockSize> block_{};
+    std::size_t block_used_{0};
+    std::uint64_t total_bytes_{0};
+};
+
+}  // namespace net
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string_view>
+
+namespace net {
+
+// Transparent hasher: string-keyed unordered maps declared with
+// <StringHash, std::equal_to<>> can be probed with a std::string_view without
+// building a temporary std::string.
+struct StringHash {
+    using is_transparent = void;
+
+    std::size_t operator()(std::string_view value) const noexcept {
+        return std::hash<std::string_view>{}(value);
+    }
+};
+
+}  // namespace net
@@ -0,0 +1,166 @@
+#include "net/timer_wheel.h"
+
+#include <algorithm>
+
+namespace net {
+
+TimerWheel::TimerWheel(std::chrono::steady_clock::time_point start,
+                       std::chrono::nanoseconds resolution)
+    : start_(start),
+      resolution_(std::max(resolution, std::chrono::nanoseconds{1})) {
+    heads_.fill(kNil);
+}
+
+TimerWheel::TimerId TimerWheel::schedule(std::chrono::steady_clock::time_point deadline,
+                                         Key key) {
+    std::uint32_t index = 0;
+    if (!free_.empty()) {
+        index = free_.back();
+        free_.pop_back();
+    } else {
+        index = static_cast<std::uint32_t>(nodes_.size());
+        nodes_.emplace_back();
+    }
+    auto &node = nodes_[index];
+    node.key = key;
+    node.expires = tickFor(deadline, true);
+    place(index);
+    active_ += 1;
+    return (static_cast<TimerId>(node.generation) << 32) | (index + 1);
+}
+
+bool TimerWheel::cancel(TimerId id) {
+    auto low = static_cast<std::uint32_t>(id & 0xFFFFFFFFu);
+    if (low == 0 || low > nodes_.size()) {
+        return false;
+    }
+    std::uint32_t index = low - 1;
+    auto &node = nodes_[index];
+    if (node.slot == kNil || node.generation != static_cast<std::uint32_t>(id >> 32)) {
+        return false;
+    }
+    unlink(index);
+    release(index);
+    return true;
+}
+
+std::size_t TimerWheel::advance(std::chrono::steady_clock::time_point now,
+                                std::vector<Key> &expired) {
+    if (now < start_) {
+        return 0;
+    }
+    const auto target = tickFor(now, false);
+    std::size_t fired = 0;
+    while (active_ > 0 && current_tick_ <= target) {
+        auto index = static_cast<std::uint32_t>(current_tick_ & (kRootSlots - 1));
+        if (index == 0) {
+            for (std::uint32_t level = 1; level < kLevels && cascade(level); ++level) {
+            }
+        }
+        auto node_index = heads_[index];
+        heads_[index] = kNil;
+        while (node_index != kNil) {
+            auto next = nodes_[node_index].next;
+            expired.push_back(nodes_[node_index].key);
+            release(node_index);
+            fired += 1;
+            node_index = next;
+        }
+        current_tick_ += 1;
+    }
+    // Nothing left to fire: jump straight to the target instead of walking
+    // empty slots one tick at a time.
+    if (current_tick_ <= target) {
+        current_tick_ = target + 1;
+    }
+    return fired;
+}
+
+std::size_t TimerWheel::size() const {
+    return active_;
+}
+
+std::uint64_t TimerWheel::tickFor(std::chrono::steady_clock::time_point time,
+                                  bool round_up) const {
+    if (time <= start_) {
+        return 0;
+    }
+    auto elapsed = time - start_;
+    auto ticks = static_cast<std::uint64_t>(elapsed / resolution_);
+    if (round_up && elapsed % resolution_ != std::chrono::nanoseconds::zero()) {
+        ticks += 1;
+    }
+    return ticks;
+}
+
+void TimerWheel::place(std::uint32_t index) {
+    auto expires = std::max(nodes_[index].expires, current_tick_);
+    auto delta = expires - current_tick_;
+    if (delta < kRootSlots) {
+        link(index, static_cast<std::uint32_t>(expires & (kRootSlots - 1)));
+        return;
+    }
+    if (delta > kMaxSpan) {
+        expires = current_tick_ + kMaxSpan;
+        delta = kMaxSpan;
+    }
+    for (std::uint32_t level = 1; level < kLevels; ++level) {
+        auto shift = kRootBits + (level - 1) * kLevelBits;
+        if (level + 1 == kLevels || delta < (std::uint64_t{1} << (shift + kLevelBits))) {
+            auto slot = kRootSlots + (level - 1) * kLevelSlots +
+                        static_cast<std::uint32_t>((expires >> shift) & (kLevelSlots - 1));
+            link(index, slot);
+            return;
+        }
+    }
+}
+
+void TimerWheel::link(std::uint32_t index, std::uint32_t slot) {
+    auto &node = nodes_[index];
+    node.slot = slot;
+    node.prev = kNil;
+    node.next = heads_[slot];
+    if (node.next != kNil) {
+        nodes_[node.next].prev = index;
+    }
+    heads_[slot] = index;
+}
+
+void TimerWheel::unlink(std::uint32_t index) {
+    auto &node = nodes_[index];
+    if (node.prev != kNil) {
+        nodes_[node.prev].next = node.next;
+    } else {
+        heads_[node.slot] = node.next;
+    }
+    if (node.next != kNil) {
+        nodes_[node.next].prev = node.prev;
+    }
+    node.prev = kNil;
+    node.next = kNil;
+    node.slot = kNil;
+}
+
+void TimerWheel::release(std::uint32_t index) {
+    auto &node = nodes_[index];
+    node.slot = kNil;
+    node.generation += 1;
+    free_.push_back(index);
+    active_ -= 1;
+}
+
+bool TimerWheel::cascade(std::uint32_t level) {
+    auto shift = kRootBits + (level - 1) * kLevelBits;
+    auto level_index = static_cast<std::uint32_t>((current_tick_ >> shift) & (kLevelSlots - 1));
+    auto slot = kRootSlots + (level - 1) * kLevelSlots + level_index;
+    auto node_index = heads_[slot];
+    heads_[slot] = kNil;
+    while (node_index != kNil) {
+        auto next = nodes_[node_index].next;
+        place(node_index);
+        node_index = next;
+    }
+    return level_index == 0;
+}
+
+}  // namespace net
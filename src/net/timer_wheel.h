@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace net {
+
+// Hashed hierarchical timing wheel (256 + 3x64 slots). Scheduling and
+// cancelling are O(1); advance() costs O(elapsed ticks + expired timers) and
+// never touches timers that are not yet due. Deadlines beyond the wheel range
+// are parked in the outermost level and re-cascaded until they fit.
+class TimerWheel {
+public:
+    using TimerId = std::uint64_t;
+    using Key = std::uint64_t;
+
+    static constexpr TimerId kInvalidTimer = 0;
+
+    explicit TimerWheel(std::chrono::steady_clock::time_point start,
+                        std::chrono::nanoseconds resolution = std::chrono::milliseconds{1});
+
+    // Fires on the first advance() whose `now` is at or past `deadline`;
+    // deadlines already behind the wheel fire on the next tick.
+    TimerId schedule(std::chrono::steady_clock::time_point deadline, Key key);
+    bool cancel(TimerId id);
+
+    // Appends the keys of every expired timer to `expired` and returns how many
+    // were appended. Expired timers are released before this returns.
+    std::size_t advance(std::chrono::steady_clock::time_point now, std::vector<Key> &expired);
+
+    std::size_t size() const;
+
+private:
+    static constexpr std::uint32_t kRootBits = 8;
+    static constexpr std::uint32_t kLevelBits = 6;
+    static constexpr std::uint32_t kLevels = 4;
+    static constexpr std::uint32_t kRootSlots = 1u << kRootBits;
+    static constexpr std::uint32_t kLevelSlots = 1u << kLevelBits;
+    static constexpr std::uint32_t kSlotCount = kRootSlots + (kLevels - 1) * kLevelSlots;
+    static constexpr std::uint64_t kMaxSpan =
+        (std::uint64_t{1} << (kRootBits + (kLevels - 1) * kLevelBits)) - 1;
+    static constexpr std::uint32_t kNil = 0xFFFFFFFFu;
+
+    struct Node {
+        Key key{0};
+        std::uint64_t expires{0};
+        std::uint32_t prev{kNil};
+        std::uint32_t next{kNil};
+        std::uint32_t slot{kNil};
+        std::uint32_t generation{0};
+    };
+
+    std::uint64_t tickFor(std::chrono::steady_clock::time_point time, bool round_up) const;
+    void place(std::uint32_t index);
+    void link(std::uint32_t index, std::uint32_t slot);
+    void unlink(std::uint32_t index);
+    void release(std::uint32_t index);
+    bool cascade(std::uint32_t level);
+
+    std::chrono::steady_clock::time_point start_;
+    std::chrono::nanoseconds resolution_;
+    std::uint64_t current_tick_{0};
+    std::array<std::uint32_t, kSlotCount> heads_;
+    std::vector<Node> nodes_;
+    std::vector<std::uint32_t> free_;
+    std::size_t active_{0};
+};
+
+}  // namespace net
@@ -0,0 +1,320 @@
+#pragma once
+
+#include "net/buffer_pool.h"
+#include "net/codec.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace net::wire {
+
+// Each protocol message specialises Fields<T> with a tuple of member pointers
+// in wire order. encode/decode below are generated from that list: encoders
+// size the buffer once and write without per-byte growth, decoders rely on a
+// compile-time minimum size so fixed-width fields are read unchecked and only
+// variable-length fields carry a bounds check.
+template <typename Message>
+struct Fields;
+
+// Primitive encodings, all big-endian:
+//   bool        1 byte (non-zero is true)
+//   uint16/32/64, uint16-backed enums
+//   string      uint16 length + bytes (truncated to 65535)
+//   list        uint16 count + elements (truncated to 65535)
+template <typename T, typename = void>
+struct Field;
+
+class Reader {
+public:
+    explicit Reader(std::span<const std::uint8_t> payload)
+        : data_(payload.data()), end_(payload.data() + payload.size()) {}
+
+    std::size_t remaining() const {
+        return static_cast<std::size_t>(end_ - data_);
+    }
+
+    bool done() const {
+        return data_ == end_;
+    }
+
+    const std::uint8_t *take(std::size_t count) {
+        const std::uint8_t *at = data_;
+        data_ += count;
+        return at;
+    }
+
+    template <typename T>
+    T takeInt() {
+        T value = 0;
+        for (std::size_t i = 0; i < sizeof(T); ++i) {
+            value = static_cast<T>((value << 8) | data_[i]);
+        }
+        data_ += sizeof(T);
+        return value;
+    }
+
+private:
+    const std::uint8_t *data_;
+    const std::uint8_t *end_;
+};
+
+template <typename T>
+std::uint8_t *putInt(T value, std::uint8_t *out) {
+    for (std::size_t i = 0; i < sizeof(T); ++i) {
+        out[i] = static_cast<std::uint8_t>(value >> (8 * (sizeof(T) - 1 - i)));
+    }
+    return out + sizeof(T);
+}
+
+inline std::uint16_t clampedCount(std::size_t size) {
+    return static_cast<std::uint16_t>(
+        std::min<std::size_t>(size, std::numeric_limits<std::uint16_t>::max()));
+}
+
+// Fixed-width fields: min_size is exact, reads never check bounds. `reserve`
+// is the minimum size of the fields that follow and is ignored here.
+template <>
+struct Field<bool> {
+    static constexpr std::size_t min_size = 1;
+    static std::size_t size(bool) { return 1; }
+    static std::uint8_t *write(bool value, std::uint8_t *out) {
+        *out = static_cast<std::uint8_t>(value ? 1 : 0);
+        return out + 1;
+    }
+    static bool read(Reader &in, bool &out, std::size_t) {
+        out = *in.take(1) != 0;
+        return true;
+    }
+};
+
+template <typename T>
+struct Field<T, std::enable_if_t<std::is_same_v<T, std::uint16_t> ||
+                                 std::is_same_v<T, std::uint32_t> ||
+                                 std::is_same_v<T, std::uint64_t>>> {
+    static constexpr std::size_t min_size = sizeof(T);
+    static std::size_t size(T) { return sizeof(T); }
+    static std::uint8_t *write(T value, std::uint8_t *out) { return putInt(value, out); }
+    static bool read(Reader &in, T &out, std::size_t) {
+        out = in.takeInt<T>();
+        return true;
+    }
+};
+
+template <typename T>
+struct Field<T, std::enable_if_t<std::is_enum_v<T>>> {
+    static_assert(std::is_same_v<std::underlying_type_t<T>, std::uint16_t>,
+                  "wire enums are uint16-backed");
+    static constexpr std::size_t min_size = 2;
+    static std::size_t size(T) { return 2; }
+    static std::uint8_t *write(T value, std::uint8_t *out) {
+        return putInt(static_cast<std::uint16_t>(value), out);
+    }
+    static bool read(Reader &in, T &out, std::size_t) {
+        out = static_cast<T>(in.takeInt<std::uint16_t>());
+        return true;
+    }
+};
+
+template <>
+struct Field<std::string> {
+    static constexpr std::size_t min_size = 2;
+    static std::size_t size(const std::string &value) {
+        return 2 + clampedCount(value.size());
+    }
+    static std::uint8_t *write(const std::string &value, std::uint8_t *out) {
+        auto length = clampedCount(value.size());
+        out = putInt(length, out);
+        std::memcpy(out, value.data(), length);
+        return out + length;
+    }
+    static bool read(Reader &in, std::string &out, std::size_t reserve) {
+        auto length = in.takeInt<std::uint16_t>();
+        if (in.remaining() < length + reserve) {
+            return false;
+        }
+        out.assign(reinterpret_cast<const char *>(in.take(length)), length);
+        return true;
+    }
+};
+
+// Views decode without copying: the result points into the payload.
+template <>
+struct Field<std::string_view> {
+    static constexpr std::size_t min_size = 2;
+    static std::size_t size(std::string_view value) {
+        return 2 + clampedCount(value.size());
+    }
+    static std::uint8_t *write(std::string_view value, std::uint8_t *out) {
+        auto length = clampedCount(value.size());
+        out = putInt(length, out);
+        std::memcpy(out, value.data(), length);
+        return out + length;
+    }
+    static bool read(Reader &in, std::string_view &out, std::size_t reserve) {
+        auto length = in.takeInt<std::uint16_t>();
+        if (in.remaining() < length + reserve) {
+            return false;
+        }
+        out = std::string_view(reinterpret_cast<const char *>(in.take(length)), length);
+        return true;
+    }
+};
+
+template <typename T>
+struct Field<std::vector<T>> {
+    static constexpr std::size_t min_size = 2;
+    static std::size_t size(const std::vector<T> &values) {
+        std::size_t total = 2;
+        auto count = clampedCount(values.size());
+        for (std::size_t i = 0; i < count; ++i) {
+            total += Field<T>::size(values[i]);
+        }
+        return total;
+    }
+    static std::uint8_t *write(const std::vector<T> &values, std::uint8_t *out) {
+        auto count = clampedCount(values.size());
+        out = putInt(count, out);
+        for (std::size_t i = 0; i < count; ++i) {
+            out = Field<T>::write(values[i], out);
+        }
+        return out;
+    }
+    static bool read(Reader &in, std::vector<T> &out, std::size_t reserve) {
+        auto count = in.takeInt<std::uint16_t>();
+        // One check covers the minimum size of every element; variable-length
+        // elements then only check their own tail.
+        std::size_t element_min = Field<T>::min_size;
+        if (in.remaining() < count * element_min + reserve) {
+            return false;
+        }
+        out.clear();
+        out.resize(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            if (!Field<T>::read(in, out[i], (count - 1 - i) * element_min + reserve)) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+// Structs with their own Fields<T> (e.g. list elements) nest naturally.
+template <typename T>
+struct Field<T, std::void_t<decltype(Fields<T>::members)>> {
+    static constexpr std::size_t min_size = std::apply(
+        [](auto... member) {
+            return (std::size_t{0} + ... +
+                    Field<std::remove_cvref_t<decltype(std::declval<T &>().*member)>>::min_size);
+        },
+        Fields<T>::members);
+
+    static std::size_t size(const T &value) {
+        return std::apply(
+            [&](auto... member) {
+                return (std::size_t{0} + ... +
+                        Field<std::remove_cvref_t<decltype(value.*member)>>::size(value.*member));
+            },
+            Fields<T>::members);
+    }
+
+    static std::uint8_t *write(const T &value, std::uint8_t *out) {
+        std::apply(
+            [&](auto... member) {
+                ((out = Field<std::remove_cvref_t<decltype(value.*member)>>::write(value.*member,
+                                                                                  out)),
+                 ...);
+            },
+            Fields<T>::members);
+        return out;
+    }
+
+    static bool read(Reader &in, T &value, std::size_t reserve) {
+        return readFrom<0>(in, value, reserve);
+    }
+
+private:
+    template <std::size_t Index>
+    static constexpr std::size_t minSizeFrom() {
+        constexpr std::size_t count = std::tuple_size_v<decltype(Fields<T>::members)>;
+        if constexpr (Index >= count) {
+            return 0;
+        } else {
+            using Member = std::remove_cvref_t<
+                decltype(std::declval<T &>().*std::get<Index>(Fields<T>::members))>;
+            return Field<Member>::min_size + minSizeFrom<Index + 1>();
+        }
+    }
+
+    template <std::size_t Index>
+    static bool readFrom(Reader &in, T &value, std::size_t reserve) {
+        constexpr std::size_t count = std::tuple_size_v<decltype(Fields<T>::members)>;
+        if constexpr (Index >= count) {
+            return true;
+        } else {
+            auto &member = value.*std::get<Index>(Fields<T>::members);
+            using Member = std::remove_cvref_t<decltype(member)>;
+            if (!Field<Member>::read(in, member, minSizeFrom<Index + 1>() + reserve)) {
+                return false;
+            }
+            return readFrom<Index + 1>(in, value, reserve);
+        }
+    }
+};
+
+template <typename Message>
+std::size_t encodedSize(const Message &message) {
+    return Field<Message>::size(message);
+}
+
+// Writes exactly encodedSize(message) bytes starting at `out`.
+template <typename Message>
+std::uint8_t *encodeTo(const Message &message, std::uint8_t *out) {
+    return Field<Message>::write(message, out);
+}
+
+template <typename Message>
+std::vector<std::uint8_t> encode(const Message &message) {
+    auto size = encodedSize(message);
+    auto out = BufferPool::acquire(size);
+    out.resize(size);
+    encodeTo(message, out.data());
+    return out;
+}
+
+// Appends the message to a frame under construction; no intermediate buffer.
+template <typename Message>
+void encodeTo(const Message &message, FrameBuilder &frame) {
+    encodeTo(message, frame.extend(encodedSize(message)));
+}
+
+template <typename Message>
+std::vector<std::uint8_t> encodeFrame(std::uint16_t type,
+                                      std::uint16_t version,
+                                      const Message &message) {
+    auto size = encodedSize(message);
+    FrameBuilder frame(type, version, size);
+    encodeTo(message, frame.extend(size));
+    return std::move(frame).finish();
+}
+
+// Succeeds only when the payload holds exactly one message.
+template <typename Message>
+bool decode(std::span<const std::uint8_t> payload, Message &out) {
+    if (payload.size() < Field<Message>::min_size) {
+        return false;
+    }
+    Reader in(payload);
+    return Field<Message>::read(in, out, 0) && in.done();
+}
+
+}  // namespace net::wire
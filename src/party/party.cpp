@@ -56,9 +56,13 @@ bool PartyService::inviteMember(PartyId party_id,
         return false;
     }
 
-    party_invites.emplace(
-        invitee_session_id,
-        PartyInvite{inviter_session_id, std::move(invitee_user_id), now});
+    auto invite_it = party_invites
+                         .emplace(invitee_session_id,
+                                  PartyInvite{inviter_session_id,
+                                              std::move(invitee_user_id),
+                                              now})
+                         .first;
+    armInviteTimer(party_id, invitee_session_id, invite_it->second);
 
     PartyEvent event;
     event.type = PartyEventType::InviteSent;
@@ -259,34 +263,53 @@ bool PartyService::replaceMemberSession(SessionId old_session_id,
         PartyInvite invite = invite_it->second;
         invites.erase(invite_it);
         invites.emplace(new_session_id, invite);
+        auto ref_it = invite_timer_refs_.find(invite.timer_key);
+        if (ref_it != invite_timer_refs_.end()) {
+            ref_it->second.invitee_session_id = new_session_id;
+        }
     }
 
     return true;
 }
 
 std::size_t PartyService::expireInvites(std::chrono::steady_clock::time_point now) {
+    expired_invite_keys_.clear();
+    if (invite_timers_) {
+        invite_timers_->advance(now, expired_invite_keys_);
+    }
     std::size_t expired_count = 0;
-    for (auto &party_entry : parties_) {
-        auto invite_it = invites_.find(party_entry.first);
-        if (invite_it == invites_.end()) {
+    for (auto key : expired_invite_keys_) {
+        auto ref_it = invite_timer_refs_.find(key);
+        if (ref_it == invite_timer_refs_.end()) {
+            continue;
+        }
+        InviteRef ref = ref_it->second;
+        invite_timer_refs_.erase(ref_it);
+
+        auto party_it = parties_.find(ref.party_id);
+        auto invite_it = invites_.find(ref.party_id);
+        if (party_it == parties_.end() || invite_it == invites_.end()) {
             continue;
         }
         auto &party_invites = invite_it->second;
-        for (auto it = party_invites.begin(); it != party_invites.end();) {
-            if (now - it->second.sent_at > invite_timeout_) {
-                PartyEvent event;
-                event.type = PartyEventType::InviteExpired;
-                event.party_id = party_entry.first;
-                event.target_session_id = it->first;
-                event.message = "Party invite expired";
-                emitToParty(party_entry.second, event);
-                emitToInvitee(it->first, event);
-                it = party_invites.erase(it);
-                ++expired_count;
-            } else {
-                ++it;
-            }
+        auto entry = party_invites.find(ref.invitee_session_id);
+        if (entry == party_invites.end() || entry->second.timer_key != key) {
+            continue;
+        }
+        if (now - entry->second.sent_at <= invite_timeout_) {
+            armInviteTimer(ref.party_id, ref.invitee_session_id, entry->second);
+            continue;
         }
+
+        PartyEvent event;
+        event.type = PartyEventType::InviteExpired;
+        event.party_id = ref.party_id;
+        event.target_session_id = ref.invitee_session_id;
+        event.message = "Party invite expired";
+        emitToParty(party_it->second, event);
+        emitToInvitee(ref.invitee_session_id, event);
+        party_invites.erase(entry);
+        ++expired_count;
     }
     return expired_count;
 }
@@ -324,7 +347,31 @@ void PartyService::setEventSink(EventSink sink) {
 }
 
 void PartyService::setInviteTimeout(std::chrono::milliseconds timeout) {
+    bool shortened = timeout < invite_timeout_;
     invite_timeout_ = timeout;
+    if (!shortened) {
+        return;
+    }
+    // Pending timers would fire late; re-arm them against the new timeout.
+    for (auto &party_entry : invites_) {
+        for (auto &invite_entry : party_entry.second) {
+            armInviteTimer(party_entry.first, invite_entry.first, invite_entry.second);
+        }
+    }
+}
+
+void PartyService::armInviteTimer(PartyId party_id,
+                                  SessionId invitee_session_id,
+                                  PartyInvite &invite) {
+    invite_timer_refs_.erase(invite.timer_key);
+    invite.timer_key = next_invite_timer_key_++;
+    invite_timer_refs_.emplace(invite.timer_key, InviteRef{party_id, invitee_session_id});
+    if (!invite_timers_) {
+        invite_timers_.emplace(invite.sent_at);
+    }
+    // Expiry is strict (elapsed > timeout), so arm just past the boundary.
+    invite_timers_->schedule(invite.sent_at + invite_timeout_ + std::chrono::nanoseconds{1},
+                            invite.timer_key);
 }
 
 void PartyService::emitToParty(const PartyRecord &party, const PartyEvent &event) {
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "net/timer_wheel.h"
+
 #include <chrono>
 #include <cstdint>
 #include <functional>
@@ -81,10 +83,17 @@ private:
         SessionId inviter_session_id{0};
         std::string invitee_user_id;
         std::chrono::steady_clock::time_point sent_at{};
+        net::TimerWheel::Key timer_key{0};
+    };
+
+    struct InviteRef {
+        PartyId party_id{0};
+        SessionId invitee_session_id{0};
     };
 
     void emitToParty(const PartyRecord &party, const PartyEvent &event);
     void emitToInvitee(SessionId invitee_session_id, const PartyEvent &event);
+    void armInviteTimer(PartyId party_id, SessionId invitee_session_id, PartyInvite &invite);
 
     PartyId next_party_id_{1};
     std::unordered_map<PartyId, PartyRecord> parties_;
@@ -92,6 +101,14 @@ private:
     std::unordered_map<PartyId, std::unordered_map<SessionId, PartyInvite>> invites_;
     EventSink event_sink_;
     std::chrono::milliseconds invite_timeout_{std::chrono::minutes{5}};
+    // Timer keys are never reused; a fired key whose invite is gone or was
+    // re-armed under a newer key is simply dropped. The wheel starts at the
+    // first invite's time, so callers passing their own clock (tests, a
+    // server's packet time) are not behind it.
+    std::optional<net::TimerWheel> invite_timers_;
+    std::unordered_map<net::TimerWheel::Key, InviteRef> invite_timer_refs_;
+    net::TimerWheel::Key next_invite_timer_key_{1};
+    std::vector<net::TimerWheel::Key> expired_invite_keys_;
 };
 
 }  // namespace party
@@ -0,0 +1,230 @@
+#include "reward/compiled_drop_table.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+namespace reward {
+
+namespace {
+
+constexpr std::uint64_t kGolden = 0x9E3779B97F4A7C15ULL;
+constexpr double kThresholdScale = 2147483648.0;  // 2^31
+
+std::uint64_t mix(std::uint64_t value) {
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    return value ^ (value >> 31);
+}
+
+std::uint32_t toThreshold(double probability) {
+    return static_cast<std::uint32_t>(
+        std::llround(std::clamp(probability, 0.0, 1.0) * kThresholdScale));
+}
+
+CompiledEntry compileEntry(const DropEntry &entry) {
+    auto min_qty = std::min(entry.min_quantity, entry.max_quantity);
+    auto max_qty = std::max(entry.min_quantity, entry.max_quantity);
+    auto span = static_cast<std::uint64_t>(max_qty) - min_qty + 1;
+    return CompiledEntry{entry.item_id,
+                         min_qty,
+                         static_cast<std::uint32_t>(std::min<std::uint64_t>(span, 0xFFFFFFFFu)),
+                         toThreshold(entry.probability)};
+}
+
+std::uint32_t quantityFor(const CompiledEntry &entry, std::uint64_t draw) {
+    return entry.min_quantity +
+           static_cast<std::uint32_t>(((draw & 0xFFFFFFFFu) * entry.quantity_span) >> 32);
+}
+
+// Vose's alias method over `weights` (outcome i is outcomes[i]).
+void buildAlias(const std::vector<double> &weights,
+                const std::vector<std::uint32_t> &outcomes,
+                std::vector<AliasSlot> &slots) {
+    auto count = weights.size();
+    double total = 0.0;
+    for (auto weight : weights) {
+        total += weight;
+    }
+    std::vector<double> scaled(count);
+    std::vector<std::size_t> small;
+    std::vector<std::size_t> large;
+    for (std::size_t i = 0; i < count; ++i) {
+        scaled[i] = total > 0.0 ? weights[i] * static_cast<double>(count) / total : 1.0;
+        (scaled[i] < 1.0 ? small : large).push_back(i);
+    }
+
+    auto base = slots.size();
+    slots.resize(base + count);
+    while (!small.empty() && !large.empty()) {
+        auto less = small.back();
+        small.pop_back();
+        auto more = large.back();
+        slots[base + less] = AliasSlot{outcomes[less], outcomes[more], toThreshold(scaled[less])};
+        scaled[more] -= 1.0 - scaled[less];
+        if (scaled[more] < 1.0) {
+            large.pop_back();
+            small.push_back(more);
+        }
+    }
+    // Leftovers are 1 up to rounding.
+    for (auto index : large) {
+        slots[base + index] = AliasSlot{outcomes[index], outcomes[index], toThreshold(1.0)};
+    }
+    for (auto index : small) {
+        slots[base + index] = AliasSlot{outcomes[index], outcomes[index], toThreshold(1.0)};
+    }
+}
+
+}  // namespace
+
+DropRng::DropRng(std::uint64_t key, std::uint64_t counter) : key_(key), counter_(counter) {}
+
+DropRng DropRng::forInstance(std::uint32_t instance_seed, std::uint32_t table_id) {
+    return DropRng(mix((static_cast<std::uint64_t>(instance_seed) << 32) | table_id));
+}
+
+std::uint64_t DropRng::next() {
+    return mix(key_ + ++counter_ * kGolden);
+}
+
+std::uint64_t DropRng::key() const {
+    return key_;
+}
+
+std::uint64_t DropRng::counter() const {
+    return counter_;
+}
+
+DropTableView::DropTableView(std::span<const CompiledTable> tables,
+                             std::span<const CompiledEntry> entries,
+                             std::span<const CompiledGroup> groups,
+                             std::span<const AliasSlot> slots)
+    : tables_(tables), entries_(entries), groups_(groups), slots_(slots) {}
+
+bool DropTableView::hasTable(std::uint32_t table_id) const {
+    return find(table_id) != nullptr;
+}
+
+std::size_t DropTableView::tableCount() const {
+    return tables_.size();
+}
+
+std::size_t DropTableView::roll(std::uint32_t table_id,
+                                DropRng &rng,
+                                std::vector<RewardItem> &out) const {
+    const auto *table = find(table_id);
+    if (!table) {
+        return 0;
+    }
+    auto before = out.size();
+    // Sized for the worst case and trimmed afterwards, so independent
+    // entries are written without a branch on whether they dropped.
+    out.resize(before + table->independent_count);
+    auto *cursor = out.data() + before;
+    const auto *entry = entries_.data() + table->first_entry;
+    for (std::uint32_t i = 0; i < table->independent_count; ++i, ++entry) {
+        auto draw = rng.next();
+        *cursor = RewardItem{entry->item_id, quantityFor(*entry, draw)};
+        cursor += (draw >> 33) < entry->threshold ? 1 : 0;
+    }
+    out.resize(static_cast<std::size_t>(cursor - out.data()));
+    const auto *group = groups_.data() + table->first_group;
+    for (std::uint32_t g = 0; g < table->group_count; ++g, ++group) {
+        auto draw = rng.next();
+        auto column = static_cast<std::uint32_t>(((draw >> 32) * group->slot_count) >> 32);
+        const auto &slot = slots_[group->first_slot + column];
+        auto outcome = (draw & 0x7FFFFFFFu) < slot.threshold ? slot.primary : slot.alias;
+        if (outcome == AliasSlot::kNoDrop) {
+            continue;
+        }
+        const auto &picked = entries_[outcome];
+        out.push_back(RewardItem{picked.item_id, quantityFor(picked, rng.next())});
+    }
+    return out.size() - before;
+}
+
+std::span<const CompiledTable> DropTableView::tables() const {
+    return tables_;
+}
+
+std::span<const CompiledEntry> DropTableView::entries() const {
+    return entries_;
+}
+
+std::span<const CompiledGroup> DropTableView::groups() const {
+    return groups_;
+}
+
+std::span<const AliasSlot> DropTableView::slots() const {
+    return slots_;
+}
+
+const CompiledTable *DropTableView::find(std::uint32_t table_id) const {
+    auto found = std::lower_bound(tables_.begin(),
+                                  tables_.end(),
+                                  table_id,
+                                  [](const CompiledTable &table, std::uint32_t id) {
+                                      return table.table_id < id;
+                                  });
+    if (found == tables_.end() || found->table_id != table_id) {
+        return nullptr;
+    }
+    return &*found;
+}
+
+CompiledDropTable CompiledDropTable::compile(const DropTable &source) {
+    CompiledDropTable compiled;
+    std::map<std::uint32_t, const std::vector<DropEntry> *> ordered;
+    for (const auto &[table_id, entries] : source.tables()) {
+        ordered.emplace(table_id, &entries);
+    }
+
+    for (const auto &[table_id, entries] : ordered) {
+        CompiledTable table;
+        table.table_id = table_id;
+        table.first_entry = static_cast<std::uint32_t>(compiled.entries_.size());
+        table.first_group = static_cast<std::uint32_t>(compiled.groups_.size());
+
+        std::map<std::uint32_t, std::vector<const DropEntry *>> groups;
+        for (const auto &entry : *entries) {
+            if (entry.group != 0) {
+                groups[entry.group].push_back(&entry);
+                continue;
+            }
+            compiled.entries_.push_back(compileEntry(entry));
+            table.independent_count += 1;
+        }
+
+        for (const auto &[group_id, members] : groups) {
+            std::vector<double> weights;
+            std::vector<std::uint32_t> outcomes;
+            double total = 0.0;
+            for (const auto *member : members) {
+                auto weight = std::max(static_cast<double>(member->probability), 0.0);
+                outcomes.push_back(static_cast<std::uint32_t>(compiled.entries_.size()));
+                compiled.entries_.push_back(compileEntry(*member));
+                weights.push_back(weight);
+                total += weight;
+            }
+            if (total < 1.0) {
+                weights.push_back(1.0 - total);
+                outcomes.push_back(AliasSlot::kNoDrop);
+            }
+            CompiledGroup group;
+            group.first_slot = static_cast<std::uint32_t>(compiled.slots_.size());
+            group.slot_count = static_cast<std::uint32_t>(weights.size());
+            buildAlias(weights, outcomes, compiled.slots_);
+            compiled.groups_.push_back(group);
+            table.group_count += 1;
+        }
+        compiled.tables_.push_back(table);
+    }
+    return compiled;
+}
+
+DropTableView CompiledDropTable::view() const {
+    return DropTableView(tables_, entries_, groups_, slots_);
+}
+
+}  // namespace reward
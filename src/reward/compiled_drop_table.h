@@ -0,0 +1,114 @@
+#pragma once
+
+#include "reward/drop_table.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace reward {
+
+// Counter-based generator: output n is splitmix64's finaliser applied to
+// key + n * golden ratio, so a stream is a pure function of (key, counter).
+// Rolls are reproducible from the instance seed and can be replayed from any
+// counter; each draw is a multiply-add and three xor-shift-multiply rounds.
+class DropRng {
+public:
+    explicit DropRng(std::uint64_t key, std::uint64_t counter = 0);
+
+    // One stream per (instance, table), so tables of the same run are
+    // independent.
+    static DropRng forInstance(std::uint32_t instance_seed, std::uint32_t table_id);
+
+    std::uint64_t next();
+    std::uint64_t key() const;
+    std::uint64_t counter() const;
+
+private:
+    std::uint64_t key_;
+    std::uint64_t counter_;
+};
+
+// Flat records of a compiled table set. They hold no pointers, so the same
+// arrays can be built in memory or used in place from a file.
+struct CompiledTable {
+    std::uint32_t table_id{0};
+    // Independent entries come first, then each group's members.
+    std::uint32_t first_entry{0};
+    std::uint32_t independent_count{0};
+    std::uint32_t first_group{0};
+    std::uint32_t group_count{0};
+};
+
+struct CompiledEntry {
+    std::uint32_t item_id{0};
+    std::uint32_t min_quantity{0};
+    // max - min + 1, saturated.
+    std::uint32_t quantity_span{1};
+    // Drops when the top 31 bits of a draw are below this (probability * 2^31).
+    std::uint32_t threshold{0};
+};
+
+struct CompiledGroup {
+    std::uint32_t first_slot{0};
+    std::uint32_t slot_count{0};
+};
+
+// Vose alias slot: the column picks `primary` when the low 31 bits of the
+// draw are below `threshold`, else `alias`. Outcomes are entry indices, or
+// kNoDrop for the share of a group that drops nothing.
+struct AliasSlot {
+    static constexpr std::uint32_t kNoDrop = 0xFFFFFFFFu;
+
+    std::uint32_t primary{kNoDrop};
+    std::uint32_t alias{kNoDrop};
+    std::uint32_t threshold{0};
+};
+
+// Read-only view over compiled records; tables must be sorted by id.
+class DropTableView {
+public:
+    DropTableView() = default;
+    DropTableView(std::span<const CompiledTable> tables,
+                  std::span<const CompiledEntry> entries,
+                  std::span<const CompiledGroup> groups,
+                  std::span<const AliasSlot> slots);
+
+    bool hasTable(std::uint32_t table_id) const;
+    std::size_t tableCount() const;
+    // Appends the drops to `out` and returns how many; unknown tables drop
+    // nothing. One draw per independent entry, one per group plus one for the
+    // quantity of whatever the group picks.
+    std::size_t roll(std::uint32_t table_id, DropRng &rng, std::vector<RewardItem> &out) const;
+
+    std::span<const CompiledTable> tables() const;
+    std::span<const CompiledEntry> entries() const;
+    std::span<const CompiledGroup> groups() const;
+    std::span<const AliasSlot> slots() const;
+
+private:
+    const CompiledTable *find(std::uint32_t table_id) const;
+
+    std::span<const CompiledTable> tables_;
+    std::span<const CompiledEntry> entries_;
+    std::span<const CompiledGroup> groups_;
+    std::span<const AliasSlot> slots_;
+};
+
+// DropTable compiled once at load time into the flat records above.
+class CompiledDropTable {
+public:
+    static CompiledDropTable compile(const DropTable &source);
+
+    // Invalidated when this object is moved or destroyed.
+    DropTableView view() const;
+
+private:
+    std::vector<CompiledTable> tables_;
+    std::vector<CompiledEntry> entries_;
+    std::vector<CompiledGroup> groups_;
+    std::vector<AliasSlot> slots_;
+};
+
+}  // namespace reward
@@ -1,9 +1,21 @@
 #include "reward/drop_table.h"
 
 #include <algorithm>
+#include <map>
 
 namespace reward {
 
+namespace {
+
+RewardItem rollQuantity(const DropEntry &entry, std::mt19937 &rng) {
+    std::uint32_t min_qty = std::min(entry.min_quantity, entry.max_quantity);
+    std::uint32_t max_qty = std::max(entry.min_quantity, entry.max_quantity);
+    std::uniform_int_distribution<std::uint32_t> quantity(min_qty, max_qty);
+    return RewardItem{entry.item_id, quantity(rng)};
+}
+
+}  // namespace
+
 DropTable::DropTable() {
     addEntry(1, DropEntry{1001, 1, 2, 0.75f});
     addEntry(1, DropEntry{2001, 1, 1, 0.25f});
@@ -14,6 +26,10 @@ void DropTable::addEntry(std::uint32_t table_id, const DropEntry &entry) {
     tables_[table_id].push_back(entry);
 }
 
+void DropTable::clear() {
+    tables_.clear();
+}
+
 bool DropTable::hasTable(std::uint32_t table_id) const {
     return tables_.find(table_id) != tables_.end();
 }
@@ -26,17 +42,38 @@ std::vector<RewardItem> DropTable::roll(std::uint32_t table_id, std::mt19937 &rn
     }
 
     std::uniform_real_distribution<float> chance(0.0f, 1.0f);
+    std::map<std::uint32_t, std::vector<const DropEntry *>> groups;
     for (const auto &entry : it->second) {
+        if (entry.group != 0) {
+            groups[entry.group].push_back(&entry);
+            continue;
+        }
         if (chance(rng) > entry.probability) {
             continue;
         }
-        std::uint32_t min_qty = std::min(entry.min_quantity, entry.max_quantity);
-        std::uint32_t max_qty = std::max(entry.min_quantity, entry.max_quantity);
-        std::uniform_int_distribution<std::uint32_t> quantity(min_qty, max_qty);
-        rewards.push_back(RewardItem{entry.item_id, quantity(rng)});
+        rewards.push_back(rollQuantity(entry, rng));
+    }
+
+    for (const auto &[group, members] : groups) {
+        float total = 0.0f;
+        for (const auto *entry : members) {
+            total += std::max(entry->probability, 0.0f);
+        }
+        float pick = chance(rng) * std::max(total, 1.0f);
+        for (const auto *entry : members) {
+            pick -= std::max(entry->probability, 0.0f);
+            if (pick < 0.0f) {
+                rewards.push_back(rollQuantity(*entry, rng));
+                break;
+            }
+        }
     }
 
     return rewards;
 }
 
+const std::unordered_map<std::uint32_t, std::vector<DropEntry>> &DropTable::tables() const {
+    return tables_;
+}
+
 }  // namespace reward
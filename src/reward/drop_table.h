@@ -17,6 +17,10 @@ struct DropEntry {
     std::uint32_t min_quantity{0};
     std::uint32_t max_quantity{0};
     float probability{0.0f};
+    // Entries sharing a non-zero group are mutually exclusive: at most one of
+    // them drops per roll, picked by probability (if the group's probabilities
+    // add up to less than 1, the rest is the chance that none drops).
+    std::uint32_t group{0};
 };
 
 class DropTable {
@@ -24,8 +28,11 @@ public:
     DropTable();
 
     void addEntry(std::uint32_t table_id, const DropEntry &entry);
+    // Drops every table, including the built-in table 1.
+    void clear();
     bool hasTable(std::uint32_t table_id) const;
     std::vector<RewardItem> roll(std::uint32_t table_id, std::mt19937 &rng) const;
+    const std::unordered_map<std::uint32_t, std::vector<DropEntry>> &tables() const;
 
 private:
     std::unordered_map<std::uint32_t, std::vector<DropEntry>> tables_;
@@ -0,0 +1,307 @@
+#include "reward/drop_table_file.h"
+
+#include "common/binary_file.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace reward {
+
+namespace {
+
+static_assert(sizeof(DropTableFileHeader) == 72);
+static_assert(sizeof(CompiledTable) == 20);
+static_assert(sizeof(CompiledEntry) == 16);
+static_assert(sizeof(CompiledGroup) == 8);
+static_assert(sizeof(AliasSlot) == 12);
+
+constexpr std::uint32_t kMaxThreshold = 0x80000000u;
+
+std::uint64_t alignUp(std::uint64_t value) {
+    return (value + 7) & ~std::uint64_t{7};
+}
+
+template <typename Record>
+bool sectionFits(std::uint64_t offset, std::uint32_t count, std::size_t file_size) {
+    if (offset % alignof(Record) != 0 || offset > file_size) {
+        return false;
+    }
+    return static_cast<std::uint64_t>(count) * sizeof(Record) <= file_size - offset;
+}
+
+template <typename Record>
+std::span<const Record> section(const std::uint8_t *data, std::uint64_t offset,
+                                std::uint32_t count) {
+    return {reinterpret_cast<const Record *>(data + offset), count};
+}
+
+// Every index a roll follows must stay inside its section.
+bool validRecords(const DropTableView &view) {
+    auto entries = view.entries().size();
+    auto groups = view.groups().size();
+    auto slots = view.slots().size();
+    const CompiledTable *previous = nullptr;
+    for (const auto &table : view.tables()) {
+        if (previous && previous->table_id >= table.table_id) {
+            return false;
+        }
+        previous = &table;
+        if (static_cast<std::uint64_t>(table.first_entry) + table.independent_count > entries ||
+            static_cast<std::uint64_t>(table.first_group) + table.group_count > groups) {
+            return false;
+        }
+    }
+    for (const auto &entry : view.entries()) {
+        if (entry.quantity_span == 0 || entry.threshold > kMaxThreshold) {
+            return false;
+        }
+    }
+    for (const auto &group : view.groups()) {
+        if (group.slot_count == 0 ||
+            static_cast<std::uint64_t>(group.first_slot) + group.slot_count > slots) {
+            return false;
+        }
+    }
+    for (const auto &slot : view.slots()) {
+        auto valid = [entries](std::uint32_t outcome) {
+            return outcome == AliasSlot::kNoDrop || outcome < entries;
+        };
+        if (!valid(slot.primary) || !valid(slot.alias) || slot.threshold > kMaxThreshold) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool parseField(const std::string &text, std::uint32_t &value) {
+    if (text.empty()) {
+        return false;
+    }
+    char *end = nullptr;
+    auto parsed = std::strtoull(text.c_str(), &end, 10);
+    if (*end != '\0' || parsed > 0xFFFFFFFFu || text[0] == '-') {
+        return false;
+    }
+    value = static_cast<std::uint32_t>(parsed);
+    return true;
+}
+
+bool parseField(const std::string &text, float &value) {
+    if (text.empty()) {
+        return false;
+    }
+    char *end = nullptr;
+    value = std::strtof(text.c_str(), &end);
+    return *end == '\0' && value >= 0.0f;
+}
+
+std::string trim(const std::string &text) {
+    auto begin = text.find_first_not_of(" \t\r");
+    if (begin == std::string::npos) {
+        return {};
+    }
+    auto end = text.find_last_not_of(" \t\r");
+    return text.substr(begin, end - begin + 1);
+}
+
+}  // namespace
+
+std::shared_ptr<const DropTableFile> DropTableFile::open(const std::string &path) {
+    if constexpr (std::endian::native != std::endian::little) {
+        return nullptr;
+    }
+    std::shared_ptr<DropTableFile> file(new DropTableFile());
+    file->path_ = path;
+
+#if defined(_WIN32)
+    std::ifstream input(path, std::ios::binary | std::ios::ate);
+    if (!input) {
+        return nullptr;
+    }
+    file->size_ = static_cast<std::size_t>(input.tellg());
+    file->buffer_ = std::make_unique<std::uint64_t[]>((file->size_ + 7) / 8);
+    input.seekg(0);
+    if (!input.read(reinterpret_cast<char *>(file->buffer_.get()),
+                    static_cast<std::streamsize>(file->size_))) {
+        return nullptr;
+    }
+    file->data_ = reinterpret_cast<const std::uint8_t *>(file->buffer_.get());
+#else
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return nullptr;
+    }
+    struct stat info {};
+    if (::fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(DropTableFileHeader))) {
+        ::close(fd);
+        return nullptr;
+    }
+    auto size = static_cast<std::size_t>(info.st_size);
+    void *mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        return nullptr;
+    }
+    file->data_ = static_cast<const std::uint8_t *>(mapped);
+    file->size_ = size;
+#endif
+
+    if (file->size_ < sizeof(DropTableFileHeader)) {
+        return nullptr;
+    }
+    DropTableFileHeader header;
+    std::memcpy(&header, file->data_, sizeof(header));
+    if (header.magic != DropTableFileHeader::kMagic ||
+        header.version != DropTableFileHeader::kVersion ||
+        header.header_size != sizeof(DropTableFileHeader) ||
+        !sectionFits<CompiledTable>(header.tables_offset, header.table_count, file->size_) ||
+        !sectionFits<CompiledEntry>(header.entries_offset, header.entry_count, file->size_) ||
+        !sectionFits<CompiledGroup>(header.groups_offset, header.group_count, file->size_) ||
+        !sectionFits<AliasSlot>(header.slots_offset, header.slot_count, file->size_)) {
+        return nullptr;
+    }
+    file->view_ = DropTableView(
+        section<CompiledTable>(file->data_, header.tables_offset, header.table_count),
+        section<CompiledEntry>(file->data_, header.entries_offset, header.entry_count),
+        section<CompiledGroup>(file->data_, header.groups_offset, header.group_count),
+        section<AliasSlot>(file->data_, header.slots_offset, header.slot_count));
+    if (!validRecords(file->view_)) {
+        return nullptr;
+    }
+    return file;
+}
+
+DropTableFile::~DropTableFile() {
+#if !defined(_WIN32)
+    if (data_ && !buffer_) {
+        ::munmap(const_cast<std::uint8_t *>(data_), size_);
+    }
+#endif
+}
+
+const DropTableView &DropTableFile::view() const {
+    return view_;
+}
+
+const std::string &DropTableFile::path() const {
+    return path_;
+}
+
+std::size_t DropTableFile::sizeBytes() const {
+    return size_;
+}
+
+bool writeDropTableFile(const std::string &path, const DropTableView &tables) {
+    if constexpr (std::endian::native != std::endian::little) {
+        return false;
+    }
+    DropTableFileHeader header;
+    header.table_count = static_cast<std::uint32_t>(tables.tables().size());
+    header.entry_count = static_cast<std::uint32_t>(tables.entries().size());
+    header.group_count = static_cast<std::uint32_t>(tables.groups().size());
+    header.slot_count = static_cast<std::uint32_t>(tables.slots().size());
+    header.tables_offset = alignUp(sizeof(header));
+    header.entries_offset =
+        alignUp(header.tables_offset + tables.tables().size_bytes());
+    header.groups_offset =
+        alignUp(header.entries_offset + tables.entries().size_bytes());
+    header.slots_offset = alignUp(header.groups_offset + tables.groups().size_bytes());
+    header.items_offset = alignUp(header.slots_offset + tables.slots().size_bytes());
+
+    std::vector<std::uint8_t> image(header.items_offset, 0);
+    std::memcpy(image.data(), &header, sizeof(header));
+    auto copy = [&image](std::uint64_t offset, auto records) {
+        if (!records.empty()) {
+            std::memcpy(image.data() + offset, records.data(), records.size_bytes());
+        }
+    };
+    copy(header.tables_offset, tables.tables());
+    copy(header.entries_offset, tables.entries());
+    copy(header.groups_offset, tables.groups());
+    copy(header.slots_offset, tables.slots());
+
+    return common::replaceFile(path, image);
+}
+
+std::optional<DropTable> parseDropTableCsv(std::istream &input, std::size_t *error_line) {
+    DropTable tables;
+    tables.clear();
+    std::string line;
+    std::size_t number = 0;
+    auto fail = [&]() -> std::optional<DropTable> {
+        if (error_line) {
+            *error_line = number;
+        }
+        return std::nullopt;
+    };
+    while (std::getline(input, line)) {
+        number += 1;
+        line = trim(line);
+        if (line.empty() || line[0] == '#' || line.rfind("table_id", 0) == 0) {
+            continue;
+        }
+        std::vector<std::string> fields;
+        std::stringstream stream(line);
+        std::string field;
+        while (std::getline(stream, field, ',')) {
+            fields.push_back(trim(field));
+        }
+        if (fields.size() != 5 && fields.size() != 6) {
+            return fail();
+        }
+        std::uint32_t table_id = 0;
+        DropEntry entry;
+        if (!parseField(fields[0], table_id) || !parseField(fields[1], entry.item_id) ||
+            !parseField(fields[2], entry.min_quantity) ||
+            !parseField(fields[3], entry.max_quantity) ||
+            !parseField(fields[4], entry.probability) ||
+            (fields.size() == 6 && !parseField(fields[5], entry.group))) {
+            return fail();
+        }
+        tables.addEntry(table_id, entry);
+    }
+    return tables;
+}
+
+bool DropTableLibrary::load(const std::string &path) {
+    std::lock_guard<std::mutex> lock(load_mutex_);
+    auto file = DropTableFile::open(path);
+    if (!file) {
+        return false;
+    }
+    path_ = path;
+    current_.store(std::move(file), std::memory_order_release);
+    generation_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool DropTableLibrary::reload() {
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(load_mutex_);
+        path = path_;
+    }
+    return !path.empty() && load(path);
+}
+
+std::shared_ptr<const DropTableFile> DropTableLibrary::current() const {
+    return current_.load(std::memory_order_acquire);
+}
+
+std::uint64_t DropTableLibrary::generation() const {
+    return generation_.load(std::memory_order_relaxed);
+}
+
+}  // namespace reward
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "reward/compiled_drop_table.h"
+#include "reward/drop_table.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+
+namespace reward {
+
+// On-disk drop table set, version 1. All fields little-endian; each section
+// is an array of the compiled records, 8-byte aligned, so a mapped file is
+// used in place. The item section is reserved for item metadata and is
+// empty in version 1 (readers ignore it).
+struct DropTableFileHeader {
+    static constexpr std::uint32_t kMagic = 0x54444844;  // "DHDT"
+    static constexpr std::uint16_t kVersion = 1;
+
+    std::uint32_t magic{kMagic};
+    std::uint16_t version{kVersion};
+    std::uint16_t header_size{sizeof(DropTableFileHeader)};
+    std::uint32_t table_count{0};
+    std::uint32_t entry_count{0};
+    std::uint32_t group_count{0};
+    std::uint32_t slot_count{0};
+    std::uint32_t item_count{0};
+    std::uint32_t reserved{0};
+    std::uint64_t tables_offset{0};
+    std::uint64_t entries_offset{0};
+    std::uint64_t groups_offset{0};
+    std::uint64_t slots_offset{0};
+    std::uint64_t items_offset{0};
+};
+
+// A validated, read-only mapping of a drop table file. Rolls read straight
+// from the mapping; it is unmapped when the last shared_ptr goes away.
+class DropTableFile {
+public:
+    // Null if the file is missing, truncated, of another version, or has a
+    // record pointing outside its sections.
+    static std::shared_ptr<const DropTableFile> open(const std::string &path);
+
+    ~DropTableFile();
+    DropTableFile(const DropTableFile &) = delete;
+    DropTableFile &operator=(const DropTableFile &) = delete;
+
+    const DropTableView &view() const;
+    const std::string &path() const;
+    std::size_t sizeBytes() const;
+
+private:
+    DropTableFile() = default;
+
+    std::string path_;
+    const std::uint8_t *data_{nullptr};
+    std::size_t size_{0};
+    // Set when the file was read into memory instead of mapped.
+    std::unique_ptr<std::uint64_t[]> buffer_;
+    DropTableView view_;
+};
+
+// Writes `tables` to a sibling temp file and renames it over `path`, so a
+// reload never maps a half-written file and existing mappings stay valid.
+bool writeDropTableFile(const std::string &path, const DropTableView &tables);
+
+// Text source for the converter: one entry per line,
+//   table_id,item_id,min_quantity,max_quantity,probability[,group]
+// Blank lines, lines starting with '#', and a header line starting with
+// "table_id" are skipped. On a malformed line returns nullopt and stores its
+// 1-based number in `error_line`.
+std::optional<DropTable> parseDropTableCsv(std::istream &input,
+                                           std::size_t *error_line = nullptr);
+
+// Currently published drop table file. Rollers pin a snapshot with current()
+// (one atomic load) and keep using it even if a reload swaps in a new file
+// meanwhile; the old mapping is released with its last snapshot.
+class DropTableLibrary {
+public:
+    // Maps and validates `path` before publishing it; on failure the
+    // current tables stay in place.
+    bool load(const std::string &path);
+    // Re-opens the last loaded path.
+    bool reload();
+
+    std::shared_ptr<const DropTableFile> current() const;
+    // Bumped by every successful load.
+    std::uint64_t generation() const;
+
+private:
+    std::atomic<std::shared_ptr<const DropTableFile>> current_;
+    std::atomic<std::uint64_t> generation_{0};
+    // Serialises loaders only; readers never take it.
+    std::mutex load_mutex_;
+    std::string path_;
+};
+
+}  // namespace reward
@@ -0,0 +1,355 @@
+#include "reward/grant_store.h"
+
+#include "common/binary_file.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace reward {
+
+namespace {
+
+using common::getLittle;
+using common::putLittle;
+
+constexpr common::RecordFileFormat kFormat{
+    {'D', 'H', 'G', 'J'},
+    GrantIdempotencyStore::kJournalVersion,
+    static_cast<std::uint16_t>(GrantIdempotencyStore::kJournalRecordSize)};
+constexpr std::size_t kExpiryPrefetch = 8;
+// Small journals are never worth rewriting.
+constexpr std::size_t kJournalCompactFloor = 1024;
+
+inline void prefetch(const void *address) {
+#if defined(__GNUC__)
+    __builtin_prefetch(address);
+#else
+    (void)address;
+#endif
+}
+
+void putRecord(std::vector<std::uint8_t> &out,
+               GrantId grant_id,
+               std::uint32_t begun_at,
+               GrantStatus status) {
+    putLittle(out, grant_id);
+    putLittle(out, begun_at);
+    out.push_back(static_cast<std::uint8_t>(status));
+    out.insert(out.end(), 3, 0);
+}
+
+bool writeAll(std::ofstream &file, const std::vector<std::uint8_t> &bytes) {
+    file.write(reinterpret_cast<const char *>(bytes.data()),
+               static_cast<std::streamsize>(bytes.size()));
+    file.flush();
+    return static_cast<bool>(file);
+}
+
+}  // namespace
+
+GrantIdempotencyStore::GrantIdempotencyStore(GrantStoreConfig config) : config_(config) {
+    config_.bucket = std::max(config_.bucket, std::chrono::seconds(1));
+    config_.window = std::max(config_.window, config_.bucket);
+    auto buckets = (config_.window.count() + config_.bucket.count() - 1) / config_.bucket.count();
+    ring_.resize(static_cast<std::size_t>(buckets) + 1);
+    slots_.resize(std::bit_ceil(std::max<std::size_t>(16, config_.initial_capacity)));
+}
+
+GrantIdempotencyStore::~GrantIdempotencyStore() {
+    closeJournal();
+}
+
+bool GrantIdempotencyStore::begin(GrantId grant_id, Clock::time_point now) {
+    advance(bucketOf(now));
+    auto &slot = locate(grant_id);
+    if (slot.status == GrantStatus::Pending || slot.status == GrantStatus::Completed) {
+        return false;
+    }
+    auto previous = slot;
+    slot.status = GrantStatus::Pending;
+    slot.bucket = newest_bucket_;
+    // Not granted unless the restart after it would still see it Pending.
+    if (!journal(slot)) {
+        if (previous.status == GrantStatus::None) {
+            erase(slot);
+        } else {
+            slot = previous;
+        }
+        return false;
+    }
+    ring_[newest_bucket_ % ring_.size()].push_back(grant_id);
+    return true;
+}
+
+bool GrantIdempotencyStore::complete(GrantId grant_id) {
+    return setStatus(grant_id, GrantStatus::Completed);
+}
+
+bool GrantIdempotencyStore::fail(GrantId grant_id) {
+    return setStatus(grant_id, GrantStatus::Failed);
+}
+
+GrantStatus GrantIdempotencyStore::status(GrantId grant_id) const {
+    const auto *slot = find(grant_id);
+    return slot ? slot->status : GrantStatus::None;
+}
+
+void GrantIdempotencyStore::expire(Clock::time_point now) {
+    advance(bucketOf(now));
+}
+
+std::size_t GrantIdempotencyStore::size() const {
+    return size_;
+}
+
+std::size_t GrantIdempotencyStore::capacity() const {
+    return slots_.size();
+}
+
+const GrantStoreConfig &GrantIdempotencyStore::config() const {
+    return config_;
+}
+
+bool GrantIdempotencyStore::openJournal(const std::string &path, Clock::time_point now) {
+    closeJournal();
+    advance(bucketOf(now));
+
+    auto contents = common::readFileBytes(path);
+    if (contents && !contents->empty()) {
+        const auto &bytes = *contents;
+        if (!common::hasRecordHeader(bytes, kFormat)) {
+            return false;
+        }
+        auto bucket_seconds = static_cast<std::uint64_t>(config_.bucket.count());
+        auto span = static_cast<std::uint64_t>(ring_.size());
+        // A torn trailing record is ignored; the rewrite below drops it.
+        for (std::size_t offset = kJournalHeaderSize;
+             offset + kJournalRecordSize <= bytes.size();
+             offset += kJournalRecordSize) {
+            const auto *record = bytes.data() + offset;
+            auto grant_id = getLittle<std::uint64_t>(record);
+            auto bucket = std::min<std::uint64_t>(getLittle<std::uint32_t>(record + 8) / bucket_seconds,
+                                                  newest_bucket_);
+            auto status = static_cast<GrantStatus>(record[12]);
+            if (bucket + span <= newest_bucket_ || status == GrantStatus::None ||
+                status > GrantStatus::Failed) {
+                continue;
+            }
+            auto &slot = locate(grant_id);
+            if (slot.status == GrantStatus::None || slot.bucket != bucket) {
+                slot.bucket = static_cast<std::uint32_t>(bucket);
+                ring_[bucket % span].push_back(grant_id);
+            }
+            slot.status = status;
+        }
+    }
+
+    // Compact: only live grants, then append from there.
+    if (!writeLiveGrants(path)) {
+        return false;
+    }
+    journal_.open(path, std::ios::binary | std::ios::app);
+    if (!journal_) {
+        closeJournal();
+        return false;
+    }
+    journal_path_ = path;
+    return true;
+}
+
+void GrantIdempotencyStore::closeJournal() {
+    if (journal_.is_open()) {
+        journal_.close();
+    }
+}
+
+bool GrantIdempotencyStore::journalOpen() const {
+    return journal_.is_open();
+}
+
+std::uint64_t GrantIdempotencyStore::journalErrors() const {
+    return journal_errors_;
+}
+
+std::size_t GrantIdempotencyStore::home(GrantId grant_id) const {
+    auto mixed = grant_id * 0x9e3779b97f4a7c15ULL;
+    mixed ^= mixed >> 32;
+    return static_cast<std::size_t>(mixed) & (slots_.size() - 1);
+}
+
+GrantIdempotencyStore::Slot *GrantIdempotencyStore::find(GrantId grant_id) {
+    auto mask = slots_.size() - 1;
+    for (auto index = home(grant_id); slots_[index].status != GrantStatus::None;
+         index = (index + 1) & mask) {
+        if (slots_[index].id == grant_id) {
+            return &slots_[index];
+        }
+    }
+    return nullptr;
+}
+
+const GrantIdempotencyStore::Slot *GrantIdempotencyStore::find(GrantId grant_id) const {
+    return const_cast<GrantIdempotencyStore *>(this)->find(grant_id);
+}
+
+// Finds or claims the slot for `grant_id` in one probe. A claimed slot still
+// reads None; the caller sets its status right away.
+GrantIdempotencyStore::Slot &GrantIdempotencyStore::locate(GrantId grant_id) {
+    if ((size_ + 1) * 4 > slots_.size() * 3) {
+        grow();
+    }
+    auto mask = slots_.size() - 1;
+    auto index = home(grant_id);
+    while (slots_[index].status != GrantStatus::None && slots_[index].id != grant_id) {
+        index = (index + 1) & mask;
+    }
+    auto &slot = slots_[index];
+    if (slot.status == GrantStatus::None) {
+        size_ += 1;
+        slot.id = grant_id;
+    }
+    return slot;
+}
+
+// Backward-shift deletion: pull later members of the probe run into the
+// hole so lookups never need tombstones.
+void GrantIdempotencyStore::erase(Slot &slot) {
+    auto mask = slots_.size() - 1;
+    auto hole = static_cast<std::size_t>(&slot - slots_.data());
+    auto next = hole;
+    while (true) {
+        next = (next + 1) & mask;
+        if (slots_[next].status == GrantStatus::None) {
+            break;
+        }
+        auto wanted = home(slots_[next].id);
+        // Movable unless its home lies cyclically in (hole, next].
+        bool stays = hole <= next ? (wanted > hole && wanted <= next)
+                                  : (wanted > hole || wanted <= next);
+        if (!stays) {
+            slots_[hole] = slots_[next];
+            hole = next;
+        }
+    }
+    slots_[hole] = Slot{};
+    size_ -= 1;
+}
+
+void GrantIdempotencyStore::grow() {
+    std::vector<Slot> previous(slots_.size() * 2);
+    previous.swap(slots_);
+    auto mask = slots_.size() - 1;
+    for (const auto &slot : previous) {
+        if (slot.status == GrantStatus::None) {
+            continue;
+        }
+        auto index = home(slot.id);
+        while (slots_[index].status != GrantStatus::None) {
+            index = (index + 1) & mask;
+        }
+        slots_[index] = slot;
+    }
+}
+
+std::uint32_t GrantIdempotencyStore::bucketOf(Clock::time_point now) const {
+    auto seconds = std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch());
+    return static_cast<std::uint32_t>(std::max<std::int64_t>(0, seconds.count()) /
+                                      config_.bucket.count());
+}
+
+// Moving to a newer bucket reuses the ring entries of buckets that just left
+// the window; their ids are erased unless they were begun again since.
+void GrantIdempotencyStore::advance(std::uint32_t bucket) {
+    if (!started_) {
+        started_ = true;
+        newest_bucket_ = bucket;
+        return;
+    }
+    if (bucket <= newest_bucket_) {
+        return;
+    }
+    auto span = ring_.size();
+    auto steps = std::min<std::uint64_t>(bucket - newest_bucket_, span);
+    for (std::uint64_t step = 1; step <= steps; ++step) {
+        auto reused = static_cast<std::uint64_t>(newest_bucket_) + step;
+        auto &ids = ring_[reused % span];
+        for (std::size_t i = 0; i < ids.size(); ++i) {
+            // A bucket's ids are scattered over the table; fetch a few
+            // lookups ahead so the misses overlap.
+            if (i + kExpiryPrefetch < ids.size()) {
+                prefetch(&slots_[home(ids[i + kExpiryPrefetch])]);
+            }
+            auto grant_id = ids[i];
+            auto *slot = find(grant_id);
+            if (slot && static_cast<std::uint64_t>(slot->bucket) + span <= bucket) {
+                erase(*slot);
+            }
+        }
+        ids.clear();
+    }
+    newest_bucket_ = bucket;
+
+    if (journal_.is_open() &&
+        journal_records_ > config_.journal_compact_ratio * size_ + kJournalCompactFloor) {
+        compactJournal();
+    }
+}
+
+bool GrantIdempotencyStore::setStatus(GrantId grant_id, GrantStatus status) {
+    auto &slot = locate(grant_id);
+    if (slot.status == GrantStatus::None) {
+        slot.bucket = newest_bucket_;
+        ring_[newest_bucket_ % ring_.size()].push_back(grant_id);
+    }
+    slot.status = status;
+    return journal(slot);
+}
+
+// A failed append closes the journal: later records would follow a torn one
+// and be lost on replay anyway.
+bool GrantIdempotencyStore::journal(const Slot &slot) {
+    if (!journal_.is_open()) {
+        return true;
+    }
+    record_.clear();
+    putRecord(record_, slot.id, slot.bucket * static_cast<std::uint32_t>(config_.bucket.count()),
+              slot.status);
+    if (writeAll(journal_, record_)) {
+        journal_records_ += 1;
+        return true;
+    }
+    journal_errors_ += 1;
+    closeJournal();
+    return false;
+}
+
+bool GrantIdempotencyStore::writeLiveGrants(const std::string &path) {
+    std::vector<std::uint8_t> image;
+    image.reserve(kJournalHeaderSize + size_ * kJournalRecordSize);
+    common::putRecordHeader(image, kFormat);
+    for (const auto &slot : slots_) {
+        if (slot.status != GrantStatus::None) {
+            putRecord(image, slot.id, slot.bucket * static_cast<std::uint32_t>(config_.bucket.count()),
+                      slot.status);
+        }
+    }
+    if (!common::replaceFile(path, image)) {
+        return false;
+    }
+    journal_records_ = size_;
+    return true;
+}
+
+// Rewrites the open journal with only the live grants. If the rewrite fails
+// the old file is intact and appending simply continues.
+void GrantIdempotencyStore::compactJournal() {
+    journal_.close();
+    writeLiveGrants(journal_path_);
+    journal_.open(journal_path_, std::ios::binary | std::ios::app);
+    if (!journal_) {
+        journal_errors_ += 1;
+        closeJournal();
+    }
+}
+
+}  // namespace reward
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "reward/inventory.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace reward {
+
+struct GrantStoreConfig {
+    // How long a grant id is remembered after it was begun.
+    std::chrono::seconds window{std::chrono::hours(24)};
+    // Expiry granularity; ids expire up to one bucket late.
+    std::chrono::seconds bucket{std::chrono::minutes(1)};
+    std::size_t initial_capacity{1024};
+    // An open journal is rewritten with only the live grants once it holds
+    // more than this many records per live grant (checked as buckets expire).
+    std::size_t journal_compact_ratio{4};
+};
+
+// Grant idempotency state for the last `window` of grants. Ids live in an
+// open-addressing table (linear probing, backward-shift deletion, so no
+// tombstones) and are also listed in a ring of per-bucket id vectors; moving
+// past a bucket erases its ids, so memory follows the grants per window
+// rather than the grants ever seen. Expiry runs lazily from begin().
+//
+// With a journal open, every state change is appended to a file and flushed
+// to the OS before the call returns, so dedup survives a process restart.
+// If an append fails the journal is closed (journalOpen() turns false and
+// journalErrors() counts it) and the store carries on in memory only.
+// The file is an 8-byte header ("DHGJ", uint16 version, uint16 record size)
+// followed by 16-byte little-endian records: grant id u64, begin time u32
+// (unix seconds), status u8, 3 bytes padding. Times are wall-clock so replay
+// can drop grants that expired while the process was down.
+class GrantIdempotencyStore {
+public:
+    using Clock = std::chrono::system_clock;
+
+    explicit GrantIdempotencyStore(GrantStoreConfig config = GrantStoreConfig());
+    ~GrantIdempotencyStore();
+    GrantIdempotencyStore(const GrantIdempotencyStore &) = delete;
+    GrantIdempotencyStore &operator=(const GrantIdempotencyStore &) = delete;
+
+    // Marks the grant Pending; false if it is already Pending or Completed
+    // (a Failed grant may be retried), or if its journal record could not
+    // be written, in which case nothing changes.
+    bool begin(GrantId grant_id, Clock::time_point now);
+    // False only when the journal record could not be written; the status
+    // changes regardless.
+    bool complete(GrantId grant_id);
+    bool fail(GrantId grant_id);
+    GrantStatus status(GrantId grant_id) const;
+    // Forgets grants begun more than `window` before `now`.
+    void expire(Clock::time_point now);
+
+    std::size_t size() const;
+    std::size_t capacity() const;
+    const GrantStoreConfig &config() const;
+
+    // Replays `path` (if it exists), rewrites it with only the live grants,
+    // and appends every later change to it, compacting again as it grows. A torn final record from a crash
+    // is dropped. False if the file cannot be opened or is not a journal.
+    bool openJournal(const std::string &path, Clock::time_point now);
+    void closeJournal();
+    bool journalOpen() const;
+    // Journal writes that failed (each one closed the journal).
+    std::uint64_t journalErrors() const;
+
+    static constexpr std::uint16_t kJournalVersion = 1;
+    static constexpr std::size_t kJournalHeaderSize = 8;
+    static constexpr std::size_t kJournalRecordSize = 16;
+
+private:
+    struct Slot {
+        GrantId id{0};
+        std::uint32_t bucket{0};
+        // None marks an empty slot.
+        GrantStatus status{GrantStatus::None};
+    };
+
+    std::size_t home(GrantId grant_id) const;
+    Slot *find(GrantId grant_id);
+    const Slot *find(GrantId grant_id) const;
+    Slot &locate(GrantId grant_id);
+    void erase(Slot &slot);
+    void grow();
+    std::uint32_t bucketOf(Clock::time_point now) const;
+    void advance(std::uint32_t bucket);
+    bool setStatus(GrantId grant_id, GrantStatus status);
+    bool journal(const Slot &slot);
+    bool writeLiveGrants(const std::string &path);
+    void compactJournal();
+
+    GrantStoreConfig config_;
+    std::vector<Slot> slots_;
+    std::size_t size_{0};
+    // ring_[b % ring_.size()] lists ids begun in absolute bucket b.
+    std::vector<std::vector<GrantId>> ring_;
+    std::uint32_t newest_bucket_{0};
+    bool started_{false};
+    std::ofstream journal_;
+    std::string journal_path_;
+    // Records in the journal file, including the compacted ones.
+    std::size_t journal_records_{0};
+    std::uint64_t journal_errors_{0};
+    std::vector<std::uint8_t> record_;
+};
+
+}  // namespace reward
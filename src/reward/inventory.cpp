@@ -1,12 +1,23 @@
 #include "reward/inventory.h"
 
+#include "reward/grant_store.h"
+
 #include <algorithm>
 
 namespace reward {
 
 Inventory::Inventory(std::size_t capacity) : capacity_(capacity) {}
 
+void Inventory::attachGrantStore(GrantIdempotencyStore *store,
+                                 std::chrono::system_clock::time_point now) {
+    grant_store_ = store;
+    grant_time_ = now;
+}
+
 bool Inventory::beginGrant(GrantId grant_id) {
+    if (grant_store_) {
+        return grant_store_->begin(grant_id, grant_time_);
+    }
     auto &status = grant_status_[grant_id];
     if (status == GrantStatus::Completed || status == GrantStatus::Pending) {
         return false;
@@ -16,10 +27,18 @@ bool Inventory::beginGrant(GrantId grant_id) {
 }
 
 void Inventory::commitGrant(GrantId grant_id) {
+    if (grant_store_) {
+        grant_store_->complete(grant_id);
+        return;
+    }
     grant_status_[grant_id] = GrantStatus::Completed;
 }
 
 void Inventory::failGrant(GrantId grant_id) {
+    if (grant_store_) {
+        grant_store_->fail(grant_id);
+        return;
+    }
     grant_status_[grant_id] = GrantStatus::Failed;
 }
 
@@ -51,6 +70,9 @@ void Inventory::removeItem(std::uint32_t item_id, std::uint32_t quantity) {
 }
 
 GrantStatus Inventory::grantStatus(GrantId grant_id) const {
+    if (grant_store_) {
+        return grant_store_->status(grant_id);
+    }
     auto it = grant_status_.find(grant_id);
     if (it == grant_status_.end()) {
         return GrantStatus::None;
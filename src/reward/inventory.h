@@ -1,11 +1,14 @@
 #pragma once
 
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <unordered_map>
 
 namespace reward {
 
+class GrantIdempotencyStore;
+
 using GrantId = std::uint64_t;
 
 enum class GrantStatus {
@@ -19,6 +22,12 @@ class Inventory {
 public:
     explicit Inventory(std::size_t capacity = 100);
 
+    // Keeps grant states in `store` (bounded by its time window) instead of
+    // the inventory's own map; the store must outlive the inventory. Grants
+    // begun through this inventory are stamped with `now`.
+    void attachGrantStore(GrantIdempotencyStore *store,
+                          std::chrono::system_clock::time_point now);
+
     bool beginGrant(GrantId grant_id);
     void commitGrant(GrantId grant_id);
     void failGrant(GrantId grant_id);
@@ -34,6 +43,8 @@ private:
     std::size_t capacity_;
     std::unordered_map<std::uint32_t, std::uint32_t> items_;
     std::unordered_map<GrantId, GrantStatus> grant_status_;
+    GrantIdempotencyStore *grant_store_{nullptr};
+    std::chrono::system_clock::time_point grant_time_{};
 };
 
 }  // namespace reward
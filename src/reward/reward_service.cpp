@@ -2,6 +2,10 @@
 
 namespace reward {
 
+RewardService::RewardService() {
+    compileDropTables();
+}
+
 RewardService::GrantResult RewardService::grantRewardsDetailed(Inventory &inventory,
                                                                GrantId grant_id,
                                                                const std::vector<RewardItem> &items) {
@@ -34,6 +38,16 @@ bool RewardService::grantFromTable(Inventory &inventory, GrantId grant_id, std::
     return grantRewards(inventory, grant_id, rewards);
 }
 
+bool RewardService::grantFromTable(Inventory &inventory, GrantId grant_id, std::uint32_t table_id, DropRng &rng) {
+    std::vector<RewardItem> rewards;
+    if (auto file = drop_table_library_.current()) {
+        file->view().roll(table_id, rng, rewards);
+    } else {
+        compiled_drop_table_.view().roll(table_id, rng, rewards);
+    }
+    return grantRewards(inventory, grant_id, rewards);
+}
+
 bool RewardService::validateClientRewards(const std::vector<RewardItem> &items,
                                           std::size_t max_items,
                                           std::uint32_t max_total_count) const {
@@ -64,4 +78,20 @@ DropTable &RewardService::dropTable() {
     return drop_table_;
 }
 
+void RewardService::compileDropTables() {
+    compiled_drop_table_ = CompiledDropTable::compile(drop_table_);
+}
+
+DropTableView RewardService::compiledDropTables() const {
+    return compiled_drop_table_.view();
+}
+
+bool RewardService::loadDropTableFile(const std::string &path) {
+    return drop_table_library_.load(path);
+}
+
+DropTableLibrary &RewardService::dropTableLibrary() {
+    return drop_table_library_;
+}
+
 }  // namespace reward
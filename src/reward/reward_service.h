@@ -1,16 +1,21 @@
 #pragma once
 
+#include "reward/compiled_drop_table.h"
 #include "reward/drop_table.h"
+#include "reward/drop_table_file.h"
 #include "reward/inventory.h"
 
 #include <cstdint>
 #include <random>
+#include <string>
 #include <vector>
 
 namespace reward {
 
 class RewardService {
 public:
+    RewardService();
+
     enum class GrantResult {
         Completed,
         Duplicate,
@@ -22,15 +27,28 @@ public:
                                      const std::vector<RewardItem> &items);
     bool grantRewards(Inventory &inventory, GrantId grant_id, const std::vector<RewardItem> &items);
     bool grantFromTable(Inventory &inventory, GrantId grant_id, std::uint32_t table_id, std::mt19937 &rng);
+    // Rolls the loaded drop table file if there is one, else the compiled
+    // tables; pass DropRng::forInstance(seed, table_id) for drops that replay
+    // from the instance seed.
+    bool grantFromTable(Inventory &inventory, GrantId grant_id, std::uint32_t table_id, DropRng &rng);
     bool validateClientRewards(const std::vector<RewardItem> &items,
                                std::size_t max_items,
                                std::uint32_t max_total_count) const;
 
     const DropTable &dropTable() const;
     DropTable &dropTable();
+    // Rebuilds the compiled tables; call after editing dropTable().
+    void compileDropTables();
+    DropTableView compiledDropTables() const;
+    // Loaded files take precedence over dropTable(); reload() on the library
+    // swaps in a new file without pausing grants.
+    bool loadDropTableFile(const std::string &path);
+    DropTableLibrary &dropTableLibrary();
 
 private:
     DropTable drop_table_{};
+    CompiledDropTable compiled_drop_table_;
+    DropTableLibrary drop_table_library_;
 };
 
 }  // namespace reward
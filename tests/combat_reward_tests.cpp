@@ -1,12 +1,25 @@
+#include "combat/combat_log.h"
+#include "combat/damage_history.h"
 #include "combat/dispatcher.h"
+#include "combat/entity_store.h"
+#include "combat/spatial_grid.h"
+#include "reward/compiled_drop_table.h"
 #include "reward/drop_table.h"
+#include "reward/drop_table_file.h"
 #include "reward/inventory.h"
 #include "reward/reward_service.h"
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <limits>
 #include <optional>
 #include <random>
+#include <sstream>
+#include <string>
 #include <vector>
 
 int main() {
@@ -63,6 +76,306 @@ int main() {
         assert(dispatcher.damageHistory().empty());
     }
 
+    {
+        combat::EntityStore store;
+        auto a = store.spawn({100, 1.0f, 2.0f, combat::Faction::Player});
+        auto b = store.spawn({50, 3.0f, 4.0f, combat::Faction::Monster});
+        auto c = store.spawn({80, 5.0f, 6.0f, combat::Faction::Monster});
+        assert(store.size() == 3);
+        assert(*store.indexOf(c) == 2);
+
+        // Despawn moves the last entity into the hole; its handle still resolves.
+        assert(store.despawn(a));
+        assert(!store.despawn(a));
+        assert(!store.contains(a));
+        assert(*store.indexOf(c) == 0);
+        assert(store.hp()[*store.indexOf(c)] == 80);
+        assert(store.positionX()[*store.indexOf(c)] == 5.0f);
+        assert(store.handles()[*store.indexOf(b)] == b);
+
+        // The freed slot is reused under a new generation.
+        auto d = store.spawn({30, 0.0f, 0.0f, combat::Faction::Player});
+        assert(d != a);
+        assert((d & 0xFFFFFFFFu) == (a & 0xFFFFFFFFu));
+        assert(store.contains(d) && !store.contains(a));
+        assert(store.setPosition(d, 7.0f, 8.0f));
+        assert(store.positionY()[*store.indexOf(d)] == 8.0f);
+        store.clear();
+        assert(store.size() == 0 && !store.contains(b));
+    }
+
+    {
+        combat::EntityStore store;
+        auto hero = store.spawn({100, 0.0f, 0.0f, combat::Faction::Player});
+        auto ally = store.spawn({100, 0.0f, 0.0f, combat::Faction::Player});
+        auto slime = store.spawn({40, 0.0f, 0.0f, combat::Faction::Monster});
+        auto boss = store.spawn({500, 0.0f, 0.0f, combat::Faction::Monster});
+
+        combat::Dispatcher dispatcher;
+        assert(!dispatcher.setSkillCooldown(9, {combat::EntityStore::kCooldownSlots, 1}));
+        assert(dispatcher.setSkillCooldown(7, {1, 10}));
+        std::size_t damage_calls = 0;
+        dispatcher.setDamageHandler([&](const combat::DamageEvent &) { damage_calls += 1; });
+
+        std::vector<combat::SkillEvent> tick_events = {
+            {hero, slime, 1, 30},
+            {ally, slime, 1, 30},   // kills the slime
+            {ally, slime, 1, 30},   // target already dead
+            {hero, ally, 1, 30},    // same faction
+            {hero, boss, 7, 100},
+            {hero, boss, 7, 100},   // slot 1 on cooldown until tick 15
+            {slime, hero, 1, 5},    // attackers are checked against pre-batch hp
+            {boss, hero, 2, 500},   // overkill clamps to 0
+            {0, boss, 1, 10},       // unknown attacker
+        };
+        auto result = dispatcher.applySkillBatch(store, tick_events, 5);
+        assert(result.applied == 5);
+        assert(result.killed == 2);
+        assert(result.rejected == 4);
+        assert(damage_calls == 5);
+        assert(dispatcher.damageHistory().size() == 5);
+        assert(store.hp()[*store.indexOf(slime)] == 0);
+        assert(store.hp()[*store.indexOf(hero)] == 0);
+        assert(store.hp()[*store.indexOf(boss)] == 400);
+        assert(store.cooldownReady(1)[*store.indexOf(hero)] == 15);
+
+        std::vector<combat::SkillEvent> later = {{ally, boss, 7, 100}, {ally, boss, 7, 100}};
+        result = dispatcher.applySkillBatch(store, later, 6);
+        assert(result.applied == 1 && result.rejected == 1);
+        assert(store.hp()[*store.indexOf(boss)] == 300);
+
+        // Negative damage heals, clamped to max hp.
+        std::vector<combat::DamageEvent> heals = {{ally, boss, 0, -1000}, {ally, hero, 0, -10}};
+        result = dispatcher.applyDamageBatch(store, heals);
+        assert(result.applied == 1 && result.rejected == 1);
+        assert(store.hp()[*store.indexOf(boss)] == 500);
+    }
+
+    auto detected_kernel = combat::activeDamageKernel();
+    for (auto kernel : {combat::DamageKernel::Portable, combat::DamageKernel::Avx2}) {
+        if (!combat::setDamageKernel(kernel)) {
+            continue;
+        }
+        combat::EntityStore store;
+        auto hero = store.spawn({100, 0.0f, 0.0f, combat::Faction::Player});
+        auto ally = store.spawn({100, 0.0f, 0.0f, combat::Faction::Player});
+        auto goblin = store.spawn({5000, 0.0f, 0.0f, combat::Faction::Monster, 100});
+        auto rat = store.spawn({10, 0.0f, 0.0f, combat::Faction::Monster});
+
+        std::vector<combat::SkillEvent> events = {
+            {hero, rat, 1, 30},
+            {ally, rat, 1, 30},     // simultaneous: lands even though the first hit kills
+            {rat, hero, 1, 5},
+            {hero, ally, 1, 5},     // same faction
+            {ally, goblin, 1, -40}, // clamped to zero
+        };
+        for (int i = 0; i < 19; ++i) {
+            events.push_back({i % 2 == 0 ? hero : ally, goblin, 1, 101});  // 50.5 -> 50
+        }
+        std::vector<std::size_t> handled;
+        combat::Dispatcher dispatcher;
+        dispatcher.setDamageBatchHandler([&](const combat::DamageBatch &batch) {
+            handled.push_back(batch.events.size());
+        });
+        const auto &batch = dispatcher.resolveSkillBatch(store, events, 1);
+        assert(handled.size() == 1 && handled[0] == 23);
+        assert(batch.rejected == 1);
+        assert(batch.killed == 1);
+        assert(batch.events[0].amount == 30 && batch.events[3].amount == 0);
+        assert(batch.events[4].amount == 50 && batch.events[4].source_id == hero);
+        assert(dispatcher.damageHistory().size() == 23);
+
+        // Per-target aggregate, in store order.
+        assert(batch.targets.size() == 3);
+        assert(batch.targets[0] == hero && batch.totals[0] == 5 && batch.hp_after[0] == 95);
+        assert(batch.targets[1] == goblin && batch.totals[1] == 19 * 50);
+        assert(batch.hp_after[1] == 5000 - 19 * 50);
+        assert(batch.targets[2] == rat && batch.totals[2] == 60 && batch.hp_after[2] == 0);
+        assert(store.hp()[*store.indexOf(goblin)] == 5000 - 19 * 50);
+
+        // The dead rat rejects the next tick's hits.
+        std::vector<combat::SkillEvent> next = {{hero, rat, 1, 30}};
+        assert(dispatcher.resolveSkillBatch(store, next, 2).rejected == 1);
+        assert(batch.events.empty() && batch.killed == 0);
+    }
+    combat::setDamageKernel(detected_kernel);
+
+    {
+        combat::DamageHistory history({32, 0});
+        std::vector<combat::DamageRecord> evicted;
+        std::size_t sink_calls = 0;
+        history.setEvictionSink([&](std::span<const combat::DamageRecord> records) {
+            sink_calls += 1;
+            evicted.insert(evicted.end(), records.begin(), records.end());
+        });
+        for (std::uint32_t i = 0; i < 100; ++i) {
+            history.push({i % 5 + 1, i % 3 + 100, 1, static_cast<std::int32_t>(i)}, i);
+        }
+        assert(history.size() <= 32 && history.size() >= 30);
+        assert(history.evictedCount() + history.size() == 100);
+        assert(evicted.size() == history.evictedCount());
+        // A full ring evicts capacity / 16 records per sink call.
+        assert(sink_calls < evicted.size());
+        for (std::size_t i = 0; i < evicted.size(); ++i) {
+            assert(evicted[i].tick == i);
+        }
+        assert(history.at(0).tick == evicted.size());
+        assert(history.at(history.size() - 1).tick == 99);
+
+        // Totals match a recount of the retained window.
+        for (combat::EntityId source = 1; source <= 5; ++source) {
+            std::int64_t amount = 0;
+            std::uint32_t hits = 0;
+            for (std::size_t i = 0; i < history.size(); ++i) {
+                if (history.at(i).event.source_id == source) {
+                    amount += history.at(i).event.amount;
+                    hits += 1;
+                }
+            }
+            assert(history.dealtBy(source).amount == amount);
+            assert(history.dealtBy(source).hits == hits);
+        }
+        assert(history.takenBy(100).hits + history.takenBy(101).hits +
+                   history.takenBy(102).hits ==
+               history.size());
+
+        history.drain();
+        assert(history.empty() && evicted.size() == 100);
+        assert(history.dealtBy(1).hits == 0 && history.takenBy(100).amount == 0);
+    }
+
+    {
+        // Window of 4 ticks at 20 Hz: only ticks 6..9 are retained.
+        combat::DamageHistory history({1024, 4});
+        for (std::uint32_t tick = 0; tick < 10; ++tick) {
+            std::vector<combat::DamageEvent> events = {{1, 2, 1, 100}, {3, 2, 1, 50}};
+            history.append(events, tick);
+        }
+        assert(history.size() == 8);
+        assert(history.at(0).tick == 6);
+        assert(history.dealtBy(1).amount == 400);
+        assert(history.takenBy(2).amount == 600);
+        auto dps = history.dps(1, std::chrono::milliseconds{50});
+        assert(dps > 1999.0 && dps < 2001.0);
+        history.advance(12);
+        assert(history.size() == 2 && history.dealtBy(3).amount == 50);
+
+        history.configure({1, 0});
+        assert(history.size() == 1 && history.at(0).event.source_id == 3);
+        history.push({7, 8, 1, 5}, 13);
+        assert(history.size() == 1 && history.dealtBy(3).hits == 0);
+        assert(history.dealtBy(7).amount == 5);
+    }
+
+    {
+        auto path = (std::filesystem::temp_directory_path() / "dungeonhub_combat_log_test.bin")
+                        .string();
+        std::filesystem::remove(path);
+        {
+            combat::CombatLogWriter writer;
+            assert(writer.open(path));
+            combat::Dispatcher dispatcher;
+            dispatcher.damageHistory().configure({16, 0});
+            dispatcher.damageHistory().setEvictionSink(writer.sink());
+
+            combat::EntityStore store;
+            auto hero = store.spawn({1000000, 0.0f, 0.0f, combat::Faction::Player});
+            auto boss = store.spawn({1000000, 0.0f, 0.0f, combat::Faction::Monster});
+            for (std::uint32_t tick = 1; tick <= 10; ++tick) {
+                std::vector<combat::SkillEvent> events(5, combat::SkillEvent{hero, boss, 3, 10});
+                dispatcher.resolveSkillBatch(store, events, tick);
+            }
+            assert(dispatcher.damageHistory().size() <= 16);
+            dispatcher.damageHistory().drain();
+            assert(writer.recordsWritten() == 50);
+        }
+        auto records = combat::readCombatLog(path);
+        assert(records.has_value());
+        assert(records->size() == 50);
+        assert(records->front().tick == 1 && records->back().tick == 10);
+        assert(records->back().event.skill_id == 3 && records->back().event.amount == 10);
+        assert(std::filesystem::file_size(path) ==
+               combat::CombatLogWriter::kHeaderSize + 50 * combat::CombatLogWriter::kRecordSize);
+
+        // Reopening appends without a second header.
+        {
+            combat::CombatLogWriter writer;
+            assert(writer.open(path));
+            combat::DamageRecord extra{11, {1, 2, 3, -4}};
+            writer.write(std::span<const combat::DamageRecord>(&extra, 1));
+        }
+        records = combat::readCombatLog(path);
+        assert(records->size() == 51 && records->back().event.amount == -4);
+        std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+        assert(!combat::readCombatLog(path).has_value());
+        std::filesystem::remove(path);
+    }
+
+    {
+        combat::SpatialGrid grid(4.0f);
+        combat::EntityStore store;
+        store.attachSpatialIndex(&grid);
+        auto origin = store.spawn({100, 0.0f, 0.0f, combat::Faction::Player});
+        auto near = store.spawn({100, 3.0f, 0.0f, combat::Faction::Monster});
+        auto behind = store.spawn({100, -3.0f, 0.5f, combat::Faction::Monster});
+        auto far = store.spawn({100, 40.0f, -40.0f, combat::Faction::Monster});
+        assert(grid.size() == 4);
+
+        std::vector<combat::EntityId> hits;
+        assert(grid.queryRadius(0.0f, 0.0f, 5.0f, hits) == 3);
+        assert(std::find(hits.begin(), hits.end(), far) == hits.end());
+        hits.clear();
+        assert(grid.queryCone(0.0f, 0.0f, 1.0f, 0.0f, 0.5f, 5.0f, hits) == 2);
+        assert(std::find(hits.begin(), hits.end(), behind) == hits.end());
+        hits.clear();
+        // Wider than the populated cells: falls back to walking them.
+        assert(grid.queryRadius(0.0f, 0.0f, 1000.0f, hits) == 4);
+
+        // Moving across cells, negative coordinates and despawn all follow.
+        assert(store.setPosition(far, -2.0f, -2.0f));
+        assert(grid.withinRange(origin, far, 3.0f));
+        assert(store.despawn(near));
+        assert(!grid.contains(near) && grid.size() == 3);
+        hits.clear();
+        assert(grid.queryRadius(0.0f, 0.0f, 5.0f, hits) == 3);
+        assert(grid.position(behind)->x == -3.0f);
+
+        combat::Dispatcher dispatcher;
+        dispatcher.setSkillValidator(combat::makeRangeValidator(grid, {{1, 2.0f}}));
+        std::vector<combat::SkillEvent> events = {
+            {origin, far, 1, 10},     // ~2.8 away, out of range
+            {origin, behind, 2, 10},  // no range rule
+        };
+        auto result = dispatcher.applySkillBatch(store, events, 1);
+        assert(result.applied == 1 && result.rejected == 1);
+        assert(store.setPosition(far, 1.0f, 1.0f));
+        result = dispatcher.applySkillBatch(store, std::span(events).first(1), 2);
+        assert(result.applied == 1);
+
+        // Non-finite positions are refused; huge ones land in the edge cell.
+        auto nan = std::numeric_limits<float>::quiet_NaN();
+        auto inf = std::numeric_limits<float>::infinity();
+        assert(!store.setPosition(far, nan, 0.0f));
+        assert(!grid.upsert(far, 0.0f, inf));
+        assert(grid.position(far)->x == 1.0f);
+        hits.clear();
+        assert(grid.queryRadius(nan, 0.0f, 5.0f, hits) == 0);
+        assert(grid.queryRadius(0.0f, 0.0f, inf, hits) == 0);
+        assert(grid.queryCone(0.0f, 0.0f, nan, 0.0f, 0.5f, 5.0f, hits) == 0);
+        assert(grid.upsert(behind, 3.0e38f, -3.0e38f));
+        assert(grid.queryRadius(0.0f, 0.0f, 1.0e6f, hits) == 2);
+        hits.clear();
+        assert(grid.queryRadius(0.0f, 0.0f, 3.0e38f, hits) == 3);
+        assert(grid.queryRadius(3.0e38f, -3.0e38f, 1.0f, hits) == 1 && hits.back() == behind);
+
+        // Attaching to a populated store indexes what is already there.
+        combat::SpatialGrid fresh;
+        store.attachSpatialIndex(&fresh);
+        assert(fresh.size() == store.size());
+        store.attachSpatialIndex(nullptr);
+        assert(store.spatialIndex() == nullptr);
+    }
+
     {
         reward::Inventory inventory(5);
         reward::RewardService service;
@@ -103,6 +416,168 @@ int main() {
         assert(inventory.totalQuantity() <= 3);
     }
 
+    {
+        // Counter-based stream: reproducible and seekable.
+        auto a = reward::DropRng::forInstance(42, 1);
+        auto b = reward::DropRng::forInstance(42, 1);
+        auto other = reward::DropRng::forInstance(42, 2);
+        std::vector<std::uint64_t> draws;
+        for (int i = 0; i < 8; ++i) {
+            draws.push_back(a.next());
+            assert(draws.back() == b.next());
+        }
+        assert(other.next() != draws[0]);
+        reward::DropRng seeked(a.key(), 5);
+        assert(seeked.next() == draws[5]);
+
+        reward::DropTable table;
+        table.addEntry(7, reward::DropEntry{10, 1, 1, 1.0f});
+        table.addEntry(7, reward::DropEntry{11, 0, 0, 0.0f});
+        table.addEntry(7, reward::DropEntry{20, 1, 3, 0.5f, 1});
+        table.addEntry(7, reward::DropEntry{21, 5, 5, 0.3f, 1});
+        table.addEntry(7, reward::DropEntry{30, 2, 2, 3.0f, 2});
+        table.addEntry(7, reward::DropEntry{31, 2, 2, 1.0f, 2});
+        auto compiled = reward::CompiledDropTable::compile(table);
+        auto view = compiled.view();
+        assert(view.tableCount() == 2 && view.hasTable(1) && view.hasTable(7));
+        assert(!view.hasTable(8));
+
+        // Group 1 drops 20 half the time, 21 30% and nothing 20%; group 2
+        // always drops one of its two, 3:1.
+        auto rng = reward::DropRng::forInstance(9, 7);
+        std::vector<reward::RewardItem> out;
+        std::size_t item20 = 0;
+        std::size_t item21 = 0;
+        std::size_t item30 = 0;
+        constexpr std::size_t kRolls = 20000;
+        for (std::size_t i = 0; i < kRolls; ++i) {
+            out.clear();
+            auto count = view.roll(7, rng, out);
+            assert(count == out.size() && count >= 2 && count <= 3);
+            assert(out[0].item_id == 10 && out[0].quantity == 1);
+            std::size_t group1 = 0;
+            std::size_t group2 = 0;
+            for (const auto &item : out) {
+                assert(item.item_id != 11);
+                if (item.item_id == 20) {
+                    assert(item.quantity >= 1 && item.quantity <= 3);
+                    item20 += 1;
+                    group1 += 1;
+                } else if (item.item_id == 21) {
+                    assert(item.quantity == 5);
+                    item21 += 1;
+                    group1 += 1;
+                } else if (item.item_id == 30 || item.item_id == 31) {
+                    item30 += item.item_id == 30 ? 1 : 0;
+                    group2 += 1;
+                }
+            }
+            assert(group1 <= 1 && group2 == 1);
+        }
+        assert(item20 > kRolls * 45 / 100 && item20 < kRolls * 55 / 100);
+        assert(item21 > kRolls * 25 / 100 && item21 < kRolls * 35 / 100);
+        assert(item30 > kRolls * 70 / 100 && item30 < kRolls * 80 / 100);
+
+        // Same seed, same drops.
+        std::vector<reward::RewardItem> first;
+        std::vector<reward::RewardItem> second;
+        auto replay_a = reward::DropRng::forInstance(1234, 7);
+        auto replay_b = reward::DropRng::forInstance(1234, 7);
+        view.roll(7, replay_a, first);
+        view.roll(7, replay_b, second);
+        assert(first.size() == second.size());
+        for (std::size_t i = 0; i < first.size(); ++i) {
+            assert(first[i].item_id == second[i].item_id &&
+                   first[i].quantity == second[i].quantity);
+        }
+        assert(view.roll(8, replay_a, first) == 0);
+
+        reward::Inventory inventory(100);
+        reward::RewardService service;
+        service.dropTable().addEntry(7, reward::DropEntry{10, 2, 2, 1.0f});
+        service.compileDropTables();
+        auto grant_rng = reward::DropRng::forInstance(5, 7);
+        assert(service.grantFromTable(inventory, 88, 7, grant_rng));
+        assert(inventory.items().at(10) == 2);
+        assert(service.compiledDropTables().hasTable(1));
+    }
+
+    {
+        std::istringstream csv(
+            "table_id,item_id,min_quantity,max_quantity,probability,group\n"
+            "# starter chest\n"
+            "1, 1001, 1, 2, 0.75\n"
+            "1, 2001, 1, 1, 0.25\n"
+            "\n"
+            "4, 7001, 1, 1, 0.6, 1\n"
+            "4, 7002, 2, 3, 0.4, 1\n");
+        auto parsed = reward::parseDropTableCsv(csv);
+        assert(parsed && parsed->tables().size() == 2 && parsed->tables().at(4).size() == 2);
+        std::istringstream bad("1,1001,1,2,0.5\n1,oops,1,1,0.1\n");
+        std::size_t error_line = 0;
+        assert(!reward::parseDropTableCsv(bad, &error_line) && error_line == 2);
+
+        auto compiled = reward::CompiledDropTable::compile(*parsed);
+        auto path = (std::filesystem::temp_directory_path() / "dungeonhub_drop_tables_test.dhdt")
+                        .string();
+        assert(reward::writeDropTableFile(path, compiled.view()));
+        auto file = reward::DropTableFile::open(path);
+        assert(file && file->view().tableCount() == 2 && file->view().hasTable(4));
+
+        // The mapped records roll exactly like the in-memory ones.
+        auto memory_rng = reward::DropRng::forInstance(77, 4);
+        auto file_rng = reward::DropRng::forInstance(77, 4);
+        std::vector<reward::RewardItem> from_memory;
+        std::vector<reward::RewardItem> from_file;
+        for (int i = 0; i < 100; ++i) {
+            compiled.view().roll(4, memory_rng, from_memory);
+            file->view().roll(4, file_rng, from_file);
+        }
+        assert(from_memory.size() == 100 && from_file.size() == 100);
+        for (std::size_t i = 0; i < from_file.size(); ++i) {
+            assert(from_memory[i].item_id == from_file[i].item_id &&
+                   from_memory[i].quantity == from_file[i].quantity);
+        }
+
+        reward::RewardService service;
+        assert(service.loadDropTableFile(path));
+        reward::Inventory inventory(100);
+        auto rng = reward::DropRng::forInstance(3, 4);
+        assert(service.grantFromTable(inventory, 99, 4, rng));
+        assert(inventory.items().count(7001) + inventory.items().count(7002) == 1);
+
+        // A reload swaps tables under a pinned snapshot without disturbing it.
+        auto &library = service.dropTableLibrary();
+        auto pinned = library.current();
+        reward::DropTable next;
+        next.addEntry(9, reward::DropEntry{9001, 1, 1, 1.0f});
+        auto next_compiled = reward::CompiledDropTable::compile(next);
+        assert(reward::writeDropTableFile(path, next_compiled.view()));
+        auto generation = library.generation();
+        assert(library.reload() && library.generation() == generation + 1);
+        assert(library.current()->view().hasTable(9) && !library.current()->view().hasTable(4));
+        assert(pinned->view().hasTable(4));
+
+        // Corrupt files are refused and the published tables stay.
+        auto image_size = std::filesystem::file_size(path);
+        std::filesystem::resize_file(path, image_size - 4);
+        assert(!reward::DropTableFile::open(path));
+        assert(!library.reload() && library.current()->view().hasTable(9));
+        std::filesystem::resize_file(path, image_size);
+        {
+            reward::DropTableFileHeader header;
+            std::ifstream input(path, std::ios::binary);
+            input.read(reinterpret_cast<char *>(&header), sizeof(header));
+            std::fstream patch(path, std::ios::binary | std::ios::in | std::ios::out);
+            reward::CompiledTable table{9, 50, 1, 0, 0};
+            patch.seekp(static_cast<std::streamoff>(header.tables_offset));
+            patch.write(reinterpret_cast<const char *>(&table), sizeof(table));
+        }
+        assert(!reward::DropTableFile::open(path));
+        assert(!reward::DropTableFile::open(path + ".missing"));
+        std::filesystem::remove(path);
+    }
+
     {
         reward::RewardService service;
         std::vector<reward::RewardItem> items = {
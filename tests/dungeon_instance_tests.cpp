@@ -1,9 +1,17 @@
 #include "dungeon/authoritative_validation.h"
 #include "dungeon/instance_manager.h"
+#include "dungeon/tick_scheduler.h"
 #include "party/party.h"
 
+#include <atomic>
 #include <cassert>
 #include <chrono>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
 
 int main() {
     using namespace std::chrono;
@@ -129,6 +137,66 @@ int main() {
                                           party_service));
     }
 
+    {
+        party::PartyService party_service;
+        auto party_id = party_service.createParty(300, "leader");
+        assert(party_id.has_value());
+
+        dungeon::InstanceManager manager;
+        manager.setReclaimGrace(seconds{5});
+        auto start = steady_clock::now();
+        auto first = manager.createInstance(*party_id, party_service);
+        assert(first.has_value());
+        manager.find(*first)->ticket = "ticket-1";
+        manager.find(*first)->member_sessions.push_back(300);
+        assert(manager.terminateInstance(*first, start));
+
+        // Still readable during the grace period.
+        assert(manager.reclaim(start + seconds{4}) == 0);
+        assert(manager.find(*first) != nullptr);
+
+        std::vector<std::uint64_t> released;
+        assert(manager.reclaim(start + seconds{5}, [&](const dungeon::InstanceRecord &record) {
+                   released = record.member_sessions;
+               }) == 1);
+        assert(released == std::vector<std::uint64_t>{300});
+        assert(manager.size() == 0);
+        assert(manager.find(*first) == nullptr);
+
+        // The slot is reused under a new generation; the old id stays dead.
+        auto second = manager.createInstance(*party_id, party_service);
+        assert(second.has_value() && *second != *first);
+        assert((*second & 0xFFFFFFFFu) == (*first & 0xFFFFFFFFu));
+        assert(manager.find(*first) == nullptr);
+        assert(!manager.terminateInstance(*first, start));
+        assert(manager.find(*second)->ticket.empty());
+        assert(manager.find(*second)->member_sessions.empty());
+        assert(!manager.getInstance(0).has_value());
+
+        // Reclaimed by due time, not terminate order, after the grace shrinks.
+        auto slow = manager.createInstance(*party_id, party_service);
+        auto quick = manager.createInstance(*party_id, party_service);
+        assert(manager.terminateInstance(*slow, start));
+        manager.setReclaimGrace(seconds{1});
+        assert(manager.terminateInstance(*quick, start));
+        assert(manager.reclaim(start + seconds{1}) == 1);
+        assert(manager.find(*quick) == nullptr && manager.find(*slow) != nullptr);
+        assert(manager.reclaim(start + seconds{5}) == 1);
+        manager.setReclaimGrace(seconds{5});
+
+        // Steady churn never grows past the peak number of live instances.
+        auto now = start;
+        for (int run = 0; run < 5000; ++run) {
+            now += milliseconds{10};
+            auto id = manager.createInstance(*party_id, party_service);
+            assert(id.has_value());
+            manager.terminateInstance(*id, now);
+            manager.reclaim(now);
+        }
+        assert(manager.size() <= 502);
+        assert(manager.capacity() <= 3 * dungeon::InstanceManager::kSlotsPerSlab);
+    }
+
     {
         dungeon::MovementValidator validator(5.0f);
         dungeon::MovementSample valid{1, 4.0f, milliseconds{1000}};
@@ -140,5 +208,165 @@ int main() {
         assert(reason == "Movement speed exceeds server limit");
     }
 
+    {
+        dungeon::MovementValidator validator(5.0f);
+        std::mt19937 rng(3);
+        std::uniform_real_distribution<float> distance(0.0f, 12.0f);
+        std::uniform_int_distribution<std::int32_t> elapsed(-20, 2000);
+        // 203 samples: full vectors plus a scalar tail, and a partial mask word.
+        std::vector<std::uint64_t> ids;
+        std::vector<float> distances;
+        std::vector<std::int32_t> elapsed_ms;
+        for (std::uint64_t i = 0; i < 203; ++i) {
+            ids.push_back(i + 1);
+            distances.push_back(distance(rng));
+            elapsed_ms.push_back(i % 17 == 0 ? 0 : elapsed(rng));
+        }
+        distances[5] = 5.0f;
+        elapsed_ms[5] = 1000;
+
+        auto detected = dungeon::activeMovementKernel();
+        for (auto kernel : {dungeon::MovementKernel::Portable, dungeon::MovementKernel::Avx2}) {
+            if (!dungeon::setMovementKernel(kernel)) {
+                continue;
+            }
+            dungeon::MovementBatchResult result;
+            assert(validator.validateBatch(ids, distances, elapsed_ms, result));
+            assert(result.rejected_mask.size() == 4 && result.reasons.size() == 203);
+            std::size_t rejected = 0;
+            for (std::size_t i = 0; i < ids.size(); ++i) {
+                auto expected = validator.check(
+                    {ids[i], distances[i], milliseconds{elapsed_ms[i]}});
+                assert(result.reasons[i] == expected);
+                assert(result.isRejected(i) == (expected != dungeon::MovementRejection::None));
+                rejected += expected != dungeon::MovementRejection::None ? 1 : 0;
+            }
+            assert(result.rejected == rejected && rejected > 0);
+            assert(result.reasons[0] == dungeon::MovementRejection::InvalidElapsed);
+            assert(!result.isRejected(5));
+
+            assert(!validator.validateBatch(ids, std::span(distances).first(10), elapsed_ms,
+                                            result));
+            assert(result.reasons.size() == 203);
+        }
+        dungeon::setMovementKernel(detected);
+        assert(std::string(dungeon::movementRejectionReason(
+                   dungeon::MovementRejection::InvalidElapsed)) == "Invalid elapsed time");
+    }
+
+    {
+        dungeon::TickHistogram histogram;
+        assert(histogram.percentile(0.99).count() == 0);
+        for (int i = 1; i <= 100; ++i) {
+            histogram.record(microseconds{i});
+        }
+        assert(histogram.count() == 100);
+        auto p50 = histogram.percentile(0.50);
+        auto p99 = histogram.percentile(0.99);
+        assert(p50 >= microseconds{50} && p50 <= microseconds{57});
+        assert(p99 >= microseconds{99} && p99 <= microseconds{112});
+        assert(histogram.percentile(1.0) >= microseconds{100});
+    }
+
+    {
+        dungeon::TickSchedulerConfig config;
+        config.worker_count = 2;
+        config.instance_budget = microseconds{200};
+        dungeon::TickScheduler scheduler(config);
+
+        std::vector<std::uint64_t> ticks(4, 0);
+        std::vector<std::uint64_t> last_tick(4, 0);
+        for (dungeon::InstanceId id = 1; id <= 4; ++id) {
+            assert(scheduler.add(id, [&, id](dungeon::InstanceId self, std::uint64_t tick,
+                                             nanoseconds dt) {
+                assert(self == id);
+                assert(dt == milliseconds{50});
+                ticks[id - 1] += 1;
+                last_tick[id - 1] = tick;
+                if (id == 4) {
+                    auto until = steady_clock::now() + microseconds{500};
+                    while (steady_clock::now() < until) {
+                    }
+                }
+            }));
+        }
+        assert(!scheduler.add(1, [](dungeon::InstanceId, std::uint64_t, nanoseconds) {}));
+        assert(scheduler.size() == 4);
+        // Least loaded placement alternates between the two workers.
+        assert(*scheduler.workerOf(1) == 0 && *scheduler.workerOf(2) == 1);
+        assert(*scheduler.workerOf(3) == 0 && *scheduler.workerOf(4) == 1);
+
+        std::vector<dungeon::InstanceId> overruns;
+        scheduler.setOverrunHandler([&](dungeon::InstanceId id, nanoseconds took) {
+            assert(took > microseconds{200});
+            // Runs outside the worker lock, so reporting stats is safe.
+            assert(scheduler.stats(id)->overruns == overruns.size() + 1);
+            overruns.push_back(id);
+        });
+        for (int i = 0; i < 3; ++i) {
+            scheduler.runOnce();
+        }
+        assert(ticks[0] == 3 && ticks[3] == 3);
+        assert(last_tick[0] == 2);
+        assert(overruns.size() == 3);
+        assert(overruns[0] == 4);
+
+        auto slow = scheduler.stats(4);
+        assert(slow.has_value());
+        assert(slow->ticks == 3 && slow->overruns == 3);
+        assert(slow->p99 >= microseconds{500} && slow->max >= microseconds{500});
+        auto fast = scheduler.stats(1);
+        assert(fast->ticks == 3 && fast->overruns == 0);
+        assert(scheduler.workerStats(1).instances == 2);
+        assert(scheduler.workerStats(1).ticks == 3);
+
+        // Removal takes effect at the worker's next tick; the id cannot be
+        // re-added (possibly onto another worker) until then.
+        std::vector<dungeon::InstanceId> removed;
+        assert(scheduler.remove(1, [&](dungeon::InstanceId id) {
+            assert(ticks[0] == 3);
+            removed.push_back(id);
+        }));
+        assert(!scheduler.remove(1));
+        assert(!scheduler.stats(1).has_value());
+        assert(!scheduler.add(1, [](dungeon::InstanceId, std::uint64_t, nanoseconds) {}));
+        assert(removed.empty());
+        scheduler.runOnce();
+        assert(removed == std::vector<dungeon::InstanceId>{1});
+        assert(ticks[0] == 3 && ticks[2] == 4);
+        assert(scheduler.workerStats(0).instances == 1);
+        // The freed worker receives the next instance.
+        assert(scheduler.add(5, [](dungeon::InstanceId, std::uint64_t, nanoseconds) {}));
+        assert(*scheduler.workerOf(5) == 0);
+    }
+
+    {
+        dungeon::TickSchedulerConfig config;
+        config.period = milliseconds{2};
+        config.worker_count = 2;
+        dungeon::TickScheduler scheduler(config);
+        std::atomic<std::uint64_t> total{0};
+        for (dungeon::InstanceId id = 1; id <= 8; ++id) {
+            scheduler.add(id, [&](dungeon::InstanceId, std::uint64_t, nanoseconds) {
+                total.fetch_add(1, std::memory_order_relaxed);
+            });
+        }
+        scheduler.start();
+        auto deadline = steady_clock::now() + seconds{5};
+        while (total.load() < 80 && steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(milliseconds{1});
+        }
+        std::atomic<bool> removed{false};
+        assert(scheduler.remove(8, [&](dungeon::InstanceId) { removed = true; }));
+        scheduler.stop();
+        assert(removed.load());
+        assert(total.load() >= 80);
+        auto stopped_at = total.load();
+        std::this_thread::sleep_for(milliseconds{10});
+        assert(total.load() == stopped_at);
+        assert(scheduler.stats(3)->ticks >= 5);
+        assert(scheduler.workerStats(0).ticks + scheduler.workerStats(1).ticks >= 10);
+    }
+
     return 0;
 }
@@ -2,22 +2,32 @@
 #include "admin/logging.h"
 #include "dungeon/instance_manager.h"
 #include "net/auth.h"
+#include "net/buffer_pool.h"
+#include "net/clock.h"
 #include "net/codec.h"
 #include "net/io_layer.h"
 #include "net/protocol.h"
+#include "net/protocol_fields.h"
+#include "net/replay_window.h"
 #include "net/security.h"
 #include "net/server.h"
 #include "net/session.h"
+#include "net/session_pool.h"
+#include "net/sha256.h"
+#include "net/timer_wheel.h"
 #include "net/worker_pool.h"
 
 #include <cassert>
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <cstdint>
 #include <iostream>
 #include <mutex>
+#include <span>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <thread>
 #include <unordered_map>
 #include <vector>
@@ -57,18 +67,23 @@ void assert_payload_type(const std::vector<std::uint8_t> &frame,
 
 class CoutCapture {
 public:
-    CoutCapture() : old_(std::cout.rdbuf(buffer_.rdbuf())) {}
+    CoutCapture() {
+        admin::StructuredLogger::flush();
+        old_ = std::cout.rdbuf(buffer_.rdbuf());
+    }
     ~CoutCapture() {
+        admin::StructuredLogger::flush();
         std::cout.rdbuf(old_);
     }
 
     std::string str() const {
+        admin::StructuredLogger::flush();
         return buffer_.str();
     }
 
 private:
     std::ostringstream buffer_;
-    std::streambuf *old_;
+    std::streambuf *old_{nullptr};
 };
 
 bool is_hex_string(const std::string &value) {
@@ -128,6 +143,135 @@ int main() {
         assert(decoded == payload);
     }
 
+    {
+        net::FrameBuilder builder(9, 3, 4);
+        auto *bytes = builder.extend(2);
+        bytes[0] = 0x01;
+        bytes[1] = 0x02;
+        std::vector<std::uint8_t> tail = {0x03, 0x04, 0x05};
+        builder.append(tail);
+        assert(builder.payloadSize() == 5);
+        auto frame = std::move(builder).finish();
+        assert(frame == net::Codec::encode(9, 3, std::vector<std::uint8_t>{1, 2, 3, 4, 5}));
+
+        net::ChatEvent chat{net::ChatChannel::Global, 0, "sender", "hi"};
+        assert(net::wire::encodeFrame(net::PacketType::ChatEvent, 2, chat) ==
+               net::Codec::encode(static_cast<std::uint16_t>(net::PacketType::ChatEvent), 2,
+                                  net::encodeChatEvent(chat)));
+    }
+
+    {
+        auto buffer = net::BufferPool::acquire(100);
+        assert(buffer.empty());
+        assert(buffer.capacity() >= 128);
+        const auto *storage = buffer.data();
+        auto before = net::BufferPool::stats();
+        net::BufferPool::release(std::move(buffer));
+        assert(buffer.capacity() == 0);
+        auto reused = net::BufferPool::acquire(120);
+        assert(reused.data() == storage);
+        auto after = net::BufferPool::stats();
+        assert(after.hits == before.hits + 1);
+        assert(after.recycled == before.recycled + 1);
+
+        // Oversized requests bypass the size classes.
+        auto large = net::BufferPool::acquire(net::BufferPool::kMaxClassBytes + 1);
+        assert(large.capacity() > net::BufferPool::kMaxClassBytes);
+        assert(net::BufferPool::stats().misses == after.misses + 1);
+        net::BufferPool::release(std::move(reused));
+        net::BufferPool::release(std::move(large));
+
+        net::PooledBuffer shared(net::Codec::encode(5, 1, std::vector<std::uint8_t>{7, 8}));
+        net::PooledBuffer copy = shared;
+        assert(shared.useCount() == 2);
+        assert(copy.bytes().data() == shared.bytes().data());
+        auto copied = copy.take();
+        assert(copy.empty() && copy.useCount() == 0);
+        assert(shared.useCount() == 1);
+        assert(copied.data() != shared.bytes().data());
+        assert(std::equal(copied.begin(), copied.end(), shared.bytes().begin(),
+                          shared.bytes().end()));
+        const auto *unique_storage = shared.bytes().data();
+        auto moved = shared.take();
+        assert(moved.data() == unique_storage);
+    }
+
+    {
+        // Frames split across reads, with consumed bytes compacted lazily.
+        std::vector<std::uint8_t> stream;
+        for (std::uint8_t i = 0; i < 5; ++i) {
+            auto frame = net::Codec::encode(i, 1, std::vector<std::uint8_t>(i * 10u, i));
+            stream.insert(stream.end(), frame.begin(), frame.end());
+        }
+        net::FrameDecoder decoder;
+        net::FrameHeader header{};
+        std::vector<std::uint8_t> payload;
+        std::uint16_t next_type = 0;
+        for (std::size_t offset = 0; offset < stream.size(); offset += 7) {
+            auto count = std::min<std::size_t>(7, stream.size() - offset);
+            decoder.append(std::span<const std::uint8_t>(stream.data() + offset, count));
+            while (decoder.nextFrame(header, payload)) {
+                assert(header.type == next_type);
+                assert(payload == std::vector<std::uint8_t>(next_type * 10u, next_type));
+                ++next_type;
+            }
+        }
+        assert(next_type == 5);
+    }
+
+    {
+        net::PartyEvent event;
+        event.type = net::PartyEventType::InviteAccepted;
+        event.party_id = 0x0102030405060708ULL;
+        event.actor_user_id = "leader";
+        event.target_user_id = "member";
+        event.member_user_ids = {"leader", "member", ""};
+        event.message = "Invite accepted";
+        auto payload = net::encodePartyEvent(event);
+        assert(payload.size() == 2 + 8 + (2 + 6) + (2 + 6) + (2 + 8 + 8 + 2) + (2 + 15));
+        assert(payload[2] == 0x01 && payload[9] == 0x08);
+
+        net::PartyEvent decoded;
+        assert(net::decodePartyEvent(payload, decoded));
+        assert(decoded.type == event.type);
+        assert(decoded.party_id == event.party_id);
+        assert(decoded.member_user_ids == event.member_user_ids);
+        assert(decoded.message == event.message);
+
+        // Every truncation and a trailing byte must be rejected.
+        for (std::size_t length = 0; length < payload.size(); ++length) {
+            std::vector<std::uint8_t> truncated(payload.begin(), payload.begin() + length);
+            assert(!net::decodePartyEvent(truncated, decoded));
+        }
+        payload.push_back(0);
+        assert(!net::decodePartyEvent(payload, decoded));
+
+        net::LoginRequest oversized{std::string(70000, 'x'), "pw"};
+        net::LoginRequest login;
+        assert(net::decodeLoginRequest(net::encodeLoginRequest(oversized), login));
+        assert(login.user_id.size() == 65535);
+        assert(login.password == "pw");
+
+        auto login_payload = net::encodeLoginRequest({"player", "letmein"});
+        net::LoginRequestView login_view;
+        assert(net::decodeLoginRequestView(login_payload, login_view));
+        assert(login_view.user_id == "player");
+        assert(login_view.password == "letmein");
+        const auto *base = reinterpret_cast<const char *>(login_payload.data());
+        assert(login_view.user_id.data() == base + 2);
+        assert(login_view.password.data() == base + 2 + 6 + 2);
+        login_payload.pop_back();
+        assert(!net::decodeLoginRequestView(login_payload, login_view));
+
+        net::ChatSendRequest chat{net::ChatChannel::Party, 9, "hello"};
+        net::ChatSendRequestView chat_view;
+        auto chat_payload = net::encodeChatSendRequest(chat);
+        assert(net::decodeChatSendRequestView(chat_payload, chat_view));
+        assert(chat_view.channel == net::ChatChannel::Party);
+        assert(chat_view.party_id == 9);
+        assert(chat_view.message == "hello");
+    }
+
     {
         net::SessionConfig config;
         config.heartbeat_interval = milliseconds{1000};
@@ -143,6 +287,102 @@ int main() {
         assert(!session.connected());
     }
 
+    {
+        auto start = steady_clock::now();
+        net::TimerWheel wheel(start);
+        std::vector<net::TimerWheel::Key> expired;
+        wheel.schedule(start + milliseconds{5}, 1);
+        auto cancelled = wheel.schedule(start + milliseconds{5}, 2);
+        wheel.schedule(start + milliseconds{300}, 3);
+        wheel.schedule(start + seconds{70}, 4);
+        wheel.schedule(start + hours{30}, 5);
+        assert(wheel.cancel(cancelled));
+        assert(!wheel.cancel(cancelled));
+        assert(wheel.size() == 4);
+
+        assert(wheel.advance(start + milliseconds{4}, expired) == 0);
+        assert(wheel.advance(start + milliseconds{5}, expired) == 1);
+        assert(expired.back() == 1);
+        assert(wheel.advance(start + milliseconds{299}, expired) == 0);
+        assert(wheel.advance(start + seconds{1}, expired) == 1);
+        assert(expired.back() == 3);
+        assert(wheel.advance(start + seconds{69}, expired) == 0);
+        assert(wheel.advance(start + seconds{71}, expired) == 1);
+        assert(expired.back() == 4);
+        assert(wheel.advance(start + hours{29}, expired) == 0);
+        assert(wheel.advance(start + hours{30}, expired) == 1);
+        assert(expired.back() == 5);
+        assert(wheel.size() == 0);
+
+        auto late = wheel.schedule(start, 6);
+        assert(late != net::TimerWheel::kInvalidTimer);
+        assert(wheel.advance(start + hours{30} + milliseconds{1}, expired) == 1);
+        assert(expired.back() == 6);
+    }
+
+    {
+        auto pinned = steady_clock::now() + seconds{5};
+        net::CoarseClock::update(pinned);
+        assert(net::CoarseClock::now() == pinned);
+        assert(net::CoarseClock::now() == pinned);
+        const auto &stamp = net::CoarseClock::isoTimestamp();
+        assert(stamp.size() == 20);
+        assert(stamp[10] == 'T' && stamp.back() == 'Z');
+
+        net::SessionConfig config;
+        config.rate_limit_capacity = 4.0;
+        net::Session session(6, config, pinned);
+        assert(session.enqueueSend(std::vector<std::uint8_t>(4, 0x01)));
+        assert(!session.enqueueSend(std::vector<std::uint8_t>(1, 0x02), pinned - seconds{1}));
+
+        // Wall time follows the injected steady time, not the real one.
+        auto wall_ahead = net::CoarseClock::systemNow() - std::chrono::system_clock::now();
+        assert(wall_ahead > seconds{4} && wall_ahead <= seconds{5});
+        // The cache belongs to this thread; others read the real clock.
+        std::thread([pinned] { assert(net::CoarseClock::now() < pinned); }).join();
+
+        net::CoarseClock::reset();
+        assert(net::CoarseClock::now() < pinned);
+
+        // A drain's scope ends with the drain.
+        {
+            net::CoarseClock::Scope scope(pinned);
+            assert(net::CoarseClock::now() == pinned);
+            {
+                net::CoarseClock::Scope inner(pinned + seconds{1});
+                assert(net::CoarseClock::now() == pinned + seconds{1});
+            }
+            assert(net::CoarseClock::now() == pinned);
+        }
+        assert(net::CoarseClock::now() < pinned);
+        net::IoEventLoop loop;
+        std::chrono::steady_clock::time_point seen{};
+        loop.setAcceptHandler([&](std::uint64_t, steady_clock::time_point) {
+            seen = net::CoarseClock::now();
+        });
+        loop.enqueueEvent(net::IoEvent{.type = net::IoEvent::Type::Accept, .connection_id = 1});
+        loop.drain(pinned);
+        assert(seen == pinned);
+        assert(net::CoarseClock::now() < pinned);
+    }
+
+    {
+        net::Server server;
+        net::SessionConfig config;
+        config.timeout = milliseconds{2000};
+        auto now = steady_clock::now();
+        auto idle = server.createSession(config, now);
+        auto active = server.createSession(config, now);
+        server.tick(now + milliseconds{1500});
+        assert(server.sessionCount() == 2);
+        active->onReceive(now + milliseconds{1500});
+        server.tick(now + milliseconds{2500});
+        assert(server.findSession(idle->id()) == nullptr);
+        assert(server.findSession(active->id()) != nullptr);
+        server.tick(now + milliseconds{3600});
+        assert(server.sessionCount() == 0);
+    }
+
     {
         net::SessionConfig config;
         config.send_queue_limit_bytes = 6;
@@ -154,6 +394,69 @@ int main() {
         assert(session.queuedBytes() <= config.send_queue_limit_bytes);
     }
 
+    {
+        // One shared frame fanned out to two queues without copies.
+        net::SessionConfig config;
+        auto now = steady_clock::now();
+        net::Session first(5, config, now);
+        net::Session second(6, config, now);
+        net::PooledBuffer frame(std::vector<std::uint8_t>(16, 0xEE));
+        assert(first.enqueueSend(frame, now));
+        assert(second.enqueueSend(frame, now));
+        assert(frame.useCount() == 3);
+        assert(first.queuedBytes() == 16 && second.queuedBytes() == 16);
+        net::PooledBuffer queued;
+        assert(first.dequeueSend(queued));
+        assert(queued.bytes().data() == frame.bytes().data());
+        assert(first.queuedBytes() == 0);
+        std::vector<std::uint8_t> drained;
+        assert(second.dequeueSend(drained));
+        assert(drained == std::vector<std::uint8_t>(16, 0xEE));
+        assert(frame.useCount() == 2);
+    }
+
+    {
+        // The send ring keeps FIFO order across wrap-around and growth.
+        net::SessionConfig config;
+        auto now = steady_clock::now();
+        net::Session session(7, config, now);
+        std::vector<std::uint8_t> drained;
+        std::uint8_t next_in = 0;
+        std::uint8_t next_out = 0;
+        for (int round = 0; round < 4; ++round) {
+            for (int i = 0; i < 3 + round * 3; ++i) {
+                assert(session.enqueueSend(std::vector<std::uint8_t>(1, next_in++), now));
+            }
+            for (int i = 0; i < 2 + round; ++i) {
+                assert(session.dequeueSend(drained));
+                assert(drained.size() == 1 && drained[0] == next_out++);
+            }
+        }
+        while (session.dequeueSend(drained)) {
+            assert(drained[0] == next_out++);
+        }
+        assert(next_out == next_in && session.queuedBytes() == 0);
+    }
+
+    {
+        net::SessionConfig config;
+        auto now = steady_clock::now();
+        auto before = net::SessionPool::stats();
+        auto first = net::makeSession(1, config, now);
+        auto second = net::makeSession(2, config, now);
+        assert(reinterpret_cast<std::uintptr_t>(first.get()) % alignof(net::Session) == 0);
+        assert(net::SessionPool::stats().live == before.live + 2);
+        const net::Session *freed = first.get();
+        first.reset();
+        auto third = net::makeSession(3, config, now);
+        assert(third.get() == freed);
+        assert(third->id() == 3 && second->id() == 2);
+        assert(net::SessionPool::stats().reused >= before.reused + 1);
+        second.reset();
+        third.reset();
+        assert(net::SessionPool::stats().live == before.live);
+    }
+
     {
         net::SessionConfig config;
         config.send_queue_limit_bytes = 4;
@@ -381,6 +684,137 @@ int main() {
         assert(net::decodeDungeonResultResponse(duplicate_payload_out, duplicate_out));
         assert(!duplicate_out.success);
         assert(duplicate_out.code == "REWARD_DUPLICATE");
+        assert(server.rewardGrants().status(match_result.instance_id) ==
+               reward::GrantStatus::Completed);
+
+        // The finished run is terminated and reclaimed after the grace period;
+        // its id no longer resolves and the session is detached from it.
+        auto record = server.instanceManager().getInstance(match_result.instance_id);
+        assert(record.has_value());
+        assert(record->state == dungeon::InstanceState::Terminate);
+        assert(record->reward_grant.has_value());
+        assert(record->member_sessions == std::vector<std::uint64_t>{session->id()});
+        server.tick(now + seconds{1});
+        assert(server.instanceManager().size() == 1);
+        server.tick(now + seconds{31});
+        assert(server.instanceManager().size() == 0);
+        assert(!server.instanceManager().getInstance(match_result.instance_id).has_value());
+        // The grant outlives the reclaimed record.
+        assert(server.rewardGrants().status(match_result.instance_id) ==
+               reward::GrantStatus::Completed);
+        auto late_response =
+            server.handlePacket(*session, result_header, result_payload, now + seconds{31});
+        std::vector<std::uint8_t> late_payload_out;
+        assert_payload_type(*late_response, net::PacketType::DungeonResultRes,
+                            net::kMinProtocolVersion, late_payload_out);
+        net::DungeonResultResponse late_out;
+        assert(net::decodeDungeonResultResponse(late_payload_out, late_out));
+        assert(late_out.code == "NO_INSTANCE");
+    }
+
+    {
+        auto to_hex = [](std::span<const std::uint8_t> bytes) {
+            static constexpr char kDigits[] = "0123456789abcdef";
+            std::string out;
+            for (auto byte : bytes) {
+                out.push_back(kDigits[byte >> 4]);
+                out.push_back(kDigits[byte & 0x0F]);
+            }
+            return out;
+        };
+        auto as_bytes = [](std::string_view text) {
+            return std::span<const std::uint8_t>(
+                reinterpret_cast<const std::uint8_t *>(text.data()), text.size());
+        };
+        auto big_endian = [](std::string_view text) {
+            std::uint64_t value = 0;
+            for (char ch : text) {
+                value = (value << 8) | static_cast<std::uint8_t>(ch);
+            }
+            return value;
+        };
+        // HMAC input is seq || nonce || payload, so RFC 4231 messages are split
+        // at bytes 4 and 12.
+        auto hmac_hex = [&](const net::SignatureKey &key, std::string_view message) {
+            auto seq = static_cast<std::uint32_t>(big_endian(message.substr(0, 4)));
+            auto nonce = big_endian(message.substr(4, 8));
+            return to_hex(key.sign(seq, nonce, as_bytes(message.substr(12))));
+        };
+
+        auto original = net::activeSha256Impl();
+        for (auto impl : {net::Sha256Impl::Portable, net::Sha256Impl::ShaNi}) {
+            if (!net::setSha256Impl(impl)) {
+                continue;
+            }
+            assert(to_hex(net::Sha256::hash({})) ==
+                   "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+            assert(to_hex(net::Sha256::hash(as_bytes("abc"))) ==
+                   "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+            std::string long_input = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+            assert(to_hex(net::Sha256::hash(as_bytes(long_input))) ==
+                   "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+            net::Sha256 streamed;
+            std::string million(1000000, 'a');
+            for (std::size_t offset = 0; offset < million.size(); offset += 997) {
+                streamed.update(as_bytes(std::string_view(million).substr(offset, 997)));
+            }
+            assert(to_hex(streamed.finish()) ==
+                   "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+
+            assert(hmac_hex(net::SignatureKey("Jefe"), "what do ya want for nothing?") ==
+                   "5bdcc146bf60754e6a042426089575c7");
+            assert(hmac_hex(net::SignatureKey(std::string(131, '\xaa')),
+                            "Test Using Larger Than Block-Size Key - Hash Key First") ==
+                   "60e431591ee0b67f0d8a26aacbf5b77f");
+        }
+        assert(net::setSha256Impl(original));
+
+        net::SignatureKey key("secure-key");
+        std::vector<std::uint8_t> body = {0x09, 0x08};
+        net::SecurityHeader header{3, 4, key.sign(3, 4, body)};
+        assert(header.signature == net::computeSignature("secure-key", 3, 4, body));
+        assert(net::verifySignature(key, header, body));
+        header.signature[15] ^= 0x01;
+        assert(!net::verifySignature(key, header, body));
+    }
+
+    {
+        net::ReplayWindow window(100);
+        assert(window.size() == 128);
+        assert(!window.accept(0));
+        assert(window.accept(5));
+        assert(window.accept(3));  // reordered but inside the window
+        assert(!window.accept(3));
+        assert(!window.accept(5));
+        assert(window.accept(200));
+        assert(window.highest() == 200);
+        assert(!window.check(72));  // fell out of the window
+        assert(window.check(73));
+        assert(window.accept(199) && window.accept(150));
+        assert(!window.accept(150));
+        // A jump larger than the window forgets everything behind it.
+        assert(window.accept(1000));
+        assert(window.accept(999) && !window.accept(999));
+        window.reset(2000);
+        assert(!window.check(2000) && !window.check(1990));
+        assert(window.accept(2001));
+        assert(net::ReplayWindow(5000).size() == net::ReplayWindow::kMaxBits);
+    }
+
+    {
+        std::vector<std::uint8_t> body = {0x01, 0x02, 0x03};
+        auto secured = net::wrapSecurePayload(7, 42, "secure-key", body);
+        net::SecurityHeader header{};
+        std::span<const std::uint8_t> inner;
+        assert(net::unwrapSecurePayload(secured, header, inner));
+        assert(header.seq == 7);
+        assert(header.nonce == 42);
+        assert(inner.data() == secured.data() + net::kSecurityHeaderSize);
+        assert(std::equal(inner.begin(), inner.end(), body.begin(), body.end()));
+        assert(net::verifySignature("secure-key", header, inner));
+        assert(!net::unwrapSecurePayload(
+            std::span<const std::uint8_t>(secured.data(), net::kSecurityHeaderSize - 1),
+            header, inner));
     }
 
     {
@@ -405,6 +839,13 @@ int main() {
         auto replay_response = server.handlePacket(*session, header, secured, now);
         assert(!replay_response.has_value());
         assert(capture.str().find("\"event\":\"security_violation\"") != std::string::npos);
+        // Reordering inside the replay window is accepted once per seq.
+        auto ahead = net::wrapSecurePayload(3, 9003, policy.hmac_key, login_payload);
+        auto late = net::wrapSecurePayload(2, 9002, policy.hmac_key, login_payload);
+        assert(server.handlePacket(*session, header, ahead, now).has_value());
+        assert(server.handlePacket(*session, header, late, now).has_value());
+        assert(!server.handlePacket(*session, header, late, now).has_value());
+        assert(session->lastSeq() == 3);
     }
 
     {
@@ -427,6 +868,208 @@ int main() {
         assert(capture.str().find("Signature verification failed") != std::string::npos);
     }
 
+    {
+        net::SignatureKey server_key("secure-key");
+        auto first = net::deriveSessionKey(server_key, "token-a");
+        auto again = net::deriveSessionKey(server_key, "token-a");
+        auto other = net::deriveSessionKey(server_key, "token-b");
+        std::vector<std::uint8_t> body = {0x01, 0x02};
+        assert(first.sign(1, 2, body) == again.sign(1, 2, body));
+        assert(first.sign(1, 2, body) != other.sign(1, 2, body));
+        assert(first.sign(1, 2, body) != server_key.sign(1, 2, body));
+        assert(net::deriveSessionKey(net::SignatureKey("other-key"), "token-a")
+                   .sign(1, 2, body) != first.sign(1, 2, body));
+    }
+
+    {
+        net::SecurityPolicy policy;
+        policy.require_hmac = true;
+        policy.enable_replay_protection = true;
+        policy.hmac_key = "secure-key";
+        net::Server server(nullptr, policy);
+        net::SessionConfig config;
+        auto now = steady_clock::now();
+        auto session = server.createSession(config, now);
+        assert(session->signingKey() == nullptr);
+
+        auto login_payload = net::encodeLoginRequest(net::LoginRequest{"user1", "letmein"});
+        auto login = net::wrapSecurePayload(1, 1, policy.hmac_key, login_payload);
+        net::FrameHeader login_header{static_cast<std::uint32_t>(login.size()),
+                                      static_cast<std::uint16_t>(net::PacketType::LoginReq),
+                                      net::kMinProtocolVersion};
+        auto login_frame = server.handlePacket(*session, login_header, login, now);
+        assert(login_frame.has_value());
+        std::vector<std::uint8_t> login_response_payload;
+        assert_payload_type(*login_frame, net::PacketType::LoginRes, net::kMinProtocolVersion,
+                            login_response_payload);
+        net::LoginResponse login_response;
+        assert(net::decodeLoginResponse(login_response_payload, login_response));
+        assert(session->signingKey() != nullptr);
+        auto session_key =
+            net::deriveSessionKey(net::SignatureKey(policy.hmac_key), login_response.token);
+
+        // One read: a frame signed with the server key, a good one, a replay
+        // of it, a truncated one, a logout and a frame after it. Screening
+        // stops at the logout, which changes the key for what follows.
+        auto logout_payload = net::encodeLogoutRequest(net::LogoutRequest{});
+        auto with_server_key = net::wrapSecurePayload(2, 2, policy.hmac_key, logout_payload);
+        auto good = net::wrapSecurePayload(3, 3, session_key, logout_payload);
+        std::vector<std::uint8_t> truncated(good.begin(), good.begin() + 8);
+        auto logout = net::wrapSecurePayload(4, 4, session_key, logout_payload);
+        auto after_logout = net::wrapSecurePayload(5, 5, policy.hmac_key, logout_payload);
+        auto frame_header = [](net::PacketType type, const std::vector<std::uint8_t> &payload) {
+            return net::FrameHeader{static_cast<std::uint32_t>(payload.size()),
+                                    static_cast<std::uint16_t>(type),
+                                    net::kMinProtocolVersion};
+        };
+        auto logout_header = [&](const std::vector<std::uint8_t> &payload) {
+            return frame_header(net::PacketType::LogoutReq, payload);
+        };
+        // Screening never decodes the body, so any non-session type will do.
+        auto chat = net::PacketType::ChatSendReq;
+        std::vector<net::InboundFrame> frames(6);
+        frames[0].header = frame_header(chat, with_server_key);
+        frames[0].payload = with_server_key;
+        frames[1].header = frame_header(chat, good);
+        frames[1].payload = good;
+        frames[2] = frames[1];
+        frames[3].header = frame_header(chat, truncated);
+        frames[3].payload = truncated;
+        frames[4].header = logout_header(logout);
+        frames[4].payload = logout;
+        frames[5].header = frame_header(chat, after_logout);
+        frames[5].payload = after_logout;
+
+        auto errors_before = server.metrics().error_total;
+        CoutCapture capture;
+        assert(server.screenFrames(*session, frames) == 5);
+        assert(frames[0].rejection == net::FrameRejection::InvalidSignature);
+        assert(frames[1].rejection == net::FrameRejection::None);
+        assert(frames[1].body.data() == good.data() + net::kSecurityHeaderSize);
+        assert(frames[2].rejection == net::FrameRejection::Replay);
+        assert(frames[3].rejection == net::FrameRejection::MalformedHeader);
+        assert(frames[4].rejection == net::FrameRejection::None);
+        assert(server.metrics().error_total == errors_before + 3);
+        assert(capture.str().find("Replay sequence detected") != std::string::npos);
+        // Rejected frames never reach dispatch.
+        assert(capture.str().find("packet_received") == std::string::npos);
+
+        // A short payload passed in as screened is checked, not sliced.
+        errors_before = server.metrics().error_total;
+        std::vector<std::uint8_t> stub(3, 0x00);
+        assert(!server.handleScreenedPacket(*session, logout_header(stub), stub, now));
+        assert(server.metrics().error_total == errors_before + 1);
+        assert(session->signingKey() != nullptr);
+
+        auto logout_frame =
+            server.handleScreenedPacket(*session, frames[4].header, frames[4].payload, now);
+        assert(logout_frame.has_value());
+        assert(session->signingKey() == nullptr);
+
+        // The frame after the logout is checked against the key it left.
+        assert(server.screenFrames(*session, std::span(frames).subspan(5)) == 1);
+        assert(frames[5].rejection == net::FrameRejection::None);
+    }
+
+    {
+        net::SecurityPolicy policy;
+        policy.require_hmac = true;
+        policy.hmac_key = "secure-key";
+        net::Server server(nullptr, policy);
+        net::SessionConfig config;
+        auto now = steady_clock::now();
+        auto session = server.createSession(config, now);
+        std::size_t dispatched = 0;
+        net::PacketPipeline pipeline(
+            [&](std::uint64_t,
+                const net::FrameHeader &header,
+                const std::vector<std::uint8_t> &payload,
+                std::chrono::steady_clock::time_point received_at) {
+                auto response = server.handleScreenedPacket(*session, header, payload,
+                                                            received_at);
+                assert(response.has_value());
+                dispatched += 1;
+            });
+        pipeline.setScreen([&](std::uint64_t, std::span<net::InboundFrame> frames) {
+            return server.screenFrames(*session, frames);
+        });
+        pipeline.registerConnection(1);
+
+        auto login_payload = net::encodeLoginRequest(net::LoginRequest{"user1", "letmein"});
+        auto forged = net::wrapSecurePayload(1, 1, "wrong-key", login_payload);
+        auto signed_login = net::wrapSecurePayload(2, 2, policy.hmac_key, login_payload);
+        auto read = net::Codec::encode(static_cast<std::uint16_t>(net::PacketType::LoginReq),
+                                       net::kMinProtocolVersion, forged);
+        auto second = net::Codec::encode(static_cast<std::uint16_t>(net::PacketType::LoginReq),
+                                         net::kMinProtocolVersion, signed_login);
+        read.insert(read.end(), second.begin(), second.end());
+        CoutCapture capture;
+        pipeline.onRead(1, read, now);
+        assert(dispatched == 1);
+        assert(session->userContext().has_value());
+    }
+
+    {
+        // A reconnect pipelined with frames signed by the key it derives:
+        // those are screened only after the reconnect has been dispatched.
+        net::SecurityPolicy policy;
+        policy.require_hmac = true;
+        policy.enable_replay_protection = true;
+        policy.hmac_key = "secure-key";
+        net::Server server(nullptr, policy);
+        net::SessionConfig config;
+        auto now = steady_clock::now();
+        auto first = server.createSession(config, now);
+        auto login_payload = net::encodeLoginRequest(net::LoginRequest{"user1", "letmein"});
+        auto login = net::wrapSecurePayload(1, 1, policy.hmac_key, login_payload);
+        net::FrameHeader login_header{static_cast<std::uint32_t>(login.size()),
+                                      static_cast<std::uint16_t>(net::PacketType::LoginReq),
+                                      net::kMinProtocolVersion};
+        CoutCapture capture;
+        auto login_frame = server.handlePacket(*first, login_header, login, now);
+        assert(login_frame.has_value());
+        std::vector<std::uint8_t> login_response_payload;
+        assert_payload_type(*login_frame, net::PacketType::LoginRes, net::kMinProtocolVersion,
+                            login_response_payload);
+        net::LoginResponse login_response;
+        assert(net::decodeLoginResponse(login_response_payload, login_response));
+
+        auto second = server.createSession(config, now);
+        std::vector<net::PacketType> responses;
+        net::PacketPipeline pipeline(
+            [&](std::uint64_t,
+                const net::FrameHeader &header,
+                const std::vector<std::uint8_t> &payload,
+                std::chrono::steady_clock::time_point received_at) {
+                auto response = server.handleScreenedPacket(*second, header, payload, received_at);
+                assert(response.has_value());
+                std::vector<std::uint8_t> response_payload;
+                auto response_header = decode_header(*response, response_payload);
+                responses.push_back(static_cast<net::PacketType>(response_header.type));
+            });
+        pipeline.setScreen([&](std::uint64_t, std::span<net::InboundFrame> frames) {
+            return server.screenFrames(*second, frames);
+        });
+        pipeline.registerConnection(2);
+
+        auto reconnect_payload =
+            net::encodeSessionReconnectRequest(net::SessionReconnectRequest{login_response.token, 7});
+        auto reconnect = net::wrapSecurePayload(1, 1, policy.hmac_key, reconnect_payload);
+        auto session_key =
+            net::deriveSessionKey(net::SignatureKey(policy.hmac_key), login_response.token);
+        auto logout = net::wrapSecurePayload(8, 8, session_key,
+                                             net::encodeLogoutRequest(net::LogoutRequest{}));
+        auto read = net::Codec::encode(static_cast<std::uint16_t>(net::PacketType::SessionReconnectReq),
+                                       net::kMinProtocolVersion, reconnect);
+        auto tail = net::Codec::encode(static_cast<std::uint16_t>(net::PacketType::LogoutReq),
+                                       net::kMinProtocolVersion, logout);
+        read.insert(read.end(), tail.begin(), tail.end());
+        pipeline.onRead(2, read, now);
+        assert((responses == std::vector<net::PacketType>{net::PacketType::SessionReconnectRes,
+                                                          net::PacketType::LogoutRes}));
+        assert(second->signingKey() == nullptr);
+    }
+
     {
         net::SecurityPolicy policy;
         policy.require_tls = true;
@@ -656,12 +1299,87 @@ int main() {
         assert(output.find("\"reason\":\"testing\"") != std::string::npos);
     }
 
+    {
+        admin::StructuredLogger logger;
+        admin::LogFields fields;
+        fields.user_id = "plain_user";
+        fields.reason = std::string_view("quote\" slash\\ line\n ctl\x01", 24);
+        fields.bytes = 18446744073709551615ull;
+        CoutCapture capture;
+        logger.log("warn", "escape_event", "Tab\there", fields);
+        const auto output = capture.str();
+        assert(output.find("\"message\":\"Tab\\there\"") != std::string::npos);
+        assert(output.find("\"user_id\":\"plain_user\"") != std::string::npos);
+        assert(output.find("\"reason\":\"quote\\\" slash\\\\ line\\n ctl\\u0001\"") !=
+               std::string::npos);
+        assert(output.find("\"bytes\":18446744073709551615") != std::string::npos);
+        assert(output.find("session_trace_id") == std::string::npos);
+        assert(output.find("\"session_id\"") == std::string::npos);
+    }
+
+    {
+        admin::TraceId fixed{0x0123456789abcdefULL, 0xfedcba9876543210ULL};
+        assert(fixed.toString() == "0123456789abcdeffedcba9876543210");
+        assert(admin::TraceId{}.empty() && !fixed.empty());
+        std::vector<std::string> seen;
+        for (int i = 0; i < 1000; ++i) {
+            auto id = admin::StructuredLogger::generateTraceId();
+            assert(!id.empty());
+            seen.push_back(id.toString());
+        }
+        std::sort(seen.begin(), seen.end());
+        assert(std::adjacent_find(seen.begin(), seen.end()) == seen.end());
+
+        // Binary ids are formatted when the line is written; empty ones are omitted.
+        admin::StructuredLogger logger;
+        admin::LogFields fields;
+        fields.request_trace_id = fixed;
+        fields.session_trace_id = admin::TraceId{};
+        CoutCapture capture;
+        logger.log("info", "binary_trace", "Binary trace id", fields);
+        const auto output = capture.str();
+        assert(output.find("\"request_trace_id\":\"0123456789abcdeffedcba9876543210\"") !=
+               std::string::npos);
+        assert(output.find("session_trace_id") == std::string::npos);
+    }
+
+    {
+        auto log_burst = [](std::size_t count) {
+            std::thread producer([count] {
+                admin::StructuredLogger logger;
+                for (std::size_t i = 0; i < count; ++i) {
+                    logger.log("info", "burst", "Burst line");
+                }
+            });
+            producer.join();
+            admin::StructuredLogger::flush();
+        };
+        CoutCapture capture;
+        admin::LoggerConfig config;
+        config.ring_capacity = 4;
+        config.full_policy = admin::LogFullPolicy::Drop;
+        admin::StructuredLogger::configure(config);
+        auto before = admin::StructuredLogger::stats();
+        log_burst(2000);
+        auto after = admin::StructuredLogger::stats();
+        assert((after.written - before.written) + (after.dropped - before.dropped) == 2000);
+
+        config.full_policy = admin::LogFullPolicy::Block;
+        admin::StructuredLogger::configure(config);
+        before = after;
+        log_burst(2000);
+        after = admin::StructuredLogger::stats();
+        assert(after.written - before.written == 2000);
+        assert(after.dropped == before.dropped);
+        admin::StructuredLogger::configure(admin::LoggerConfig{});
+    }
+
     {
         net::Server server;
         net::SessionConfig config;
         auto now = steady_clock::now();
         auto session = server.createSession(config, now);
-        assert(is_hex_string(session->traceId()));
+        assert(is_hex_string(session->traceId().toString()));
         net::LoginRequest login{"user1", "letmein"};
         auto payload = net::encodeLoginRequest(login);
         net::FrameHeader header{static_cast<std::uint32_t>(payload.size()),
@@ -673,8 +1391,8 @@ int main() {
         const auto logs = capture.str();
         assert(logs.find("\"event\":\"packet_received\"") != std::string::npos);
         assert(logs.find("\"request_trace_id\":\"") != std::string::npos);
-        assert(logs.find("\"session_trace_id\":\"" + session->traceId() + "\"") !=
-               std::string::npos);
+        assert(logs.find("\"session_trace_id\":\"" + session->traceId().toString() +
+                         "\"") != std::string::npos);
     }
 
     {
@@ -694,6 +1412,22 @@ int main() {
         assert(metrics.bytes_total == payload.size());
         assert(metrics.error_total == 1);
         assert(server.sessionCount() == 1);
+
+        login.password = "letmein";
+        payload = net::encodeLoginRequest(login);
+        header.length = static_cast<std::uint32_t>(payload.size());
+        assert(server.handlePacket(*session, header, payload, now).has_value());
+        auto login_metrics = server.packetMetrics(net::PacketType::LoginReq);
+        assert(login_metrics.has_value());
+        assert(login_metrics->count == 2);
+        assert(login_metrics->errors == 1);
+        assert(login_metrics->latency.count() == 2);
+        assert(server.packetMetrics(net::PacketType::LogoutReq)->count == 0);
+        assert(!server.packetMetrics(net::PacketType::VersionReject).has_value());
+
+        net::FrameHeader unknown{0, 0xFFFF, net::kMinProtocolVersion};
+        assert(!server.handlePacket(*session, unknown, {}, now).has_value());
+        assert(server.metrics().error_total == 2);
     }
 
     {
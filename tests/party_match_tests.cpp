@@ -67,6 +67,20 @@ int main() {
                          party::PartyEventType::InviteExpired) != events.end());
     }
 
+    {
+        // Times from before the service was built (a caller's own clock)
+        // still expire invites.
+        party::PartyService service;
+        service.setInviteTimeout(milliseconds{5});
+        auto party_id = service.createParty(100, "leader");
+        assert(party_id.has_value());
+        auto past = steady_clock::now() - std::chrono::hours{1};
+        assert(service.inviteMember(*party_id, 100, 200, "member", past));
+        assert(service.expireInvites(past + milliseconds{1}) == 0);
+        assert(service.expireInvites(past + milliseconds{10}) == 1);
+        assert(!service.acceptInvite(*party_id, 200, past + milliseconds{10}));
+    }
+
     {
         match::MatchRule rule;
         rule.max_mmr_delta = 100;
@@ -1,9 +1,19 @@
+#include "reward/grant_store.h"
 #include "reward/inventory.h"
 #include "reward/reward_service.h"
 
 #include <cassert>
+#include <chrono>
+#include <csignal>
+#include <filesystem>
+#include <fstream>
+#include <string>
 #include <vector>
 
+#if !defined(_WIN32)
+#include <sys/resource.h>
+#endif
+
 int main() {
     {
         reward::Inventory inventory(5);
@@ -39,5 +49,191 @@ int main() {
         assert(inventory.items().empty());
     }
 
+    {
+        using namespace std::chrono_literals;
+        reward::GrantStoreConfig config;
+        config.window = 10min;
+        config.bucket = 1min;
+        config.initial_capacity = 16;
+        reward::GrantIdempotencyStore store(config);
+        auto start = reward::GrantIdempotencyStore::Clock::time_point(1'699'999'980s);
+
+        // Duplicate detection through an attached inventory (wall clock).
+        reward::GrantIdempotencyStore shared;
+        reward::Inventory inventory(10);
+        inventory.attachGrantStore(&shared, reward::GrantIdempotencyStore::Clock::now());
+        reward::RewardService service;
+        std::vector<reward::RewardItem> items = {{101, 1}};
+        assert(service.grantRewards(inventory, 7, items));
+        assert(service.grantRewardsDetailed(inventory, 7, items) ==
+               reward::RewardService::GrantResult::Duplicate);
+        assert(shared.status(7) == reward::GrantStatus::Completed);
+        assert(inventory.grantStatus(7) == reward::GrantStatus::Completed);
+
+        // Failed grants may be retried; pending ones may not.
+        assert(store.begin(1, start));
+        assert(!store.begin(1, start));
+        store.fail(1);
+        assert(store.begin(1, start + 30s));
+        store.complete(1);
+
+        // Enough ids to grow the table several times, spread over the window.
+        for (reward::GrantId id = 100; id < 1100; ++id) {
+            assert(store.begin(id, start + std::chrono::seconds(id - 100) / 2));
+            store.complete(id);
+        }
+        assert(store.size() == 1001 && store.capacity() >= 1024);
+        for (reward::GrantId id = 100; id < 1100; ++id) {
+            assert(store.status(id) == reward::GrantStatus::Completed);
+        }
+
+        // 12 minutes in: everything begun in the first two minutes is gone
+        // (ids 100..339 and 1), the rest stays, and lookups still resolve
+        // across the holes deletion left behind.
+        store.expire(start + 12min);
+        assert(store.status(1) == reward::GrantStatus::None);
+        assert(store.status(339) == reward::GrantStatus::None);
+        assert(store.status(340) == reward::GrantStatus::Completed);
+        assert(store.status(1099) == reward::GrantStatus::Completed);
+        std::size_t live = 0;
+        for (reward::GrantId id = 100; id < 1100; ++id) {
+            live += store.status(id) == reward::GrantStatus::Completed ? 1 : 0;
+        }
+        assert(live == 760 && store.size() == 760);
+
+        // Far past the window only ids begun since remain; memory is reused.
+        auto capacity = store.capacity();
+        for (int round = 0; round < 20; ++round) {
+            auto now = start + 30min + std::chrono::minutes(round);
+            for (reward::GrantId id = 0; id < 100; ++id) {
+                assert(store.begin(10'000 + round * 100 + id, now));
+            }
+        }
+        assert(store.size() <= 11 * 100 + 100 && store.capacity() == capacity);
+    }
+
+    {
+        using namespace std::chrono_literals;
+        auto path = (std::filesystem::temp_directory_path() / "dungeonhub_grant_journal_test.bin")
+                        .string();
+        std::filesystem::remove(path);
+        reward::GrantStoreConfig config;
+        config.window = 1h;
+        auto start = reward::GrantIdempotencyStore::Clock::time_point(1'700'000'000s);
+        {
+            reward::GrantIdempotencyStore store(config);
+            assert(store.openJournal(path, start));
+            assert(store.begin(1, start));
+            store.complete(1);
+            assert(store.begin(2, start + 10min));
+            store.fail(2);
+            assert(store.begin(3, start + 50min));
+        }
+        // A crash mid-record leaves a torn tail.
+        {
+            std::ofstream torn(path, std::ios::binary | std::ios::app);
+            torn.write("\x05\x00\x00", 3);
+        }
+        {
+            // Restarted 20 minutes later: grant 1 (begun 70 minutes ago) has
+            // expired, grant 2 is still within the hour, and grant 3 stays
+            // pending so it cannot be granted twice.
+            reward::GrantIdempotencyStore store(config);
+            assert(store.openJournal(path, start + 70min));
+            assert(store.status(1) == reward::GrantStatus::None);
+            assert(store.status(2) == reward::GrantStatus::Failed);
+            assert(store.status(3) == reward::GrantStatus::Pending);
+            assert(!store.begin(3, start + 70min));
+            assert(store.begin(2, start + 70min));
+            store.complete(2);
+            // Compacted to live grants, then one more record appended.
+            assert(std::filesystem::file_size(path) ==
+                   reward::GrantIdempotencyStore::kJournalHeaderSize +
+                       4 * reward::GrantIdempotencyStore::kJournalRecordSize);
+        }
+        {
+            reward::GrantIdempotencyStore store(config);
+            assert(store.openJournal(path, start + 71min));
+            assert(store.status(2) == reward::GrantStatus::Completed);
+            assert(store.size() == 2);
+        }
+        {
+            std::ofstream garbage(path, std::ios::binary | std::ios::trunc);
+            garbage << "not a journal";
+        }
+        reward::GrantIdempotencyStore store(config);
+        assert(!store.openJournal(path, start) && !store.journalOpen());
+        std::filesystem::remove(path);
+    }
+
+    {
+        // The journal is compacted again as buckets expire, not only when
+        // it is opened, so it stays proportional to the live grants.
+        using namespace std::chrono_literals;
+        auto path = (std::filesystem::temp_directory_path() / "dungeonhub_grant_journal_compact.bin")
+                        .string();
+        std::filesystem::remove(path);
+        reward::GrantStoreConfig config;
+        config.window = 1h;
+        auto start = reward::GrantIdempotencyStore::Clock::time_point(1'700'000'000s);
+        constexpr auto kRecord = reward::GrantIdempotencyStore::kJournalRecordSize;
+        constexpr auto kHeader = reward::GrantIdempotencyStore::kJournalHeaderSize;
+        reward::GrantIdempotencyStore store(config);
+        assert(store.openJournal(path, start));
+        for (reward::GrantId id = 1; id <= 2000; ++id) {
+            assert(store.begin(id, start) && store.complete(id));
+        }
+        assert(store.begin(3000, start + 30min));
+        assert(std::filesystem::file_size(path) == kHeader + 4001 * kRecord);
+
+        // The first 2000 expire; one live grant left, then one new record.
+        assert(store.begin(3001, start + 62min));
+        assert(store.size() == 2 && store.journalOpen());
+        assert(std::filesystem::file_size(path) == kHeader + 2 * kRecord);
+        store.closeJournal();
+
+        reward::GrantIdempotencyStore replayed(config);
+        assert(replayed.openJournal(path, start + 62min));
+        assert(replayed.status(3000) == reward::GrantStatus::Pending);
+        assert(replayed.status(3001) == reward::GrantStatus::Pending);
+        assert(replayed.size() == 2);
+        std::filesystem::remove(path);
+    }
+
+#if !defined(_WIN32)
+    {
+        // A failed append (here a file size limit standing in for a full
+        // disk) refuses the grant and closes the journal instead of
+        // pretending the record is durable.
+        using namespace std::chrono_literals;
+        auto path = (std::filesystem::temp_directory_path() / "dungeonhub_grant_journal_full.bin")
+                        .string();
+        std::filesystem::remove(path);
+        auto start = reward::GrantIdempotencyStore::Clock::time_point(1'700'000'000s);
+        reward::GrantIdempotencyStore store;
+        assert(store.openJournal(path, start));
+        assert(store.begin(1, start));
+
+        std::signal(SIGXFSZ, SIG_IGN);
+        rlimit original{};
+        assert(getrlimit(RLIMIT_FSIZE, &original) == 0);
+        rlimit capped = original;
+        capped.rlim_cur = std::filesystem::file_size(path) + 8;
+        assert(setrlimit(RLIMIT_FSIZE, &capped) == 0);
+        assert(!store.begin(2, start));
+        assert(setrlimit(RLIMIT_FSIZE, &original) == 0);
+        assert(store.status(2) == reward::GrantStatus::None);
+        assert(!store.journalOpen() && store.journalErrors() == 1);
+
+        // In memory only from here on.
+        assert(store.begin(2, start) && store.complete(2));
+        reward::GrantIdempotencyStore replayed;
+        assert(replayed.openJournal(path, start));
+        assert(replayed.status(1) == reward::GrantStatus::Pending);
+        assert(replayed.status(2) == reward::GrantStatus::None);
+        std::filesystem::remove(path);
+    }
+#endif
+
     return 0;
 }